@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// Compares the per-call latency of the adaptive window estimators of the
+// velocity and of the acceleration of a set of joints sampled at 1 kHz, as
+// in velocityObserver and wholeBodyDynamics, against the former
+// implementation, which kept the samples in a deque of Vectors and fitted
+// every window with the pseudo-inverse of its regressors. The estimates of
+// both implementations are checked to agree, also for a velocity estimator
+// of order 3, which exercises the fit of the plain monomials of the time.
+//
+// Usage: awPolyEstimatorBenchmark [--joints <int>] [--samples <int>]
+
+#include <cmath>
+#include <deque>
+#include <random>
+#include <string>
+#include <algorithm>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+#include <yarp/math/Math.h>
+#include <yarp/math/SVD.h>
+
+#include <iCub/ctrl/adaptWinPolyEstimator.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::ctrl;
+
+
+/************************************************************************/
+class LegacyEstimator
+{
+    deque<AWPolyElement> elemList;
+    unsigned int order,N;
+    double D;
+    Vector t,x,coeff,winLen;
+
+    Vector fit(const unsigned int n)
+    {
+        unsigned int i1=N-n;
+        if (order==1)
+        {
+            double sum_xi=0.0,sum_xixi=0.0,sum_yi=0.0,sum_xiyi=0.0;
+            for (unsigned int i=i1; i<N; i++)
+            {
+                sum_xi+=t[i];
+                sum_xixi+=t[i]*t[i];
+                sum_yi+=x[i];
+                sum_xiyi+=t[i]*x[i];
+            }
+            double den=n*sum_xixi-sum_xi*sum_xi;
+            Vector c(2);
+            c[0]=(sum_yi*sum_xixi-sum_xi*sum_xiyi)/den;
+            c[1]=(n*sum_xiyi-sum_xi*sum_yi)/den;
+            return c;
+        }
+
+        Matrix R(n,order+1);
+        Vector _y(n);
+        for (unsigned int i=i1; i<N; i++)
+        {
+            double _x=1.0;
+            R(i-i1,0)=1.0;
+            for (unsigned int j=1; j<=order; j++)
+            {
+                _x*=t[i];
+                R(i-i1,j)=_x;
+            }
+            _y[i-i1]=x[i];
+        }
+        return pinv(R)*_y;
+    }
+
+    double eval(double _x)
+    {
+        double y=coeff[0];
+        double p=1.0;
+        for (unsigned int i=1; i<=order; i++)
+        {
+            p*=_x;
+            y+=coeff[i]*p;
+        }
+        return y;
+    }
+
+public:
+    LegacyEstimator(unsigned int _order, unsigned int _N, const double _D) :
+                    order(_order), N(_N), D(_D), t(_N), x(_N), coeff(_order+1) { }
+
+    Vector estimate(const AWPolyElement &el)
+    {
+        elemList.push_back(el);
+        size_t dim=el.data.length();
+        Vector esteem(dim,0.0);
+        if (winLen.length()!=dim)
+            winLen.resize(dim,N);
+
+        int delta=(int)elemList.size()-(int)N;
+        if (delta<0)
+            return esteem;
+
+        t[0]=0.0;
+        for (unsigned int j=1; j<N; j++)
+            t[j]=elemList[delta+j].time-elemList[delta].time;
+
+        for (size_t i=0; i<dim; i++)
+        {
+            for (unsigned int j=0; j<N; j++)
+                x[j]=elemList[delta+j].data[i];
+
+            unsigned int n1=(unsigned int)((winLen[i]>(order+1))?(winLen[i]-1):(order+1));
+            unsigned int n2=(unsigned int)((winLen[i]<N)?(winLen[i]+1):N);
+            for (unsigned int n=n1; n<=n2; n++)
+            {
+                coeff=fit(n);
+                bool _stop=false;
+                for (unsigned int k=N-n; k<N; k++)
+                    _stop|=(fabs(x[k]-eval(t[k]))>D);
+                if (_stop)
+                {
+                    winLen[i]=n;
+                    break;
+                }
+            }
+
+            esteem[i]=(order==2)?2.0*coeff[2]:coeff[1];
+        }
+
+        int margin=delta-10;
+        if (margin>0)
+            elemList.erase(elemList.begin(),elemList.begin()+margin);
+
+        return esteem;
+    }
+};
+
+
+/************************************************************************/
+class AWCubicEstimator : public AWPolyEstimator
+{
+protected:
+    virtual double getEsteeme() { return coeff[1]; }
+
+public:
+    AWCubicEstimator(unsigned int _N, const double _D) :
+                     AWPolyEstimator(3,_N,_D) { }
+};
+
+
+/************************************************************************/
+template<class T>
+void benchmark(const string &name, const unsigned int order, const unsigned int N,
+               const double D, const int joints, const int samples)
+{
+    LegacyEstimator legacy(order,N,D);
+    T estimator(N,D);
+
+    mt19937 gen(0);
+    normal_distribution<double> noise(0.0,0.01);
+
+    double tLegacy=0.0,tEstimator=0.0,err=0.0;
+    for (int k=0; k<samples; k++)
+    {
+        double time=1e-3*k;
+        Vector q(joints);
+        for (int j=0; j<joints; j++)
+            q[j]=30.0*sin(2.0*M_PI*0.5*time+j)+noise(gen);
+        AWPolyElement el(q,time);
+
+        double t0=Time::now();
+        Vector v0=legacy.estimate(el);
+        double t1=Time::now();
+        Vector v1=estimator.estimate(el);
+        double t2=Time::now();
+
+        tLegacy+=t1-t0;
+        tEstimator+=t2-t1;
+        for (int j=0; j<joints; j++)
+            err=std::max(err,fabs(v0[j]-v1[j]));
+    }
+
+    yInfo("%s (N=%u, %d joints): legacy %7.2f [us], ring buffer %6.2f [us] (max deviation %g)",
+          name.c_str(),N,joints,1e6*tLegacy/samples,1e6*tEstimator/samples,err);
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property options;
+    options.fromCommand(argc,argv);
+    int joints=options.check("joints",Value(32)).asInt32();
+    int samples=options.check("samples",Value(10000)).asInt32();
+
+    benchmark<AWLinEstimator>("velocity",1,16,1.0,joints,samples);
+    benchmark<AWLinEstimator>("velocity",1,32,0.5,joints,samples);
+    benchmark<AWQuadEstimator>("acceleration",2,25,1.0,joints,samples);
+    benchmark<AWQuadEstimator>("acceleration",2,50,0.5,joints,samples);
+    benchmark<AWCubicEstimator>("cubic velocity",3,25,1.0,joints,samples);
+
+    return 0;
+}
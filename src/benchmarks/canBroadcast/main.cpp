@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// Compares the per-cycle cost of decoding the broadcast messages received by
+// CanBusMotionControl when the destination axes are searched for every message
+// (former handleBroadcasts) against the lookup in the CanBroadcastTable built
+// at open(). A recorded CAN buffer is replayed: either the one given in a text
+// file, with one message per line as "<id> <len> <b0> ... <b7>" in hex, or a
+// synthetic one of a full body network (8 control boards, 2 strain sensors).
+//
+// Usage: canBroadcastBenchmark [--iterations <int>] [--file <path>]
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+
+#include <messages.h>
+#include "CanBroadcastTable.h"
+
+using namespace std;
+using namespace yarp::os;
+
+
+/************************************************************************/
+const int njoints=16;
+const int ncards=16;
+
+struct Frame
+{
+    unsigned int id;
+    unsigned int len;
+    unsigned char data[8];
+};
+
+struct Axis
+{
+    double torque;
+    int position_joint;
+    int position_rotor;
+    int speed_rotor,accel_rotor;
+    int speed_joint,accel_joint;
+    int pid_value;
+    int current;
+    int position_error,torque_error;
+    double update;
+};
+
+struct Config
+{
+    unsigned char destinations[ncards];
+    int sensorId[njoints];
+    int sensorChan[njoints];
+    double newtonsToSensor[njoints];
+};
+
+
+/************************************************************************/
+// the decoding of the payload of the messages of the control boards
+static void decodeBoard(unsigned int type, int j, const unsigned char *data,
+                        vector<Axis> &axes, double now)
+{
+    if (j>=njoints)
+        return;
+
+    switch (type)
+    {
+        case ICUBCANPROTO_PER_MC_MSG__POSITION:
+            axes[j].position_joint=*((int *)(data)); axes[j].update=now;
+            if (++j<njoints) { axes[j].position_joint=*((int *)(data+4)); axes[j].update=now; }
+        break;
+        case ICUBCANPROTO_PER_MC_MSG__MOTOR_POSITION:
+            axes[j].position_rotor=*((int *)(data)); axes[j].update=now;
+            if (++j<njoints) { axes[j].position_rotor=*((int *)(data+4)); axes[j].update=now; }
+        break;
+        case ICUBCANPROTO_PER_MC_MSG__MOTOR_SPEED:
+            axes[j].speed_rotor=*((short *)(data)); axes[j].accel_rotor=*((short *)(data+4));
+            if (++j<njoints) { axes[j].speed_rotor=*((short *)(data+2)); axes[j].accel_rotor=*((short *)(data+6)); }
+        break;
+        case ICUBCANPROTO_PER_MC_MSG__PID_VAL:
+            axes[j].pid_value=*((short *)(data));
+            if (++j<njoints) axes[j].pid_value=*((short *)(data+2));
+        break;
+        case ICUBCANPROTO_PER_MC_MSG__CURRENT:
+            axes[j].current=*((short *)(data));
+            if (++j<njoints) axes[j].current=*((short *)(data+2));
+        break;
+        case ICUBCANPROTO_PER_MC_MSG__PID_ERROR:
+            axes[j].position_error=*((short *)(data)); axes[j].torque_error=*((short *)(data+4));
+            if (++j<njoints) { axes[j].position_error=*((short *)(data+2)); axes[j].torque_error=*((short *)(data+6)); }
+        break;
+        case ICUBCANPROTO_PER_MC_MSG__VELOCITY:
+            axes[j].speed_joint=*((short *)(data)); axes[j].accel_joint=*((short *)(data+4));
+            if (++j<njoints) { axes[j].speed_joint=*((short *)(data+2)); axes[j].accel_joint=*((short *)(data+6)); }
+        break;
+        default:
+        break;
+    }
+}
+
+
+/************************************************************************/
+// the former decoding: the boards and the torque sensors are searched for every message
+static void decodeSearch(const Config &cfg, const vector<Frame> &buffer,
+                         vector<Axis> &axes, double now)
+{
+    for (const auto &m: buffer)
+    {
+        const unsigned char *data=m.data;
+        if ((m.id&0x700)==0x300)
+        {
+            const unsigned int addr=((m.id&0x0f0)>>4);
+            const unsigned int type=m.id&0x00f;
+            if (type==0x0A || type==0x0B)
+            {
+                int off=(type-0x0A)*3;
+                for (int axis=0; axis<njoints; axis++)
+                {
+                    if (cfg.sensorId[axis]==(int)addr)
+                    {
+                        for (int chan=0; chan<3; chan++)
+                        {
+                            if (cfg.sensorChan[axis]==chan+off)
+                            {
+                                double scaleFactor=1/cfg.newtonsToSensor[axis];
+                                axes[axis].torque=(((unsigned short)(data[2*chan+1]))<<8)+data[2*chan]-0x8000;
+                                axes[axis].torque=axes[axis].torque*scaleFactor;
+                                axes[axis].update=now;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        else if ((m.id&0x700)==0x100)
+        {
+            const int addr=((m.id&0x0f0)>>4);
+            int j;
+            for (j=0; j<ncards; j++)
+                if (cfg.destinations[j]==addr)
+                    break;
+            if (j<ncards)
+                decodeBoard(m.id&0x00f,2*j,data,axes,now);
+        }
+    }
+}
+
+
+/************************************************************************/
+// the decoding driven by the dispatch table
+static void decodeTable(const CanBroadcastTable &table, const vector<Frame> &buffer,
+                        vector<Axis> &axes, double now)
+{
+    for (const auto &m: buffer)
+    {
+        const unsigned char *data=m.data;
+        const CanBroadcastTable::Slot &slot=table.lookup(m.id);
+        if (slot.decoder==CanBroadcastTable::strain)
+        {
+            const CanBroadcastTable::StrainTarget *target=table.strainTargets(slot);
+            for (int k=0; k<slot.count; k++, target++)
+            {
+                const int chan=target->chan;
+                axes[target->axis].torque=(((unsigned short)(data[2*chan+1]))<<8)+data[2*chan]-0x8000;
+                axes[target->axis].torque=axes[target->axis].torque*target->scale;
+                axes[target->axis].update=now;
+            }
+        }
+        else if (slot.decoder==CanBroadcastTable::board)
+            decodeBoard(slot.type,slot.joint,data,axes,now);
+    }
+}
+
+
+/************************************************************************/
+static vector<Frame> synthesize(const Config &cfg)
+{
+    const unsigned int types[]={ICUBCANPROTO_PER_MC_MSG__POSITION, ICUBCANPROTO_PER_MC_MSG__MOTOR_POSITION,
+                                ICUBCANPROTO_PER_MC_MSG__MOTOR_SPEED, ICUBCANPROTO_PER_MC_MSG__PID_VAL,
+                                ICUBCANPROTO_PER_MC_MSG__CURRENT, ICUBCANPROTO_PER_MC_MSG__PID_ERROR,
+                                ICUBCANPROTO_PER_MC_MSG__VELOCITY};
+    vector<Frame> buffer;
+    unsigned char seed=0;
+    for (int b=0; b<njoints/2; b++)
+    {
+        for (unsigned int type: types)
+        {
+            Frame f;
+            f.id=0x100|(cfg.destinations[b]<<4)|type;
+            f.len=8;
+            for (int k=0; k<8; k++)
+                f.data[k]=seed++;
+            buffer.push_back(f);
+        }
+    }
+    for (int addr=13; addr<=14; addr++)
+    {
+        for (unsigned int type=0x0A; type<=0x0B; type++)
+        {
+            Frame f;
+            f.id=0x300|(addr<<4)|type;
+            f.len=6;
+            for (int k=0; k<8; k++)
+                f.data[k]=seed++;
+            buffer.push_back(f);
+        }
+    }
+    return buffer;
+}
+
+
+/************************************************************************/
+static bool load(const string &fileName, vector<Frame> &buffer)
+{
+    ifstream fin(fileName);
+    if (!fin.is_open())
+        return false;
+
+    string line;
+    while (getline(fin,line))
+    {
+        istringstream str(line);
+        Frame f;
+        memset(f.data,0,sizeof(f.data));
+        if (!(str>>hex>>f.id>>f.len))
+            continue;
+        f.len=std::min(f.len,8U);
+        for (unsigned int k=0; k<f.len; k++)
+        {
+            unsigned int b;
+            if (str>>hex>>b)
+                f.data[k]=(unsigned char)b;
+        }
+        buffer.push_back(f);
+    }
+    return true;
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property options;
+    options.fromCommand(argc,argv);
+    int iterations=options.check("iterations",Value(100000)).asInt32();
+
+    // 8 control boards with two joints each and two strain sensors
+    // measuring the torques of the first 12 joints
+    Config cfg;
+    memset(cfg.destinations,0,sizeof(cfg.destinations));
+    for (int b=0; b<njoints/2; b++)
+        cfg.destinations[b]=(unsigned char)(b+1);
+    for (int j=0; j<njoints; j++)
+    {
+        cfg.sensorId[j]=(j<6)?13:((j<12)?14:0);
+        cfg.sensorChan[j]=j%6;
+        cfg.newtonsToSensor[j]=double(0x8000)/double(10+j);
+    }
+
+    vector<Frame> buffer;
+    if (options.check("file"))
+    {
+        string fileName=options.find("file").asString();
+        if (!load(fileName,buffer))
+        {
+            yError("cannot read %s",fileName.c_str());
+            return 1;
+        }
+    }
+    else
+        buffer=synthesize(cfg);
+
+    CanBroadcastTable table;
+    table.build(njoints,cfg.destinations,ncards,cfg.sensorId,cfg.sensorChan,cfg.newtonsToSensor);
+
+    vector<Axis> axes1(njoints),axes2(njoints);
+    memset(axes1.data(),0,njoints*sizeof(Axis));
+    memset(axes2.data(),0,njoints*sizeof(Axis));
+
+    double t0=Time::now();
+    for (int k=0; k<iterations; k++)
+        decodeSearch(cfg,buffer,axes1,k);
+    double t1=Time::now();
+    for (int k=0; k<iterations; k++)
+        decodeTable(table,buffer,axes2,k);
+    double t2=Time::now();
+
+    bool same=(memcmp(axes1.data(),axes2.data(),njoints*sizeof(Axis))==0);
+
+    double ns_search=1e9*(t1-t0)/iterations;
+    double ns_table=1e9*(t2-t1)/iterations;
+    yInfo("%zu messages per cycle: search %.1f [ns/cycle], table %.1f [ns/cycle], speedup x%.2f, same result: %s",
+          buffer.size(),ns_search,ns_table,ns_search/ns_table,same?"yes":"no");
+
+    return (same?0:1);
+}
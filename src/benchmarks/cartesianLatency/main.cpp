@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// Measures the latency between a goTo request to the Cartesian controller and
+// the first command it sends to the robot, as streamed by the server on its
+// port /<ctrl>/dbg/latency:o (option DebugInfo on). The server is linked to the
+// solver either through the ports of iKinCartesianSolver or in-process (group
+// SOLVER in its configuration): run the benchmark once per configuration, e.g.
+// with the simulator, to compare the two. The hand moves back and forth along
+// the y axis around its initial position, waiting for each movement to end.
+//
+// Usage: cartesianLatencyBenchmark [--remote <port>] [--iterations <int>]
+//                                  [--amplitude <m>] [--T <s>]
+
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+#include <yarp/os/Network.h>
+#include <yarp/os/Log.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/dev/PolyDriver.h>
+#include <yarp/dev/CartesianControl.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::dev;
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Network yarp;
+    if (!yarp.checkNetwork())
+    {
+        yError("YARP server not available!");
+        return 1;
+    }
+
+    Property options;
+    options.fromCommand(argc,argv);
+    string remote=options.check("remote",Value("/icubSim/cartesianController/right_arm")).asString();
+    int iterations=options.check("iterations",Value(20)).asInt32();
+    double amplitude=options.check("amplitude",Value(0.05)).asFloat64();
+    double T=options.check("T",Value(1.0)).asFloat64();
+
+    Property optClient("(device cartesiancontrollerclient)");
+    optClient.put("remote",remote);
+    optClient.put("local","/cartesianLatencyBenchmark/client");
+
+    PolyDriver driver;
+    ICartesianControl *icart=nullptr;
+    if (!driver.open(optClient) || !driver.view(icart))
+    {
+        yError("Unable to connect to %s",remote.c_str());
+        return 1;
+    }
+
+    BufferedPort<Bottle> portLatency;
+    portLatency.open("/cartesianLatencyBenchmark/latency:i");
+    if (!Network::connect(remote+"/dbg/latency:o",portLatency.getName(),"tcp"))
+    {
+        yError("Unable to connect to %s/dbg/latency:o: is DebugInfo on?",remote.c_str());
+        portLatency.close();
+        driver.close();
+        return 1;
+    }
+
+    int context;
+    icart->storeContext(&context);
+    icart->setTrajTime(T);
+
+    Vector x0,o0;
+    icart->getPose(x0,o0);
+
+    double sum=0.0,min=1e9,max=0.0;
+    int n=0;
+    string mode;
+    for (int k=0; k<iterations; k++)
+    {
+        Vector xd=x0;
+        xd[1]+=((k%2)==0?amplitude:-amplitude);
+
+        // drop the samples of the previous movements
+        while (portLatency.read(false)!=nullptr);
+
+        icart->goToPose(xd,o0);
+
+        Bottle *b=nullptr;
+        double t0=Time::now();
+        while (((b=portLatency.read(false))==nullptr) && (Time::now()-t0<T))
+            Time::delay(0.001);
+
+        if (b!=nullptr)
+        {
+            double latency=b->get(2).asFloat64();
+            mode=b->get(3).asString();
+            sum+=latency;
+            min=std::min(min,latency);
+            max=std::max(max,latency);
+            n++;
+        }
+        else
+            yWarning("No command sent within %g [s] from the request #%d",T,k);
+
+        icart->waitMotionDone(0.1,2.0*T);
+    }
+
+    icart->goToPoseSync(x0,o0);
+    icart->waitMotionDone(0.1,2.0*T);
+    icart->restoreContext(context);
+    icart->deleteContext(context);
+
+    portLatency.close();
+    driver.close();
+
+    if (n==0)
+    {
+        yError("No latency sample received");
+        return 1;
+    }
+
+    yInfo("goTo to first command (%s solver, %d requests): mean %.2f [ms], min %.2f [ms], max %.2f [ms]",
+          mode.c_str(),n,1e3*sum/n,1e3*min,1e3*max);
+    return 0;
+}
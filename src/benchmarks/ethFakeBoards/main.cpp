@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// Stand-in for the ETH boards of a robot: it is the board-side counterpart
+// of FakeEthResource. Every fake board sends empty ropframes at a fixed rate
+// from its own IP address to the PC104, so that the throughput of the rx path
+// of TheEthManager (EthReceiver in mode poll, batch or event, with or without
+// rx workers) can be measured at 1 kHz x N boards. Run the robot interface with
+// NETWORK_PERFORMANCE_BENCHMARK enabled to get the statistics of the receiver,
+// and with the group DEBUG of its configuration set to
+//     (embBoardsConnected false) (fakeBoardsRX true)
+// so that the boards at these addresses are FakeEthResource objects, which do
+// not need the handshake with the boards, and the packets are parsed by their
+// processRXpacket() on the rx workers, as for the real boards.
+//
+// The addresses of the boards must be assigned to a local interface, e.g.:
+//     for i in $(seq 1 30); do sudo ip addr add 10.0.1.$i/32 dev lo; done
+//
+// Usage: ethFakeBoardsBenchmark [--boards <int>] [--rate <Hz>] [--duration <s>]
+//                               [--network <a.b.c>] [--pc104 <a.b.c.d>] [--port <int>]
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <ace/SOCK_Dgram.h>
+#include <ace/INET_Addr.h>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+
+#include "EOropframe_hid.h"
+
+using namespace std;
+using namespace yarp::os;
+
+
+/************************************************************************/
+struct FakeBoard
+{
+    ACE_SOCK_Dgram socket;
+    uint64_t frame[8];
+    uint64_t sequence;
+    uint64_t sent;
+    uint64_t failed;
+};
+
+
+/************************************************************************/
+// it fills an empty ropframe, i.e. an header with no rops followed by the footer
+static size_t fillRopframe(FakeBoard &board, double now)
+{
+    EOropframeHeader_t *header=reinterpret_cast<EOropframeHeader_t*>(board.frame);
+    memset(header,0,sizeof(EOropframeHeader_t));
+    header->startofframe=EOFRAME_START;
+    header->ropssizeof=0;
+    header->ropsnumberof=0;
+    header->sequencenumber=++board.sequence;
+    header->ageofframe=static_cast<uint64_t>(1e6*now);
+
+    uint32_t footer=EOFRAME_STOP;
+    memcpy(reinterpret_cast<uint8_t*>(board.frame)+sizeof(EOropframeHeader_t),&footer,sizeof(footer));
+
+    return sizeof(EOropframeHeader_t)+sizeof(footer);
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property options;
+    options.fromCommand(argc,argv);
+    int boards=options.check("boards",Value(30)).asInt32();
+    double rate=options.check("rate",Value(1000.0)).asFloat64();
+    double duration=options.check("duration",Value(10.0)).asFloat64();
+    string network=options.check("network",Value("10.0.1")).asString();
+    string pc104=options.check("pc104",Value("10.0.1.104")).asString();
+    int port=options.check("port",Value(12345)).asInt32();
+
+    boards=std::max(1,std::min(boards,32));
+    ACE_INET_Addr destination((u_short)port,pc104.c_str());
+
+    vector<FakeBoard> fake(boards);
+    for (int i=0; i<boards; i++)
+    {
+        string address=network+"."+to_string(i+1);
+        ACE_INET_Addr local((u_short)port,address.c_str());
+        if (fake[i].socket.open(local)==-1)
+        {
+            yError("cannot bind fake board %d to %s:%d: is the address assigned to a local interface?",
+                   i+1,address.c_str(),port);
+            return 1;
+        }
+        fake[i].sequence=fake[i].sent=fake[i].failed=0;
+    }
+
+    yInfo("%d fake boards on %s.[1-%d] send empty ropframes at %g Hz to %s:%d for %g s",
+          boards,network.c_str(),boards,rate,pc104.c_str(),port,duration);
+
+    // the periods are scheduled on absolute deadlines so that the rate does not drift
+    const double period=1.0/rate;
+    double t0=Time::now();
+    double next=t0;
+    double maxlateness=0.0;
+    uint64_t cycles=0;
+
+    while (Time::now()-t0<duration)
+    {
+        double now=Time::now();
+        maxlateness=std::max(maxlateness,now-next);
+
+        for (auto &board: fake)
+        {
+            size_t size=fillRopframe(board,now);
+            if (board.socket.send(board.frame,size,destination)==(ssize_t)size)
+                board.sent++;
+            else
+                board.failed++;
+        }
+        cycles++;
+
+        next+=period;
+        double wait=next-Time::now();
+        if (wait>0.0)
+            Time::delay(wait);
+    }
+    double elapsed=Time::now()-t0;
+
+    uint64_t sent=0,failed=0;
+    for (auto &board: fake)
+    {
+        sent+=board.sent;
+        failed+=board.failed;
+        board.socket.close();
+    }
+
+    yInfo("%llu cycles in %.3f s: achieved rate %.1f Hz per board, %.0f packets/s in total, %llu failed sends, max lateness %.3f ms",
+          (unsigned long long)cycles,elapsed,cycles/elapsed,sent/elapsed,(unsigned long long)failed,1e3*maxlateness);
+
+    return 0;
+}
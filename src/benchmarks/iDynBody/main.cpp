@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// Compares the per-cycle latency of the whole-body computations carried out
+// by wholeBodyDynamics (upper torso Newton-Euler, attachment and lower torso
+// Newton-Euler, COM and COM Jacobian) when the limbs are solved serially and
+// when they are solved concurrently by iCubWholeBody::setParallel() with an
+// increasing number of workers. The joint torques must be identical.
+//
+// Usage: iDynBodyBenchmark [--iterations <int>] [--workers <int>]
+
+#include <cmath>
+#include <random>
+#include <deque>
+#include <thread>
+#include <algorithm>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+
+#include <iCub/iDyn/iDyn.h>
+#include <iCub/iDyn/iDynBody.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::iDyn;
+using namespace iCub::skinDynLib;
+
+
+/************************************************************************/
+struct Sample
+{
+    Vector q[6],dq[6],ddq[6];
+    Vector w0,dw0,ddp0;
+    Vector FM[4];
+};
+
+
+/************************************************************************/
+static iDynLimb *getLimb(iCubWholeBody &body, const int i)
+{
+    iDynSensorTorsoNode *node=(i<3)?(iDynSensorTorsoNode*)body.upperTorso:
+                                    (iDynSensorTorsoNode*)body.lowerTorso;
+    switch (i%3)
+    {
+        case 0:  return node->left;
+        case 1:  return node->right;
+        default: return node->up;
+    }
+}
+
+
+/************************************************************************/
+static void cycle(iCubWholeBody &body, const Sample &s)
+{
+    for (int i=0; i<6; i++)
+    {
+        iDynLimb *limb=getLimb(body,i);
+        limb->setAng(s.q[i]);
+        limb->setDAng(s.dq[i]);
+        limb->setD2Ang(s.ddq[i]);
+    }
+
+    Vector FM_up(6,0.0);
+    body.upperTorso->setInertialMeasure(s.w0,s.dw0,s.ddp0);
+    body.upperTorso->setSensorMeasurement(s.FM[0],s.FM[1],FM_up);
+    body.upperTorso->solveKinematics();
+    body.upperTorso->solveWrench();
+
+    body.attachLowerTorso(s.FM[2],s.FM[3]);
+    body.lowerTorso->solveKinematics();
+    body.lowerTorso->solveWrench();
+
+    body.computeCOM();
+    body.EXPERIMENTAL_computeCOMjacobian();
+}
+
+
+/************************************************************************/
+static void getTorques(iCubWholeBody &body, Vector &tau)
+{
+    Vector t;
+    tau.clear();
+    for (int i=0; i<6; i++)
+    {
+        iDynSensorTorsoNode *node=(i<3)?(iDynSensorTorsoNode*)body.upperTorso:
+                                        (iDynSensorTorsoNode*)body.lowerTorso;
+        node->getTorques(i%3,t);
+        for (size_t k=0; k<t.length(); k++)
+            tau.push_back(t[k]);
+    }
+    for (size_t k=0; k<body.whole_COM.length(); k++)
+        tau.push_back(body.whole_COM[k]);
+}
+
+
+/************************************************************************/
+static double run(iCubWholeBody &body, const deque<Sample> &samples, deque<Vector> &taus)
+{
+    Vector tau;
+    taus.clear();
+    double t0=Time::now();
+    for (const auto &s: samples)
+    {
+        cycle(body,s);
+        getTorques(body,tau);
+        taus.push_back(tau);
+    }
+    return (Time::now()-t0);
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property options;
+    options.fromCommand(argc,argv);
+    int iterations=options.check("iterations",Value(5000)).asInt32();
+    int maxWorkers=options.check("workers",Value((int)(std::max(2U,thread::hardware_concurrency())-1))).asInt32();
+
+    version_tag tag;
+    iCubWholeBody body(tag,DYNAMIC,NO_VERBOSE);
+
+    // draw the inputs beforehand
+    mt19937 gen(0);
+    uniform_real_distribution<double> d(-1.0,1.0);
+    deque<Sample> samples;
+    for (int k=0; k<iterations; k++)
+    {
+        Sample s;
+        for (int i=0; i<6; i++)
+        {
+            iDynLimb *limb=getLimb(body,i);
+            unsigned int n=limb->getN();
+            s.q[i].resize(n); s.dq[i].resize(n); s.ddq[i].resize(n);
+            for (unsigned int j=0; j<n; j++)
+            {
+                double min=(*limb->asChain())(j).getMin();
+                double max=(*limb->asChain())(j).getMax();
+                s.q[i][j]=min+0.5*(d(gen)+1.0)*(max-min);
+                s.dq[i][j]=d(gen);
+                s.ddq[i][j]=d(gen);
+            }
+        }
+        s.w0.resize(3); s.dw0.resize(3); s.ddp0.resize(3);
+        for (int j=0; j<3; j++)
+        {
+            s.w0[j]=d(gen); s.dw0[j]=d(gen); s.ddp0[j]=d(gen);
+        }
+        s.ddp0[2]+=9.81;
+        for (int i=0; i<4; i++)
+        {
+            s.FM[i].resize(6);
+            for (int j=0; j<6; j++)
+                s.FM[i][j]=5.0*d(gen);
+        }
+        samples.push_back(s);
+    }
+
+    deque<Vector> ref,taus;
+    double t_serial=run(body,samples,ref);
+    yInfo("%d cycles: serial %.1f [us/cycle]",iterations,1e6*t_serial/iterations);
+
+    bool ok=true;
+    for (int w=1; w<=maxWorkers; w++)
+    {
+        // start from the same state of the serial run
+        iCubWholeBody parBody(tag,DYNAMIC,NO_VERBOSE);
+        parBody.setParallel((unsigned int)w);
+        double t=run(parBody,samples,taus);
+
+        bool same=true;
+        for (size_t k=0; k<ref.size(); k++)
+            same&=(ref[k].length()==taus[k].length()) &&
+                  std::equal(ref[k].begin(),ref[k].end(),taus[k].begin());
+        ok&=same;
+
+        yInfo("%d workers: %.1f [us/cycle], speedup x%.2f, same result: %s",
+              w,1e6*t/iterations,t_serial/t,same?"yes":"no");
+    }
+
+    return (ok?0:1);
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// Checks the composite rigid body (mass matrix) and the articulated body
+// (forward dynamics) algorithms of iDynChain against the recursive
+// Newton-Euler, and compares their latency with the Newton-Euler based
+// approach they replace, i.e. DOF calls with unit accelerations for the
+// mass matrix and one more call for the bias torques, followed by the
+// solution of M*ddq=tau-h, for the forward dynamics. The chains are the
+// arm of iCub with the torso released and the leg. The accelerations from
+// the forward dynamics must reproduce the Newton-Euler torques.
+//
+// Usage: iDynDynamicsBenchmark [--iterations <int>]
+
+#include <cmath>
+#include <random>
+#include <deque>
+#include <string>
+#include <algorithm>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+#include <yarp/math/Math.h>
+
+#include <iCub/iDyn/iDyn.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::iDyn;
+
+
+/************************************************************************/
+struct Sample
+{
+    Vector q,dq,ddq;
+    Vector w0,dw0,ddp0;
+    Vector F,Mu;
+    Vector tau;
+};
+
+
+/************************************************************************/
+static double maxAbsDiff(const Vector &a, const Vector &b)
+{
+    double e=0.0;
+    for (size_t i=0; i<a.length(); i++)
+        e=std::max(e,fabs(a[i]-b[i]));
+    return e;
+}
+
+
+/************************************************************************/
+static double maxAbsDiff(const Matrix &A, const Matrix &B)
+{
+    double e=0.0;
+    for (size_t r=0; r<A.rows(); r++)
+        for (size_t c=0; c<A.cols(); c++)
+            e=std::max(e,fabs(A(r,c)-B(r,c)));
+    return e;
+}
+
+
+/************************************************************************/
+static void setState(iDynChain &chain, const Sample &s)
+{
+    chain.setAng(s.q);
+    chain.setDAng(s.dq);
+    chain.setD2Ang(s.ddq);
+}
+
+
+/************************************************************************/
+static void massMatrixNE(iDynChain &chain, Matrix &M)
+{
+    // the chains have no blocked links, hence the torques are the DOF ones
+    unsigned int dof=chain.getDOF();
+    Vector zero3(3,0.0),e(dof,0.0),tau;
+    M.resize(dof,dof);
+    chain.setDAng(e);
+    for (unsigned int j=0; j<dof; j++)
+    {
+        e[j]=1.0;
+        chain.setD2Ang(e);
+        chain.computeNewtonEuler(zero3,zero3,zero3,zero3,zero3);
+        chain.getTorques(tau);
+        for (unsigned int i=0; i<dof; i++)
+            M(i,j)=tau[i];
+        e[j]=0.0;
+    }
+}
+
+
+/************************************************************************/
+static void forwardDynamicsNE(iDynChain &chain, const Sample &s, Vector &ddq)
+{
+    Matrix M;
+    Vector h;
+    massMatrixNE(chain,M);
+    chain.setDAng(s.dq);
+    chain.setD2Ang(Vector(chain.getDOF(),0.0));
+    chain.computeNewtonEuler(s.w0,s.dw0,s.ddp0,s.F,s.Mu);
+    chain.getTorques(h);
+    ddq=luinv(M)*(s.tau-h);
+}
+
+
+/************************************************************************/
+static void drawSamples(iDynChain &chain, const int n, mt19937 &gen, deque<Sample> &samples)
+{
+    uniform_real_distribution<double> d(-1.0,1.0);
+    unsigned int dof=chain.getDOF();
+    for (int k=0; k<n; k++)
+    {
+        Sample s;
+        s.q.resize(dof); s.dq.resize(dof); s.ddq.resize(dof);
+        for (unsigned int j=0; j<dof; j++)
+        {
+            double min=chain(j).getMin();
+            double max=chain(j).getMax();
+            s.q[j]=min+0.5*(d(gen)+1.0)*(max-min);
+            s.dq[j]=d(gen);
+            s.ddq[j]=d(gen);
+        }
+        s.w0.resize(3); s.dw0.resize(3); s.ddp0.resize(3);
+        s.F.resize(3); s.Mu.resize(3);
+        for (int j=0; j<3; j++)
+        {
+            s.w0[j]=d(gen); s.dw0[j]=d(gen); s.ddp0[j]=d(gen);
+            s.F[j]=5.0*d(gen); s.Mu[j]=0.5*d(gen);
+        }
+        s.ddp0[2]+=9.81;
+
+        setState(chain,s);
+        chain.computeNewtonEuler(s.w0,s.dw0,s.ddp0,s.F,s.Mu);
+        chain.getTorques(s.tau);
+        samples.push_back(s);
+    }
+}
+
+
+/************************************************************************/
+static bool benchmarkChain(const string &name, iDynChain &chain, const int iterations)
+{
+    mt19937 gen(0);
+    deque<Sample> samples;
+    chain.prepareNewtonEuler(DYNAMIC);
+    drawSamples(chain,iterations,gen,samples);
+
+    // consistency
+    double e_M=0.0,e_aba=0.0,e_ne=0.0;
+    Matrix M,M_NE;
+    Vector ddq;
+    for (const auto &s: samples)
+    {
+        setState(chain,s);
+        chain.computeMassMatrix(M);
+        massMatrixNE(chain,M_NE);
+        e_M=std::max(e_M,maxAbsDiff(M,M_NE));
+
+        setState(chain,s);
+        chain.computeForwardDynamics(s.w0,s.dw0,s.ddp0,s.F,s.Mu,s.tau,ddq);
+        e_aba=std::max(e_aba,maxAbsDiff(ddq,s.ddq));
+
+        forwardDynamicsNE(chain,s,ddq);
+        e_ne=std::max(e_ne,maxAbsDiff(ddq,s.ddq));
+    }
+
+    // latency
+    double t_M_NE=0.0,t_M=0.0,t_fd_NE=0.0,t_fd=0.0;
+    for (const auto &s: samples)
+    {
+        setState(chain,s);
+        double t0=Time::now();
+        massMatrixNE(chain,M_NE);
+        double t1=Time::now();
+        chain.computeMassMatrix(M);
+        double t2=Time::now();
+        t_M_NE+=t1-t0;
+        t_M+=t2-t1;
+
+        setState(chain,s);
+        t0=Time::now();
+        forwardDynamicsNE(chain,s,ddq);
+        t1=Time::now();
+        chain.computeForwardDynamics(s.w0,s.dw0,s.ddp0,s.F,s.Mu,s.tau,ddq);
+        t2=Time::now();
+        t_fd_NE+=t1-t0;
+        t_fd+=t2-t1;
+    }
+
+    double n=(double)iterations;
+    yInfo("%s (%d DOF):",name.c_str(),chain.getDOF());
+    yInfo("  mass matrix: Newton-Euler %.2f [us], CRBA %.2f [us], speedup x%.1f, max error %.2e",
+          1e6*t_M_NE/n,1e6*t_M/n,t_M_NE/t_M,e_M);
+    yInfo("  forward dynamics: Newton-Euler %.2f [us], ABA %.2f [us], speedup x%.1f, max error %.2e (Newton-Euler %.2e)",
+          1e6*t_fd_NE/n,1e6*t_fd/n,t_fd_NE/t_fd,e_aba,e_ne);
+
+    return (e_M<1e-9) && (e_aba<1e-6);
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property options;
+    options.fromCommand(argc,argv);
+    int iterations=options.check("iterations",Value(5000)).asInt32();
+
+    iCubArmDyn arm("right");
+    for (unsigned int i=0; i<3; i++)
+        arm.releaseLink(i);
+    iCubLegDyn leg("right");
+
+    bool ok=true;
+    ok&=benchmarkChain("arm",arm,iterations);
+    ok&=benchmarkChain("leg",leg,iterations);
+
+    yInfo("consistency with Newton-Euler: %s",ok?"yes":"no");
+    return (ok?0:1);
+}
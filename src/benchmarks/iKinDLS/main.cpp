@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// Compares the latency and the accuracy of iKinIpOptMin and iKinDLSMin
+// when tracking a stream of targets with the right arm of iCub, each
+// solver being warm-started from its previous solution as the Cartesian
+// solver does in tracking mode. The shoulder and elbow constraints of
+// iCubAdditionalArmConstraints are enforced. The targets are either
+// generated through the forward kinematics of a smooth joints trajectory
+// or read from a file, whose lines end with the 7 components of a pose
+// (x y z ax ay az theta), e.g. as logged by the dataDumper on the xd port
+// of the Cartesian solver.
+//
+// Usage: iKinDLSBenchmark [--targets <int>] [--file <path>] [--pose full|xyz]
+
+#include <cmath>
+#include <string>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include <IpReturnCodes.hpp>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+#include <yarp/math/Math.h>
+
+#include <iCub/iKin/iKinFwd.h>
+#include <iCub/iKin/iKinIpOpt.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::iKin;
+
+
+/************************************************************************/
+bool readTargets(const string &file, deque<Vector> &targets)
+{
+    ifstream fin(file.c_str());
+    if (!fin.is_open())
+        return false;
+
+    string line;
+    while (getline(fin,line))
+    {
+        deque<double> values;
+        istringstream str(line);
+        double v;
+        while (str>>v)
+            values.push_back(v);
+
+        if (values.size()>=7)
+        {
+            Vector xd(7);
+            for (size_t i=0; i<7; i++)
+                xd[i]=values[values.size()-7+i];
+            targets.push_back(xd);
+        }
+    }
+
+    return true;
+}
+
+
+/************************************************************************/
+void generateTargets(iKinChain &chain, const int n, deque<Vector> &targets)
+{
+    // a smooth trajectory spanning the central part of the joints ranges,
+    // sampled every 20 ms as the Cartesian solver would be fed
+    unsigned int dof=chain.getDOF();
+    Vector q(dof);
+    for (int k=0; k<n; k++)
+    {
+        double t=0.02*k;
+        for (unsigned int i=0; i<dof; i++)
+        {
+            double mid=0.5*(chain(i).getMax()+chain(i).getMin());
+            double amp=0.3*(chain(i).getMax()-chain(i).getMin());
+            q[i]=mid+amp*sin(0.2*(i+1)*t+i);
+        }
+        targets.push_back(chain.EndEffPose(q));
+    }
+}
+
+
+/************************************************************************/
+void benchmark(const string &name, iKinIpOptMin &slv, iKinChain &chain,
+               const deque<Vector> &targets, const Vector &q0)
+{
+    Vector q=q0;
+    double t=0.0,t_max=0.0;
+    double ep=0.0,ep_max=0.0;
+    double eo=0.0,eo_max=0.0;
+    int failures=0;
+
+    for (size_t k=0; k<targets.size(); k++)
+    {
+        Vector xd=targets[k];
+        int exit_code;
+        Vector dummy(1);
+
+        double t0=Time::now();
+        q=slv.solve(q,xd,0.0,dummy,dummy,0.0,dummy,dummy,&exit_code);
+        double dt=Time::now()-t0;
+        t+=dt;
+        t_max=std::max(t_max,dt);
+
+        // e.g. iKinDLSMin reports an unmet constraint with the positive
+        // Search_Direction_Becomes_Too_Small
+        if ((exit_code!=Ipopt::Solve_Succeeded) &&
+            (exit_code!=Ipopt::Solved_To_Acceptable_Level))
+            failures++;
+
+        Vector x=chain.EndEffPose(q);
+        double e_xyz=norm(xd.subVector(0,2)-x.subVector(0,2));
+        Matrix E=axis2dcm(xd.subVector(3,6))*axis2dcm(x.subVector(3,6)).transposed();
+        double e_ang=dcm2axis(E)[3];
+
+        ep+=e_xyz; ep_max=std::max(ep_max,e_xyz);
+        eo+=e_ang; eo_max=std::max(eo_max,e_ang);
+    }
+
+    double n=(double)targets.size();
+    yInfo("%-6s: latency %.3f [ms] (max %.3f [ms]), position error %.2e [m] (max %.2e [m]), orientation error %.2e [rad] (max %.2e [rad]), %d failures",
+          name.c_str(),1e3*t/n,1e3*t_max,ep/n,ep_max,eo/n,eo_max,failures);
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property options;
+    options.fromCommand(argc,argv);
+    int n=options.check("targets",Value(2000)).asInt32();
+    string pose=options.check("pose",Value("full")).asString();
+    unsigned int ctrlPose=(pose=="xyz")?IKINCTRL_POSE_XYZ:IKINCTRL_POSE_FULL;
+
+    iCubArm arm("right");
+    iKinChain &chain=*arm.asChain();
+    Vector q0=chain.getAng();
+
+    deque<Vector> targets;
+    if (options.check("file"))
+    {
+        string file=options.find("file").asString();
+        if (!readTargets(file,targets))
+        {
+            yError("Unable to read the targets from %s",file.c_str());
+            return 1;
+        }
+    }
+    else
+        generateTargets(chain,n,targets);
+
+    if (targets.empty())
+    {
+        yError("No targets to track");
+        return 1;
+    }
+
+    yInfo("Tracking %d targets with %s, pose %s",(int)targets.size(),
+          arm.getType().c_str(),pose.c_str());
+
+    // same settings as the Cartesian solver
+    iCubAdditionalArmConstraints cns(arm);
+    iKinIpOptMin ipopt(chain,ctrlPose,1e-4,1e-6,200);
+    iKinDLSMin dls(chain,ctrlPose,1e-4,1e-6,200);
+    iKinIpOptMin *slv[]={&ipopt,&dls};
+    for (int i=0; i<2; i++)
+    {
+        slv[i]->setUserScaling(true,100.0,100.0,100.0);
+        slv[i]->attachLIC(cns);
+
+        double lower_bound_inf,upper_bound_inf;
+        slv[i]->getBoundsInf(lower_bound_inf,upper_bound_inf);
+        slv[i]->getLIC().getLowerBoundInf()=2.0*lower_bound_inf;
+        slv[i]->getLIC().getUpperBoundInf()=2.0*upper_bound_inf;
+        slv[i]->getLIC().update(NULL);
+    }
+
+    benchmark("ipopt",ipopt,chain,targets,q0);
+    benchmark("dls",dls,chain,targets,q0);
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// Compares the per-call latency of the Matrix-based forward kinematics
+// of iKinChain against the allocation-free path relying on iKinSE3 and
+// against the batched path iKinChain::BatchKinematics().
+//
+// Usage: iKinFwdBenchmark [--iterations <int>] [--threads <int>]
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <deque>
+#include <thread>
+#include <algorithm>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+
+#include <iCub/iKin/iKinFwd.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::iKin;
+
+
+/************************************************************************/
+void benchmark(const string &name, iKinLimb &limb, const int iterations,
+               const unsigned int threads)
+{
+    iKinChain &chain=*limb.asChain();
+    unsigned int dof=chain.getDOF();
+
+    // draw the joints configurations beforehand
+    mt19937 gen(0);
+    deque<Vector> qs;
+    for (int k=0; k<iterations; k++)
+    {
+        Vector q(dof);
+        for (unsigned int i=0; i<dof; i++)
+        {
+            uniform_real_distribution<double> d(chain(i).getMin(),chain(i).getMax());
+            q[i]=d(gen);
+        }
+        qs.push_back(q);
+    }
+
+    Vector pose1,pose2;
+    Matrix J1,J2(6,dof);
+    iKinSE3 H;
+    double err=0.0;
+
+    double t0=Time::now();
+    for (int k=0; k<iterations; k++)
+    {
+        pose1=chain.EndEffPose(qs[k]);
+        J1=chain.GeoJacobian();
+    }
+    double t1=Time::now();
+    for (int k=0; k<iterations; k++)
+    {
+        chain.setAng(qs[k]);
+        chain.getH(H);
+        H.toPose(pose2);
+        chain.GeoJacobian(J2);
+    }
+    double t2=Time::now();
+
+    // check consistency on the last configuration
+    for (size_t i=0; i<pose1.length(); i++)
+        err=std::max(err,fabs(pose1[i]-pose2[i]));
+    for (size_t r=0; r<J1.rows(); r++)
+        for (size_t c=0; c<J1.cols(); c++)
+            err=std::max(err,fabs(J1(r,c)-J2(r,c)));
+
+    double us_matrix=1e6*(t1-t0)/iterations;
+    double us_fixed=1e6*(t2-t1)/iterations;
+    yInfo("%-12s DOF=%u: Matrix path %.3f [us/call], fixed path %.3f [us/call], speedup x%.2f, max error %g",
+          name.c_str(),dof,us_matrix,us_fixed,us_matrix/us_fixed,err);
+
+    Matrix Q(iterations,dof);
+    for (int k=0; k<iterations; k++)
+        for (unsigned int i=0; i<dof; i++)
+            Q(k,i)=qs[k][i];
+
+    iKinFwdBatch batch;
+    double t3=Time::now();
+    chain.BatchKinematics(Q,batch,true,1);
+    double t4=Time::now();
+    chain.BatchKinematics(Q,batch,true,threads);
+    double t5=Time::now();
+
+    err=0.0;
+    batch.getPose(iterations-1,pose2);
+    batch.getJacobian(iterations-1,J2);
+    for (size_t i=0; i<pose1.length(); i++)
+        err=std::max(err,fabs(pose1[i]-pose2[i]));
+    for (size_t r=0; r<J1.rows(); r++)
+        for (size_t c=0; c<J1.cols(); c++)
+            err=std::max(err,fabs(J1(r,c)-J2(r,c)));
+
+    double us_batch1=1e6*(t4-t3)/iterations;
+    double us_batchN=1e6*(t5-t4)/iterations;
+    yInfo("%-12s DOF=%u: batch path %.3f [us/conf] (1 thread), %.3f [us/conf] (%u threads), speedup x%.2f, max error %g",
+          name.c_str(),dof,us_batch1,us_batchN,threads,us_matrix/us_batchN,err);
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property options;
+    options.fromCommand(argc,argv);
+    int iterations=options.check("iterations",Value(100000)).asInt32();
+    unsigned int threads=options.check("threads",Value(0)).asInt32();
+    if (threads==0)
+        threads=std::max(1U,std::thread::hardware_concurrency());
+
+    iCubArm arm("right");
+    arm.releaseLink(0);
+    arm.releaseLink(1);
+    arm.releaseLink(2);
+    iCubEye eye("right");
+    eye.releaseLink(0);
+    eye.releaseLink(1);
+    eye.releaseLink(2);
+
+    benchmark("iCubArm",arm,iterations,threads);
+    benchmark("iCubEye",eye,iterations,threads);
+
+    return 0;
+}
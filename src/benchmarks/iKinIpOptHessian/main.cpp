@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// Compares the number of iterations and the latency of iKinIpOptMin
+// when IpOpt relies on the exact Hessian of the Lagrangian or on its
+// limited-memory quasi-Newton approximation. The right arm of iCub is
+// driven from the rest configuration toward random reachable poses,
+// enforcing the shoulder and elbow constraints of
+// iCubAdditionalArmConstraints as the Cartesian solver does.
+//
+// Usage: iKinIpOptHessianBenchmark [--targets <int>] [--pose full|xyz]
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <deque>
+
+#include <IpReturnCodes.hpp>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Vector.h>
+
+#include <iCub/iKin/iKinFwd.h>
+#include <iCub/iKin/iKinIpOpt.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::iKin;
+
+
+/************************************************************************/
+class IterationsCounter : public iKinIterateCallback
+{
+public:
+    int cnt;
+    IterationsCounter() : cnt(0) { }
+    void exec(const Vector &xd, const Vector &q) override { cnt++; }
+};
+
+
+/************************************************************************/
+void benchmark(const string &name, iKinIpOptMin &slv, const deque<Vector> &targets,
+               const Vector &q0)
+{
+    IterationsCounter counter;
+    double t=0.0;
+    int failures=0;
+
+    for (size_t k=0; k<targets.size(); k++)
+    {
+        Vector xd=targets[k];
+        int exit_code;
+        Vector dummy(1);
+
+        double t0=Time::now();
+        slv.solve(q0,xd,0.0,dummy,dummy,0.0,dummy,dummy,&exit_code,NULL,&counter);
+        t+=Time::now()-t0;
+
+        if ((exit_code!=Ipopt::Solve_Succeeded) &&
+            (exit_code!=Ipopt::Solved_To_Acceptable_Level))
+            failures++;
+    }
+
+    double n=(double)targets.size();
+    yInfo("%-7s: %.1f iterations per solve, %.3f [ms] per solve, %.3f [ms] per iteration, %d failures",
+          name.c_str(),counter.cnt/n,1e3*t/n,1e3*t/counter.cnt,failures);
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property options;
+    options.fromCommand(argc,argv);
+    int n=options.check("targets",Value(500)).asInt32();
+    string pose=options.check("pose",Value("full")).asString();
+    unsigned int ctrlPose=(pose=="xyz")?IKINCTRL_POSE_XYZ:IKINCTRL_POSE_FULL;
+
+    iCubArm arm("right");
+    iKinChain &chain=*arm.asChain();
+    Vector q0=chain.getAng();
+
+    // targets are generated in the central part of the joints ranges
+    // so that they are all reachable
+    mt19937 gen(0);
+    uniform_real_distribution<double> U(0.2,0.8);
+    deque<Vector> targets;
+    Vector q(chain.getDOF());
+    for (int k=0; k<n; k++)
+    {
+        for (unsigned int i=0; i<chain.getDOF(); i++)
+            q[i]=chain(i).getMin()+U(gen)*(chain(i).getMax()-chain(i).getMin());
+        targets.push_back(chain.EndEffPose(q));
+    }
+    chain.setAng(q0);
+
+    yInfo("Solving for %d targets with %s, pose %s",n,arm.getType().c_str(),pose.c_str());
+
+    // same settings as the Cartesian solver
+    iCubAdditionalArmConstraints cns(arm);
+    iKinIpOptMin slv(chain,ctrlPose,1e-4,1e-6,200);
+    slv.setUserScaling(true,100.0,100.0,100.0);
+    slv.attachLIC(cns);
+
+    double lower_bound_inf,upper_bound_inf;
+    slv.getBoundsInf(lower_bound_inf,upper_bound_inf);
+    slv.getLIC().getLowerBoundInf()=2.0*lower_bound_inf;
+    slv.getLIC().getUpperBoundInf()=2.0*upper_bound_inf;
+    slv.getLIC().update(NULL);
+
+    slv.setHessianOpt(true);
+    benchmark("exact",slv,targets,q0);
+
+    slv.setHessianOpt(false);
+    benchmark("l-bfgs",slv,targets,q0);
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// Compares the cost of learning one more sample with the LSSVMLearner in
+// incremental mode, i.e. bordering the inverse of the kernel matrix, against
+// retraining it from scratch with train(), for an increasing number of
+// samples. The incremental update is measured also with a sliding window,
+// where the oldest sample is dropped as the new one is learned, and the
+// predictions of both learners are checked to agree.
+//
+// Usage: lssvmUpdateBenchmark [--samples <int>] [--window <int>]
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Vector.h>
+
+#include <iCub/learningMachine/LSSVMLearner.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::learningmachine;
+
+
+/************************************************************************/
+static void synthesize(mt19937 &gen, Vector &x, Vector &y)
+{
+    normal_distribution<double> d(0.0,1.0);
+    x.resize(3);
+    for (size_t i=0; i<x.length(); i++)
+        x[i]=d(gen);
+    y.resize(1);
+    y[0]=sin(x[0])+x[1]*x[2]+0.05*d(gen);
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property options;
+    options.fromCommand(argc,argv);
+    int samples=options.check("samples",Value(800)).asInt32();
+    int window=options.check("window",Value(200)).asInt32();
+
+    for (int n=100; n<=samples; n*=2)
+    {
+        mt19937 gen(0);
+        LSSVMLearner batch(3,1,10.0);
+        LSSVMLearner incremental(3,1,10.0);
+        LSSVMLearner windowed(3,1,10.0);
+        incremental.setIncremental(true);
+        windowed.setIncremental(true);
+        windowed.setWindow(std::min(window,n));
+
+        Vector x,y;
+        for (int k=0; k<n; k++)
+        {
+            synthesize(gen,x,y);
+            batch.feedSample(x,y);
+            incremental.feedSample(x,y);
+            windowed.feedSample(x,y);
+        }
+        batch.train();
+
+        // a few more samples, each learned on its own
+        const int updates=10;
+        double tBatch=0.0, tIncremental=0.0, tWindowed=0.0;
+        for (int k=0; k<updates; k++)
+        {
+            synthesize(gen,x,y);
+
+            double t0=Time::now();
+            batch.feedSample(x,y);
+            batch.train();
+            double t1=Time::now();
+            incremental.feedSample(x,y);
+            double t2=Time::now();
+            windowed.feedSample(x,y);
+            double t3=Time::now();
+
+            tBatch+=t1-t0;
+            tIncremental+=t2-t1;
+            tWindowed+=t3-t2;
+        }
+
+        double err=0.0;
+        for (int k=0; k<100; k++)
+        {
+            synthesize(gen,x,y);
+            err=std::max(err,fabs(batch.predict(x).getPrediction()[0]-
+                                  incremental.predict(x).getPrediction()[0]));
+        }
+
+        yInfo("%4d samples: train() %8.3f [ms], incremental %7.3f [ms], window of %d %7.3f [ms] (max prediction error %g)",
+              n,1e3*tBatch/updates,1e3*tIncremental/updates,windowed.getWindow(),
+              1e3*tWindowed/updates,err);
+    }
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// Measures the frame rate of the simulated cameras, i.e. of rendering the
+// views of both eyes and reading them back into images, at 320x240 and
+// 640x480. The views are read in the way iCub_SIM used to (glReadPixels
+// into a temporary buffer, flipped pixel by pixel and copied into the port
+// image) and through the PixelReadback of the simulator, synchronously and
+// with rings of 1 to 3 pixel buffer objects. Run it with
+// LIBGL_ALWAYS_SOFTWARE=1 to measure Mesa's software renderer.
+//
+// Usage: simCameraReadbackBenchmark [--frames <int>] [--grid <int>]
+
+#include <cmath>
+#include <string>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Stamp.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Image.h>
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+#include "PixelReadback.h"
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+
+
+/************************************************************************/
+static void drawView(const int w, const int h, const int grid, const double angle)
+{
+    // a lit and shaded surface of 2*grid^2 triangles, as a stand-in for the world
+    glViewport(0,0,w,h);
+    glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glFrustum(-0.05,0.05,-0.0375,0.0375,0.1,10.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glTranslated(0.0,0.0,-2.0);
+    glRotated(angle,0.3,1.0,0.0);
+
+    double d=2.0/grid;
+    for (int i=0; i<grid; i++)
+    {
+        glBegin(GL_TRIANGLE_STRIP);
+        for (int j=0; j<=grid; j++)
+        {
+            for (int k=0; k<2; k++)
+            {
+                double x=-1.0+(i+k)*d;
+                double y=-1.0+j*d;
+                double z=0.1*sin(5.0*x)*cos(5.0*y);
+                glColor3d(0.5+0.5*x,0.5+0.5*y,0.5);
+                glNormal3d(-0.5*cos(5.0*x)*cos(5.0*y),0.5*sin(5.0*x)*sin(5.0*y),1.0);
+                glVertex3d(x,y,z);
+            }
+        }
+        glEnd();
+    }
+}
+
+
+/************************************************************************/
+static void legacyRead(const int w, const int h, ImageOf<PixelRgb> &target)
+{
+    char *buf=new char[w*h*3];
+    glReadPixels(0,0,w,h,GL_RGB,GL_UNSIGNED_BYTE,buf);
+    ImageOf<PixelRgb> img;
+    img.setQuantum(1);
+    img.setExternal(buf,w,h);
+
+    ImageOf<PixelRgb> flipped;
+    flipped.resize(img);
+    for (int x=0; x<w; x++)
+        for (int y=0; y<h; y++)
+            flipped(x,y)=img(x,h-1-y);
+
+    target.copy(flipped);
+    delete[] buf;
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property options;
+    options.fromCommand(argc,argv);
+    int frames=options.check("frames",Value(300)).asInt32();
+    int grid=options.check("grid",Value(100)).asInt32();
+
+    if (SDL_Init(SDL_INIT_VIDEO)!=0)
+    {
+        yError("Unable to initialize SDL: %s",SDL_GetError());
+        return 1;
+    }
+    if (SDL_SetVideoMode(640,480,32,SDL_OPENGL)==NULL)
+    {
+        yError("Unable to create the OpenGL window: %s",SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+    yInfo("OpenGL %s, %s",(const char*)glGetString(GL_VERSION),(const char*)glGetString(GL_RENDERER));
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+    glEnable(GL_COLOR_MATERIAL);
+    glEnable(GL_NORMALIZE);
+    glShadeModel(GL_SMOOTH);
+
+    const int sizes[2][2]={{320,240},{640,480}};
+    for (int s=0; s<2; s++)
+    {
+        int w=sizes[s][0];
+        int h=sizes[s][1];
+        ImageOf<PixelRgb> eyes[2];
+
+        // -1 stands for the legacy read
+        for (int buffers=-1; buffers<=3; buffers++)
+        {
+            PixelReadback readback;
+            readback.setBuffers(buffers);
+
+            int images=0;
+            double t0=Time::now();
+            for (int k=0; k<frames; k++)
+            {
+                for (int eye=0; eye<2; eye++)
+                {
+                    drawView(w,h,grid,k+10.0*eye);
+                    if (buffers<0)
+                    {
+                        legacyRead(w,h,eyes[eye]);
+                        images++;
+                    }
+                    else
+                    {
+                        Stamp stamp(k,Time::now());
+                        if (readback.read(eye,w,h,stamp,eyes[eye]))
+                            images++;
+                    }
+                }
+            }
+            glFinish();
+            double dt=Time::now()-t0;
+            readback.release();
+
+            string mode=(buffers<0)?string("legacy"):
+                        (buffers==0)?string("glReadPixels"):
+                        (to_string(buffers)+" PBO");
+            yInfo("%dx%d %-12s: %.1f [fps] (both eyes, %d images)",w,h,mode.c_str(),frames/dt,images);
+        }
+    }
+
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// Compares the cost of sending a skinContactList (as the skin_events of
+// skinManager) in the default encoding, i.e. a nested Bottle of tagged lists
+// per contact, and in the packed one, read either into a skinContactList or
+// into a skinContactListView, for an increasing number of contacts. Each
+// message is written and read back in memory, and the time of packing and
+// unpacking alone is reported too.
+//
+// Usage: skinContactListBenchmark [--iterations <int>] [--taxels <int>]
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Portable.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Vector.h>
+
+#include <iCub/skinDynLib/skinContactList.h>
+#include <iCub/skinDynLib/skinContactListView.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::skinDynLib;
+
+
+/************************************************************************/
+static skinContactList synthesize(const int contacts, const int taxels)
+{
+    mt19937 gen(0);
+    uniform_real_distribution<double> d(-1.0,1.0);
+    auto rnd3=[&]() { Vector v(3); for (size_t i=0; i<3; i++) v[i]=d(gen); return v; };
+
+    skinContactList l;
+    for (int k=0; k<contacts; k++)
+    {
+        vector<unsigned int> taxelList(taxels);
+        for (auto &t: taxelList)
+            t=(unsigned int)(gen()%384);
+        l.push_back(skinContact(LEFT_ARM,SKIN_LEFT_FOREARM,4,rnd3(),rnd3(),taxelList,
+                                fabs(d(gen)),rnd3(),rnd3(),rnd3()));
+    }
+    return l;
+}
+
+
+/************************************************************************/
+template<class T>
+static double roundTrip(const skinContactList &l, T &out, const int iterations)
+{
+    double t0=Time::now();
+    for (int k=0; k<iterations; k++)
+        Portable::copyPortable(l,out);
+    return 1e6*(Time::now()-t0)/iterations;
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property options;
+    options.fromCommand(argc,argv);
+    int iterations=options.check("iterations",Value(2000)).asInt32();
+    int taxels=options.check("taxels",Value(10)).asInt32();
+
+    bool ok=true;
+    for (int contacts=1; contacts<=1000; contacts*=10)
+    {
+        skinContactList l=synthesize(contacts,taxels);
+        skinContactList in;
+        skinContactListView view;
+
+        l.setPackedEncoding(false);
+        double t_default=roundTrip(l,in,iterations);
+
+        l.setPackedEncoding(true);
+        double t_packed=roundTrip(l,in,iterations);
+        double t_view=roundTrip(l,view,iterations);
+        ok&=(in.size()==l.size()) && (view.size()==l.size());
+
+        vector<char> buffer;
+        double t0=Time::now();
+        for (int k=0; k<iterations; k++)
+            l.pack(buffer);
+        double t1=Time::now();
+        for (int k=0; k<iterations; k++)
+            in.unpack(buffer.data(),buffer.size());
+        double t2=Time::now();
+
+        yInfo("%4d contacts: default %.1f [us], packed %.1f [us], packed view %.1f [us] (pack %.2f [us], unpack %.2f [us], %zu bytes)",
+              contacts,t_default,t_packed,t_view,1e6*(t1-t0)/iterations,1e6*(t2-t1)/iterations,buffer.size());
+    }
+
+    return (ok?0:1);
+}
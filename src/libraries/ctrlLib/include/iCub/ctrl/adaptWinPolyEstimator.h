@@ -26,6 +26,7 @@
 #define __ADAPTWINPOLYESTIMATOR_H__
 
 #include <deque>
+#include <vector>
 
 #include <yarp/sig/Vector.h>
 #include <iCub/ctrl/math.h>
@@ -69,6 +70,12 @@ typedef std::deque<AWPolyElement> AWPolyList;
 *
 * Adaptive window polynomial fitting. 
 * Abstract class. 
+*  
+* The last N samples are kept in a ring buffer, one contiguous 
+* array per component, and the candidate windows of each 
+* component are fitted by solving the normal equations, whose 
+* matrices depend on the time instants only and are thus shared 
+* among all the components. 
 */
 class AWPolyEstimator
 {
@@ -86,6 +93,23 @@ protected:
 
     bool firstRun;
 
+    // ring buffer of the last N samples, each one written twice
+    // so that any window is contiguous
+    unsigned int dim;
+    unsigned int head;
+    unsigned int count;
+    std::vector<double> times;
+    std::vector<double> samples;
+
+    // regressors and normal equations of the windows
+    std::vector<double> phi;
+    std::vector<double> gram;
+    std::vector<double> chol;
+    std::vector<int> factored;
+    std::vector<double> rhs;
+    std::vector<double> sol;
+    int stamp;
+
     /**
     * Find the regressor which best fits in least square sense the 
     * last n data sample couples, or all couples if n==0. 
@@ -97,6 +121,17 @@ protected:
     virtual yarp::sig::Vector fit(const yarp::sig::Vector &x,
                                   const yarp::sig::Vector &y, const unsigned int n=0);
 
+    /**
+    * Solve the normal equations of the last n samples of the 
+    * buffer for the right-hand side b. 
+    * @param n last n samples to fit.
+    * @param b the right-hand side of the normal equations.
+    * @param c on output, the coefficients of the regressor in 
+    *          the normalized time.
+    * @return false if the normal equations are singular.
+    */
+    bool solve(const unsigned int n, const double *b, double *c);
+
     /** 
     * Evaluate regressor at certain point. 
     * @param x the point.
@@ -122,10 +157,12 @@ public:
     AWPolyEstimator(unsigned int _order, unsigned int _N, const double _D);
 
     /**
-    * Return a reference to internal elements list.
-    * @return reference to internal elements list.
+    * Return the buffered elements, from the oldest one.
+    * @return reference to a list filled with a copy of the 
+    *         buffered elements.
+    * @note changing the list does not affect the estimation.
     */
-    AWPolyList &getList() { return elemList; }
+    AWPolyList &getList();
 
     /**
     * Feed data into the algorithm.
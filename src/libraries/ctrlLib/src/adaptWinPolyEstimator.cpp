@@ -10,6 +10,7 @@
 
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 #include <yarp/os/LogStream.h>
 #include <yarp/math/Math.h>
@@ -33,6 +34,20 @@ AWPolyEstimator::AWPolyEstimator(unsigned int _order, unsigned int _N, const dou
     t.resize(N);
     x.resize(N);
 
+    dim=0;
+    head=0;
+    count=0;
+    times.assign(2*N,0.0);
+
+    unsigned int P=order+1;
+    phi.assign(N*P,0.0);
+    gram.assign((N+1)*P*P,0.0);
+    chol.assign((N+1)*P*P,0.0);
+    factored.assign(N+1,0);
+    rhs.assign(3*P,0.0);
+    sol.assign(P,0.0);
+    stamp=0;
+
     firstRun=true;
 }
 
@@ -41,10 +56,11 @@ AWPolyEstimator::AWPolyEstimator(unsigned int _order, unsigned int _N, const dou
 double AWPolyEstimator::eval(double x)
 {
     double y=coeff[0];
+    double p=1.0;
     for (unsigned int i=1; i<=order; i++)
     {
-        y+=coeff[i]*x;
-        x*=x;
+        p*=x;
+        y+=coeff[i]*p;
     }
 
     return y;
@@ -69,14 +85,14 @@ Vector AWPolyEstimator::fit(const Vector &x, const Vector &y, const unsigned int
 
     for (unsigned int i=i1; i<i2; i++)
     {
-        double _x=x[i];
+        double _x=1.0;
 
         R(i-i1,0)=1.0;
 
         for (unsigned int j=1; j<=order; j++)
         {
+            _x*=x[i];
             R(i-i1,j)=_x;
-            _x*=_x;
         }
 
         _y[i-i1]=y[i];
@@ -89,19 +105,111 @@ Vector AWPolyEstimator::fit(const Vector &x, const Vector &y, const unsigned int
 }
 
 
+/***************************************************************************/
+bool AWPolyEstimator::solve(const unsigned int n, const double *b, double *c)
+{
+    unsigned int P=order+1;
+    double *L=&chol[n*P*P];
+
+    // Cholesky factorization of the normal matrix, once per estimation
+    if ((factored[n]!=stamp) && (factored[n]!=-stamp))
+    {
+        const double *G=&gram[n*P*P];
+        factored[n]=stamp;
+        for (unsigned int j=0; j<P; j++)
+        {
+            double d=G[j*P+j];
+            for (unsigned int k=0; k<j; k++)
+                d-=L[j*P+k]*L[j*P+k];
+
+            if (d<=1e-12*G[j*P+j])
+            {
+                factored[n]=-stamp;
+                break;
+            }
+
+            L[j*P+j]=sqrt(d);
+            for (unsigned int i=j+1; i<P; i++)
+            {
+                double v=G[i*P+j];
+                for (unsigned int k=0; k<j; k++)
+                    v-=L[i*P+k]*L[j*P+k];
+                L[i*P+j]=v/L[j*P+j];
+            }
+        }
+    }
+
+    if (factored[n]<0)
+        return false;
+
+    for (unsigned int i=0; i<P; i++)
+    {
+        double v=b[i];
+        for (unsigned int k=0; k<i; k++)
+            v-=L[i*P+k]*c[k];
+        c[i]=v/L[i*P+i];
+    }
+
+    for (int i=P-1; i>=0; i--)
+    {
+        double v=c[i];
+        for (unsigned int k=i+1; k<P; k++)
+            v-=L[k*P+i]*c[k];
+        c[i]=v/L[i*P+i];
+    }
+
+    return true;
+}
+
+
 /***************************************************************************/
 void AWPolyEstimator::feedData(const AWPolyElement &el)
 {
-    elemList.push_back(el);
+    unsigned int len=(unsigned int)el.data.length();
+    if (len!=dim)
+    {
+        dim=len;
+        samples.assign(2*N*dim,0.0);
+        head=0;
+        count=0;
+    }
+
+    // each sample is stored twice, N slots apart, so that
+    // the last N samples are contiguous from head on
+    times[head]=times[head+N]=el.time;
+    for (unsigned int i=0; i<dim; i++)
+        samples[2*N*i+head]=samples[2*N*i+head+N]=el.data[i];
+
+    head=(head+1)%N;
+    count++;
+}
+
+
+/***************************************************************************/
+AWPolyList &AWPolyEstimator::getList()
+{
+    unsigned int L=std::min(count,N);
+    unsigned int first=head+N-L;
+
+    elemList.resize(L);
+    for (unsigned int j=0; j<L; j++)
+    {
+        AWPolyElement &el=elemList[j];
+        el.time=times[first+j];
+        el.data.resize(dim);
+        for (unsigned int i=0; i<dim; i++)
+            el.data[i]=samples[2*N*i+first+j];
+    }
+
+    return elemList;
 }
 
 
 /***************************************************************************/
 Vector AWPolyEstimator::estimate()
 {
-    yAssert(elemList.size()>0);
+    yAssert(count>0);
 
-    size_t dim=elemList[0].data.length();
     Vector esteem(dim,0.0);
 
     if (firstRun)
@@ -111,18 +219,16 @@ Vector AWPolyEstimator::estimate()
         firstRun=false;
     }    
 
-    size_t L=elemList.size();
-    int delta=(int)L-(int)N;
-
-    if (delta<0)
+    if (count<N)
         return esteem;
 
     // retrieve the time vector
     // starting from t=0 (numeric stability reason)
+    const double *tN=&times[head];
     t[0]=0.0;
     for (unsigned int j=1; j<N; j++)
     {
-        t[j]=elemList[delta+j].time-elemList[delta].time;
+        t[j]=tN[j]-tN[0];
 
         // enforce condition on time vector
         if (t[j]<=0.0)
@@ -132,34 +238,99 @@ Vector AWPolyEstimator::estimate()
         }
     }
 
+    // the regressors are evaluated in the time normalized over the
+    // whole window; as long as they are plain monomials the origin
+    // is moved to the last sample, which keeps the normal equations
+    // of the short windows well conditioned
+    unsigned int P=order+1;
+    double T=t[N-1];
+    double origin=(order<=2)?1.0:0.0;
+    for (unsigned int k=0; k<N; k++)
+    {
+        double tau=t[k]/T-origin;
+        double p=1.0;
+        phi[k]=1.0;
+        for (unsigned int j=1; j<=order; j++)
+        {
+            p*=tau;
+            phi[j*N+k]=p;
+        }
+    }
+
+    // normal matrices of the last n samples, for all n
+    for (unsigned int n=1; n<=N; n++)
+    {
+        unsigned int k=N-n;
+        const double *G0=&gram[(n-1)*P*P];
+        double *G1=&gram[n*P*P];
+        for (unsigned int r=0; r<P; r++)
+            for (unsigned int c=0; c<P; c++)
+                G1[r*P+c]=G0[r*P+c]+phi[r*N+k]*phi[c*N+k];
+    }
+    stamp=(stamp<std::numeric_limits<int>::max())?stamp+1:1;
+
     // cycle upon all elements
     for (unsigned int i=0; i<dim; i++)
     {
         // retrieve the data vector
-        for (unsigned int j=0; j<N; j++)
-            x[j]=elemList[delta+j].data[i];
+        const double *xN=&samples[2*N*i+head];
 
         // change the window length of two units, back and forth
         unsigned int n1=(unsigned int)((winLen[i]>(order+1))?(winLen[i]-1):(order+1));
         unsigned int n2=(unsigned int)((winLen[i]<N)?(winLen[i]+1):N);
 
+        // right-hand sides of the normal equations of the shortest
+        // window, then of the longer ones sample by sample
+        for (unsigned int j=0; j<P; j++)
+        {
+            const double *phij=&phi[j*N];
+            double b=0.0;
+            for (unsigned int k=N-n1; k<N; k++)
+                b+=phij[k]*xN[k];
+            rhs[j]=b;
+
+            for (unsigned int n=n1+1; n<=n2; n++)
+                rhs[(n-n1)*P+j]=rhs[(n-n1-1)*P+j]+phij[N-n]*xN[N-n];
+        }
+
         // cycle upon all possibile window's length
+        double *c=&sol[0];
         for (unsigned int n=n1; n<=n2; n++)
         {
             // find the regressor's coefficients
-            coeff=fit(t,x,n);
-            bool _stop=false;            
+            if (!solve(n,&rhs[(n-n1)*P],c))
+            {
+                // degenerate time instants, resort to the pseudo-inverse
+                for (unsigned int k=0; k<N; k++)
+                {
+                    t[k]=phi[N+k];
+                    x[k]=xN[k];
+                }
+                Vector _c=fit(t,x,n);
+                std::copy(_c.begin(),_c.end(),c);
+            }
 
             // test the regressor upon all the elements
             // belonging to the actual window
-            mse[i]=0.0;
+            double *e=x.data();
             for (unsigned int k=N-n; k<N; k++)
+                e[k]=xN[k]-c[0];
+            for (unsigned int j=1; j<P; j++)
             {
-                double e=x[k]-eval(t[k]);                
-                _stop|=(fabs(e)>D);
-                mse[i]+=e*e;
+                const double *phij=&phi[j*N];
+                for (unsigned int k=N-n; k<N; k++)
+                    e[k]-=c[j]*phij[k];
             }
-            mse[i]/=n;
+
+            double emax=0.0;
+            double sse=0.0;
+            for (unsigned int k=N-n; k<N; k++)
+            {
+                emax=std::max(emax,fabs(e[k]));
+                sse+=e[k]*e[k];
+            }
+            mse[i]=sse/n;
+            bool _stop=(emax>D);
 
             // set the new window's length in case of
             // crossing of max deviation threshold
@@ -170,13 +341,35 @@ Vector AWPolyEstimator::estimate()
             }
         }
 
+        // bring the coefficients back to the time vector
+        if (origin!=0.0)
+        {
+            // expand the monomials of (t/T-1)
+            for (unsigned int m=0; m<P; m++)
+            {
+                double binom=1.0;
+                double v=0.0;
+                for (unsigned int j=m; j<P; j++)
+                {
+                    v+=(((j-m)&1)?-binom:binom)*c[j];
+                    binom=binom*(j+1)/(j+1-m);
+                }
+                coeff[m]=v;
+            }
+        }
+        else
+            std::copy(c,c+P,coeff.begin());
+
+        double s=1.0;
+        for (unsigned int j=1; j<=order; j++)
+        {
+            s*=1.0/T;
+            coeff[j]*=s;
+        }
+
         esteem[i]=getEsteeme();
     }
 
-    int margin=delta-10;
-    if (margin>0)
-        elemList.erase(elemList.begin(),elemList.begin()+margin);
-
     return esteem;
 }
 
@@ -192,9 +385,11 @@ Vector AWPolyEstimator::estimate(const AWPolyElement &el)
 /***************************************************************************/
 void AWPolyEstimator::reset()
 {
-    if (elemList.size()>0)
+    if (count>0)
     {
-        winLen.resize(elemList[0].data.length(),N);
+        winLen.resize(dim,N);
+        head=0;
+        count=0;
         elemList.clear();
     }
 }
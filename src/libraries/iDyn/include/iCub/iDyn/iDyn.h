@@ -73,6 +73,7 @@
 
 #include <deque>
 #include <string>
+#include <vector>
 
 
 namespace iCub
@@ -555,6 +556,44 @@ protected:
 
     const yarp::sig::Vector zero0;
 
+    /**
+    * Spatial quantities of a link, expressed in the link frame as
+    * [angular; linear] and referred to its origin, used by the
+    * composite and articulated body algorithms.
+    */
+    struct SpatialLink
+    {
+        /// motion transform from the previous frame
+        double X[6][6];
+        /// motion subspace of the joint
+        double S[6];
+        /// velocity, velocity-product acceleration and acceleration
+        double v[6],c[6],a[6];
+        /// composite or articulated inertia
+        double I[6][6];
+        /// articulated bias force
+        double p[6];
+        /// I*S, S'*I*S and the joint torque minus the bias
+        double U[6],d,u;
+    };
+
+    /// workspace of computeMassMatrix() and computeForwardDynamics()
+    std::vector<SpatialLink> spatial;
+
+    /**
+    * Fills the transform, the joint axis and the rigid body inertia
+    * of each link of the spatial workspace.
+    */
+    void prepareSpatialLinks();
+
+    /**
+    * Articulated body algorithm with the base kinematics and the end
+    * wrench given in the frames of the first and last link.
+    */
+    void computeArticulatedBody(const double *w0, const double *dw0, const double *ddp0,
+                                const double *Fend, const double *Muend,
+                                const yarp::sig::Vector &tau, yarp::sig::Vector &ddq);
+
     /**
     * Clone function
     */
@@ -731,6 +770,13 @@ public:
     */
     yarp::sig::Vector getTorques() const;
 
+    /**
+    * Returns the links torque in a vector provided by the caller, which is
+    * resized only if its length differs from the number of links
+    * @param tau the vector filled with the torques
+    */
+    void getTorques(yarp::sig::Vector &tau) const;
+
     /**
     * Returns the i-th link force
     * @return the i-th link force
@@ -1104,6 +1150,57 @@ public:
     */
     yarp::sig::Matrix computeMassMatrix(const yarp::sig::Vector& q);
 
+    /**
+    * Compute the joint space mass matrix considering only the active joints
+    * with the composite rigid body algorithm, in O(N*DOF) and without
+    * allocating memory once the workspace is built. The blocked links
+    * are rigidly attached to the previous ones, the rotor dynamics is
+    * neglected as in the DYNAMIC mode of Newton-Euler, and neither the
+    * joints velocities/accelerations nor the Newton-Euler state are
+    * modified.
+    * @param M the DOF-by-DOF symmetric positive-definite matrix, resized
+    *          only if its dimensions differ
+    * @return true if succeeds, false otherwise
+    */
+    bool computeMassMatrix(yarp::sig::Matrix &M);
+
+    /**
+    * Compute the accelerations of the active joints produced by the
+    * torques tau with the articulated body algorithm, in O(N) and
+    * without allocating memory once the workspace is built. The result
+    * satisfies computeNewtonEuler(w0,dw0,ddp0,Fend,Muend) == tau in
+    * DYNAMIC mode with the kinematics iterated FORWARD, whereas here the
+    * base kinematics is always the one of the base; the blocked links
+    * move with the velocities and accelerations they currently store.
+    * Neither the joints state nor the Newton-Euler state are modified.
+    * @param w0 angular velocity of the base in the root frame, rotated by
+    *           H0^T as in computeNewtonEuler()
+    * @param dw0 angular acceleration of the base, as w0
+    * @param ddp0 linear acceleration of the base, equal and opposite to gravity
+    *             if the base is still, as in computeNewtonEuler()
+    * @param Fend force exerted by the end-effector, as in computeNewtonEuler()
+    * @param Muend moment exerted by the end-effector, as in computeNewtonEuler()
+    * @param tau the DOF-dim vector of the active joint torques
+    * @param ddq the DOF-dim vector of the joint accelerations, resized only
+    *            if its length differs
+    * @return true if succeeds, false otherwise
+    */
+    bool computeForwardDynamics(const yarp::sig::Vector &w0, const yarp::sig::Vector &dw0, const yarp::sig::Vector &ddp0,
+                                const yarp::sig::Vector &Fend, const yarp::sig::Vector &Muend,
+                                const yarp::sig::Vector &tau, yarp::sig::Vector &ddq);
+
+    /**
+    * Compute the accelerations of the active joints produced by the
+    * torques tau with the articulated body algorithm, taking the base
+    * kinematics and the end wrench currently held by Newton-Euler, e.g.
+    * as set by initNewtonEuler() or propagated by an iDynNode.
+    * @param tau the DOF-dim vector of the active joint torques
+    * @param ddq the DOF-dim vector of the joint accelerations, resized only
+    *            if its length differs
+    * @return true if succeeds, false otherwise
+    */
+    bool computeForwardDynamics(const yarp::sig::Vector &tau, yarp::sig::Vector &ddq);
+
     /**
     * Compute the torques due to centrifugal and coriolis effects considering only the active joints.
     * @return a DOF-dim vector
@@ -54,6 +54,11 @@
 #include <iCub/iDyn/iDynContact.h>
 #include <deque>
 #include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 
 namespace iCub
@@ -119,6 +124,64 @@ struct version_tag
     }
 };
 
+
+/**
+* \ingroup iDynBody
+*
+* A fixed pool of worker threads running the independent steps of 
+* the whole-body computations, e.g. the Newton-Euler passes of the 
+* limbs attached to a node. 
+*  
+* \note The steps are data parallel and each of them only touches 
+*       its own limb, thus the results are identical to those of
+*       the serial execution. The pool is meant to be driven by
+*       one thread at a time and run() is not reentrant.
+*/
+class iDynTaskPool
+{
+protected:
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable cvStart;
+    std::condition_variable cvDone;
+    const std::function<void(unsigned int)> *job;
+    unsigned int jobSize;
+    unsigned int next;
+    unsigned int pending;
+    unsigned long generation;
+    bool quit;
+
+    void work();
+    void execute();
+
+public:
+    /**
+    * Constructor.
+    * @param nWorkers the number of worker threads, in addition to 
+    *                 the thread calling run().
+    */
+    iDynTaskPool(const unsigned int nWorkers);
+
+    /**
+    * Returns the number of worker threads.
+    * @return the number of worker threads.
+    */
+    unsigned int getNumWorkers() const { return (unsigned int)workers.size(); }
+
+    /**
+    * Executes task(0),...,task(n-1) on the workers and the calling 
+    * thread, returning when all of them are completed. 
+    * @param n the number of tasks.
+    * @param task the task, which receives its index.
+    */
+    void run(const unsigned int n, const std::function<void(unsigned int)> &task);
+
+    /**
+    * Destructor: stops and joins the workers.
+    */
+    ~iDynTaskPool();
+};
+
 //enum partEnum{ LEFT_ARM=0, RIGHT_ARM, LEFT_LEG, RIGHT_LEG, TORSO, HEAD, ALL }; 
 
 /**
@@ -558,6 +621,10 @@ protected:
     yarp::sig::Vector COM;  
     /// total mass of the node
     double mass;
+    /// the pool executing the limbs concurrently (NULL for serial execution)
+    iDynTaskPool *pool;
+    /// the indexes of the limbs processed in the current step
+    std::vector<unsigned int> tasks;
 
     /**
     * Reset all data to zero. The list of limbs is not modified or deleted.
@@ -602,6 +669,24 @@ protected:
     */
     unsigned int howManyKinematicInputs(bool afterAttach=false) const;
 
+    /**
+    * Executes func on the limbs listed in tasks, concurrently if a 
+    * pool is set. 
+    */
+    void runTasks(const std::function<void(unsigned int)> &func);
+
+    /**
+    * Forwards the kinematics of the node to the limbs with kinematic 
+    * flow = RBT_NODE_OUT and solves them.
+    */
+    void forwardKinematics();
+
+    /**
+    * Forwards the wrench of the node to the limbs with wrench flow = 
+    * RBT_NODE_OUT and solves them.
+    */
+    void forwardWrench();
+
 public:
 
     /**
@@ -636,6 +721,19 @@ public:
     */
     yarp::sig::Matrix getRBT(unsigned int iLimb) const;
 
+    /**
+    * Sets the pool used to solve the limbs of the node concurrently.
+    * @param _pool the pool, which is not owned by the node (NULL 
+    *              restores the serial execution).
+    */
+    void setTaskPool(iDynTaskPool *_pool) { pool=_pool; }
+
+    /**
+    * Returns the pool used to solve the limbs of the node.
+    * @return the pool, NULL if the execution is serial.
+    */
+    iDynTaskPool* getTaskPool() const { return pool; }
+
     /**
     * Main function to manage the exchange of kinematic information among the limbs attached to the node.
     * One single limb with kinematic flow of input type must exist: this limb is initilized with the kinematic variables
@@ -921,6 +1019,11 @@ protected:
     /// the list of iDynSensors used to solve each limb after FT sensor measurements
     std::deque<iDyn::iDynSensor *> sensorList;
 
+    /// workspace of setWrenchMeasure() and setSensorMeasurement(), so that
+    /// they do not allocate at every cycle
+    yarp::sig::Vector fi_ws, mi_ws;
+    yarp::sig::Matrix FM2_ws, FM3_ws;
+
     /**
     * @return the number of limbs with sensor
     */
@@ -1047,6 +1150,9 @@ class iDynSensorTorsoNode : public iDynSensorNode
 {
 public:
 
+    /// handles of the limbs of the node, see getLimbHandle()
+    enum { LIMB_NONE=-1, LIMB_UP=0, LIMB_LEFT=1, LIMB_RIGHT=2 };
+
     /// roto-translational matrix defining the central-up base frame with respect to the torso node
     yarp::sig::Matrix HUp;
     /// roto-translational matrix defining the left limb base frame with respect to the torso node
@@ -1203,6 +1309,23 @@ public:
     */
     double getTorque(const std::string &limbType, const unsigned int iLink) const;
 
+    /**
+    * Return the handle of a limb, which can be resolved once (e.g. at startup)
+    * and then used with the methods taking a handle in place of the limb name
+    * @param limbType a string with the limb name
+    * @return the handle of the limb, or LIMB_NONE if there's not a limb with that name
+    */
+    int getLimbHandle(const std::string &limbType) const;
+
+    /**
+    * Return the chosen limb torques in a vector provided by the caller, which 
+    * is resized only if its length differs from the number of links of the limb
+    * @param limb the limb handle, as returned by getLimbHandle()
+    * @param tau the vector filled with the torques
+    * @return true if succeeds, false if the handle is not valid
+    */
+    bool getTorques(const int limb, yarp::sig::Vector &tau) const;
+
     /**
     * Performs the computation of the center of mass (COM) of the node
     * @return true if succeeds, false otherwise
@@ -1219,27 +1342,27 @@ public:
     * Return the torso force
     * @return the torso force
     */
-    yarp::sig::Vector getTorsoForce() const;
+    const yarp::sig::Vector& getTorsoForce() const;
     /**
     * Return the torso moment
     * @return the torso moment
     */
-    yarp::sig::Vector getTorsoMoment() const;   
+    const yarp::sig::Vector& getTorsoMoment() const;   
     /**
     * Return the torso angular velocity
     * @return the torso angular velocity
     */
-    yarp::sig::Vector getTorsoAngVel() const;
+    const yarp::sig::Vector& getTorsoAngVel() const;
     /**
     * Return the torso angular acceleration
     * @return the torso angular acceleration
     */
-    yarp::sig::Vector getTorsoAngAcc() const;
+    const yarp::sig::Vector& getTorsoAngAcc() const;
     /**
     * Return the torso linear acceleration
     * @return the torso linear acceleration
     */
-    yarp::sig::Vector getTorsoLinAcc() const;
+    const yarp::sig::Vector& getTorsoLinAcc() const;
 
 
     //----------------
@@ -1475,6 +1598,21 @@ protected:
     /// defining the connection between Upper and Lower Torso
     RigidBodyTransformation * rbt;
     version_tag tag;
+    /// the wrench passed from the upper to the lower torso by attachLowerTorso()
+    yarp::sig::Vector FUP;
+    /// the pool shared by the nodes for the parallel execution (NULL if serial)
+    iDynTaskPool *pool;
+    /// true if the pool has been created by setParallel()
+    bool ownPool;
+
+    /// executes func on the upper and lower torso, concurrently if a pool is set
+    void runNodes(void (*func)(iDynSensorTorsoNode*));
+
+    /// the limbs in the order of getAllPositions(): left leg, right leg, torso, left arm, right arm, head
+    iDyn::iDynLimb *limbs[6];
+
+    /// returns the index in limbs of which_part, -1 if it is not a single limb
+    int limbIndex(const iCub::skinDynLib::BodyPart which_part) const;
 
 public:
 
@@ -1504,6 +1642,31 @@ public:
     */
     ~iCubWholeBody();
 
+    /**
+    * Enables the parallel execution of the computations: the limbs 
+    * of each node (arms and head, legs and torso) are solved 
+    * concurrently, as well as the COM and COM Jacobian of the 
+    * upper and lower torso. The results are identical to those of 
+    * the serial execution. 
+    * @param nWorkers the number of worker threads in addition to the
+    *                 calling one (0 restores the serial execution).
+    */
+    void setParallel(const unsigned int nWorkers);
+
+    /**
+    * Shares an existing pool, e.g. the one of another iCubWholeBody 
+    * driven by the same thread. 
+    * @param _pool the pool, which is not owned by the object (NULL 
+    *              restores the serial execution).
+    */
+    void setTaskPool(iDynTaskPool *_pool);
+
+    /**
+    * Returns the pool used for the parallel execution.
+    * @return the pool, NULL if the execution is serial.
+    */
+    iDynTaskPool* getTaskPool() const { return pool; }
+
     /**
     * Connect upper and lower torso: this procedure handles the exchange of kinematic and
     * wrench variables between the two parts.
@@ -1540,6 +1703,33 @@ public:
     * @return true if succeeds, false otherwise
     */
     bool getAllPositions(yarp::sig::Vector &pos);
+
+    /**
+    * Computes the joint space mass matrix of a part with the composite
+    * rigid body algorithm (see iDynChain::computeMassMatrix()), the
+    * limb having its base fixed to its node.
+    * @param which_part the limb (LEFT_LEG, RIGHT_LEG, TORSO, LEFT_ARM,
+    *                   RIGHT_ARM, HEAD); BODY_PART_ALL is not supported,
+    *                   since the limbs are coupled through the nodes.
+    * @param M the mass matrix, resized only if its dimensions differ
+    * @return true if succeeds, false otherwise
+    */
+    bool computeMassMatrix(const iCub::skinDynLib::BodyPart which_part, yarp::sig::Matrix &M);
+
+    /**
+    * Computes the joint accelerations of a part produced by the joint
+    * torques with the articulated body algorithm (see
+    * iDynChain::computeForwardDynamics()), each limb moving with the
+    * base kinematics and the end wrench propagated to it by the last
+    * computation of the nodes.
+    * @param which_part the limb (LEFT_LEG, RIGHT_LEG, TORSO, LEFT_ARM,
+    *                   RIGHT_ARM, HEAD); BODY_PART_ALL is not supported,
+    *                   since the limbs are coupled through the nodes.
+    * @param tau the joint torques
+    * @param ddq the joint accelerations, resized only if its length differs
+    * @return true if succeeds, false otherwise
+    */
+    bool computeForwardDynamics(const iCub::skinDynLib::BodyPart which_part, const yarp::sig::Vector &tau, yarp::sig::Vector &ddq);
     
     /**
     * Retrieves the result of the last COM jacobian computation
@@ -108,6 +108,8 @@ protected:
     yarp::sig::Vector zm;   
     ///the corresponding iDynLink 
     iDyn::iDynLink *link;   
+    ///(3x1) workspace of the recursive computations, so that they do not allocate at every step
+    yarp::sig::Vector ws;
 
     //~~~~~~~~~~~~~~~~~~~~~~
     //   set methods  
@@ -18,6 +18,7 @@
 
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 
@@ -394,7 +395,7 @@ void iDynLink::zero()
     Tau = 0.0;
     Im = 0.0; kr = 0.0; Fv = 0.0;   Fs = 0.0;
     HC = eye(4,4); RC = eye(3,3); rc = zeros(3);
-    H_store = eye(4,4); R_store = eye(3,3); r_store = zeros(3);
+    H_store = eye(4,4); R_store = eye(3,3); r_store = zeros(3); r_proj_store = zeros(3);
     H_store_valid = false;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -428,10 +429,27 @@ void iDynLink::updateHstore()
 {
     if(!H_store_valid)
     {
-        H_store = iKinLink::getH(true);
-        R_store = H_store.submatrix(0,2,0,2);
-        r_store = H_store.subcol(0,3,3);
-        r_proj_store = r_store*R_store;
+        // links built by copy do not go through zero()
+        if((H_store.rows()!=4) || (H_store.cols()!=4))
+            H_store = eye(4,4);
+        if((R_store.rows()!=3) || (R_store.cols()!=3))
+            R_store.resize(3,3);
+        if(r_store.length()!=3)
+            r_store.resize(3);
+        if(r_proj_store.length()!=3)
+            r_proj_store.resize(3);
+
+        // filled in place, so that getR() and getr() do not allocate
+        iKinSE3 T;
+        iKinLink::getH(T,true);
+        for(int i=0; i<3; i++)
+        {
+            for(int j=0; j<3; j++)
+                H_store(i,j) = R_store(i,j) = T.R[i][j];
+            H_store(i,3) = r_store[i] = T.p[i];
+        }
+        for(int j=0; j<3; j++)
+            r_proj_store[j] = r_store[0]*R_store(0,j)+r_store[1]*R_store(1,j)+r_store[2]*R_store(2,j);
         H_store_valid = true;
     }
 }
@@ -880,6 +898,14 @@ Vector iDynChain::getTorques() const
     return ret;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynChain::getTorques(Vector &tau) const
+{
+    if(tau.length()!=N)
+        tau.resize(N);
+    for(unsigned int i=0;i<N;i++)
+        tau[i]= allList[i]->getTorque();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iDynChain::setDynamicParameters(const unsigned int i, const double _m, const Matrix &_HC, const Matrix &_I, const double _kr, const double _Fv, const double _Fs, const double _Im)
 {
     if(i<N)
@@ -1604,71 +1630,363 @@ Matrix iDynChain::getHCOM(unsigned int iLink)
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 Matrix iDynChain::computeMassMatrix()
 {
-    Matrix M(DOF,DOF);          // mass matrix
-    iKinLink* l;
-    int hash_i;
-    setDAng(zeros(DOF));        // set to zero the joint vel
-    setD2Ang(zeros(DOF));       // set to zero the joint acc
+    Matrix M(DOF,DOF);
+    computeMassMatrix(M);
+    return M;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+Matrix iDynChain::computeMassMatrix(const Vector& q)
+{
+    setAng(q);
+    return computeMassMatrix();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+namespace
+{
+    // helpers of the composite and articulated body algorithms, working
+    // on 6D vectors [angular; linear] and 6x6 matrices stored as arrays
 
-    if(NE==NULL || NE->getMode()!=DYNAMIC)
-        prepareNewtonEuler(DYNAMIC);
-    initNewtonEuler();                  // init with zero w, dw, ddp, F, Mu
-    NE->ForwardKinematicFromBase();     // propagate zero kinematics from base
-    
-    for(int i=DOF-1; i>=0; i--) // start from the end of the chain
+    // X = [E 0; -E*[r]x E], with E=R' and r the DH rotation and translation
+    void motionTransform(const Matrix &R, const Vector &r, double X[6][6])
     {
-        l = quickList[hash_dof[i]];
-        hash_i = hash[i];
-        l->setD2Ang(1.0);       // set i-th accelleration to 1
-        
-        // forward kinematics from link i-1 to end
-        for(unsigned int j=1+hash_i; j<N+1; j++)
-            NE->neChain[j]->ForwardKinematics(NE->neChain[j-1]);
+        const double rx[3][3]={{0.0,-r[2],r[1]},{r[2],0.0,-r[0]},{-r[1],r[0],0.0}};
+        for (int a=0; a<3; a++)
+        {
+            for (int b=0; b<3; b++)
+            {
+                double Erx=0.0;
+                for (int k=0; k<3; k++)
+                    Erx+=R(k,a)*rx[k][b];
+                X[a][b]=X[a+3][b+3]=R(b,a);
+                X[a][b+3]=0.0;
+                X[a+3][b]=-Erx;
+            }
+        }
+    }
 
-        // backward wrench from end to link i
-        for(int j=N; j>=hash_i; j--)
-            NE->neChain[j]->BackwardWrench(NE->neChain[j+1]);
+    // inertia about the link origin of a body with mass m, center of mass c
+    // and rotational inertia Ic about the center of mass
+    void rigidBodyInertia(const double m, const Vector &c, const Matrix &Ic, double I[6][6])
+    {
+        const double cx[3][3]={{0.0,-c[2],c[1]},{c[2],0.0,-c[0]},{-c[1],c[0],0.0}};
+        const double cc=c[0]*c[0]+c[1]*c[1]+c[2]*c[2];
+        for (int a=0; a<3; a++)
+        {
+            for (int b=0; b<3; b++)
+            {
+                I[a][b]=Ic(a,b)+m*((a==b?cc:0.0)-c[a]*c[b]);
+                I[a][b+3]=m*cx[a][b];
+                I[a+3][b]=-m*cx[a][b];
+                I[a+3][b+3]=(a==b?m:0.0);
+            }
+        }
+    }
 
-        // copy the joint torques in the i-th column of M
-        for(unsigned int j=i; j<DOF; j++)
-            M(j,i) = M(i,j) = NE->neChain[hash[j]]->getMoment(true)[2]; 
-        //same as quickList[hash_dof[j]]->getTorque(), but in this way you do not need to call computeTorque
+    // y = A*x
+    void mul6(const double A[6][6], const double *x, double *y)
+    {
+        for (int a=0; a<6; a++)
+        {
+            y[a]=0.0;
+            for (int k=0; k<6; k++)
+                y[a]+=A[a][k]*x[k];
+        }
+    }
 
-        l->setD2Ang(0.0);          // set i-th accelleration to 0
+    // y = A'*x
+    void mul6T(const double A[6][6], const double *x, double *y)
+    {
+        for (int a=0; a<6; a++)
+        {
+            y[a]=0.0;
+            for (int k=0; k<6; k++)
+                y[a]+=A[k][a]*x[k];
+        }
     }
 
-    return M;
+    double dot6(const double *x, const double *y)
+    {
+        double d=0.0;
+        for (int k=0; k<6; k++)
+            d+=x[k]*y[k];
+        return d;
+    }
+
+    // P += X'*I*X, i.e. the inertia I of a link seen from the previous frame
+    void addCongruence(const double X[6][6], const double I[6][6], double P[6][6])
+    {
+        double IX[6][6];
+        for (int a=0; a<6; a++)
+        {
+            for (int b=0; b<6; b++)
+            {
+                IX[a][b]=0.0;
+                for (int k=0; k<6; k++)
+                    IX[a][b]+=I[a][k]*X[k][b];
+            }
+        }
+
+        for (int a=0; a<6; a++)
+        {
+            for (int b=0; b<6; b++)
+            {
+                double sum=0.0;
+                for (int k=0; k<6; k++)
+                    sum+=X[k][a]*IX[k][b];
+                P[a][b]+=sum;
+            }
+        }
+    }
+
+    void cross3(const double *a, const double *b, double *c)
+    {
+        c[0]=a[1]*b[2]-a[2]*b[1];
+        c[1]=a[2]*b[0]-a[0]*b[2];
+        c[2]=a[0]*b[1]-a[1]*b[0];
+    }
+
+    // y = v x m, the cross product of motion vectors
+    void crossMotion(const double *v, const double *m, double *y)
+    {
+        double t[3];
+        cross3(v,m,y);
+        cross3(v,m+3,y+3);
+        cross3(v+3,m,t);
+        for (int k=0; k<3; k++)
+            y[k+3]+=t[k];
+    }
+
+    // y = v x* f, the cross product of a motion and a force vector
+    void crossForce(const double *v, const double *f, double *y)
+    {
+        double t[3];
+        cross3(v,f,y);
+        cross3(v+3,f+3,t);
+        for (int k=0; k<3; k++)
+            y[k]+=t[k];
+        cross3(v,f+3,y+3);
+    }
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-Matrix iDynChain::computeMassMatrix(const Vector& q)
+void iDynChain::prepareSpatialLinks()
 {
-    setAng(q);
-    return computeMassMatrix();
+    if (spatial.size()<N)
+        spatial.resize(N);
+
+    for (unsigned int i=0; i<N; i++)
+    {
+        iDynLink *l=refLink(i);
+        SpatialLink &s=spatial[i];
+
+        // the joint rotates about z of the previous frame, through its origin
+        motionTransform(l->getR(),l->getr(),s.X);
+        for (int k=0; k<6; k++)
+            s.S[k]=s.X[k][2];
+
+        rigidBodyInertia(l->getMass(),l->getrC(),l->getInertia(),s.I);
+    }
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// This is a simpler version of the method, just to understand what the method does.
-// The new version is about 2 times faster than this, because it exploits the fact that
-// the mass matrix is symmetric (but it is a little harder to understand the code).
-//Matrix iDynChain::computeMassMatrix()
-//{
-//    // mass matrix
-//    Matrix M(DOF,DOF);
-//    setDAng(zeros(DOF));        // set to zero the joint vel
-//    setD2Ang(zeros(DOF));       // set to zero the joint acc
-//    prepareNewtonEuler(DYNAMIC);
-//    initNewtonEuler();
-//
-//    for(unsigned int i=0; i<DOF; i++)
-//    {
-//        quickList[hash_dof[i]]->setD2Ang(1.0);          // set i-th accelleration to 1
-//        computeNewtonEuler();                           // gravity and ext wrench are zero
-//        for(unsigned int j=0; j<DOF; j++)
-//            M(j,i) = quickList[hash_dof[j]]->getTorque();
-//        quickList[hash_dof[i]]->setD2Ang(0.0);          // set i-th accelleration to 0
-//    }
-//
-//    return M;
-//}
+bool iDynChain::computeMassMatrix(Matrix &M)
+{
+    if ((M.rows()!=DOF) || (M.cols()!=DOF))
+        M.resize(DOF,DOF);
+
+    if (DOF==0)
+        return true;
+
+    prepareSpatialLinks();
+
+    // composite inertias, from the end of the chain
+    for (int i=N-1; i>0; i--)
+        addCongruence(spatial[i].X,spatial[i].I,spatial[i-1].I);
+
+    for (unsigned int i=0; i<DOF; i++)
+    {
+        unsigned int j=hash[i];
+        double F[6],Fp[6];
+        mul6(spatial[j].I,spatial[j].S,F);
+        M(i,i)=dot6(spatial[j].S,F);
+
+        // carry the force of the i-th joint to the previous joints
+        unsigned int k=i;
+        while ((j>0) && (k>0))
+        {
+            mul6T(spatial[j].X,F,Fp);
+            memcpy(F,Fp,sizeof(F));
+            j--;
+            if (hash[k-1]==j)
+            {
+                k--;
+                M(k,i)=M(i,k)=dot6(spatial[j].S,F);
+            }
+        }
+    }
+
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynChain::computeArticulatedBody(const double *w0, const double *dw0, const double *ddp0,
+                                       const double *Fend, const double *Muend,
+                                       const Vector &tau, Vector &ddq)
+{
+    prepareSpatialLinks();
+
+    // velocities and bias forces, from the base; the linear velocity of
+    // the base does not affect the dynamics and is taken null
+    double v0[6]={w0[0],w0[1],w0[2],0.0,0.0,0.0};
+    for (unsigned int i=0; i<N; i++)
+    {
+        SpatialLink &s=spatial[i];
+        double dq=allList[i]->getDAng();
+        double Iv[6];
+
+        mul6(s.X,(i>0)?spatial[i-1].v:v0,s.v);
+        for (int k=0; k<6; k++)
+            s.v[k]+=s.S[k]*dq;
+
+        crossMotion(s.v,s.S,s.c);
+        for (int k=0; k<6; k++)
+            s.c[k]*=dq;
+
+        mul6(s.I,s.v,Iv);
+        crossForce(s.v,Iv,s.p);
+    }
+
+    // the end-effector exerts Fend and Muend on the environment
+    for (int k=0; k<3; k++)
+    {
+        spatial[N-1].p[k]+=Muend[k];
+        spatial[N-1].p[k+3]+=Fend[k];
+    }
+
+    // articulated inertias and bias forces, from the end of the chain
+    int k=DOF-1;
+    for (int i=N-1; i>=0; i--)
+    {
+        SpatialLink &s=spatial[i];
+        double Ic[6],pa[6];
+
+        if (allList[i]->isBlocked())
+        {
+            // the acceleration of the joint is known
+            double ddq_b=allList[i]->getD2Ang();
+            double a[6];
+            for (int m=0; m<6; m++)
+                a[m]=s.c[m]+s.S[m]*ddq_b;
+            mul6(s.I,a,Ic);
+            for (int m=0; m<6; m++)
+                s.p[m]+=Ic[m];
+        }
+        else
+        {
+            mul6(s.I,s.S,s.U);
+            s.d=dot6(s.S,s.U);
+            s.u=tau[k--]-dot6(s.S,s.p);
+
+            for (int a=0; a<6; a++)
+                for (int b=0; b<6; b++)
+                    s.I[a][b]-=s.U[a]*s.U[b]/s.d;
+
+            mul6(s.I,s.c,Ic);
+            for (int m=0; m<6; m++)
+                s.p[m]+=Ic[m]+s.U[m]*s.u/s.d;
+        }
+
+        if (i>0)
+        {
+            addCongruence(s.X,s.I,spatial[i-1].I);
+            mul6T(s.X,s.p,pa);
+            for (int m=0; m<6; m++)
+                spatial[i-1].p[m]+=pa[m];
+        }
+    }
+
+    if (ddq.length()!=DOF)
+        ddq.resize(DOF);
+
+    // accelerations, from the base
+    double a0[6]={dw0[0],dw0[1],dw0[2],ddp0[0],ddp0[1],ddp0[2]};
+    k=0;
+    for (unsigned int i=0; i<N; i++)
+    {
+        SpatialLink &s=spatial[i];
+        double qdd;
+
+        mul6(s.X,(i>0)?spatial[i-1].a:a0,s.a);
+        for (int m=0; m<6; m++)
+            s.a[m]+=s.c[m];
+
+        if (allList[i]->isBlocked())
+            qdd=allList[i]->getD2Ang();
+        else
+            ddq[k++]=qdd=(s.u-dot6(s.U,s.a))/s.d;
+
+        for (int m=0; m<6; m++)
+            s.a[m]+=s.S[m]*qdd;
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynChain::computeForwardDynamics(const Vector &w0, const Vector &dw0, const Vector &ddp0,
+                                       const Vector &Fend, const Vector &Muend,
+                                       const Vector &tau, Vector &ddq)
+{
+    if ((w0.length()!=3) || (dw0.length()!=3) || (ddp0.length()!=3) ||
+        (Fend.length()!=3) || (Muend.length()!=3) || (tau.length()!=DOF) || (N==0))
+    {
+        if(verbose)
+            yError("iDynChain error: computeForwardDynamics() failed due to wrong sized vectors: w0,dw0,ddp0,Fend,Muend,tau have size %d,%d,%d,%d,%d,%d instead of 3,3,3,3,3,%d \n",
+                   (int)w0.length(),(int)dw0.length(),(int)ddp0.length(),(int)Fend.length(),(int)Muend.length(),(int)tau.length(),DOF);
+        return false;
+    }
+
+    // the base kinematics is given in the root frame and, as BaseLinkNewtonEuler
+    // does in setAngVel(), setAngAcc() and setLinAcc(), it is rotated by H0^T
+    // into the frame where the first joint rotates
+    double w[3],dw[3],ddp[3];
+    for (int k=0; k<3; k++)
+    {
+        w[k]=dw[k]=ddp[k]=0.0;
+        for (int m=0; m<3; m++)
+        {
+            w[k]+=H0(m,k)*w0[m];
+            dw[k]+=H0(m,k)*dw0[m];
+            ddp[k]+=H0(m,k)*ddp0[m];
+        }
+    }
+
+    computeArticulatedBody(w,dw,ddp,Fend.data(),Muend.data(),tau,ddq);
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynChain::computeForwardDynamics(const Vector &tau, Vector &ddq)
+{
+    if ((tau.length()!=DOF) || (N==0))
+    {
+        if(verbose)
+            yError("iDynChain error: computeForwardDynamics() failed due to wrong sized vector: tau has size %d instead of %d \n",(int)tau.length(),DOF);
+        return false;
+    }
+
+    if( NE == NULL)
+    {
+        if(verbose)
+        {
+            yError("iDynChain error: trying to call computeForwardDynamics() without having prepared Newton-Euler method in the class. \n");
+            yError("iDynChain: prepareNewtonEuler() called autonomously in the default mode.  \n");
+            yError("iDynChain: initNewtonEuler() called autonomously with default values.  \n");
+        }
+        prepareNewtonEuler();
+        initNewtonEuler();
+    }
+
+    // the base link stores its kinematics already rotated by H0^T
+    OneLinkNewtonEuler *base=NE->neChain[0];
+    OneLinkNewtonEuler *end=NE->neChain[N+1];
+    computeArticulatedBody(base->getAngVel().data(),base->getAngAcc().data(),base->getLinAcc().data(),
+                           end->getForce().data(),end->getMoment().data(),tau,ddq);
+    return true;
+}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 Vector iDynChain::computeCcTorques()
 {
@@ -406,6 +406,102 @@ Matrix RigidBodyTransformation::getHCOM(unsigned int iLink)
 
 
 
+//====================================
+//
+//      i DYN TASK POOL
+//
+//====================================
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+iDynTaskPool::iDynTaskPool(const unsigned int nWorkers)
+{
+    job=NULL;
+    jobSize=next=pending=0;
+    generation=0;
+    quit=false;
+    for (unsigned int i=0; i<nWorkers; i++)
+        workers.push_back(thread(&iDynTaskPool::work,this));
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+iDynTaskPool::~iDynTaskPool()
+{
+    {
+        lock_guard<mutex> lck(mtx);
+        quit=true;
+    }
+    cvStart.notify_all();
+    for (size_t i=0; i<workers.size(); i++)
+        workers[i].join();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynTaskPool::work()
+{
+    unsigned long seen=0;
+    for (;;)
+    {
+        {
+            unique_lock<mutex> lck(mtx);
+            cvStart.wait(lck,[&]{ return quit || (generation!=seen); });
+            if (quit)
+                return;
+            seen=generation;
+        }
+        execute();
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynTaskPool::execute()
+{
+    for (;;)
+    {
+        const function<void(unsigned int)> *task;
+        unsigned int i;
+        {
+            lock_guard<mutex> lck(mtx);
+            if (next>=jobSize)
+                return;
+            task=job;
+            i=next++;
+        }
+
+        (*task)(i);
+
+        lock_guard<mutex> lck(mtx);
+        if (--pending==0)
+            cvDone.notify_all();
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynTaskPool::run(const unsigned int n, const function<void(unsigned int)> &task)
+{
+    // nothing to share: avoid waking up the workers
+    if (workers.empty() || (n<2))
+    {
+        for (unsigned int i=0; i<n; i++)
+            task(i);
+        return;
+    }
+
+    {
+        lock_guard<mutex> lck(mtx);
+        job=&task;
+        jobSize=pending=n;
+        next=0;
+        generation++;
+    }
+    cvStart.notify_all();
+
+    // the calling thread takes its share of the tasks as well
+    execute();
+
+    unique_lock<mutex> lck(mtx);
+    cvDone.wait(lck,[&]{ return pending==0; });
+    job=NULL;
+    jobSize=next=0;
+}
+
+
+
 //====================================
 //
 //      i DYN NODE
@@ -417,6 +513,7 @@ iDynNode::iDynNode(const NewEulMode _mode)
 {
     rbtList.clear();
     mode = _mode;
+    pool = NULL;
     verbose = iCub::skinDynLib::VERBOSE;
     zero();
 }
@@ -426,6 +523,7 @@ iDynNode::iDynNode(const string &_info, const NewEulMode _mode, unsigned int ver
     info=_info;
     rbtList.clear();
     mode = _mode;
+    pool = NULL;
     verbose = verb;
     zero();
 }
@@ -459,6 +557,48 @@ Matrix iDynNode::getRBT(unsigned int iLimb) const
     }
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynNode::runTasks(const function<void(unsigned int)> &func)
+{
+    if (pool!=NULL)
+        pool->run((unsigned int)tasks.size(),func);
+    else for (unsigned int k=0; k<tasks.size(); k++)
+        func(k);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynNode::forwardKinematics()
+{
+    //init the kinematics with the node information
+    tasks.clear();
+    for(unsigned int i=0; i<rbtList.size(); i++)
+    {
+        if(rbtList[i].getKinematicFlow()==RBT_NODE_OUT)
+        {
+            rbtList[i].setKinematic(w,dw,ddp);
+            tasks.push_back(i);
+        }
+    }
+
+    //solve kinematics in each limb/chain: the limbs are independent
+    runTasks([this](unsigned int k){ rbtList[tasks[k]].computeLimbKinematic(); });
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynNode::forwardWrench()
+{
+    //init the wrench with the node information
+    tasks.clear();
+    for(unsigned int i=0; i<rbtList.size(); i++)
+    {
+        if(rbtList[i].getWrenchFlow()==RBT_NODE_OUT)
+        {
+            rbtList[i].setWrench(F,Mu);
+            tasks.push_back(i);
+        }
+    }
+
+    //solve wrench in each limb/chain: the limbs are independent
+    runTasks([this](unsigned int k){ rbtList[tasks[k]].computeLimbWrench(); });
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iDynNode::solveKinematics()
 {
     unsigned int inputNode=0;
@@ -483,16 +623,7 @@ bool iDynNode::solveKinematics()
     if(inputNode==1)
     {
         //now forward the kinematic input from limbs whose kinematic flow is input type
-        for(unsigned int i=0; i<rbtList.size(); i++)
-        {
-            if(rbtList[i].getKinematicFlow()==RBT_NODE_OUT)
-            {
-                //init the kinematics with the node information
-                rbtList[i].setKinematic(w,dw,ddp);
-                //solve kinematics in that limb/chain
-                rbtList[i].computeLimbKinematic();
-            }
-        }
+        forwardKinematics();
         return true;
     
     }
@@ -532,16 +663,7 @@ bool iDynNode::solveKinematics(const Vector &w0, const Vector &dw0, const Vector
     if(inputNode==1)
     {
         //now forward the kinematic input from limbs whose kinematic flow is input type
-        for(unsigned int i=0; i<rbtList.size(); i++)
-        {
-            if(rbtList[i].getKinematicFlow()==RBT_NODE_OUT)
-            {
-                //init the kinematics with the node information
-                rbtList[i].setKinematic(w,dw,ddp);
-                //solve kinematics in that limb/chain
-                rbtList[i].computeLimbKinematic();
-            }
-        }
+        forwardKinematics();
         return true;
     
     }
@@ -595,19 +717,23 @@ bool iDynNode::solveWrench()
     //first get the forces/moments from each limb
     //assuming that each limb has been properly set with the outcoming measured
     //forces/moments which are necessary for the wrench computation
+    tasks.clear();
     for(unsigned int i=0; i<rbtList.size(); i++)
+        if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)
+            tasks.push_back(i);
+
+    //compute the wrench pass in each limb
+    runTasks([this](unsigned int k){ rbtList[tasks[k]].computeLimbWrench(); });
+
+    for(unsigned int k=0; k<tasks.size(); k++)
     {
-        if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)         
-        {
-            //compute the wrench pass in that limb
-            rbtList[i].computeLimbWrench();
-            //update the node force/moment with the wrench coming from the limb base/end
-            // note that getWrench sum the result to F,Mu - because they are passed by reference
-            // F = F + F[i], Mu = Mu + Mu[i]
-            rbtList[i].getWrench(F,Mu);
-            //check
-            outputNode++;
-        }
+        //update the node force/moment with the wrench coming from the limb base/end
+        //following the order of the limbs, so that the sum does not depend on the execution
+        // note that getWrench sum the result to F,Mu - because they are passed by reference
+        // F = F + F[i], Mu = Mu + Mu[i]
+        rbtList[tasks[k]].getWrench(F,Mu);
+        //check
+        outputNode++;
     }
 
     // node summation: already performed by each RBT
@@ -628,16 +754,7 @@ bool iDynNode::solveWrench()
     }
 
     //now forward the wrench output from the node to limbs whose wrench flow is output type
-    for(unsigned int i=0; i<rbtList.size(); i++)
-    {
-        if(rbtList[i].getWrenchFlow()==RBT_NODE_OUT)
-        {
-            //init the wrench with the node information
-            rbtList[i].setWrench(F,Mu);
-            //solve wrench in that limb/chain
-            rbtList[i].computeLimbWrench();
-        }
-    }
+    forwardWrench();
     return true;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -1328,12 +1445,16 @@ iDynSensorNode::iDynSensorNode(const NewEulMode _mode)
 :iDynNode(_mode)
 {
     sensorList.clear();
+    fi_ws.resize(3,0.0); mi_ws.resize(3,0.0);
+    FM2_ws.resize(6,2); FM3_ws.resize(6,3);
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 iDynSensorNode::iDynSensorNode(const string &_info, const NewEulMode _mode, unsigned int verb)
 :iDynNode(_info,_mode,verb)
 {
     sensorList.clear();
+    fi_ws.resize(3,0.0); mi_ws.resize(3,0.0);
+    FM2_ws.resize(6,2); FM3_ws.resize(6,3);
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void iDynSensorNode::addLimb(iDynLimb *limb, const Matrix &H, const FlowType kinFlow, const FlowType wreFlow)
@@ -1358,25 +1479,32 @@ bool iDynSensorNode::solveWrench()
     //first get the forces/moments from each limb
     //assuming that each limb has been properly set with the outcoming measured
     //forces/moments which are necessary for the wrench computation
+    tasks.clear();
     for(unsigned int i=0; i<rbtList.size(); i++)
+        if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)
+            tasks.push_back(i);
+
+    //compute the wrench pass in each limb
+    // if there's a sensor, we must use iDynSensor
+    // otherwise we use the limb method as usual
+    runTasks([this](unsigned int k)
     {
-        if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)         
-        {
-            //compute the wrench pass in that limb
-            // if there's a sensor, we must use iDynSensor
-            // otherwise we use the limb method as usual
-            if(rbtList[i].isSensorized()==true)
-                sensorList[i]->computeWrenchFromSensorNewtonEuler();
-            else
-                rbtList[i].computeLimbWrench();
-
-            //update the node force/moment with the wrench coming from the limb base/end
-            // note that getWrench sum the result to F,Mu - because they are passed by reference
-            // F = F + F[i], Mu = Mu + Mu[i]
-            rbtList[i].getWrench(F,Mu);
-            //check
-            outputNode++;
-        }
+        unsigned int i=tasks[k];
+        if(rbtList[i].isSensorized()==true)
+            sensorList[i]->computeWrenchFromSensorNewtonEuler();
+        else
+            rbtList[i].computeLimbWrench();
+    });
+
+    for(unsigned int k=0; k<tasks.size(); k++)
+    {
+        //update the node force/moment with the wrench coming from the limb base/end
+        //following the order of the limbs, so that the sum does not depend on the execution
+        // note that getWrench sum the result to F,Mu - because they are passed by reference
+        // F = F + F[i], Mu = Mu + Mu[i]
+        rbtList[tasks[k]].getWrench(F,Mu);
+        //check
+        outputNode++;
     }
 
     // node summation: already performed by each RBT
@@ -1397,24 +1525,14 @@ bool iDynSensorNode::solveWrench()
 
     //now forward the wrench output from the node to limbs whose wrench flow is output type
     // assuming they don't have a FT sensor
-    for(unsigned int i=0; i<rbtList.size(); i++)
-    {
-        if(rbtList[i].getWrenchFlow()==RBT_NODE_OUT)
-        {
-            //init the wrench with the node information
-            rbtList[i].setWrench(F,Mu);
-            //solve wrench in that limb/chain
-            rbtList[i].computeLimbWrench();
-        }
-    }
+    forwardWrench();
     return true;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iDynSensorNode::setWrenchMeasure(const Matrix &FM, bool afterAttach)
 {
-    Vector fi(3); fi.zero();
-    Vector mi(3); mi.zero();
-    Vector FMi(6);FMi.zero();
+    Vector &fi = fi_ws; fi.zero();
+    Vector &mi = mi_ws; mi.zero();
     bool inputWasOk = true;
 
     //check how many limbs have wrench input
@@ -1459,9 +1577,8 @@ bool iDynSensorNode::setWrenchMeasure(const Matrix &FM, bool afterAttach)
             if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)         
             {
                 // from the input matrix - read the input wrench
-                FMi = FM.getCol(inputNode);
-                fi[0]=FMi[0];fi[1]=FMi[1];fi[2]=FMi[2];
-                mi[0]=FMi[3];mi[1]=FMi[4];mi[2]=FMi[5];
+                fi[0]=FM(0,inputNode);fi[1]=FM(1,inputNode);fi[2]=FM(2,inputNode);
+                mi[0]=FM(3,inputNode);mi[1]=FM(4,inputNode);mi[2]=FM(5,inputNode);
                 inputNode++;
                 //set the input wrench in the RBT->limb
                 // if there's a sensor, set on the sensor
@@ -1629,21 +1746,24 @@ Matrix iDynSensorNode::estimateSensorsWrench(const Matrix &FM, bool afterAttach)
     //first get the forces/moments from each limb
     //assuming that each limb has been properly set with the outcoming measured
     //forces/moments which are necessary for the wrench computation
+    tasks.clear();
     for(unsigned int i=0; i<rbtList.size(); i++)
-    {
-        if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)         
-        {
-            //compute the wrench pass in that limb
-            // if there's a sensor, it's the same because here we estimate its value
-            rbtList[i].computeLimbWrench();
+        if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)
+            tasks.push_back(i);
 
-            //update the node force/moment with the wrench coming from the limb base/end
-            // note that getWrench sum the result to F,Mu - because they are passed by reference
-            // F = F + F[i], Mu = Mu + Mu[i]
-            rbtList[i].getWrench(F,Mu);
-            //check
-            outputNode++;
-        }
+    //compute the wrench pass in each limb
+    // if there's a sensor, it's the same because here we estimate its value
+    runTasks([this](unsigned int k){ rbtList[tasks[k]].computeLimbWrench(); });
+
+    for(unsigned int k=0; k<tasks.size(); k++)
+    {
+        //update the node force/moment with the wrench coming from the limb base/end
+        //following the order of the limbs, so that the sum does not depend on the execution
+        // note that getWrench sum the result to F,Mu - because they are passed by reference
+        // F = F + F[i], Mu = Mu + Mu[i]
+        rbtList[tasks[k]].getWrench(F,Mu);
+        //check
+        outputNode++;
     }
 
     // node summation: already performed by each RBT
@@ -1665,16 +1785,7 @@ Matrix iDynSensorNode::estimateSensorsWrench(const Matrix &FM, bool afterAttach)
 
     //now forward the wrench output from the node to limbs whose wrench flow is output type
     // assuming they don't have a FT sensor
-    for(unsigned int i=0; i<rbtList.size(); i++)
-    {
-        if(rbtList[i].getWrenchFlow()==RBT_NODE_OUT)
-        {
-            //init the wrench with the node information
-            rbtList[i].setWrench(F,Mu);
-            //solve wrench in that limb/chain
-            rbtList[i].computeLimbWrench();
-        }
-    }
+    forwardWrench();
 
     // now look for sensors
     numSensor = 0;
@@ -1757,7 +1868,7 @@ bool iDynSensorTorsoNode::setInertialMeasure(const Vector &w0, const Vector &dw0
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iDynSensorTorsoNode::setSensorMeasurement(const Vector &FM_right, const Vector &FM_left)
 {
-    Matrix FM(6,2); FM.zero();
+    Matrix &FM = FM2_ws; FM.zero();
     if((FM_right.length()==6)&&(FM_left.length()==6))
     {
         FM.setCol(0,FM_right);
@@ -1774,7 +1885,7 @@ bool iDynSensorTorsoNode::setSensorMeasurement(const Vector &FM_right, const Vec
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iDynSensorTorsoNode::setSensorMeasurement(const Vector &FM_right, const Vector &FM_left, const Vector &FM_up)
 {
-    Matrix FM(6,3); FM.zero();
+    Matrix &FM = FM3_ws; FM.zero();
     if((FM_right.length()==6)&&(FM_left.length()==6)&&(FM_up.length()==6))
     {
         // order: up 0 - right 1 - left 2
@@ -1899,15 +2010,40 @@ Vector iDynSensorTorsoNode::getTorques(const string &limbType)
     }
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-Vector iDynSensorTorsoNode::getTorsoForce() const { return F;}  
+int iDynSensorTorsoNode::getLimbHandle(const string &limbType) const
+{
+    if(limbType==up_name)           return LIMB_UP;
+    else if(limbType==left_name)    return LIMB_LEFT;
+    else if(limbType==right_name)   return LIMB_RIGHT;
+    else
+    {       
+        if(verbose) fprintf(stderr,"Node <%s> there's not a limb named %s. Only %s,%s,%s are available. \n",name.c_str(),limbType.c_str(),left_name.c_str(),right_name.c_str(),up_name.c_str());
+        return LIMB_NONE;
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynSensorTorsoNode::getTorques(const int limb, Vector &tau) const
+{
+    switch(limb)
+    {
+        case LIMB_UP:       up->getTorques(tau);    return true;
+        case LIMB_LEFT:     left->getTorques(tau);  return true;
+        case LIMB_RIGHT:    right->getTorques(tau); return true;
+        default:
+            if(verbose) fprintf(stderr,"Node <%s> there's not a limb with handle %d. \n",name.c_str(),limb);
+            return false;
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+const Vector& iDynSensorTorsoNode::getTorsoForce() const { return F;}  
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-Vector iDynSensorTorsoNode::getTorsoMoment() const{ return Mu;} 
+const Vector& iDynSensorTorsoNode::getTorsoMoment() const{ return Mu;} 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-Vector iDynSensorTorsoNode::getTorsoAngVel() const{ return w;}
+const Vector& iDynSensorTorsoNode::getTorsoAngVel() const{ return w;}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-Vector iDynSensorTorsoNode::getTorsoAngAcc() const{ return dw;}
+const Vector& iDynSensorTorsoNode::getTorsoAngAcc() const{ return dw;}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-Vector iDynSensorTorsoNode::getTorsoLinAcc() const{ return ddp;}
+const Vector& iDynSensorTorsoNode::getTorsoLinAcc() const{ return ddp;}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool   iDynSensorTorsoNode::computeCOM()
 {
@@ -2409,66 +2545,119 @@ iCubWholeBody::iCubWholeBody(version_tag _tag, const NewEulMode mode, unsigned i
     H.eye();
     //H  is no used currently since the transformation is an identity
     rbt = new RigidBodyTransformation(lowerTorso->up,H,"connection between lower and upper torso",false,RBT_NODE_OUT,RBT_NODE_OUT,mode,verbose);
+
+    FUP.resize(6,0.0);
+    pool = NULL;
+    ownPool = false;
+
+    limbs[0] = lowerTorso->left;
+    limbs[1] = lowerTorso->right;
+    limbs[2] = lowerTorso->up;
+    limbs[3] = upperTorso->left;
+    limbs[4] = upperTorso->right;
+    limbs[5] = upperTorso->up;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 iCubWholeBody::~iCubWholeBody()
 {
+    setTaskPool(NULL);
     if (upperTorso) delete upperTorso; upperTorso = NULL;
     if (lowerTorso) delete lowerTorso; lowerTorso = NULL;
     if (rbt)        delete rbt;        rbt        = NULL;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iCubWholeBody::setTaskPool(iDynTaskPool *_pool)
+{
+    if (ownPool && (pool!=_pool))
+        delete pool;
+    ownPool = false;
+
+    pool = _pool;
+    upperTorso->setTaskPool(pool);
+    lowerTorso->setTaskPool(pool);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iCubWholeBody::setParallel(const unsigned int nWorkers)
+{
+    if (nWorkers>0)
+    {
+        setTaskPool(new iDynTaskPool(nWorkers));
+        ownPool = true;
+    }
+    else
+        setTaskPool(NULL);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void iCubWholeBody::attachLowerTorso(const Vector &FM_right_leg, const Vector &FM_left_leg)
 {
-    Vector in_w   = upperTorso->getTorsoAngVel();
-    Vector in_dw  = upperTorso->getTorsoAngAcc();
-    Vector in_ddp = upperTorso->getTorsoLinAcc();
-    Vector in_F   = upperTorso->getTorsoForce();
-    Vector in_M   = upperTorso->getTorsoMoment();
-
-    Vector out_w;   out_w.resize(3);
-    Vector out_dw;  out_dw.resize(3);
-    Vector out_ddp; out_ddp.resize(3);
-    Vector out_F;   out_F.resize(3);
-    Vector out_M;   out_M.resize(3);
-    
-    //kinematics: 
-    out_w[0]= in_w[0];
-    out_w[1]= in_w[1];
-    out_w[2]= in_w[2];
-
-    out_dw[0]= in_dw[0];
-    out_dw[1]= in_dw[1];
-    out_dw[2]= in_dw[2];
-
-    out_ddp[0]= in_ddp[0];
-    out_ddp[1]= in_ddp[1];
-    out_ddp[2]= in_ddp[2];
-
-    //wrenches:
-    out_F[0]= in_F[0];
-    out_F[1]= in_F[1];
-    out_F[2]= in_F[2];
-
-    out_M[0]= in_M[0];
-    out_M[1]= in_M[1];
-    out_M[2]= in_M[2];
-
-    Vector FUP ;
-    Vector FLL ;
-    Vector FRL ;
-    FUP.resize(6);
-    FUP[0] = out_F[0];
-    FUP[1] = out_F[1];
-    FUP[2] = out_F[2];
-    FUP[3] = out_M[0];
-    FUP[4] = out_M[1];
-    FUP[5] = out_M[2];
-    lowerTorso->setKinematicMeasure(out_w,out_dw,out_ddp);
+    //kinematics and wrenches of the upper torso node are forwarded as they are:
+    //no copies, as the node keeps them in its members
+    const Vector &in_F = upperTorso->getTorsoForce();
+    const Vector &in_M = upperTorso->getTorsoMoment();
+
+    FUP[0] = in_F[0];
+    FUP[1] = in_F[1];
+    FUP[2] = in_F[2];
+    FUP[3] = in_M[0];
+    FUP[4] = in_M[1];
+    FUP[5] = in_M[2];
+    lowerTorso->setKinematicMeasure(upperTorso->getTorsoAngVel(),upperTorso->getTorsoAngAcc(),upperTorso->getTorsoLinAcc());
     lowerTorso->setSensorMeasurement(FM_right_leg,FM_left_leg,FUP);
 
 }
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iCubWholeBody::runNodes(void (*func)(iDynSensorTorsoNode*))
+{
+    iDynSensorTorsoNode *nodes[2]={upperTorso,lowerTorso};
+    if (pool!=NULL)
+        pool->run(2,[&](unsigned int i){ func(nodes[i]); });
+    else
+    {
+        func(nodes[0]);
+        func(nodes[1]);
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+int iCubWholeBody::limbIndex(const BodyPart which_part) const
+{
+    switch (which_part)
+    {
+        case LEFT_LEG:  return 0;
+        case RIGHT_LEG: return 1;
+        case TORSO:     return 2;
+        case LEFT_ARM:  return 3;
+        case RIGHT_ARM: return 4;
+        case HEAD:      return 5;
+        default:        return -1;
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iCubWholeBody::computeMassMatrix(const BodyPart which_part, Matrix &M)
+{
+    // the limbs share the nodes, hence stacking their fixed-base matrices
+    // would not give the mass matrix of the whole body
+    int i=limbIndex(which_part);
+    if (i<0)
+    {
+        fprintf(stderr,"iCubWholeBody error: computeMassMatrix() not available for the part %s \n",BodyPart_s[which_part].c_str());
+        return false;
+    }
+    return limbs[i]->computeMassMatrix(M);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iCubWholeBody::computeForwardDynamics(const BodyPart which_part, const Vector &tau, Vector &ddq)
+{
+    // as for the mass matrix, stacking the accelerations of the limbs with
+    // their bases fixed to the nodes would not give those of the whole body
+    int i=limbIndex(which_part);
+    if (i<0)
+    {
+        fprintf(stderr,"iCubWholeBody error: computeForwardDynamics() not available for the part %s \n",BodyPart_s[which_part].c_str());
+        return false;
+    }
+    return limbs[i]->computeForwardDynamics(tau,ddq);
+}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iCubWholeBody::computeCOM()
 {
@@ -2476,7 +2665,8 @@ bool iCubWholeBody::computeCOM()
     yarp::sig::Matrix T0 = lowerTorso->HUp;
     yarp::sig::Matrix T1 = lowerTorso->up->getH(2,true);
 
-    upperTorso->computeCOM();
+    //the upper and lower torso are independent
+    runNodes([](iDynSensorTorsoNode *node){ node->computeCOM(); });
 
     upper_mass =   upperTorso->total_mass_UP
                   +upperTorso->total_mass_LF
@@ -2489,8 +2679,6 @@ bool iCubWholeBody::computeCOM()
     upper_COM= T0 * T1 * upper_COM;
 
     //lower torso COM computation
-    lowerTorso->computeCOM();
-
     lower_mass =   lowerTorso->total_mass_UP
                   +lowerTorso->total_mass_LF
                   +lowerTorso->total_mass_RT;
@@ -2682,11 +2870,8 @@ bool iCubWholeBody::EXPERIMENTAL_computeCOMjacobian()
     int ct=0;
     int c=0;
 
-    //upper torso COM jacobian computation
-    upperTorso->EXPERIMENTAL_computeCOMjacobian();
-
-    //lower torso COM jacobian computation
-    lowerTorso->EXPERIMENTAL_computeCOMjacobian();
+    //upper and lower torso COM jacobian computation
+    runNodes([](iDynSensorTorsoNode *node){ node->EXPERIMENTAL_computeCOMjacobian(); });
 
     //order the partial jacobians in the main jacobian.
     this->COM_Jacob.resize(6,32);
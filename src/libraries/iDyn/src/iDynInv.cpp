@@ -35,6 +35,54 @@ using namespace iCub::iKin;
 using namespace iCub::iDyn;
 using namespace iCub::skinDynLib;
 
+namespace
+{
+    // helpers of the recursive Newton-Euler computation working on
+    // 3x1 vectors (and 3x3 matrices) without temporaries
+
+    // out = M*v
+    inline void mul3(const Matrix &M, const double *v, double *out)
+    {
+        for (int i=0; i<3; i++)
+            out[i]=M(i,0)*v[0]+M(i,1)*v[1]+M(i,2)*v[2];
+    }
+
+    // out = M'*v, i.e. v*M
+    inline void mul3T(const Matrix &M, const double *v, double *out)
+    {
+        for (int i=0; i<3; i++)
+            out[i]=M(0,i)*v[0]+M(1,i)*v[1]+M(2,i)*v[2];
+    }
+
+    // out = a x b
+    inline void cross3(const double *a, const double *b, double *out)
+    {
+        out[0]=a[1]*b[2]-a[2]*b[1];
+        out[1]=a[2]*b[0]-a[0]*b[2];
+        out[2]=a[0]*b[1]-a[1]*b[0];
+    }
+
+    // rF = r x F, rmddpC = (r+rC) x (m*ddpC)
+    inline void momentArms(const Vector &r, const Vector &rC, const Vector &F, const double m,
+                           const Vector &ddpC, double *rF, double *rmddpC)
+    {
+        double rrC[3]={r[0]+rC[0], r[1]+rC[1], r[2]+rC[2]};
+        double mddpC[3]={m*ddpC[0], m*ddpC[1], m*ddpC[2]};
+        cross3(r.data(),F.data(),rF);
+        cross3(rrC,mddpC,rmddpC);
+    }
+
+    // out = r x F + (r+rC) x (m*ddpC) + Mu, with the quantities of the next link
+    inline void momentTransport(const Vector &r, OneLinkNewtonEuler *next, double *out)
+    {
+        double rF[3],rmddpC[3];
+        momentArms(r,next->getrC(),next->getForce(),next->getMass(),next->getLinAccC(),rF,rmddpC);
+        const Vector& Mu = next->getMoment(false);
+        for (int k=0; k<3; k++)
+            out[k]=rF[k]+rmddpC[k]+Mu[k];
+    }
+}
+
 
 //================================
 //
@@ -51,6 +99,7 @@ OneLinkNewtonEuler::OneLinkNewtonEuler(iDynLink *dlink)
     link = dlink;
     z0.resize(3); z0.zero(); z0(2)=1;   
     zm.resize(3); zm.zero();
+    ws.resize(3,0.0);
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 OneLinkNewtonEuler::OneLinkNewtonEuler(const NewEulMode _mode, unsigned int verb, iDynLink *dlink)
@@ -61,6 +110,7 @@ OneLinkNewtonEuler::OneLinkNewtonEuler(const NewEulMode _mode, unsigned int verb
     link = dlink;
     z0.resize(3); z0.zero(); z0(2)=1;   
     zm.resize(3); zm.zero();
+    ws.resize(3,0.0);
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void OneLinkNewtonEuler::zero()
@@ -393,9 +443,10 @@ void OneLinkNewtonEuler::computeAngVel(OneLinkNewtonEuler *prev)
     case DYNAMIC:
     case DYNAMIC_W_ROTOR:
         {
-            Vector w = prev->getAngVel();
-            w[2] += getDq();
-            setAngVel(w*getR());
+            const Vector& prevW = prev->getAngVel();
+            double w[3]={prevW[0], prevW[1], prevW[2]+getDq()};
+            mul3T(getR(),w,ws.data());
+            setAngVel(ws);
             //setAngVel( getR().transposed() * ( prev->getAngVel() + getDq() * z0 ));
             break;
         }
@@ -413,9 +464,9 @@ void OneLinkNewtonEuler::computeAngVelBackward(OneLinkNewtonEuler *next)
     case DYNAMIC:
     case DYNAMIC_W_ROTOR:
         {
-            Vector w = next->getR() * next->getAngVel();
-            w[2] -= next->getDq();
-            setAngVel(w);
+            mul3(next->getR(),next->getAngVel().data(),ws.data());
+            ws[2] -= next->getDq();
+            setAngVel(ws);
             //setAngVel( next->getR() * next->getAngVel() - next->getDq() * z0 );
             break;
         }
@@ -432,22 +483,21 @@ void OneLinkNewtonEuler::computeAngAcc(OneLinkNewtonEuler *prev)
     case DYNAMIC:
     case DYNAMIC_W_ROTOR:
         {
-            Vector dw = prev->getAngAcc();
+            const Vector& prevDw = prev->getAngAcc();
             const Vector& prevW = prev->getAngVel();
-            dw[0] += getDq()*prevW[1];
-            dw[1] -= getDq()*prevW[0];
-            dw[2] += getD2q();
-            setAngAcc(dw * getR());
+            double dw[3]={prevDw[0]+getDq()*prevW[1], prevDw[1]-getDq()*prevW[0], prevDw[2]+getD2q()};
+            mul3T(getR(),dw,ws.data());
+            setAngAcc(ws);
             //setAngAcc( (getR()).transposed() * ( prev->getAngAcc() + getD2q()*z0 + getDq() * cross(prev->getAngVel(),z0));
             break;
         }
     case DYNAMIC_CORIOLIS_GRAVITY:
         {
-            Vector dw = prev->getAngAcc();
+            const Vector& prevDw = prev->getAngAcc();
             const Vector& prevW = prev->getAngVel();
-            dw[0] += getDq()*prevW[1];
-            dw[1] -= getDq()*prevW[0];
-            setAngAcc(dw * getR());
+            double dw[3]={prevDw[0]+getDq()*prevW[1], prevDw[1]-getDq()*prevW[0], prevDw[2]};
+            mul3T(getR(),dw,ws.data());
+            setAngAcc(ws);
             //setAngAcc( (getR()).transposed() * ( prev->getAngAcc() + getDq() * cross(prev->getAngVel(),z0) ));
             break;
         }
@@ -464,22 +514,22 @@ void OneLinkNewtonEuler::computeAngAccBackward(OneLinkNewtonEuler *next)
     case DYNAMIC:
     case DYNAMIC_W_ROTOR:
         {
-            Vector nextDw = next->getR() * next->getAngAcc();
+            mul3(next->getR(),next->getAngAcc().data(),ws.data());
             const Vector& w = getAngVel();
-            nextDw[0] -= next->getDq()*w[1];
-            nextDw[1] += next->getDq()*w[0];
-            nextDw[2] -= next->getD2q();
-            setAngAcc(nextDw);
+            ws[0] -= next->getDq()*w[1];
+            ws[1] += next->getDq()*w[0];
+            ws[2] -= next->getD2q();
+            setAngAcc(ws);
             //setAngAcc( next->getR() * next->getAngAcc() - next->getD2q() * z0 - next->getDq() * cross(getAngVel(),z0) );
             break;
         }
     case DYNAMIC_CORIOLIS_GRAVITY:
         {
-            Vector nextDw = next->getR() * next->getAngAcc();
+            mul3(next->getR(),next->getAngAcc().data(),ws.data());
             const Vector& w = getAngVel();
-            nextDw[0] -= next->getDq()*w[1];
-            nextDw[1] += next->getDq()*w[0];
-            setAngAcc(nextDw);
+            ws[0] -= next->getDq()*w[1];
+            ws[1] += next->getDq()*w[0];
+            setAngAcc(ws);
             //setAngAcc( next->getR() * next->getAngAcc() - next->getDq() * cross(getAngVel(),z0) );
             break;
         }
@@ -499,10 +549,14 @@ void OneLinkNewtonEuler::computeLinAcc(OneLinkNewtonEuler *prev)
     case DYNAMIC_W_ROTOR:
         {
             const Vector& r = getr(true);
-            Vector temp = prev->getLinAcc()*R;
-            temp += cross(link->dw, r);
-            temp += cross(link->w, cross(link->w, r));
-            setLinAcc(temp);
+            double dwxr[3],wxr[3],wxwxr[3];
+            cross3(link->dw.data(),r.data(),dwxr);
+            cross3(link->w.data(),r.data(),wxr);
+            cross3(link->w.data(),wxr,wxwxr);
+            mul3T(R,prev->getLinAcc().data(),ws.data());
+            for (int k=0; k<3; k++)
+                ws[k]=ws[k]+dwxr[k]+wxwxr[k];
+            setLinAcc(ws);
             /*setLinAcc( prev->getLinAcc()*R
                 + cross(getAngAcc(), r)
                 + cross(getAngVel(), cross(getAngVel(), r)) );*/
@@ -524,10 +578,16 @@ void OneLinkNewtonEuler::computeLinAccBackward(OneLinkNewtonEuler *next)
     case DYNAMIC_W_ROTOR:
         {
             const Vector& r = next->getr(true);
-            Vector temp = next->getLinAcc();
-            temp -= cross(next->getAngAcc(), r);
-            temp -= cross(next->getAngVel(), cross(next->getAngVel(), r));
-            setLinAcc(R*temp);
+            const Vector& nextDdp = next->getLinAcc();
+            const Vector& nextW = next->getAngVel();
+            double dwxr[3],wxr[3],wxwxr[3],temp[3];
+            cross3(next->getAngAcc().data(),r.data(),dwxr);
+            cross3(nextW.data(),r.data(),wxr);
+            cross3(nextW.data(),wxr,wxwxr);
+            for (int k=0; k<3; k++)
+                temp[k]=nextDdp[k]-dwxr[k]-wxwxr[k];
+            mul3(R,temp,ws.data());
+            setLinAcc(ws);
             /*setLinAcc(R * (next->getLinAcc() 
                 - cross(next->getAngAcc(), r) 
                 - cross(next->getAngVel(), cross(next->getAngVel(), r)) ));*/
@@ -547,10 +607,16 @@ void OneLinkNewtonEuler::computeLinAccC()
     case DYNAMIC_CORIOLIS_GRAVITY:
     case DYNAMIC_W_ROTOR:
         {
-            Vector temp = getLinAcc();
-            temp += cross(getAngAcc(),getrC());
-            temp += cross(getAngVel(),cross(getAngVel(),getrC()));
-            setLinAccC(temp);
+            const Vector& ddp = getLinAcc();
+            const Vector& w = getAngVel();
+            const Vector& rC = getrC();
+            double dwxr[3],wxr[3],wxwxr[3];
+            cross3(getAngAcc().data(),rC.data(),dwxr);
+            cross3(w.data(),rC.data(),wxr);
+            cross3(w.data(),wxr,wxwxr);
+            for (int k=0; k<3; k++)
+                ws[k]=ddp[k]+dwxr[k]+wxwxr[k];
+            setLinAccC(ws);
             //setLinAccC( getLinAcc() + cross(getAngAcc(),getrC()) + cross(getAngVel(),cross(getAngVel(),getrC())));
             break;
         }
@@ -580,16 +646,22 @@ void OneLinkNewtonEuler::computeAngAccM(OneLinkNewtonEuler *prev)
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void OneLinkNewtonEuler::computeForceBackward(OneLinkNewtonEuler *next)
 {
-    Vector temp = next->getMass() * next->getLinAccC();
-    temp += next->getForce();
-    setForce(next->getR() * temp);
+    const double m = next->getMass();
+    const Vector& ddpC = next->getLinAccC();
+    const Vector& F = next->getForce();
+    double temp[3]={m*ddpC[0]+F[0], m*ddpC[1]+F[1], m*ddpC[2]+F[2]};
+    mul3(next->getR(),temp,ws.data());
+    setForce(ws);
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void OneLinkNewtonEuler::computeForceForward(OneLinkNewtonEuler *prev)
 {
-    Vector temp = prev->getForce()*getR();
-    temp -= getMass() * getLinAccC();
-    setForce(temp);
+    const double m = getMass();
+    const Vector& ddpC = getLinAccC();
+    mul3T(getR(),prev->getForce().data(),ws.data());
+    for (int k=0; k<3; k++)
+        ws[k] -= m*ddpC[k];
+    setForce(ws);
     //setForce( prev->getForce()*getR() - getMass() * getLinAccC() );
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -602,12 +674,17 @@ void OneLinkNewtonEuler::computeMomentBackward(OneLinkNewtonEuler *next)
     case DYNAMIC_CORIOLIS_GRAVITY:
     case DYNAMIC:
         {
-            Vector temp = cross(rnp , next->getForce());
-            temp += cross(rnp + next->getrC() , next->getMass() * next->getLinAccC());
-            temp += next->getMoment(false);
-            temp += next->getInertia() * next->getAngAcc();
-            temp += cross( next->getAngVel() , next->getInertia() * next->getAngVel());
-            setMoment(Rn*temp);
+            const Vector& nextW = next->getAngVel();
+            const Matrix& I = next->getInertia();
+            double temp[3],Idw[3],Iw[3],wxIw[3];
+            momentTransport(rnp,next,temp);
+            mul3(I,next->getAngAcc().data(),Idw);
+            mul3(I,nextW.data(),Iw);
+            cross3(nextW.data(),Iw,wxIw);
+            for (int k=0; k<3; k++)
+                temp[k]=temp[k]+Idw[k]+wxIw[k];
+            mul3(Rn,temp,ws.data());
+            setMoment(ws);
             /*setMoment( Rn * ( cross(rnp , next->getForce()) 
                             + cross(rnp + next->getrC() , next->getMass() * next->getLinAccC())
                             + next->getMoment(false)
@@ -627,10 +704,10 @@ void OneLinkNewtonEuler::computeMomentBackward(OneLinkNewtonEuler *next)
         break;
     case STATIC:
         {
-            Vector temp = cross(rnp , next->getForce());
-            temp += cross(rnp + next->getrC() , next->getMass() * next->getLinAccC());
-            temp += next->getMoment(false);
-            setMoment(Rn*temp);
+            double temp[3];
+            momentTransport(rnp,next,temp);
+            mul3(Rn,temp,ws.data());
+            setMoment(ws);
             /*setMoment( Rn * ( cross(rnp , next->getForce()) 
                         + cross(rnp + next->getrC() , next->getMass() * next->getLinAccC())
                         + next->getMoment(false)));*/
@@ -648,12 +725,15 @@ void OneLinkNewtonEuler::computeMomentForward( OneLinkNewtonEuler *prev)
     case DYNAMIC_CORIOLIS_GRAVITY:
     case DYNAMIC:
         {
-            Vector temp = prev->getMoment(false)*R;
-            temp -= cross(RTr, link->F);
-            temp -= cross(RTr + link->rc, link->m * link->ddpC);
-            temp -= link->I * link->dw;
-            temp -= cross( link->w, link->I * link->w);
-            setMoment(temp);
+            double rF[3],rmddpC[3],Idw[3],Iw[3],wxIw[3];
+            momentArms(RTr,link->rc,link->F,link->m,link->ddpC,rF,rmddpC);
+            mul3(link->I,link->dw.data(),Idw);
+            mul3(link->I,link->w.data(),Iw);
+            cross3(link->w.data(),Iw,wxIw);
+            mul3T(R,prev->getMoment(false).data(),ws.data());
+            for (int k=0; k<3; k++)
+                ws[k]=ws[k]-rF[k]-rmddpC[k]-Idw[k]-wxIw[k];
+            setMoment(ws);
             /*setMoment( prev->getMoment(false)*R- cross(RTr, getForce())
                 - cross(RTr + getrC(), getMass() * getLinAccC())
                 - getInertia() * getAngAcc()
@@ -684,10 +764,12 @@ void OneLinkNewtonEuler::computeMomentForward( OneLinkNewtonEuler *prev)
         }
     case STATIC:
         {
-            Vector temp = prev->getMoment(false)*R;
-            temp -= cross(RTr, getForce());
-            temp -= cross(RTr + getrC(), getMass() * getLinAccC());
-            setMoment(temp);
+            double rF[3],rmddpC[3];
+            momentArms(RTr,getrC(),getForce(),getMass(),getLinAccC(),rF,rmddpC);
+            mul3T(R,prev->getMoment(false).data(),ws.data());
+            for (int k=0; k<3; k++)
+                ws[k]=ws[k]-rF[k]-rmddpC[k];
+            setMoment(ws);
             /*setMoment( prev->getMoment(false)*R - cross(RTr, getForce())
                 - cross(RTr + getrC(), getMass() * getLinAccC()));*/
             break;
@@ -55,6 +55,7 @@
 
 #include <string>
 #include <deque>
+#include <vector>
 
 #include <yarp/os/Property.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
@@ -73,6 +74,160 @@ namespace iKin
 
 void notImplemented(const unsigned int verbose);
 
+
+/**
+* \ingroup iKinFwd
+*
+* A compact rigid roto-translation (element of SE(3)) stored as a 
+* 3x3 rotation matrix plus a 3x1 translation vector. 
+*  
+* \note It is meant to be used with the allocation-free 
+*       kinematics routines (e.g. iKinChain::getH(iKinSE3&)),
+*       where it replaces the 4x4 homogeneous yarp::sig::Matrix
+*       without requiring any heap allocation.
+*/
+struct iKinSE3
+{
+    double R[3][3];
+    double p[3];
+
+    /**
+    * Sets the transformation to the identity.
+    */
+    void eye();
+
+    /**
+    * Fills the transformation from a 4x4 homogeneous matrix.
+    * @param H is the 4x4 homogeneous matrix.
+    */
+    void fromMatrix(const yarp::sig::Matrix &H);
+
+    /**
+    * Copies the transformation into a 4x4 homogeneous matrix.
+    * @param H is the output matrix (resized only if not 4x4).
+    */
+    void toMatrix(yarp::sig::Matrix &H) const;
+
+    /**
+    * Computes the composition res=A*B. 
+    * @param A is the first transformation. 
+    * @param B is the second transformation.
+    * @param res is the result (it can be aliased with A or B).
+    */
+    static void compose(const iKinSE3 &A, const iKinSE3 &B, iKinSE3 &res);
+
+    /**
+    * Converts the transformation into a pose vector without 
+    * allocating memory. 
+    * @param pose is the output vector: 7x1 in axis/angle notation 
+    *             or 6x1 with XYZ Euler angles (resized only if its
+    *             length does not match).
+    * @param axisRep if true returns the axis/angle notation.
+    */
+    void toPose(yarp::sig::Vector &pose, const bool axisRep=true) const;
+};
+
+
+/**
+* \ingroup iKinFwd
+*
+* Results of the batched forward kinematics computed by 
+* iKinChain::BatchKinematics() over a set of joints 
+* configurations. 
+*  
+* \note Data are stored in structure-of-arrays layout: each 
+*       component (e.g. the x coordinate of the end-effector) is
+*       kept in a contiguous array indexed by the configuration,
+*       so that the kernels can be vectorized across
+*       configurations.
+*/
+class iKinFwdBatch
+{
+protected:
+    unsigned int        n;
+    unsigned int        dof;
+    bool                jac;
+    std::vector<double> data;
+
+    friend class iKinChain;
+
+    void resize(const unsigned int _n, const unsigned int _dof, const bool _jac);
+
+public:
+    /**
+    * Default constructor. 
+    */
+    iKinFwdBatch() : n(0), dof(0), jac(false) { }
+
+    /**
+    * Returns the number of configurations. 
+    * @return the number of configurations. 
+    */
+    unsigned int size() const { return n; }
+
+    /**
+    * Returns the number of DOF of the chain. 
+    * @return the number of DOF. 
+    */
+    unsigned int getDOF() const { return dof; }
+
+    /**
+    * Tells whether the Jacobians have been computed. 
+    * @return true iff the Jacobians are available. 
+    */
+    bool hasJacobians() const { return jac; }
+
+    /**
+    * Returns the contiguous array of a rotation matrix element of 
+    * the end-effector frame over all configurations. 
+    * @param r is the row index in [0,2]. 
+    * @param c is the column index in [0,2]. 
+    * @return pointer to the array of size() elements.
+    */
+    const double *R(const unsigned int r, const unsigned int c) const { return &data[(3*r+c)*n]; }
+
+    /**
+    * Returns the contiguous array of a position component of the 
+    * end-effector frame over all configurations. 
+    * @param r is the component index in [0,2]. 
+    * @return pointer to the array of size() elements.
+    */
+    const double *p(const unsigned int r) const { return &data[(9+r)*n]; }
+
+    /**
+    * Returns the contiguous array of an element of the geometric 
+    * Jacobian over all configurations. 
+    * @param r is the row index in [0,5]. 
+    * @param c is the column index in [0,DOF-1]. 
+    * @return pointer to the array of size() elements.
+    */
+    const double *J(const unsigned int r, const unsigned int c) const { return &data[(12+6*c+r)*n]; }
+
+    /**
+    * Retrieves the end-effector frame of the ith configuration. 
+    * @param i is the configuration index. 
+    * @param H is the output transformation. 
+    */
+    void getH(const unsigned int i, iKinSE3 &H) const;
+
+    /**
+    * Retrieves the end-effector pose of the ith configuration. 
+    * @param i is the configuration index. 
+    * @param pose is the output pose. 
+    * @param axisRep if true returns the axis/angle notation. 
+    * @see iKinSE3::toPose 
+    */
+    void getPose(const unsigned int i, yarp::sig::Vector &pose, const bool axisRep=true) const;
+
+    /**
+    * Retrieves the geometric Jacobian of the ith configuration. 
+    * @param i is the configuration index. 
+    * @param J is the output 6xDOF matrix. 
+    * @return true iff the Jacobians are available. 
+    */
+    bool getJacobian(const unsigned int i, yarp::sig::Matrix &J) const;
+};
+
 /**
 * \ingroup iKinFwd
 *
@@ -106,6 +261,11 @@ protected:
     const yarp::sig::Matrix zeros1x1;
     const yarp::sig::Vector zeros1;
 
+    // cache of the trigonometric functions of the joint angle
+    double theta_c;
+    double c_theta;
+    double s_theta;
+
     friend class iKinChain;
 
     // Default constructor: not implemented.
@@ -118,6 +278,7 @@ protected:
     void         release()          { blocked=false;              }
     void         rmCumH()           { cumulative=false;           }
     void         addCumH(const yarp::sig::Matrix &_cumH);
+    void         updateTrig();
 
 public:
     /**
@@ -284,6 +445,15 @@ public:
     */
     yarp::sig::Matrix getH(double _Ang, bool c_override=false);
 
+    /**
+    * Same as getH() but writing the result into caller-owned 
+    * storage without allocating memory. 
+    * @param H is the output transformation. 
+    * @param c_override. 
+    * @see getH
+    */
+    void getH(iKinSE3 &H, bool c_override=false);
+
     /**
     * Computes the derivative of order n of the homogeneous 
     * transformation matrix H with respect to the joint angle. 
@@ -370,10 +540,15 @@ protected:
     yarp::sig::Matrix hess_J;
     yarp::sig::Matrix hess_Jlnk;
 
+    std::vector<iKinSE3> fwdH;
+
     virtual void clone(const iKinChain &c);
     virtual void build();
     virtual void dispose();
 
+    void batchWorker(const yarp::sig::Matrix &Q, iKinFwdBatch &res,
+                     const unsigned int i0, const unsigned int i1);
+
     yarp::sig::Vector RotAng(const yarp::sig::Matrix &R);
     yarp::sig::Vector dRotAng(const yarp::sig::Matrix &R, const yarp::sig::Matrix &dR);
     yarp::sig::Vector d2RotAng(const yarp::sig::Matrix &R, const yarp::sig::Matrix &dRi,
@@ -645,6 +820,14 @@ public:
     */
     yarp::sig::Matrix getH(const yarp::sig::Vector &q);
 
+    /**
+    * Computes the rigid roto-translation from the root reference 
+    * frame to the end-effector frame (HN is taken into account) 
+    * without allocating memory. 
+    * @param H is the output transformation H(N-1)*HN.
+    */
+    void getH(iKinSE3 &H);
+
     /**
     * Returns the coordinates of ith Link. Two notations are
     * provided: the first with Euler Angles (XYZ form=>6x1 output 
@@ -751,6 +934,36 @@ public:
     */
     yarp::sig::Matrix GeoJacobian(const yarp::sig::Vector &q);
 
+    /**
+    * Computes the geometric Jacobian of the end-effector writing 
+    * the result into caller-owned storage. 
+    * @param J is the output 6xDOF matrix; no memory is allocated 
+    *          as long as J is already sized 6xDOF.
+    * @note The blocked links are not considered. 
+    */
+    void GeoJacobian(yarp::sig::Matrix &J);
+
+    /**
+    * Computes the end-effector frame and (optionally) the 
+    * geometric Jacobian for a set of joints configurations at 
+    * once, without affecting the current state of the chain. 
+    * @param Q is the NxDOF matrix whose rows are the 
+    *          configurations (joints constraints are evaluated).
+    * @param res is the output in structure-of-arrays layout.
+    * @param jacobian if true computes the Jacobians as well. 
+    * @param threads is the number of worker threads used to split 
+    *                the configurations (0 to use all the available
+    *                cores).
+    * @return true iff successful (e.g. Q has DOF columns). 
+    * @note The kernels are vectorized across configurations with 
+    *       AVX2 when the CPU supports it, which is detected at run
+    *       time on x86 with GCC and clang (builds with -mavx2 use
+    *       AVX2 unconditionally), falling back to the scalar code
+    *       otherwise.
+    */
+    bool BatchKinematics(const yarp::sig::Matrix &Q, iKinFwdBatch &res,
+                         const bool jacobian=true, unsigned int threads=1);
+
     /**
     * Returns the 6x1 vector \f$ 
     * \partial{^2}F\left(q\right)/\partial q_i \partial q_j, \f$
@@ -771,6 +984,15 @@ public:
     */
     void prepareForHessian();
 
+    /**
+    * Prepares computation for a successive call to 
+    * fastHessian_ij() relying on the geometric Jacobian already 
+    * computed by the caller at the current configuration. 
+    * @param J is the 6xDOF geometric Jacobian of the end-effector.
+    * @see fastHessian_ij
+    */
+    void prepareForHessian(const yarp::sig::Matrix &J);
+
     /**
     * Returns the 6x1 vector \f$ 
     * \partial{^2}F\left(q\right)/\partial q_i \partial q_j, \f$
@@ -789,6 +1011,18 @@ public:
     */
     yarp::sig::Vector fastHessian_ij(const unsigned int i, const unsigned int j);
 
+    /**
+    * Same as fastHessian_ij() but writing the result into 
+    * caller-owned storage. 
+    * @param i is the index of the first DOF. 
+    * @param j is the index of the second DOF.
+    * @param h is the output 6x1 vector (resized only if its length 
+    *          is not 6).
+    * @see prepareForHessian
+    */
+    void fastHessian_ij(const unsigned int i, const unsigned int j,
+                        yarp::sig::Vector &h);
+
     /**
     * Returns the 6x1 vector \f$ 
     * \partial{^2}F\left(q\right)/\partial q_i \partial q_j, \f$
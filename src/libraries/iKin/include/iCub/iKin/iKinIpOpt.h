@@ -411,6 +411,14 @@ public:
     */
     void setBoundsInf(const double lower, const double upper);
 
+    /**
+    * Returns the linear solver used by IpOpt, as configured through
+    * the options (e.g. the ipopt.opt file) or the default of the
+    * IpOpt build.
+    * @return the name of the linear solver (e.g. "mumps", "ma27").
+    */
+    std::string getLinearSolver();
+
     /**
     * Executes the IpOpt algorithm trying to converge on target. 
     * @param q0 is the vector of initial joint angles values. 
@@ -485,6 +493,84 @@ public:
     virtual ~iKinIpOptMin();
 };
 
+
+/**
+* \ingroup iKinIpOpt
+*
+* Class for inverting chain's kinematics by damped least squares, 
+* with the same interface of iKinIpOptMin. 
+*  
+* Each iteration computes the Gauss-Newton step of the tasks 
+* minimized by iKinIpOptMin, damped in a Levenberg-Marquardt 
+* fashion, as the solution of a small QP subject to the joints 
+* bounds and to the attached linear inequality constraints, which 
+* is found by an active-set method. The constraint of the 
+* nonlinear problem (the position with the default pose priority) 
+* is enforced as a heavily weighted task. 
+*  
+* It is meant for targets close to the starting configuration 
+* (e.g. in tracking mode), where it converges in few iterations 
+* without the set-up cost of IpOpt; the IpOpt options (tolerances 
+* and maximum iterations) are used as convergence criteria, 
+* whereas those specific to IpOpt (e.g. scaling, Hessian) are 
+* ignored. 
+*/
+class iKinDLSMin : public iKinIpOptMin
+{
+protected:
+    yarp::sig::Matrix J;
+    yarp::sig::Matrix J2;
+    yarp::sig::Matrix Hqp;
+    yarp::sig::Matrix A;
+    yarp::sig::Vector b;
+    yarp::sig::Vector g;
+    yarp::sig::Vector dq;
+
+    bool solveQP(const yarp::sig::Matrix &H, const yarp::sig::Vector &g,
+                 const yarp::sig::Matrix &A, const yarp::sig::Vector &b,
+                 yarp::sig::Vector &x);
+
+public:
+    /**
+    * Constructor. 
+    * @param c is the Chain object on which the control operates. Do 
+    *          not change Chain DOF from this point onwards!!
+    * @param _ctrlPose one of the following: 
+    *  IKINCTRL_POSE_FULL => complete pose control.
+    *  IKINCTRL_POSE_XYZ  => translational part of pose controlled.
+    *  IKINCTRL_POSE_ANG  => rotational part of pose controlled. 
+    * @param tol        tolerance on the joints step at convergence 
+    *                   [rad].
+    * @param constr_tol tolerance on the squared norm of the 
+    *                   constraint error.
+    * @param max_iter   exits if iter>=max_iter (max_iter<0 disables
+    *                   this check, IKINCTRL_DISABLED(==-1) by
+    *                   default).
+    */
+    iKinDLSMin(iKinChain &c, const unsigned int _ctrlPose,
+               const double tol, const double constr_tol,
+               const int max_iter=IKINCTRL_DISABLED);
+
+    using iKinIpOptMin::solve;
+
+    /**
+    * Executes the damped least squares iterations trying to 
+    * converge on target. 
+    * @see iKinIpOptMin::solve 
+    * @note The exit code is one of the IpOpt application return 
+    *       status, as for iKinIpOptMin: Solve_Succeeded,
+    *       Solved_To_Acceptable_Level (the constraint is met but
+    *       the tasks cannot be improved any further),
+    *       Maximum_Iterations_Exceeded, User_Requested_Stop and
+    *       Search_Direction_Becomes_Too_Small (the constraint is
+    *       not met).
+    */
+    virtual yarp::sig::Vector solve(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
+                                    double weight2ndTask, yarp::sig::Vector &xd_2nd, yarp::sig::Vector &w_2nd,
+                                    double weight3rdTask, yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
+                                    int *exit_code=NULL, bool *exhalt=NULL, iKinIterateCallback *iterate=NULL);
+};
+
 }
 
 }
@@ -237,10 +237,15 @@ given rest
 #ifndef __IKINSLV_H__
 #define __IKINSLV_H__
 
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <thread>
+#include <random>
 #include <string>
 #include <deque>
+#include <vector>
+#include <utility>
 
 #include <yarp/os/BufferedPort.h>
 #include <yarp/os/PeriodicThread.h>
@@ -310,6 +315,7 @@ public:
     bool handleDOF(yarp::os::Bottle *b);
     bool handlePose(const int newPose);
     bool handleMode(const int newMode);    
+    void handleRequest(yarp::os::Bottle &b);
 };
 
 
@@ -336,6 +342,120 @@ struct PartDescriptor
 };
 
 
+/**
+* \ingroup iKinSlv
+*
+* Cache of the joints configurations found for past targets, used 
+* to warm-start the solver. The targets are indexed by a k-d tree 
+* over their position and their orientation (as rotation vector, 
+* scaled by 0.1 m/rad); when the capacity is reached the oldest 
+* half of the entries is dropped and the tree is rebuilt balanced.
+*/
+class SolutionCache
+{
+protected:
+    struct Entry
+    {
+        double            key[6];
+        yarp::sig::Vector q;
+        int               left;
+        int               right;
+    };
+
+    std::vector<Entry> entries;
+    size_t             capacity;
+    int                root;
+
+    static void makeKey(const yarp::sig::Vector &xd, double *key);
+    int  build(std::vector<int> &idx, const int lo, const int hi, const unsigned int depth);
+    void search(const int node, const unsigned int depth, const double *key,
+                const unsigned int dims, const size_t k,
+                std::vector<std::pair<double,int> > &nearest) const;
+
+public:
+    /**
+    * Constructor. 
+    * @param _capacity the maximum number of cached solutions (0 
+    *                  disables the cache).
+    */
+    SolutionCache(const size_t _capacity=0);
+
+    /**
+    * Changes the maximum number of cached solutions, clearing the 
+    * cache. 
+    * @param _capacity the new capacity (0 disables the cache).
+    */
+    void setCapacity(const size_t _capacity);
+
+    /**
+    * Returns the maximum number of cached solutions.
+    * @return the capacity.
+    */
+    size_t getCapacity() const { return capacity; }
+
+    /**
+    * Returns the number of cached solutions.
+    * @return the number of entries.
+    */
+    size_t size() const { return entries.size(); }
+
+    /**
+    * Removes all the cached solutions.
+    */
+    void clear();
+
+    /**
+    * Stores a solution.
+    * @param xd the target pose (3 or 7 components).
+    * @param q the joints configuration attaining xd.
+    */
+    void add(const yarp::sig::Vector &xd, const yarp::sig::Vector &q);
+
+    /**
+    * Retrieves the solutions of the k past targets nearest to xd.
+    * @param xd the target pose.
+    * @param full if false only the positions of the targets are 
+    *             compared.
+    * @param k the number of solutions to retrieve.
+    * @param q is filled with the solutions, nearest first.
+    * @param dist is filled with the distances of their targets.
+    * @return the number of solutions retrieved.
+    */
+    size_t lookup(const yarp::sig::Vector &xd, const bool full, const size_t k,
+                  std::deque<yarp::sig::Vector> &q, std::deque<double> &dist) const;
+
+    /**
+    * Returns the distance between two targets as measured by the 
+    * cache. 
+    * @param xd1 the first target pose.
+    * @param xd2 the second target pose.
+    * @param full if false only the positions are compared.
+    * @return the distance.
+    */
+    static double distance(const yarp::sig::Vector &xd1, const yarp::sig::Vector &xd2,
+                           const bool full);
+};
+
+
+struct SolverWorker
+{
+    iKinLimb          *lmb;
+    iKinLinIneqConstr  cns;
+    iKinIpOptMin      *slv;
+    std::thread        thr;
+    yarp::sig::Vector  q0;
+    yarp::sig::Vector  q;
+    yarp::sig::Vector  xd;
+    yarp::sig::Vector  xd_2nd;
+    yarp::sig::Vector  w_2nd;
+    yarp::sig::Vector  qd_3rd;
+    yarp::sig::Vector  w_3rd;
+    double             weight2ndTask;
+    double             err;
+    std::atomic<bool>  halt;    // request to stop, written by the caller
+};
+
+
 /**
 * \ingroup iKinSlv
 *
@@ -398,8 +518,29 @@ protected:
     std::mutex mtx_dofEvent;
     std::condition_variable cv_dofEvent;
 
+    SolutionCache              cache;
+    std::deque<SolverWorker*>  workers;
+    std::mutex                 mtx_workers;
+    std::condition_variable    cv_workersStart;
+    std::condition_variable    cv_workersDone;
+    unsigned int               workersJob;
+    int                        workersBusy;
+    bool                       workersQuit;
+    double                     multiStartTmo;
+    std::mt19937               seedGen;
+    std::string                backend;
+
+    std::deque<yarp::os::Bottle> localIn;
+    yarp::os::Bottle             localOut;
+    bool                         localOutNew;
+    std::thread                  localThr;
+    std::mutex                   mtx_local;
+    std::condition_variable      cv_local;
+    bool                         localQuit;
+
     virtual PartDescriptor *getPartDesc(yarp::os::Searchable &options)=0;
     virtual yarp::sig::Vector solve(yarp::sig::Vector &xd);
+    virtual yarp::sig::Vector solveMultiStart(yarp::sig::Vector &xd);
 
     virtual yarp::sig::Vector &encodeDOF();
     virtual bool decodeDOF(const yarp::sig::Vector &_dof);
@@ -410,6 +551,13 @@ protected:
                                          yarp::os::Bottle *reply=NULL);
 
     yarp::dev::PolyDriver *waitPart(const yarp::os::Property &partOpt);
+
+    void startWorkers(const int n, const double tol, const double constr_tol, const int maxIter);
+    void stopWorkers();
+    void syncWorker(SolverWorker *w);
+    void runWorker(SolverWorker *w);
+    static double evalSolution(const yarp::sig::Vector &xd, const yarp::sig::Vector &x, const bool full);
+    void runLocalLink();
     
     bool isNewDOF(const yarp::sig::Vector &_dof);
     bool changeDOF(const yarp::sig::Vector &_dof);
@@ -526,6 +674,37 @@ public:
     *    ports are pinged prior to connecting; a timeout equal to
     *    zero disables this option.
     *  
+    * \b warmStartCache <int>: example (warmStartCache 1000),
+    *    specifies how many past targets are cached along with
+    *    their solutions to warm-start the solver from the one of
+    *    the nearest target (0 by default, i.e. disabled). The
+    *    cache is cleared whenever the dof change.
+    *  
+    * \b multiStart <int>: example (multiStart 4), specifies how
+    *    many solver instances are run in parallel on a pool of
+    *    threads for each target, starting from the current
+    *    configuration, from the cached solutions of the nearest
+    *    targets and from random configurations within the bounds;
+    *    the solution attaining the target best is retained (1 by
+    *    default, i.e. a single instance run from the current
+    *    configuration or the nearest cached solution). The
+    *    intermediate points are not streamed when multiStart>1.
+    *    With the ipopt backend, the parallel instances require a
+    *    thread-safe linear solver (ma27, ma57, ma77, ma86, ma97,
+    *    pardisomkl or spral, e.g. selected in the ipopt.opt file);
+    *    otherwise, as with MUMPS, multiStart is clamped to 1.
+    *  
+    * \b multiStartTmo <double>: example (multiStartTmo 0.05),
+    *    specifies the deadline in seconds for the parallel solver
+    *    instances, after which those still running are halted and
+    *    return their current estimation.
+    *  
+    * \b backend <string>: example (backend dls), selects the
+    *    optimizer between [ipopt], the interior-point solver used
+    *    by default, and [dls], the bounded damped least-squares
+    *    iKinDLSMin, which suits the tracking of targets moving
+    *    little from one request to the next.
+    *  
     * @return true/false if successful/failed
     */
     virtual bool open(yarp::os::Searchable &options);
@@ -558,6 +737,37 @@ public:
     */
     virtual bool &getTimeoutFlag() { return timeout_detected; }
 
+    /**
+    * Deliver a request to the solver from within the same process, 
+    * as if it were received on the /<_slvName>/in port, and wake up
+    * the solver to process it without waiting for its next period.
+    * @param request contains the request.
+    * @return true/false on success/failure (i.e. not configured). 
+    *  
+    * @note Together with readLocal() and rpcLocal() it allows an 
+    *       owner living in the same process (e.g. the Cartesian
+    *       controller) to skip the ports.
+    */
+    virtual bool postLocal(const yarp::os::Bottle &request);
+
+    /**
+    * Retrieve from within the same process the latest result 
+    * streamed out on the /<_slvName>/out port, if not yet 
+    * retrieved. 
+    * @param result is filled with the result.
+    * @return true iff a new result has been retrieved.
+    */
+    virtual bool readLocal(yarp::os::Bottle &result);
+
+    /**
+    * Send a command to the solver from within the same process and 
+    * wait for the reply, as through the /<_slvName>/rpc port. 
+    * @param command contains the command.
+    * @param reply is filled with the reply.
+    * @return true/false on success/failure (i.e. closed).
+    */
+    virtual bool rpcLocal(const yarp::os::Bottle &command, yarp::os::Bottle &reply);
+
     /**
     * Suspend the solver's main loop.
     */
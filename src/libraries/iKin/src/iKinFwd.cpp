@@ -13,6 +13,24 @@
 #include <sstream>
 #include <cmath>
 #include <algorithm>
+#include <limits>
+#include <thread>
+
+// the AVX2 kernel of BatchKinematics() is built in any case on x86 with GCC
+// and clang, and it is selected at run time if the CPU supports it; a build
+// with -mavx2 calls it directly
+#if defined(__AVX2__)
+    #define IKINFWD_AVX2
+    #define IKINFWD_AVX2_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define IKINFWD_AVX2
+    #define IKINFWD_AVX2_DISPATCH
+    #define IKINFWD_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#if defined(IKINFWD_AVX2)
+    #include <immintrin.h>
+#endif
 
 #include <yarp/os/Log.h>
 
@@ -35,6 +53,304 @@ void iCub::iKin::notImplemented(const unsigned int verbose)
 }
 
 
+/************************************************************************/
+void iKinSE3::eye()
+{
+    R[0][0]=1.0; R[0][1]=0.0; R[0][2]=0.0; p[0]=0.0;
+    R[1][0]=0.0; R[1][1]=1.0; R[1][2]=0.0; p[1]=0.0;
+    R[2][0]=0.0; R[2][1]=0.0; R[2][2]=1.0; p[2]=0.0;
+}
+
+
+/************************************************************************/
+void iKinSE3::fromMatrix(const Matrix &H)
+{
+    yAssert((H.rows()>=3) && (H.cols()>=4));
+
+    for (int r=0; r<3; r++)
+    {
+        R[r][0]=H(r,0);
+        R[r][1]=H(r,1);
+        R[r][2]=H(r,2);
+        p[r]   =H(r,3);
+    }
+}
+
+
+/************************************************************************/
+void iKinSE3::toMatrix(Matrix &H) const
+{
+    if ((H.rows()!=4) || (H.cols()!=4))
+        H.resize(4,4);
+
+    for (int r=0; r<3; r++)
+    {
+        H(r,0)=R[r][0];
+        H(r,1)=R[r][1];
+        H(r,2)=R[r][2];
+        H(r,3)=p[r];
+    }
+
+    H(3,0)=H(3,1)=H(3,2)=0.0;
+    H(3,3)=1.0;
+}
+
+
+/************************************************************************/
+void iKinSE3::compose(const iKinSE3 &A, const iKinSE3 &B, iKinSE3 &res)
+{
+    // compute on the stack first to allow for aliasing
+    iKinSE3 C;
+    for (int r=0; r<3; r++)
+    {
+        for (int c=0; c<3; c++)
+            C.R[r][c]=A.R[r][0]*B.R[0][c]+A.R[r][1]*B.R[1][c]+A.R[r][2]*B.R[2][c];
+
+        C.p[r]=A.R[r][0]*B.p[0]+A.R[r][1]*B.p[1]+A.R[r][2]*B.p[2]+A.p[r];
+    }
+
+    res=C;
+}
+
+
+/************************************************************************/
+void iKinSE3::toPose(Vector &pose, const bool axisRep) const
+{
+    size_t len=axisRep ? 7 : 6;
+    if (pose.length()!=len)
+        pose.resize(len);
+
+    pose[0]=p[0];
+    pose[1]=p[1];
+    pose[2]=p[2];
+
+    if (axisRep)
+    {
+        // same as dcm2axis() but without temporaries
+        double x=R[2][1]-R[1][2];
+        double y=R[0][2]-R[2][0];
+        double z=R[1][0]-R[0][1];
+        double r=sqrt(x*x+y*y+z*z);
+        double theta=atan2(0.5*r,0.5*(R[0][0]+R[1][1]+R[2][2]-1.0));
+
+        if (r<1e-9)
+        {
+            // R is symmetric: theta is either 0 or pi;
+            // in the latter case R+I=2*a*a', hence the axis
+            // can be recovered from the column of R+I with
+            // the largest diagonal element
+            if (theta<0.5*M_PI)
+            {
+                x=y=0.0;
+                z=1.0;
+            }
+            else
+            {
+                int k=0;
+                if (R[1][1]>R[k][k]) k=1;
+                if (R[2][2]>R[k][k]) k=2;
+
+                x=R[0][k]; y=R[1][k]; z=R[2][k];
+                if (k==0) x+=1.0;
+                else if (k==1) y+=1.0;
+                else z+=1.0;
+
+                double n=sqrt(x*x+y*y+z*z);
+                x/=n; y/=n; z/=n;
+            }
+        }
+        else
+        {
+            x/=r; y/=r; z/=r;
+        }
+
+        pose[3]=x;
+        pose[4]=y;
+        pose[5]=z;
+        pose[6]=theta;
+    }
+    else
+    {
+        // Euler Angles as XYZ (see iKinChain::RotAng())
+        pose[3]=atan2(-R[2][1],R[2][2]);
+        pose[4]=asin(R[2][0]);
+        pose[5]=atan2(-R[1][0],R[0][0]);
+    }
+}
+
+
+/************************************************************************/
+void iKinFwdBatch::resize(const unsigned int _n, const unsigned int _dof,
+                          const bool _jac)
+{
+    n=_n;
+    dof=_dof;
+    jac=_jac;
+    data.resize((12+(jac?6*dof:0))*n);
+}
+
+
+/************************************************************************/
+void iKinFwdBatch::getH(const unsigned int i, iKinSE3 &H) const
+{
+    yAssert(i<n);
+
+    for (unsigned int r=0; r<3; r++)
+    {
+        for (unsigned int c=0; c<3; c++)
+            H.R[r][c]=R(r,c)[i];
+
+        H.p[r]=p(r)[i];
+    }
+}
+
+
+/************************************************************************/
+void iKinFwdBatch::getPose(const unsigned int i, Vector &pose,
+                           const bool axisRep) const
+{
+    iKinSE3 H;
+    getH(i,H);
+    H.toPose(pose,axisRep);
+}
+
+
+/************************************************************************/
+bool iKinFwdBatch::getJacobian(const unsigned int i, Matrix &_J) const
+{
+    yAssert(i<n);
+
+    if (!jac)
+        return false;
+
+    if ((_J.rows()!=6) || (_J.cols()!=dof))
+        _J.resize(6,dof);
+
+    for (unsigned int c=0; c<dof; c++)
+        for (unsigned int r=0; r<6; r++)
+            _J(r,c)=J(r,c)[i];
+
+    return true;
+}
+
+
+namespace
+{
+    /********************************************************************/
+    // T=T*B with B constant across the configurations
+    void batchCompose(double *T[12], const iKinSE3 &B, const unsigned int m)
+    {
+        for (unsigned int k=0; k<m; k++)
+        {
+            for (int r=0; r<3; r++)
+            {
+                double x=T[3*r][k];
+                double y=T[3*r+1][k];
+                double z=T[3*r+2][k];
+
+                T[3*r][k]  =x*B.R[0][0]+y*B.R[1][0]+z*B.R[2][0];
+                T[3*r+1][k]=x*B.R[0][1]+y*B.R[1][1]+z*B.R[2][1];
+                T[3*r+2][k]=x*B.R[0][2]+y*B.R[1][2]+z*B.R[2][2];
+                T[9+r][k]+=x*B.p[0]+y*B.p[1]+z*B.p[2];
+            }
+        }
+    }
+
+
+    /********************************************************************/
+    // T=T*A(theta), where A is the DH matrix given c=cos(theta) and
+    // s=sin(theta) for each configuration in [k,m)
+    void batchLinkScalar(double *T[12], const double *c, const double *s,
+                         const double c_alpha, const double s_alpha,
+                         const double A, const double D,
+                         unsigned int k, const unsigned int m)
+    {
+        for (; k<m; k++)
+        {
+            for (int r=0; r<3; r++)
+            {
+                double x=T[3*r][k];
+                double y=T[3*r+1][k];
+                double z=T[3*r+2][k];
+
+                double u=x*c[k]+y*s[k];
+                double v=y*c[k]-x*s[k];
+
+                T[3*r][k]  =u;
+                T[3*r+1][k]=c_alpha*v+s_alpha*z;
+                T[3*r+2][k]=c_alpha*z-s_alpha*v;
+                T[9+r][k] +=A*u+D*z;
+            }
+        }
+    }
+
+
+#if defined(IKINFWD_AVX2)
+    /********************************************************************/
+    // the same as batchLinkScalar() on the configurations [0,m), four
+    // at a time
+    IKINFWD_AVX2_TARGET
+    void batchLinkAVX2(double *T[12], const double *c, const double *s,
+                       const double c_alpha, const double s_alpha,
+                       const double A, const double D, const unsigned int m)
+    {
+        unsigned int k=0;
+
+        const __m256d ca=_mm256_set1_pd(c_alpha);
+        const __m256d sa=_mm256_set1_pd(s_alpha);
+        const __m256d a=_mm256_set1_pd(A);
+        const __m256d d=_mm256_set1_pd(D);
+
+        for (; k+4<=m; k+=4)
+        {
+            __m256d ck=_mm256_loadu_pd(c+k);
+            __m256d sk=_mm256_loadu_pd(s+k);
+
+            for (int r=0; r<3; r++)
+            {
+                __m256d x=_mm256_loadu_pd(T[3*r]+k);
+                __m256d y=_mm256_loadu_pd(T[3*r+1]+k);
+                __m256d z=_mm256_loadu_pd(T[3*r+2]+k);
+                __m256d p=_mm256_loadu_pd(T[9+r]+k);
+
+                __m256d u=_mm256_add_pd(_mm256_mul_pd(x,ck),_mm256_mul_pd(y,sk));
+                __m256d v=_mm256_sub_pd(_mm256_mul_pd(y,ck),_mm256_mul_pd(x,sk));
+
+                _mm256_storeu_pd(T[3*r]+k,u);
+                _mm256_storeu_pd(T[3*r+1]+k,_mm256_add_pd(_mm256_mul_pd(ca,v),_mm256_mul_pd(sa,z)));
+                _mm256_storeu_pd(T[3*r+2]+k,_mm256_sub_pd(_mm256_mul_pd(ca,z),_mm256_mul_pd(sa,v)));
+                _mm256_storeu_pd(T[9+r]+k,_mm256_add_pd(p,_mm256_add_pd(_mm256_mul_pd(a,u),_mm256_mul_pd(d,z))));
+            }
+        }
+
+        batchLinkScalar(T,c,s,c_alpha,s_alpha,A,D,k,m);
+    }
+#endif
+
+
+    /********************************************************************/
+    // T=T*A(theta) for each configuration with the fastest kernel
+    // available
+    void batchLink(double *T[12], const double *c, const double *s,
+                   const double c_alpha, const double s_alpha,
+                   const double A, const double D, const unsigned int m)
+    {
+    #if defined(IKINFWD_AVX2_DISPATCH)
+        static const bool avx2=(__builtin_cpu_supports("avx2")!=0);
+        if (avx2)
+        {
+            batchLinkAVX2(T,c,s,c_alpha,s_alpha,A,D,m);
+            return;
+        }
+    #elif defined(IKINFWD_AVX2)
+        batchLinkAVX2(T,c,s,c_alpha,s_alpha,A,D,m);
+        return;
+    #endif
+        batchLinkScalar(T,c,s,c_alpha,s_alpha,A,D,0,m);
+    }
+}
+
+
 /************************************************************************/
 iKinLink::iKinLink(double _A, double _D, double _Alpha, double _Offset,
                    double _Min, double _Max): zeros1x1(zeros(1,1)), zeros1(zeros(1))
@@ -51,6 +367,10 @@ iKinLink::iKinLink(double _A, double _D, double _Alpha, double _Offset,
     c_alpha=cos(Alpha);
     s_alpha=sin(Alpha);
 
+    theta_c=std::numeric_limits<double>::quiet_NaN();
+    c_theta=1.0;
+    s_theta=0.0;
+
     blocked    =false;
     cumulative =false;
     constrained=true;
@@ -80,6 +400,10 @@ void iKinLink::clone(const iKinLink &l)
     c_alpha=l.c_alpha;
     s_alpha=l.s_alpha;
 
+    theta_c=l.theta_c;
+    c_theta=l.c_theta;
+    s_theta=l.s_theta;
+
     Ang=l.Ang;
     Min=l.Min;
     Max=l.Max;
@@ -166,11 +490,24 @@ double iKinLink::setAng(double _Ang)
 
 
 /************************************************************************/
-Matrix iKinLink::getH(bool c_override)
+void iKinLink::updateTrig()
 {
     double theta=Ang+Offset;
-    double c_theta=cos(theta);
-    double s_theta=sin(theta);
+
+    // sin() and cos() are recomputed only upon changes
+    if (theta!=theta_c)
+    {
+        theta_c=theta;
+        c_theta=cos(theta);
+        s_theta=sin(theta);
+    }
+}
+
+
+/************************************************************************/
+Matrix iKinLink::getH(bool c_override)
+{
+    updateTrig();
 
     H(0,0)=c_theta;
     H(0,1)=-s_theta*c_alpha;
@@ -198,6 +535,35 @@ Matrix iKinLink::getH(double _Ang, bool c_override)
 }
 
 
+/************************************************************************/
+void iKinLink::getH(iKinSE3 &_H, bool c_override)
+{
+    updateTrig();
+
+    _H.R[0][0]=c_theta;
+    _H.R[0][1]=-s_theta*c_alpha;
+    _H.R[0][2]=s_theta*s_alpha;
+    _H.p[0]   =c_theta*A;
+
+    _H.R[1][0]=s_theta;
+    _H.R[1][1]=c_theta*c_alpha;
+    _H.R[1][2]=-c_theta*s_alpha;
+    _H.p[1]   =s_theta*A;
+
+    _H.R[2][0]=0.0;
+    _H.R[2][1]=s_alpha;
+    _H.R[2][2]=c_alpha;
+    _H.p[2]   =D;
+
+    if (cumulative && !c_override)
+    {
+        iKinSE3 C;
+        C.fromMatrix(cumH);
+        iKinSE3::compose(C,_H,_H);
+    }
+}
+
+
 /************************************************************************/
 Matrix iKinLink::getDnH(unsigned int n, bool c_override)
 {
@@ -205,9 +571,7 @@ Matrix iKinLink::getDnH(unsigned int n, bool c_override)
         return getH(c_override);
     else
     {
-        double theta=Ang+Offset;
-        double c_theta=cos(theta);
-        double s_theta=sin(theta);
+        updateTrig();
 
         int    C=(n>>1)&1 ? -1 : 1;
 
@@ -271,6 +635,7 @@ void iKinChain::clone(const iKinChain &c)
     verbose  =c.verbose;
     hess_J   =c.hess_J;
     hess_Jlnk=c.hess_Jlnk;
+    fwdH     =c.fwdH;
 
     allList.assign(c.allList.begin(),c.allList.end());
     quickList.assign(c.quickList.begin(),c.quickList.end());
@@ -555,6 +920,9 @@ void iKinChain::build()
 
     if (DOF>0)
         curr_q.resize(DOF,0);
+
+    // workspace for the allocation-free kinematics
+    fwdH.resize(N+1);
 }
 
 
@@ -799,6 +1167,26 @@ Matrix iKinChain::getH(const Vector &q)
 }
 
 
+/************************************************************************/
+void iKinChain::getH(iKinSE3 &H)
+{
+    // may be different from DOF since one blocked link may lie
+    // at the end of the chain.
+    unsigned int n=(unsigned int)quickList.size();
+    iKinSE3 Hi;
+
+    H.fromMatrix(H0);
+    for (unsigned int i=0; i<n; i++)
+    {
+        quickList[i]->getH(Hi);
+        iKinSE3::compose(H,Hi,H);
+    }
+
+    Hi.fromMatrix(HN);
+    iKinSE3::compose(H,Hi,H);
+}
+
+
 /************************************************************************/
 Vector iKinChain::Pose(const unsigned int i, const bool axisRep)
 {
@@ -1090,6 +1478,185 @@ Matrix iKinChain::GeoJacobian(const Vector &q)
 }
 
 
+/************************************************************************/
+void iKinChain::GeoJacobian(Matrix &J)
+{
+    yAssert(DOF>0);
+
+    if ((J.rows()!=6) || (J.cols()!=DOF))
+        J.resize(6,DOF);
+
+    iKinSE3 Hi,PN;
+    if (fwdH.size()<N+1)
+        fwdH.resize(N+1);
+
+    fwdH[0].fromMatrix(H0);
+    for (unsigned int i=0; i<N; i++)
+    {
+        allList[i]->getH(Hi,true);
+        iKinSE3::compose(fwdH[i],Hi,fwdH[i+1]);
+    }
+
+    PN.fromMatrix(HN);
+    iKinSE3::compose(fwdH[N],PN,PN);
+
+    for (unsigned int i=0; i<DOF; i++)
+    {
+        const iKinSE3 &Z=fwdH[hash[i]];
+        double d0=PN.p[0]-Z.p[0];
+        double d1=PN.p[1]-Z.p[1];
+        double d2=PN.p[2]-Z.p[2];
+
+        J(0,i)=Z.R[1][2]*d2-Z.R[2][2]*d1;
+        J(1,i)=Z.R[2][2]*d0-Z.R[0][2]*d2;
+        J(2,i)=Z.R[0][2]*d1-Z.R[1][2]*d0;
+        J(3,i)=Z.R[0][2];
+        J(4,i)=Z.R[1][2];
+        J(5,i)=Z.R[2][2];
+    }
+}
+
+
+/************************************************************************/
+void iKinChain::batchWorker(const Matrix &Q, iKinFwdBatch &res,
+                            const unsigned int i0, const unsigned int i1)
+{
+    unsigned int m=i1-i0;
+    vector<double> c(m),s(m);
+
+    // the end-effector frame slots of the output
+    // are used as accumulators
+    double *T[12];
+    for (unsigned int r=0; r<3; r++)
+    {
+        for (unsigned int col=0; col<3; col++)
+            T[3*r+col]=&res.data[(3*r+col)*res.n+i0];
+
+        T[9+r]=&res.data[(9+r)*res.n+i0];
+    }
+
+    iKinSE3 B;
+    B.fromMatrix(H0);
+    for (unsigned int e=0; e<9; e++)
+        std::fill(T[e],T[e]+m,B.R[e/3][e%3]);
+    for (unsigned int r=0; r<3; r++)
+        std::fill(T[9+r],T[9+r]+m,B.p[r]);
+
+    for (unsigned int j=0, i=0; j<N; j++)
+    {
+        iKinLink *lnk=allList[j];
+        if (lnk->isBlocked())
+        {
+            batchCompose(T,fwdH[j],m);
+            continue;
+        }
+
+        if (res.jac)
+        {
+            // store the origin of the link frame in place of the
+            // linear part, which is computed once the end-effector
+            // position is known
+            for (unsigned int r=0; r<3; r++)
+            {
+                std::copy(T[9+r],T[9+r]+m,&res.data[(12+6*i+r)*res.n+i0]);
+                std::copy(T[3*r+2],T[3*r+2]+m,&res.data[(12+6*i+3+r)*res.n+i0]);
+            }
+        }
+
+        for (unsigned int k=0; k<m; k++)
+        {
+            double q=Q(i0+k,i);
+            if (lnk->constrained)
+                q=(q<lnk->Min) ? lnk->Min : ((q>lnk->Max) ? lnk->Max : q);
+
+            double theta=q+lnk->Offset;
+            c[k]=cos(theta);
+            s[k]=sin(theta);
+        }
+
+        batchLink(T,c.data(),s.data(),lnk->c_alpha,lnk->s_alpha,lnk->A,lnk->D,m);
+        i++;
+    }
+
+    B.fromMatrix(HN);
+    batchCompose(T,B,m);
+
+    if (res.jac)
+    {
+        for (unsigned int i=0; i<DOF; i++)
+        {
+            double *w[3],*z[3];
+            for (unsigned int r=0; r<3; r++)
+            {
+                w[r]=&res.data[(12+6*i+r)*res.n+i0];
+                z[r]=&res.data[(12+6*i+3+r)*res.n+i0];
+            }
+
+            for (unsigned int k=0; k<m; k++)
+            {
+                double d0=T[9][k]-w[0][k];
+                double d1=T[10][k]-w[1][k];
+                double d2=T[11][k]-w[2][k];
+
+                w[0][k]=z[1][k]*d2-z[2][k]*d1;
+                w[1][k]=z[2][k]*d0-z[0][k]*d2;
+                w[2][k]=z[0][k]*d1-z[1][k]*d0;
+            }
+        }
+    }
+}
+
+
+/************************************************************************/
+bool iKinChain::BatchKinematics(const Matrix &Q, iKinFwdBatch &res,
+                                const bool jacobian, unsigned int threads)
+{
+    if ((DOF==0) || (Q.cols()!=DOF))
+    {
+        if (verbose)
+            yError("BatchKinematics() failed due to wrong number of columns: %d!=%d",
+                   (int)Q.cols(),DOF);
+
+        return false;
+    }
+
+    unsigned int n=(unsigned int)Q.rows();
+    res.resize(n,DOF,jacobian);
+    if (n==0)
+        return true;
+
+    // the transformations of the blocked links are shared
+    // by all the configurations: compute them beforehand
+    // so that the workers do not touch the links state
+    if (fwdH.size()<N+1)
+        fwdH.resize(N+1);
+    for (unsigned int j=0; j<N; j++)
+        if (allList[j]->isBlocked())
+            allList[j]->getH(fwdH[j],true);
+
+    if (threads==0)
+        threads=std::max(1U,std::thread::hardware_concurrency());
+    threads=std::min(threads,n);
+
+    // configurations are split in chunks that are
+    // multiple of the vector width
+    unsigned int chunk=(((n+threads-1)/threads+3)/4)*4;
+
+    vector<std::thread> workers;
+    unsigned int i0=0;
+    for (; (i0+chunk<n) && (workers.size()+1<threads); i0+=chunk)
+        workers.push_back(std::thread(&iKinChain::batchWorker,this,
+                                      std::cref(Q),std::ref(res),i0,i0+chunk));
+
+    batchWorker(Q,res,i0,n);
+
+    for (auto &w:workers)
+        w.join();
+
+    return true;
+}
+
+
 /************************************************************************/
 Vector iKinChain::Hessian_ij(const unsigned int i, const unsigned int j)
 {
@@ -1109,18 +1676,37 @@ void iKinChain::prepareForHessian()
         return;
     }
 
-    hess_J=GeoJacobian();
+    GeoJacobian(hess_J);
+}
+
+
+/************************************************************************/
+void iKinChain::prepareForHessian(const Matrix &J)
+{
+    yAssert((J.rows()==6) && (J.cols()==DOF));
+    hess_J=J;
 }
 
 
 /************************************************************************/
 Vector iKinChain::fastHessian_ij(const unsigned int i, const unsigned int j)
+{
+    Vector h(6);
+    fastHessian_ij(i,j,h);
+    return h;
+}
+
+
+/************************************************************************/
+void iKinChain::fastHessian_ij(const unsigned int i, const unsigned int j, Vector &h)
 {
     yAssert((i<DOF) && (j<DOF));
 
+    if (h.length()!=6)
+        h.resize(6);
+
     // ref. E.D. Pohl, H. Lipkin, "A New Method of Robotic Motion Control Near Singularities",
     // Advanced Robotics, 1991
-    Vector h(6,0.0);
     if(i<j)
     {
         //h.setSubvector(0,cross(hess_Jo,i,hess_Jl,j));
@@ -1140,8 +1726,6 @@ Vector iKinChain::fastHessian_ij(const unsigned int i, const unsigned int j)
         h[2] = hess_J(3,j)*hess_J(1,i) - hess_J(4,j)*hess_J(0,i);
         h[3]=h[4]=h[5]=0.0;
     }
-
-    return h;
 }
 
 
@@ -9,8 +9,12 @@
 */
 
 #include <cstdlib>
+#include <cmath>
 #include <limits>
 #include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
 
 #include <IpTNLP.hpp>
 #include <IpIpoptApplication.hpp>
@@ -19,6 +23,11 @@
 
 #define CAST_IPOPTAPP(x)                    (static_cast<IpoptApplication*>(x))
 #define IKINIPOPT_SHOULDER_MAXABDUCTION     (100.0*CTRL_DEG2RAD)
+#define IKINDLS_CONSTR_WEIGHT               1e4
+#define IKINDLS_DAMPING_INIT                1e-4
+#define IKINDLS_DAMPING_MIN                 1e-9
+#define IKINDLS_DAMPING_MAX                 1e4
+#define IKINDLS_QP_TOL                      1e-10
 
 using namespace std;
 using namespace yarp::sig;
@@ -274,6 +283,17 @@ protected:
 
     yarp::sig::Vector linC;
 
+    // evaluation buffers, allocated once per problem
+    iKinSE3            Hd;
+    iKinSE3            H;
+    iKinSE3            H_2nd;
+    iKinSE3            E;
+    yarp::sig::Vector  axis;
+    yarp::sig::Matrix  J_geo;
+    yarp::sig::Matrix  J_geo_2nd;
+    yarp::sig::Vector  hess;
+    yarp::sig::Vector  hess_2nd;
+
     double __obj_scaling;
     double __x_scaling;
     double __g_scaling;
@@ -286,57 +306,69 @@ protected:
     double weight3rdTask;
     bool   firstGo;
 
+    /************************************************************************/
+    static double dot3(const yarp::sig::Matrix &J, const int col, const yarp::sig::Vector &e)
+    {
+        return J(0,col)*e[0]+J(1,col)*e[1]+J(2,col)*e[2];
+    }
+
     /************************************************************************/
     virtual void computeQuantities(const Number *x)
     {
-        yarp::sig::Vector new_q(dim);
-        for (Index i=0; i<(int)dim; i++)
-            new_q[i]=x[i];
+        bool new_q=firstGo;
+        for (Index i=0; (i<(int)dim) && !new_q; i++)
+            new_q=(q[i]!=x[i]);
 
-        if (!(q==new_q) || firstGo)
+        if (new_q)
         {
             firstGo=false;
-            q=new_q;
 
-            yarp::sig::Vector v(4,0.0);
-            if (xd.length()>=7)
+            // all the quantities below are written into the
+            // buffers preallocated by the constructor
+            for (unsigned int i=0; i<dim; i++)
+                q[i]=chain(i).setAng(x[i]);
+
+            chain.getH(H);
+
+            // E=Hd*H'
+            E.eye();
+            for (int r=0; r<3; r++)
+                for (int c=0; c<3; c++)
+                    E.R[r][c]=Hd.R[r][0]*H.R[c][0]+Hd.R[r][1]*H.R[c][1]+Hd.R[r][2]*H.R[c][2];
+            E.toPose(axis);
+
+            e_xyz[0]=xd[0]-H.p[0];
+            e_xyz[1]=xd[1]-H.p[1];
+            e_xyz[2]=xd[2]-H.p[2];
+            e_ang[0]=axis[6]*axis[3];
+            e_ang[1]=axis[6]*axis[4];
+            e_ang[2]=axis[6]*axis[5];
+
+            chain.GeoJacobian(J_geo);
+            for (unsigned int i=0; i<dim; i++)
             {
-                v[0]=xd[3];
-                v[1]=xd[4];
-                v[2]=xd[5];
-                v[3]=xd[6];
+                J_xyz(0,i)=J_geo(0,i);
+                J_xyz(1,i)=J_geo(1,i);
+                J_xyz(2,i)=J_geo(2,i);
+                J_ang(0,i)=J_geo(3,i);
+                J_ang(1,i)=J_geo(4,i);
+                J_ang(2,i)=J_geo(5,i);
             }
-            
-            q=chain.setAng(q);
-            yarp::sig::Matrix H=chain.getH();
-            yarp::sig::Matrix E=axis2dcm(v)*H.transposed();
-            v=dcm2axis(E);
-            
-            e_xyz[0]=xd[0]-H(0,3);
-            e_xyz[1]=xd[1]-H(1,3);
-            e_xyz[2]=xd[2]-H(2,3);
-            e_ang[0]=v[3]*v[0];
-            e_ang[1]=v[3]*v[1];
-            e_ang[2]=v[3]*v[2];
-
-            yarp::sig::Matrix J1=chain.GeoJacobian();
-            submatrix(J1,J_xyz,0,2,0,dim-1);
-            submatrix(J1,J_ang,3,5,0,dim-1);
 
             if (weight2ndTask!=0.0)
             {
-                yarp::sig::Matrix H_2nd=chain2ndTask.getH();
-                e_2nd[0]=w_2nd[0]*(xd_2nd[0]-H_2nd(0,3));
-                e_2nd[1]=w_2nd[1]*(xd_2nd[1]-H_2nd(1,3));
-                e_2nd[2]=w_2nd[2]*(xd_2nd[2]-H_2nd(2,3));
+                chain2ndTask.getH(H_2nd);
+                e_2nd[0]=w_2nd[0]*(xd_2nd[0]-H_2nd.p[0]);
+                e_2nd[1]=w_2nd[1]*(xd_2nd[1]-H_2nd.p[1]);
+                e_2nd[2]=w_2nd[2]*(xd_2nd[2]-H_2nd.p[2]);
 
-                yarp::sig::Matrix J2=chain2ndTask.GeoJacobian();
+                chain2ndTask.GeoJacobian(J_geo_2nd);
 
                 for (unsigned int i=0; i<dim_2nd; i++)
                 {
-                    J_2nd(0,i)=w_2nd[0]*J2(0,i);
-                    J_2nd(1,i)=w_2nd[1]*J2(1,i);
-                    J_2nd(2,i)=w_2nd[2]*J2(2,i);
+                    J_2nd(0,i)=w_2nd[0]*J_geo_2nd(0,i);
+                    J_2nd(1,i)=w_2nd[1]*J_geo_2nd(1,i);
+                    J_2nd(2,i)=w_2nd[2]*J_geo_2nd(2,i);
                 }
             }
 
@@ -345,7 +377,18 @@ protected:
                     e_3rd[i]=w_3rd[i]*(qd_3rd[i]-q[i]);
 
             if (LIC.isActive())
-                linC=LIC.getC()*q;
+            {
+                const yarp::sig::Matrix &C=LIC.getC();
+                if (linC.length()!=C.rows())
+                    linC.resize(C.rows());
+
+                for (size_t r=0; r<C.rows(); r++)
+                {
+                    linC[r]=0.0;
+                    for (unsigned int c=0; c<dim; c++)
+                        linC[r]+=C(r,c)*q[c];
+                }
+            }
         }
     }
 
@@ -398,6 +441,27 @@ public:
         J_ang.resize(3,dim);  J_ang.zero();
         J_2nd.resize(3,dim);  J_2nd.zero();
 
+        // the target orientation does not change throughout the
+        // optimization, hence its rotation matrix is computed once
+        yarp::sig::Vector v(4,0.0);
+        if (xd.length()>=7)
+        {
+            v[0]=xd[3];
+            v[1]=xd[4];
+            v[2]=xd[5];
+            v[3]=xd[6];
+        }
+
+        Hd.fromMatrix(axis2dcm(v));
+        H.eye();
+        H_2nd.eye();
+        E.eye();
+        axis.resize(7,0.0);
+        J_geo.resize(6,dim);
+        J_geo_2nd.resize(6,dim_2nd);
+        hess.resize(6,0.0);
+        hess_2nd.resize(6,0.0);
+
         if (ctrlPose==IKINCTRL_POSE_FULL)
         {
             e_1st=&e_ang;
@@ -575,16 +639,16 @@ public:
     {
         computeQuantities(x);
 
-        yarp::sig::Vector grad=-2.0*(J_1st->transposed() * *e_1st);
-
-        if (weight2ndTask!=0.0)
-            grad=grad-2.0*weight2ndTask*(J_2nd.transposed()*e_2nd);
+        for (Index i=0; i<n; i++)
+        {
+            grad_f[i]=-2.0*dot3(*J_1st,i,*e_1st);
 
-        if (weight3rdTask!=0.0)
-            grad=grad-2.0*weight3rdTask*(w_3rd*e_3rd);
+            if (weight2ndTask!=0.0)
+                grad_f[i]-=2.0*weight2ndTask*dot3(J_2nd,i,e_2nd);
 
-        for (Index i=0; i<n; i++)
-            grad_f[i]=grad[i];
+            if (weight3rdTask!=0.0)
+                grad_f[i]-=2.0*weight3rdTask*w_3rd[i]*e_3rd[i];
+        }
 
         return true;
     }
@@ -633,8 +697,6 @@ public:
             else
             {
                 computeQuantities(x);
-            
-                yarp::sig::Vector grad=-2.0*(J_cst->transposed() * *e_cst);
 
                 Index idx =0;
                 Index offs=0;
@@ -645,7 +707,7 @@ public:
                     {    
                         if (row==0)
                         {
-                            values[idx]=grad[idx];                    
+                            values[idx]=-2.0*dot3(*J_cst,col,*e_cst);
                             offs=1;
                         }
                         else
@@ -683,11 +745,26 @@ public:
         {
             // Given the task: min f(q)=||xd-F(q)||^2
             // the Hessian Hij is: 2 * (<dF/dqi,dF/dqj> - <d2F/dqidqj,e>)
+            // the Jacobians computed for the gradients are reused
             computeQuantities(x);
-            chain.prepareForHessian();
+            chain.prepareForHessian(J_geo);
 
             if (weight2ndTask!=0.0)
-                chain2ndTask.prepareForHessian();
+                chain2ndTask.prepareForHessian(J_geo_2nd);
+
+            // offsets of the components of the second derivatives
+            // matching the 1st task and the constraint (-1 if null)
+            int offs_1st, offs_cst;
+            if (e_cst==&e_xyz)
+            {
+                offs_1st=(ctrlPose==IKINCTRL_POSE_FULL)?3:-1;
+                offs_cst=0;
+            }
+            else
+            {
+                offs_1st=(ctrlPose==IKINCTRL_POSE_FULL)?0:-1;
+                offs_cst=3;
+            }
 
             Index idx=0;
             for (Index row=0; row<n; row++)
@@ -696,41 +773,29 @@ public:
                 {
                     // warning: row and col are swapped due to asymmetry
                     // of orientation part within the hessian 
-                    yarp::sig::Vector h=chain.fastHessian_ij(col,row);
-                    yarp::sig::Vector h_xyz(3), h_ang(3), h_zero(3,0.0);
-                    h_xyz[0]=h[0];
-                    h_xyz[1]=h[1];
-                    h_xyz[2]=h[2];
-                    h_ang[0]=h[3];
-                    h_ang[1]=h[4];
-                    h_ang[2]=h[5];
-
-                    yarp::sig::Vector *h_1st,*h_cst;
-                    if (e_cst==&e_xyz)
-                    {
-                        h_1st=(ctrlPose==IKINCTRL_POSE_FULL)?&h_ang:&h_zero;
-                        h_cst=&h_xyz;
-                    }
-                    else
-                    {
-                        h_1st=(ctrlPose==IKINCTRL_POSE_FULL)?&h_xyz:&h_zero;
-                        h_cst=&h_ang;
-                    }
+                    chain.fastHessian_ij(col,row,hess);
+
+                    double he_1st=0.0;
+                    if (offs_1st>=0)
+                        he_1st=hess[offs_1st]*(*e_1st)[0]+hess[offs_1st+1]*(*e_1st)[1]+
+                               hess[offs_1st+2]*(*e_1st)[2];
+
+                    double he_cst=hess[offs_cst]*(*e_cst)[0]+hess[offs_cst+1]*(*e_cst)[1]+
+                                  hess[offs_cst+2]*(*e_cst)[2];
 
-                    values[idx]=2.0*(obj_factor*(dot(*J_1st,row,*J_1st,col)-dot(*h_1st,*e_1st))+
-                                     lambda[0]*(dot(*J_cst,row,*J_cst,col)-dot(*h_cst,*e_cst)));
+                    values[idx]=2.0*(obj_factor*(dot(*J_1st,row,*J_1st,col)-he_1st)+
+                                     lambda[0]*(dot(*J_cst,row,*J_cst,col)-he_cst));
                 
                     if ((weight2ndTask!=0.0) && (row<(int)dim_2nd) && (col<(int)dim_2nd))
                     {    
                         // warning: row and col are swapped due to asymmetry
                         // of orientation part within the hessian 
-                        yarp::sig::Vector h2=chain2ndTask.fastHessian_ij(col,row);
-                        yarp::sig::Vector h_2nd(3);
-                        h_2nd[0]=(w_2nd[0]*w_2nd[0])*h2[0];
-                        h_2nd[1]=(w_2nd[1]*w_2nd[1])*h2[1];
-                        h_2nd[2]=(w_2nd[2]*w_2nd[2])*h2[2];
+                        chain2ndTask.fastHessian_ij(col,row,hess_2nd);
+                        double he_2nd=(w_2nd[0]*w_2nd[0])*hess_2nd[0]*e_2nd[0]+
+                                      (w_2nd[1]*w_2nd[1])*hess_2nd[1]*e_2nd[1]+
+                                      (w_2nd[2]*w_2nd[2])*hess_2nd[2]*e_2nd[2];
                 
-                        values[idx]+=2.0*obj_factor*weight2ndTask*(dot(J_2nd,row,J_2nd,col)-dot(h_2nd,e_2nd));
+                        values[idx]+=2.0*obj_factor*weight2ndTask*(dot(J_2nd,row,J_2nd,col)-he_2nd);
                     }
                 
                     idx++;
@@ -1026,6 +1091,15 @@ void iKinIpOptMin::setBoundsInf(const double lower, const double upper)
 }
 
 
+/************************************************************************/
+string iKinIpOptMin::getLinearSolver()
+{
+    string linear_solver;
+    CAST_IPOPTAPP(App)->Options()->GetStringValue("linear_solver",linear_solver,"");
+    return linear_solver;
+}
+
+
 /************************************************************************/
 yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
                                       double weight2ndTask, yarp::sig::Vector &xd_2nd,
@@ -1077,3 +1151,376 @@ iKinIpOptMin::~iKinIpOptMin()
 }
 
 
+/************************************************************************/
+iKinDLSMin::iKinDLSMin(iKinChain &c, const unsigned int _ctrlPose, const double tol,
+                       const double constr_tol, const int max_iter) :
+                       iKinIpOptMin(c,_ctrlPose,tol,constr_tol,max_iter)
+{
+}
+
+
+/************************************************************************/
+bool iKinDLSMin::solveQP(const Matrix &H, const Vector &g, const Matrix &A,
+                         const Vector &b, Vector &x)
+{
+    // min 1/2*x'*H*x-g'*x s.t. A*x<=b by the primal active-set method
+    // started from x=0, which is feasible given b>=0 (otherwise the
+    // violated constraints are not violated any further): the step toward
+    // the minimum over the working set is taken up to the first blocking
+    // constraint, which joins the set, whereas the constraint with the
+    // most negative multiplier leaves the set once the minimum is reached
+    size_t n=g.length();
+    size_t m=b.length();
+    Matrix Hinv=luinv(H);
+    Vector x0=Hinv*g;
+    x.resize(n,0.0);
+
+    deque<size_t> W;
+    vector<bool> inW(m,false);
+    for (size_t iter=0; iter<3*(m+n); iter++)
+    {
+        Vector xw=x0;
+        Vector mu;
+        if (W.size()>0)
+        {
+            size_t k=W.size();
+            Matrix Aw(k,n);
+            Vector b_w(k);
+            for (size_t i=0; i<k; i++)
+            {
+                b_w[i]=b[W[i]];
+                for (size_t j=0; j<n; j++)
+                    Aw(i,j)=A(W[i],j);
+            }
+
+            Matrix B=Hinv*Aw.transposed();
+            Matrix Sinv=pinv(Aw*B);
+            mu=Sinv*(Aw*x0-b_w);
+            xw=x0-B*mu;
+
+            // one step of iterative refinement, since x0 may be large
+            // whenever the damping is low
+            Vector dmu=Sinv*(Aw*xw-b_w);
+            mu+=dmu;
+            xw-=B*dmu;
+        }
+
+        Vector p=xw-x;
+        if (norm(p)<=IKINDLS_QP_TOL*(1.0+norm(x)))
+        {
+            size_t jmin=W.size();
+            double mumin=-IKINDLS_QP_TOL;
+            for (size_t j=0; j<W.size(); j++)
+            {
+                if (mu[j]<mumin)
+                {
+                    mumin=mu[j];
+                    jmin=j;
+                }
+            }
+
+            if (jmin==W.size())
+                return true;
+
+            inW[W[jmin]]=false;
+            W.erase(W.begin()+jmin);
+            continue;
+        }
+
+        size_t iblk=m;
+        double alpha=1.0;
+        for (size_t i=0; i<m; i++)
+        {
+            if (!inW[i])
+            {
+                double Ap=0.0,Ax=0.0;
+                for (size_t j=0; j<n; j++)
+                {
+                    Ap+=A(i,j)*p[j];
+                    Ax+=A(i,j)*x[j];
+                }
+
+                if (Ap>IKINDLS_QP_TOL)
+                {
+                    double a=std::max(b[i]-Ax,0.0)/Ap;
+                    if (a<alpha)
+                    {
+                        alpha=a;
+                        iblk=i;
+                    }
+                }
+            }
+        }
+
+        x+=alpha*p;
+        if (iblk<m)
+        {
+            inW[iblk]=true;
+            W.push_back(iblk);
+        }
+    }
+
+    return false;
+}
+
+
+/************************************************************************/
+yarp::sig::Vector iKinDLSMin::solve(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
+                                    double weight2ndTask, yarp::sig::Vector &xd_2nd,
+                                    yarp::sig::Vector &w_2nd, double weight3rdTask,
+                                    yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
+                                    int *exit_code, bool *exhalt, iKinIterateCallback *iterate)
+{
+    unsigned int dim=chain.getDOF();
+    unsigned int dim_2nd=chain2ndTask.getDOF();
+    if (dim_2nd==0)
+        weight2ndTask=0.0;
+
+    double tol=getTol();
+    double constr_tol=getConstrTol();
+    int max_iter=getMaxIter();
+
+    // the tasks are selected as in iKin_NLP: the constraint is
+    // the position (the orientation if prioritized), the 1st task
+    // is the other part of the pose, if controlled
+    bool orientationFirst=(posePriority=="orientation");
+    bool full=(ctrlPose==IKINCTRL_POSE_FULL);
+    unsigned int rowsCst=orientationFirst?3:0;
+    unsigned int rows1st=orientationFirst?0:3;
+
+    yarp::sig::Vector v(4,0.0);
+    if (xd.length()>=7)
+        v=xd.subVector(3,6);
+    Matrix Rd=axis2dcm(v);
+
+    yarp::sig::Vector q(dim),lo(dim),hi(dim);
+    for (unsigned int i=0; i<dim; i++)
+    {
+        lo[i]=chain(i).getMin();
+        hi[i]=chain(i).getMax();
+        q[i]=std::min(std::max(i<q0.length()?q0[i]:0.0,lo[i]),hi[i]);
+    }
+
+    // constraints on the step: the joints bounds and the finite
+    // bounds of the linear inequalities
+    deque<int> licRows;
+    bool lic=pLIC->isActive() && (pLIC->getlB().length()==pLIC->getuB().length()) &&
+             (pLIC->getC().rows()==pLIC->getlB().length()) && (pLIC->getC().cols()==dim);
+    if (lic)
+    {
+        for (size_t i=0; i<pLIC->getuB().length(); i++)
+        {
+            if (pLIC->getuB()[i]<pLIC->getUpperBoundInf())
+                licRows.push_back((int)i+1);
+            if (pLIC->getlB()[i]>pLIC->getLowerBoundInf())
+                licRows.push_back(-(int)i-1);
+        }
+    }
+
+    A.resize(2*dim+licRows.size(),dim); A.zero();
+    b.resize(A.rows());
+    for (unsigned int i=0; i<dim; i++)
+    {
+        A(2*i,i)=1.0;
+        A(2*i+1,i)=-1.0;
+    }
+    for (size_t k=0; k<licRows.size(); k++)
+    {
+        int r=abs(licRows[k])-1;
+        double sign=(licRows[k]>0)?1.0:-1.0;
+        for (unsigned int j=0; j<dim; j++)
+            A(2*dim+k,j)=sign*pLIC->getC()(r,j);
+    }
+
+    iKinSE3 H,H2,E;
+    yarp::sig::Vector pose;
+    yarp::sig::Vector e(6,0.0);
+    yarp::sig::Vector e_2nd(3,0.0);
+    yarp::sig::Vector e_3rd(dim,0.0);
+
+    // computes the errors of the tasks and the merit function
+    auto evalTasks=[&](const yarp::sig::Vector &_q) -> double
+    {
+        chain.setAng(_q);
+        chain.getH(H);
+
+        for (int i=0; i<3; i++)
+            for (int j=0; j<3; j++)
+                E.R[i][j]=Rd(i,0)*H.R[j][0]+Rd(i,1)*H.R[j][1]+Rd(i,2)*H.R[j][2];
+        E.p[0]=E.p[1]=E.p[2]=0.0;
+        E.toPose(pose);
+
+        for (int i=0; i<3; i++)
+        {
+            e[i]=xd[i]-H.p[i];
+            e[3+i]=pose[6]*pose[3+i];
+        }
+
+        double f=0.0;
+        for (unsigned int i=0; i<3; i++)
+        {
+            f+=0.5*IKINDLS_CONSTR_WEIGHT*e[rowsCst+i]*e[rowsCst+i];
+            if (full)
+                f+=0.5*e[rows1st+i]*e[rows1st+i];
+        }
+
+        if (weight2ndTask!=0.0)
+        {
+            chain2ndTask.getH(H2);
+            for (int i=0; i<3; i++)
+            {
+                e_2nd[i]=w_2nd[i]*(xd_2nd[i]-H2.p[i]);
+                f+=0.5*weight2ndTask*e_2nd[i]*e_2nd[i];
+            }
+        }
+
+        if (weight3rdTask!=0.0)
+        {
+            for (unsigned int i=0; i<dim; i++)
+            {
+                e_3rd[i]=w_3rd[i]*(qd_3rd[i]-_q[i]);
+                f+=0.5*weight3rdTask*e_3rd[i]*e_3rd[i];
+            }
+        }
+
+        return f;
+    };
+
+    auto constrErr=[&]() -> double
+    {
+        return e[rowsCst]*e[rowsCst]+e[rowsCst+1]*e[rowsCst+1]+e[rowsCst+2]*e[rowsCst+2];
+    };
+
+    double f=evalTasks(q);
+    chain.GeoJacobian(J);
+    if (weight2ndTask!=0.0)
+        chain2ndTask.GeoJacobian(J2);
+
+    Hqp.resize(dim,dim);
+    g.resize(dim);
+    yarp::sig::Vector q_try(dim);
+    double lambda2=IKINDLS_DAMPING_INIT;
+
+    ApplicationReturnStatus status=Maximum_Iterations_Exceeded;
+    for (int iter=0; (max_iter<0) || (iter<max_iter); iter++)
+    {
+        if ((exhalt!=NULL) && *exhalt)
+        {
+            status=User_Requested_Stop;
+            break;
+        }
+
+        // Gauss-Newton model of the tasks, damped
+        Hqp.zero();
+        g.zero();
+        for (unsigned int i=0; i<dim; i++)
+        {
+            for (unsigned int j=i; j<dim; j++)
+            {
+                double h=0.0;
+                for (unsigned int r=0; r<3; r++)
+                {
+                    h+=IKINDLS_CONSTR_WEIGHT*J(rowsCst+r,i)*J(rowsCst+r,j);
+                    if (full)
+                        h+=J(rows1st+r,i)*J(rows1st+r,j);
+                    if ((weight2ndTask!=0.0) && (i<dim_2nd) && (j<dim_2nd))
+                        h+=weight2ndTask*w_2nd[r]*w_2nd[r]*J2(r,i)*J2(r,j);
+                }
+                Hqp(i,j)=Hqp(j,i)=h;
+            }
+
+            for (unsigned int r=0; r<3; r++)
+            {
+                g[i]+=IKINDLS_CONSTR_WEIGHT*J(rowsCst+r,i)*e[rowsCst+r];
+                if (full)
+                    g[i]+=J(rows1st+r,i)*e[rows1st+r];
+                if ((weight2ndTask!=0.0) && (i<dim_2nd))
+                    g[i]+=weight2ndTask*w_2nd[r]*J2(r,i)*e_2nd[r];
+            }
+
+            if (weight3rdTask!=0.0)
+            {
+                Hqp(i,i)+=weight3rdTask*w_3rd[i]*w_3rd[i];
+                g[i]+=weight3rdTask*w_3rd[i]*e_3rd[i];
+            }
+
+            Hqp(i,i)+=lambda2;
+        }
+
+        for (unsigned int i=0; i<dim; i++)
+        {
+            b[2*i]=hi[i]-q[i];
+            b[2*i+1]=q[i]-lo[i];
+        }
+        for (size_t k=0; k<licRows.size(); k++)
+        {
+            int r=abs(licRows[k])-1;
+            double Cq=0.0;
+            for (unsigned int j=0; j<dim; j++)
+                Cq+=pLIC->getC()(r,j)*q[j];
+            b[2*dim+k]=(licRows[k]>0)?(pLIC->getuB()[r]-Cq):(Cq-pLIC->getlB()[r]);
+        }
+
+        // a QP not solved within its iterations is dealt with as a
+        // rejected step, since the larger damping makes it easier
+        if (!solveQP(Hqp,g,A,b,dq))
+        {
+            lambda2*=4.0;
+            if (lambda2>IKINDLS_DAMPING_MAX)
+            {
+                status=(constrErr()<=constr_tol)?Solved_To_Acceptable_Level:
+                                                  Search_Direction_Becomes_Too_Small;
+                break;
+            }
+
+            continue;
+        }
+
+        double step=0.0;
+        for (unsigned int i=0; i<dim; i++)
+        {
+            q_try[i]=std::min(std::max(q[i]+dq[i],lo[i]),hi[i]);
+            step=std::max(step,fabs(q_try[i]-q[i]));
+        }
+
+        double f_try=evalTasks(q_try);
+        if (f_try<f)
+        {
+            q=q_try;
+            f=f_try;
+            lambda2=std::max(0.25*lambda2,IKINDLS_DAMPING_MIN);
+
+            if (iterate!=NULL)
+                iterate->exec(xd,q);
+
+            if ((constrErr()<=constr_tol) && (step<=tol))
+            {
+                status=Solve_Succeeded;
+                break;
+            }
+
+            chain.GeoJacobian(J);
+            if (weight2ndTask!=0.0)
+                chain2ndTask.GeoJacobian(J2);
+        }
+        else
+        {
+            evalTasks(q);
+            lambda2*=4.0;
+
+            // no further improvement can be achieved
+            if ((lambda2>IKINDLS_DAMPING_MAX) || (step<=IKINDLS_QP_TOL))
+            {
+                status=(constrErr()<=constr_tol)?Solved_To_Acceptable_Level:
+                                                  Search_Direction_Becomes_Too_Small;
+                break;
+            }
+        }
+    }
+
+    if (exit_code!=NULL)
+        *exit_code=status;
+
+    return chain.setAng(q);
+}
+
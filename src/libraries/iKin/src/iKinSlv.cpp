@@ -10,6 +10,8 @@
 
 #include <cstdlib>
 #include <cmath>
+#include <limits>
+#include <chrono>
 #include <algorithm>
 
 #include <yarp/os/Log.h>
@@ -26,6 +28,10 @@
 #define CARTSLV_WEIGHT_2ND_TASK             0.01
 #define CARTSLV_WEIGHT_3RD_TASK             0.01
 #define CARTSLV_UNCTRLEDJNTS_THRES          1.0     // [deg]
+#define CARTSLV_DEFAULT_MULTISTART_TMO      0.05    // [s]
+#define CARTSLV_CACHE_ANG_SCALE             0.1     // [m/rad]
+#define CARTSLV_CACHE_MAX_ERR               5e-3
+#define CARTSLV_MULTISTART_EPS              1e-4
 
 using namespace std;
 using namespace yarp::os;
@@ -206,6 +212,13 @@ bool InputPort::handleMode(const int newMode)
 
 /************************************************************************/
 void InputPort::onRead(Bottle &b)
+{
+    handleRequest(b);
+}
+
+
+/************************************************************************/
+void InputPort::handleRequest(Bottle &b)
 {
     bool xdOptIn  =b.check(Vocab32::decode(IKINSLV_VOCAB_OPT_XD));
     bool dofOptIn =b.check(Vocab32::decode(IKINSLV_VOCAB_OPT_DOF));
@@ -263,6 +276,195 @@ void SolverCallback::exec(const Vector &xd, const Vector &q)
 }
 
 
+/************************************************************************/
+SolutionCache::SolutionCache(const size_t _capacity) : capacity(_capacity), root(-1)
+{
+}
+
+
+/************************************************************************/
+void SolutionCache::setCapacity(const size_t _capacity)
+{
+    capacity=_capacity;
+    clear();
+}
+
+
+/************************************************************************/
+void SolutionCache::clear()
+{
+    entries.clear();
+    root=-1;
+}
+
+
+/************************************************************************/
+void SolutionCache::makeKey(const Vector &xd, double *key)
+{
+    for (size_t i=0; i<3; i++)
+        key[i]=(i<xd.length())?xd[i]:0.0;
+
+    if (xd.length()>=7)
+    {
+        double s=CARTSLV_CACHE_ANG_SCALE*xd[6];
+        for (size_t i=0; i<3; i++)
+            key[3+i]=s*xd[3+i];
+    }
+    else
+        key[3]=key[4]=key[5]=0.0;
+}
+
+
+/************************************************************************/
+int SolutionCache::build(vector<int> &idx, const int lo, const int hi,
+                         const unsigned int depth)
+{
+    if (lo>=hi)
+        return -1;
+
+    unsigned int d=depth%6;
+    int mid=(lo+hi)/2;
+    nth_element(idx.begin()+lo,idx.begin()+mid,idx.begin()+hi,
+                [this,d](int a, int b) { return entries[a].key[d]<entries[b].key[d]; });
+
+    Entry &e=entries[idx[mid]];
+    e.left=build(idx,lo,mid,depth+1);
+    e.right=build(idx,mid+1,hi,depth+1);
+    return idx[mid];
+}
+
+
+/************************************************************************/
+void SolutionCache::add(const Vector &xd, const Vector &q)
+{
+    if (capacity==0)
+        return;
+
+    // drop the oldest half and rebuild the tree balanced
+    if (entries.size()>=capacity)
+    {
+        entries.erase(entries.begin(),entries.begin()+(entries.size()+1)/2);
+
+        vector<int> idx(entries.size());
+        for (size_t i=0; i<idx.size(); i++)
+            idx[i]=(int)i;
+        root=build(idx,0,(int)idx.size(),0);
+    }
+
+    Entry e;
+    makeKey(xd,e.key);
+    e.q=q;
+    e.left=e.right=-1;
+    entries.push_back(e);
+
+    int n=(int)entries.size()-1;
+    if (root<0)
+    {
+        root=n;
+        return;
+    }
+
+    int node=root;
+    for (unsigned int depth=0;; depth++)
+    {
+        unsigned int d=depth%6;
+        int &child=(e.key[d]<entries[node].key[d])?entries[node].left:entries[node].right;
+        if (child<0)
+        {
+            child=n;
+            break;
+        }
+        node=child;
+    }
+}
+
+
+/************************************************************************/
+void SolutionCache::search(const int node, const unsigned int depth, const double *key,
+                           const unsigned int dims, const size_t k,
+                           vector<pair<double,int> > &nearest) const
+{
+    if (node<0)
+        return;
+
+    const Entry &e=entries[node];
+    double d2=0.0;
+    for (unsigned int i=0; i<dims; i++)
+        d2+=(key[i]-e.key[i])*(key[i]-e.key[i]);
+
+    // nearest is kept as a max-heap of the best k so far
+    if (nearest.size()<k)
+    {
+        nearest.push_back(make_pair(d2,node));
+        push_heap(nearest.begin(),nearest.end());
+    }
+    else if (d2<nearest.front().first)
+    {
+        pop_heap(nearest.begin(),nearest.end());
+        nearest.back()=make_pair(d2,node);
+        push_heap(nearest.begin(),nearest.end());
+    }
+
+    // splits on ignored components do not allow pruning
+    unsigned int d=depth%6;
+    if (d>=dims)
+    {
+        search(e.left,depth+1,key,dims,k,nearest);
+        search(e.right,depth+1,key,dims,k,nearest);
+        return;
+    }
+
+    double diff=key[d]-e.key[d];
+    int first=(diff<0.0)?e.left:e.right;
+    int second=(diff<0.0)?e.right:e.left;
+
+    search(first,depth+1,key,dims,k,nearest);
+    if ((nearest.size()<k) || (diff*diff<nearest.front().first))
+        search(second,depth+1,key,dims,k,nearest);
+}
+
+
+/************************************************************************/
+size_t SolutionCache::lookup(const Vector &xd, const bool full, const size_t k,
+                             deque<Vector> &q, deque<double> &dist) const
+{
+    q.clear();
+    dist.clear();
+    if ((k==0) || (root<0))
+        return 0;
+
+    double key[6];
+    makeKey(xd,key);
+
+    vector<pair<double,int> > nearest;
+    search(root,0,key,full?6:3,k,nearest);
+    sort_heap(nearest.begin(),nearest.end());
+
+    for (size_t i=0; i<nearest.size(); i++)
+    {
+        q.push_back(entries[nearest[i].second].q);
+        dist.push_back(sqrt(nearest[i].first));
+    }
+
+    return q.size();
+}
+
+
+/************************************************************************/
+double SolutionCache::distance(const Vector &xd1, const Vector &xd2, const bool full)
+{
+    double key1[6],key2[6];
+    makeKey(xd1,key1);
+    makeKey(xd2,key2);
+
+    double d2=0.0;
+    for (unsigned int i=0; i<(full?6U:3U); i++)
+        d2+=(key1[i]-key2[i])*(key1[i]-key2[i]);
+
+    return sqrt(d2);
+}
+
+
 /************************************************************************/
 CartesianSolver::CartesianSolver(const string &_slvName) :
                                 PeriodicThread((double)CARTSLV_DEFAULT_PER/1000.0)
@@ -278,6 +480,13 @@ CartesianSolver::CartesianSolver(const string &_slvName) :
     maxPartJoints=0;
     unctrlJointsNum=0;
     ping_robot_tmo=0.0;
+    workersJob=0;
+    workersBusy=0;
+    workersQuit=false;
+    multiStartTmo=CARTSLV_DEFAULT_MULTISTART_TMO;
+    backend="ipopt";
+    localOutNew=false;
+    localQuit=false;
 
     prt=NULL;
     slv=NULL;
@@ -1136,6 +1345,12 @@ void CartesianSolver::send(const Vector &xd, const Vector &x, const Vector &q,
     if (tok!=NULL)
         addTokenOption(b,*tok);
 
+    // latch the result for the in-process readers
+    mtx_local.lock();
+    localOut=b;
+    localOutNew=true;
+    mtx_local.unlock();
+
     outPort->writeStrict();
 }
 
@@ -1396,7 +1611,14 @@ bool CartesianSolver::open(Searchable &options)
     int maxIter=options.check("maxIter",Value(CARTSLV_DEFAULT_MAXITER)).asInt32();
 
     // instantiate the optimizer
-    slv=new iKinIpOptMin(*prt->chn,ctrlPose,tol,constr_tol,maxIter);
+    backend=options.check("backend",Value("ipopt")).asString();
+    if (backend=="dls")
+        slv=new iKinDLSMin(*prt->chn,ctrlPose,tol,constr_tol,maxIter);
+    else
+    {
+        backend="ipopt";
+        slv=new iKinIpOptMin(*prt->chn,ctrlPose,tol,constr_tol,maxIter);
+    }
 
     // instantiate solver callback object if required    
     if (options.check("interPoints"))
@@ -1422,6 +1644,26 @@ bool CartesianSolver::open(Searchable &options)
     xd_2ndTask.resize(3,0.0);
     w_2ndTask.resize(3,0.0);
 
+    // set up the warm-start cache and the parallel solver instances
+    cache.setCapacity(std::max(options.check("warmStartCache",Value(0)).asInt32(),0));
+    multiStartTmo=options.check("multiStartTmo",Value(CARTSLV_DEFAULT_MULTISTART_TMO)).asFloat64();
+    int multiStart=options.check("multiStart",Value(1)).asInt32();
+    if ((multiStart>1) && (backend!="dls"))
+    {
+        // concurrent Ipopt instances are safe only with a linear solver
+        // that does not share state across threads (not the case of MUMPS)
+        string linear_solver=slv->getLinearSolver();
+        const char *safe_solvers[]={"ma27","ma57","ma77","ma86","ma97","pardisomkl","spral"};
+        if (find(begin(safe_solvers),end(safe_solvers),linear_solver)==end(safe_solvers))
+        {
+            yWarning("%s: Ipopt linear solver \"%s\" is not thread-safe => multiStart clamped to 1",
+                     slvName.c_str(),linear_solver.c_str());
+            multiStart=1;
+        }
+    }
+    if (multiStart>1)
+        startWorkers(multiStart,tol,constr_tol,maxIter);
+
     // define input port
     inPort=new InputPort(this);
     inPort->useCallback();
@@ -1471,6 +1713,9 @@ bool CartesianSolver::changeDOF(const Vector &_dof)
         if (prt->cns!=NULL)
             prt->cns->update(NULL);
 
+        // cached solutions refer to the old dof
+        cache.clear();
+
         // count uncontrolled joints
         countUncontrolledJoints();
 
@@ -1511,13 +1756,347 @@ void CartesianSolver::prepareJointsRestTask()
 }
 
 
+/************************************************************************/
+double CartesianSolver::evalSolution(const Vector &xd, const Vector &x, const bool full)
+{
+    double err=0.0;
+    for (size_t i=0; i<3; i++)
+        err+=(xd[i]-x[i])*(xd[i]-x[i]);
+    err=sqrt(err);
+
+    if (full && (xd.length()>=7) && (x.length()>=7))
+    {
+        Matrix R=axis2dcm(xd.subVector(3,6))*axis2dcm(x.subVector(3,6)).transposed();
+        err+=fabs(dcm2axis(R)[3]);
+    }
+
+    return err;
+}
+
+
+/************************************************************************/
+void CartesianSolver::startWorkers(const int n, const double tol, const double constr_tol,
+                                   const int maxIter)
+{
+    for (int i=0; i<n; i++)
+    {
+        SolverWorker *w=new SolverWorker;
+        w->lmb=new iKinLimb(*prt->lmb);
+        if (backend=="dls")
+            w->slv=new iKinDLSMin(*w->lmb->asChain(),ctrlPose,tol,constr_tol,maxIter);
+        else
+            w->slv=new iKinIpOptMin(*w->lmb->asChain(),ctrlPose,tol,constr_tol,maxIter);
+        w->slv->setUserScaling(true,100.0,100.0,100.0);
+        if (prt->cns!=NULL)
+            w->slv->attachLIC(w->cns);
+        w->weight2ndTask=0.0;
+        w->err=0.0;
+        w->halt=false;
+        w->thr=thread(&CartesianSolver::runWorker,this,w);
+        workers.push_back(w);
+    }
+
+    yInfo("%s: %d solver instances started",slvName.c_str(),n);
+}
+
+
+/************************************************************************/
+void CartesianSolver::stopWorkers()
+{
+    {
+        lock_guard<mutex> lck(mtx_workers);
+        workersQuit=true;
+    }
+    cv_workersStart.notify_all();
+
+    for (size_t i=0; i<workers.size(); i++)
+    {
+        workers[i]->thr.join();
+        delete workers[i]->slv;
+        delete workers[i]->lmb;
+        delete workers[i];
+    }
+
+    workers.clear();
+}
+
+
+/************************************************************************/
+void CartesianSolver::syncWorker(SolverWorker *w)
+{
+    // align bounds and blocked links to the ones of the solver's chain
+    iKinChain &chn=*w->lmb->asChain();
+    for (unsigned int i=0; i<prt->chn->getN(); i++)
+    {
+        iKinLink &src=(*prt->chn)[i];
+        chn[i].setMin(src.getMin());
+        chn[i].setMax(src.getMax());
+
+        if (src.isBlocked())
+        {
+            if (chn[i].isBlocked())
+                chn.setBlockingValue(i,src.getAng());
+            else
+                chn.blockLink(i,src.getAng());
+        }
+        else if (chn[i].isBlocked())
+            chn.releaseLink(i);
+    }
+
+    if (prt->cns!=NULL)
+        w->cns=*prt->cns;
+
+    unsigned int n2nd=slv->get2ndTaskChain().getN();
+    if (w->slv->get2ndTaskChain().getN()!=n2nd)
+        w->slv->specify2ndTaskEndEff(n2nd);
+
+    w->slv->set_ctrlPose(slv->get_ctrlPose());
+    w->slv->set_posePriority(slv->get_posePriority());
+    w->slv->setTol(slv->getTol());
+    w->slv->setConstrTol(slv->getConstrTol());
+    w->slv->setMaxIter(slv->getMaxIter());
+}
+
+
+/************************************************************************/
+namespace
+{
+    // copies the halt request of a worker into the flag polled by the
+    // solver, at each iteration and within the thread of the worker
+    class WorkerHaltCallback : public iKinIterateCallback
+    {
+        const atomic<bool> &request;
+        bool &halt;
+
+    public:
+        WorkerHaltCallback(const atomic<bool> &request_, bool &halt_) :
+                           request(request_), halt(halt_) { }
+
+        void exec(const Vector &xd, const Vector &q)
+        {
+            halt=request.load();
+        }
+    };
+}
+
+
+/************************************************************************/
+void CartesianSolver::runWorker(SolverWorker *w)
+{
+    bool halt=false;
+    WorkerHaltCallback haltClb(w->halt,halt);
+    unsigned int job=0;
+    while (true)
+    {
+        {
+            unique_lock<mutex> lck(mtx_workers);
+            cv_workersStart.wait(lck,[&]() { return workersQuit || (workersJob!=job); });
+            if (workersQuit)
+                return;
+            job=workersJob;
+        }
+
+        halt=false;
+        w->q=w->slv->solve(w->q0,w->xd,w->weight2ndTask,w->xd_2nd,w->w_2nd,
+                           CARTSLV_WEIGHT_3RD_TASK,w->qd_3rd,w->w_3rd,
+                           NULL,&halt,&haltClb);
+        w->err=evalSolution(w->xd,w->lmb->asChain()->EndEffPose(w->q),
+                            w->slv->get_ctrlPose()==IKINCTRL_POSE_FULL);
+
+        {
+            lock_guard<mutex> lck(mtx_workers);
+            workersBusy--;
+        }
+        cv_workersDone.notify_all();
+    }
+}
+
+
 /************************************************************************/
 Vector CartesianSolver::solve(Vector &xd)
 {
-    return slv->solve(prt->chn->getAng(),xd,
-                      slv->get2ndTaskChain().getN()>0?CARTSLV_WEIGHT_2ND_TASK:0.0,xd_2ndTask,w_2ndTask,
-                      CARTSLV_WEIGHT_3RD_TASK,qd_3rdTask,w_3rdTask,
-                      NULL,NULL,clb);
+    if (workers.size()>0)
+        return solveMultiStart(xd);
+
+    bool full=(slv->get_ctrlPose()==IKINCTRL_POSE_FULL);
+    Vector q0=prt->chn->getAng();
+
+    // start from the solution of the nearest past target
+    // if the latter is closer than the current pose
+    if (cache.getCapacity()>0)
+    {
+        deque<Vector> seeds;
+        deque<double> dist;
+        if (cache.lookup(xd,full,1,seeds,dist)>0)
+            if ((seeds[0].length()==q0.length()) &&
+                (dist[0]<SolutionCache::distance(xd,prt->chn->EndEffPose(),full)))
+                q0=seeds[0];
+    }
+
+    Vector q=slv->solve(q0,xd,
+                        slv->get2ndTaskChain().getN()>0?CARTSLV_WEIGHT_2ND_TASK:0.0,xd_2ndTask,w_2ndTask,
+                        CARTSLV_WEIGHT_3RD_TASK,qd_3rdTask,w_3rdTask,
+                        NULL,NULL,clb);
+
+    if (cache.getCapacity()>0)
+        if (evalSolution(xd,prt->chn->EndEffPose(q),full)<CARTSLV_CACHE_MAX_ERR)
+            cache.add(xd,q);
+
+    return q;
+}
+
+
+/************************************************************************/
+Vector CartesianSolver::solveMultiStart(Vector &xd)
+{
+    bool full=(slv->get_ctrlPose()==IKINCTRL_POSE_FULL);
+    Vector q0=prt->chn->getAng();
+    size_t n=workers.size();
+
+    // seeds: the current configuration, the solutions of the nearest
+    // past targets and random configurations within the bounds
+    deque<Vector> seeds;
+    seeds.push_back(q0);
+    if (cache.getCapacity()>0)
+    {
+        deque<Vector> cached;
+        deque<double> dist;
+        cache.lookup(xd,full,n/2,cached,dist);
+        for (size_t i=0; i<cached.size(); i++)
+            if (cached[i].length()==q0.length())
+                seeds.push_back(cached[i]);
+    }
+
+    while (seeds.size()<n)
+    {
+        Vector q(q0.length());
+        for (size_t i=0; i<q.length(); i++)
+        {
+            uniform_real_distribution<double> range((*prt->chn)(i).getMin(),(*prt->chn)(i).getMax());
+            q[i]=range(seedGen);
+        }
+        seeds.push_back(q);
+    }
+
+    double weight2ndTask=slv->get2ndTaskChain().getN()>0?CARTSLV_WEIGHT_2ND_TASK:0.0;
+    for (size_t i=0; i<n; i++)
+    {
+        SolverWorker *w=workers[i];
+        syncWorker(w);
+        w->q0=seeds[i];
+        w->xd=xd;
+        w->weight2ndTask=weight2ndTask;
+        w->xd_2nd=xd_2ndTask;
+        w->w_2nd=w_2ndTask;
+        w->qd_3rd=qd_3rdTask;
+        w->w_3rd=w_3rdTask;
+        w->halt=false;
+    }
+
+    // run all the instances and halt those still running at the deadline
+    {
+        unique_lock<mutex> lck(mtx_workers);
+        workersBusy=(int)n;
+        workersJob++;
+        cv_workersStart.notify_all();
+
+        if (!cv_workersDone.wait_for(lck,chrono::duration<double>(multiStartTmo),
+                                     [this]() { return workersBusy==0; }))
+        {
+            for (size_t i=0; i<n; i++)
+                workers[i]->halt=true;
+            cv_workersDone.wait(lck,[this]() { return workersBusy==0; });
+        }
+    }
+
+    // errors below the tolerance are deemed equal, so that
+    // the earlier seeds are preferred among good solutions
+    size_t best=0;
+    for (size_t i=1; i<n; i++)
+        if (std::max(workers[i]->err,CARTSLV_MULTISTART_EPS)<
+            std::max(workers[best]->err,CARTSLV_MULTISTART_EPS))
+            best=i;
+
+    Vector q=workers[best]->q;
+    prt->chn->setAng(q);
+
+    if ((cache.getCapacity()>0) && (workers[best]->err<CARTSLV_CACHE_MAX_ERR))
+        cache.add(xd,q);
+
+    return q;
+}
+
+
+/************************************************************************/
+void CartesianSolver::runLocalLink()
+{
+    // serve the requests posted in-process as soon as they arrive;
+    // they are handled here rather than by the poster since handling
+    // may have to wait for the solver to complete the ongoing
+    // optimization, whereas run() is mutually exclusive with the
+    // periodic execution, which then finds the request already served
+    unique_lock<mutex> lck(mtx_local);
+    while (true)
+    {
+        cv_local.wait(lck,[this]() { return (!localIn.empty() || localQuit); });
+        if (localQuit)
+            break;
+
+        deque<Bottle> requests;
+        requests.swap(localIn);
+        lck.unlock();
+
+        for (size_t i=0; i<requests.size(); i++)
+            inPort->handleRequest(requests[i]);
+
+        if (isRunning() && !isSuspended())
+            run();
+
+        lck.lock();
+    }
+}
+
+
+/************************************************************************/
+bool CartesianSolver::postLocal(const Bottle &request)
+{
+    if (!configured || closing)
+        return false;
+
+    lock_guard<mutex> lck(mtx_local);
+    if (!localThr.joinable())
+        localThr=thread(&CartesianSolver::runLocalLink,this);
+
+    localIn.push_back(request);
+    cv_local.notify_one();
+    return true;
+}
+
+
+/************************************************************************/
+bool CartesianSolver::readLocal(Bottle &result)
+{
+    lock_guard<mutex> lck(mtx_local);
+    if (localOutNew)
+    {
+        result=localOut;
+        localOutNew=false;
+        return true;
+    }
+    else
+        return false;
+}
+
+
+/************************************************************************/
+bool CartesianSolver::rpcLocal(const Bottle &command, Bottle &reply)
+{
+    if (isClosed())
+        return false;
+
+    reply.clear();
+    respond(command,reply);
+    return true;
 }
 
 
@@ -1536,9 +2115,18 @@ void CartesianSolver::close()
 
     closing=true;
 
+    mtx_local.lock();
+    localQuit=true;
+    cv_local.notify_one();
+    mtx_local.unlock();
+    if (localThr.joinable())
+        localThr.join();
+
     if (isRunning())
         stop();
 
+    stopWorkers();
+
     if (inPort!=NULL)
     {
         inPort->interrupt();
@@ -0,0 +1,150 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+ * Copyright (C) 2023 iCub Facility - Istituto Italiano di Tecnologia
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#ifndef __CANBROADCASTTABLE__
+#define __CANBROADCASTTABLE__
+
+#include <vector>
+
+/*
+ * Dispatch table of the broadcast messages handled by CanBusMotionControl.
+ * A broadcast is identified by class, source address and message type, that
+ * is by the 11 bits of its CAN id, thus the table has one slot per id which
+ * tells how to decode the message and which axes it refers to. The table is
+ * built once at open(), so that decoding a message does not need to search
+ * the boards or the torque sensors attached to the axes.
+ */
+class CanBroadcastTable
+{
+public:
+    enum
+    {
+        ignore = 0,         // message not handled
+        board = 1,          // class 1 message of a control board of this network
+        unknownBoard = 2,   // class 1 message of a board which is not of this network
+        strain = 3          // class 3 message of a strain sensor attached to some axes
+    };
+
+    struct Slot
+    {
+        unsigned char decoder;  // one of the above
+        unsigned char type;     // message type, i.e. 4 lsb of the id
+        short joint;            // first joint of the control board
+        unsigned short first;   // first strain target
+        unsigned short count;   // number of strain targets
+    };
+
+    // an axis whose torque is measured by a channel of a strain message
+    struct StrainTarget
+    {
+        int axis;
+        int chan;           // channel within the message (0, 1 or 2)
+        double scale;       // sensor units to Newtons
+    };
+
+    CanBroadcastTable()
+    {
+        slots.resize(2048);
+        clear();
+    }
+
+    void clear()
+    {
+        for (size_t i=0; i<slots.size(); i++)
+        {
+            slots[i].decoder=ignore;
+            slots[i].type=(unsigned char)(i&0x0f);
+            slots[i].joint=-1;
+            slots[i].first=0;
+            slots[i].count=0;
+        }
+        targets.clear();
+    }
+
+    /*
+     * Fills the table.
+     * @param njoints number of joints.
+     * @param destinations addresses of the control boards (two joints each), as in CanBusResources.
+     * @param ncards size of destinations.
+     * @param sensorId address of the strain attached to each joint.
+     * @param sensorChan channel of the strain attached to each joint.
+     * @param newtonsToSensor conversion factor of each joint.
+     */
+    void build(int njoints, const unsigned char *destinations, int ncards,
+               const int *sensorId, const int *sensorChan, const double *newtonsToSensor)
+    {
+        clear();
+
+        for (int addr=0; addr<16; addr++)
+        {
+            // the first board having this address, as searched by the former decoder
+            int j;
+            for (j=0; j<ncards; j++)
+                if (destinations[j]==addr)
+                    break;
+
+            for (int type=0; type<16; type++)
+            {
+                Slot &s=slots[0x100|(addr<<4)|type];
+                if (j<ncards)
+                {
+                    s.decoder=board;
+                    s.joint=(short)(2*j);
+                }
+                else
+                    s.decoder=unknownBoard;
+            }
+
+            // strain messages 0x0A and 0x0B carry the channels 0..2 and 3..5 respectively
+            for (int type=0x0A; type<=0x0B; type++)
+            {
+                const int off=(type-0x0A)*3;
+                Slot &s=slots[0x300|(addr<<4)|type];
+                s.decoder=strain;
+                s.first=(unsigned short)targets.size();
+                for (int axis=0; axis<njoints; axis++)
+                {
+                    if ((sensorId[axis]==addr) && (sensorChan[axis]>=off) && (sensorChan[axis]<off+3))
+                    {
+                        StrainTarget t;
+                        t.axis=axis;
+                        t.chan=sensorChan[axis]-off;
+                        t.scale=1/newtonsToSensor[axis];
+                        targets.push_back(t);
+                    }
+                }
+                s.count=(unsigned short)(targets.size()-s.first);
+            }
+        }
+    }
+
+    inline const Slot &lookup(unsigned int id) const
+    {
+        return slots[id&0x7ff];
+    }
+
+    inline const StrainTarget *strainTargets(const Slot &s) const
+    {
+        return (s.count>0) ? &targets[s.first] : 0;
+    }
+
+private:
+    std::vector<Slot> slots;
+    std::vector<StrainTarget> targets;
+};
+
+#endif
@@ -35,6 +35,7 @@
 
 #include "ThreadTable2.h"
 #include "ThreadPool2.h"
+#include "CanBroadcastTable.h"
 
 /// specific to this device driver.
 #include "CanBusMotionControl.h"
@@ -2413,6 +2414,7 @@ ImplementCurrentControl(this)
     ACE_ASSERT (system_resources != NULL);
     _opened = false;
     _axisTorqueHelper = 0;
+    broadcastTable = 0;
     _firmwareVersionHelper = 0;
     _speedEstimationHelper = 0;
     _MCtorqueControlEnabled = false;
@@ -2678,6 +2680,10 @@ bool CanBusMotionControl::open (Searchable &config)
 
     threadPool = new ThreadPool2(res.iBufferFactory);
 
+    broadcastTable = new CanBroadcastTable;
+    broadcastTable->build(p._njoints, res._destinations, CAN_MAX_CARDS,
+                          p._torqueSensorId, p._torqueSensorChan, p._newtonsToSensor);
+
     PeriodicThread::setPeriod((double)p._polling_interval/1000.0);
     PeriodicThread::start();
 
@@ -3033,6 +3039,8 @@ bool CanBusMotionControl::close (void)
 
     if (threadPool != 0)
        {delete threadPool; threadPool = 0;}
+    if (broadcastTable != 0)
+       {delete broadcastTable; broadcastTable = 0;}
     if (_axisTorqueHelper != 0)
        {delete _axisTorqueHelper; _axisTorqueHelper = 0;}
     if (_firmwareVersionHelper != 0)
@@ -3085,36 +3093,23 @@ void CanBusMotionControl::handleBroadcasts()
             id=m.getId();
             len=m.getLen();
 
-            if ((id & 0x700) == 0x300) // class = 3 These messages come from analog sensors
+            // the dispatch table built at open() tells how to decode the message and which axes it refers to
+            const CanBroadcastTable::Slot &slot = broadcastTable->lookup(id);
+
+            if (slot.decoder == CanBroadcastTable::strain) // class = 3 These messages come from analog sensors
             {
-                // 4 next bits = source address, next 4 bits = msg type
-                const unsigned int addr = ((id & 0x0f0) >> 4);
-                const unsigned int type =   id & 0x00f;
-                if  (type == 0x0A || type == 0x0B) //strain messages
+                // strain messages 0x0A and 0x0B: each target is an axis whose torque sensor is on this board and channel
+                const CanBroadcastTable::StrainTarget *target = broadcastTable->strainTargets(slot);
+                for (int k=0; k<slot.count; k++, target++)
                 {
-                    int off = (type-0x0A)*3;
-                    for (int axis=0; axis<r.getJoints(); axis++)
-                    {
-                        int attached_board = _axisTorqueHelper->getTorqueSensorId(axis);
-                        if ( attached_board == addr)
-                        {
-                            for(int chan=0;chan<3;chan++)
-                            {
-                                int attached_channel = _axisTorqueHelper->getTorqueSensorChan(axis);
-                                if ( attached_channel == chan+off)
-                                {
-                                    double scaleFactor = 1/_axisTorqueHelper->getNewtonsToSensor(axis);
-                                    r._bcastRecvBuffer[axis]._torque=(((unsigned short)(data[2*chan+1]))<<8)+data[2*chan]-0x8000;
-                                    r._bcastRecvBuffer[axis]._torque=r._bcastRecvBuffer[axis]._torque*scaleFactor;
-                                    //r._bcastRecvBuffer[axis]._torque=0;
-                                    r._bcastRecvBuffer[axis]._update_t = before;
-                                }
-                            }
-                        }
-                    }
+                    const int axis = target->axis;
+                    const int chan = target->chan;
+                    r._bcastRecvBuffer[axis]._torque=(((unsigned short)(data[2*chan+1]))<<8)+data[2*chan]-0x8000;
+                    r._bcastRecvBuffer[axis]._torque=r._bcastRecvBuffer[axis]._torque*target->scale;
+                    r._bcastRecvBuffer[axis]._update_t = before;
                 }
             }
-            else if ((id & 0x700) == 0x100) // class = 1 These messages come from the control boards.
+            else if ((slot.decoder == CanBroadcastTable::board) || (slot.decoder == CanBroadcastTable::unknownBoard)) // class = 1 These messages come from the control boards.
             {
                 // 4 next bits = source address, next 4 bits = msg type
                 // this allows sending two 32-bit numbers is a single CAN message.
@@ -3122,17 +3117,8 @@ void CanBusMotionControl::handleBroadcasts()
                 // need an array here for storing the messages on a per-joint basis.
                 const int addr = ((id & 0x0f0) >> 4);
                 int j;
-                bool found=false;
-                for (j = 0; j < CAN_MAX_CARDS; j++)
-                {
-                    if (r._destinations[j] == addr)
-                    {
-                        found = true;
-                        break;
-                    }
-                }
 
-                if (!found)
+                if (slot.decoder == CanBroadcastTable::unknownBoard)
                 {
                     static int count=0;
                     if (count%5000==0)
@@ -3152,10 +3138,10 @@ void CanBusMotionControl::handleBroadcasts()
                 }
                 else
                 {
-                    j *= 2;
+                    j = slot.joint;
 
                     /* less sign nibble specifies msg type */
-                    switch (id & 0x00f)
+                    switch (slot.type)
                     {
                     case ICUBCANPROTO_PER_MC_MSG__OVERFLOW:
 
@@ -4528,34 +4514,74 @@ bool CanBusMotionControl::setImpedanceOffsetRaw (int axis, double off)
     return true;
 }
 
+// messages requested in a batch to read a position pid, and their decoding
+static const int posPidMessages[]=
+{
+    ICUBCANPROTO_POL_MC_CMD__GET_P_GAIN,
+    ICUBCANPROTO_POL_MC_CMD__GET_D_GAIN,
+    ICUBCANPROTO_POL_MC_CMD__GET_I_GAIN,
+    ICUBCANPROTO_POL_MC_CMD__GET_ILIM_GAIN,
+    ICUBCANPROTO_POL_MC_CMD__GET_OFFSET,
+    ICUBCANPROTO_POL_MC_CMD__GET_SCALE,
+    ICUBCANPROTO_POL_MC_CMD__GET_TLIM,
+    ICUBCANPROTO_POL_MC_CMD__GET_POS_STICTION_PARAMS
+};
+static const int posPidMessagesNum=sizeof(posPidMessages)/sizeof(posPidMessages[0]);
+
+static void decodePosPid(const CanReadRequest *rq, Pid *out)
+{
+    out->kp = double(*((short *)(rq[0].payload)));
+    out->kd = double(*((short *)(rq[1].payload)));
+    out->ki = double(*((short *)(rq[2].payload)));
+    out->max_int = double(*((short *)(rq[3].payload)));
+    out->offset = double(*((short *)(rq[4].payload)));
+    out->scale = double(*((short *)(rq[5].payload)));
+    out->max_output = double(*((short *)(rq[6].payload)));
+    out->stiction_up_val = double(*((short *)(rq[7].payload)));
+    out->stiction_down_val = double(*((short *)(rq[7].payload+2)));
+}
+
+// messages requested in a batch to read a torque pid, and their decoding
+static const int trqPidMessages[]=
+{
+    ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_PID,
+    ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_PIDLIMITS,
+    ICUBCANPROTO_POL_MC_CMD__GET_MODEL_PARAMS,
+    ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_STICTION_PARAMS
+};
+static const int trqPidMessagesNum=sizeof(trqPidMessages)/sizeof(trqPidMessages[0]);
+
+static void decodeTrqPid(const CanReadRequest *rq, Pid *out)
+{
+    out->kp = *((short *)(rq[0].payload));
+    out->ki = *((short *)(rq[0].payload+2));
+    out->kd = *((short *)(rq[0].payload+4));
+    out->scale = *((char *)(rq[0].payload+6));
+    out->offset = *((short *)(rq[1].payload));
+    out->max_output = *((short *)(rq[1].payload+2));
+    out->max_int = *((short *)(rq[1].payload+4));
+    out->kff = *((short *)(rq[2].payload));
+    out->stiction_up_val = double(*((short *)(rq[3].payload)));
+    out->stiction_down_val = double(*((short *)(rq[3].payload+2)));
+}
+
 bool CanBusMotionControl::helper_getPosPidRaw (int axis, Pid *out)
 {
     //    ACE_ASSERT (axis >= 0 && axis <= (CAN_MAX_CARDS-1)*2);
     if (!(axis >= 0 && axis <= (CAN_MAX_CARDS-1)*2))
         return false;
 
-    short s;
-    short s2;
-
-    DEBUG_FUNC("Calling GET_P_GAIN\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_P_GAIN, axis, s); out->kp = double(s);
-    DEBUG_FUNC("Calling CAN_GET_D_GAIN\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_D_GAIN, axis, s); out->kd = double(s);
-    DEBUG_FUNC("Calling CAN_GET_I_GAIN\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_I_GAIN, axis, s); out->ki = double(s);
-    DEBUG_FUNC("Calling CAN_GET_ILIM_GAIN\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_ILIM_GAIN, axis, s); out->max_int = double(s);
-    DEBUG_FUNC("Calling CAN_GET_OFFSET\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_OFFSET, axis, s); out->offset= double(s);
-    DEBUG_FUNC("Calling CAN_GET_SCALE\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_SCALE, axis, s); out->scale = double(s);
-    DEBUG_FUNC("Calling CAN_GET_TLIM\n");
-    _readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_TLIM, axis, s); out->max_output = double(s);
-    DEBUG_FUNC("Calling CAN_GET_POS_STICTION_PARAMS\n");
-    _readWord16Ex (ICUBCANPROTO_POL_MC_CMD__GET_POS_STICTION_PARAMS, axis, s, s2 ); out->stiction_up_val = double(s); out->stiction_down_val = double(s2);
+    // all the gains are requested at once and we wait a single round-trip
+    DEBUG_FUNC("Calling GET_P_GAIN ... GET_POS_STICTION_PARAMS\n");
+    std::vector<CanReadRequest> rq;
+    for (int k = 0; k < posPidMessagesNum; k++)
+        rq.push_back(CanReadRequest(axis, posPidMessages[k]));
+
+    bool ret = _readBatch(rq);
+    decodePosPid(rq.data(), out);
     DEBUG_FUNC("Get PID done!\n");
-    
-    return true;
+
+    return ret;
 }
 
 bool CanBusMotionControl::getPidRaw (const PidControlTypeEnum& pidtype, int axis, Pid *pid)
@@ -4589,10 +4615,44 @@ bool CanBusMotionControl::getPidsRaw (const PidControlTypeEnum& pidtype, Pid *pi
 {
     CanBusResources& r = RES(system_resources);
 
+    const int *msgs = 0;
+    int nmsgs = 0;
+    void (*decode)(const CanReadRequest *, Pid *) = 0;
+
+    switch (pidtype)
+    {
+        case VOCAB_PIDTYPE_POSITION:
+            msgs = posPidMessages; nmsgs = posPidMessagesNum; decode = decodePosPid;
+        break;
+        case VOCAB_PIDTYPE_TORQUE:
+            msgs = trqPidMessages; nmsgs = trqPidMessagesNum; decode = decodeTrqPid;
+        break;
+        default:
+        break;
+    }
+
     int i;
+    if (decode == 0)
+    {
+        for (i = 0; i < r.getJoints(); i++)
+        {
+            getPidRaw(pidtype,i,&pids[i]);
+        }
+        return true;
+    }
+
+    // the requests of all the joints go in the same batch, thus the cost is
+    // bound by the bandwidth of the bus rather than by its latency
+    std::vector<CanReadRequest> rq;
+    for (i = 0; i < r.getJoints(); i++)
+        for (int k = 0; k < nmsgs; k++)
+            rq.push_back(CanReadRequest(i, msgs[k]));
+
+    _readBatch(rq);
+
     for (i = 0; i < r.getJoints(); i++)
     {
-        getPidRaw(pidtype,i,&pids[i]);
+        decode(&rq[i*nmsgs], &pids[i]);
     }
 
     return true;
@@ -4647,143 +4707,28 @@ bool CanBusMotionControl::helper_getTrqPidRaw (int axis, Pid *out)
 {
     DEBUG_FUNC("Calling CAN_GET_TORQUE_PID \n");
 
-    CanBusResources& r = RES(system_resources);
     if (!(axis >= 0 && axis <= (CAN_MAX_CARDS-1)*2))
         return false;
 
- 
- 
     if (!ENABLED(axis))
     {
         //@@@ TODO: check here
         // value = 0;
         return true;
     }
- 
-    _mutex.lock();
-    int id;
-    if (!threadPool->getId(id))
-    {
-        yError("More than %d threads, cannot allow more\n", CANCONTROL_MAX_THREADS);
-        _mutex.unlock();
-        return false;
-    }
 
-    r.startPacket();
-    r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_PID);
-    r.writePacket();
+    // pid, limits, model and stiction parameters are requested at once
+    std::vector<CanReadRequest> rq;
+    for (int k = 0; k < trqPidMessagesNum; k++)
+        rq.push_back(CanReadRequest(axis, trqPidMessages[k]));
 
-    ThreadTable2 *t=threadPool->getThreadTable(id);
-    t->setPending(r._writeMessages);
-    _mutex.unlock();
-    t->synch();
-
-    if (!r.getErrorStatus() || (t->timedOut()))
+    if (!_readBatch(rq))
     {
         yError("getTorquePid: message timed out\n");
-        //@@@ TODO: check here
-        // value=0;
-        return false;
-    }
-
-    CanMessage *m=t->get(0);
-    if (m==0)
-    {
-        //@@@ TODO: check here
-        // value=0;
         return false;
     }
 
-    unsigned char *data;
-    data=m->getData()+1;
-    out->kp= *((short *)(data));
-    data+=2;
-    out->ki= *((short *)(data));
-    data+=2;
-    out->kd= *((short *)(data));
-    data+=2;
-    out->scale= *((char *)(data));
-
-    t->clear();
-
-    _mutex.lock();
-    
-    DEBUG_FUNC("Calling CAN_GET_TORQUE_PIDLIMITS\n");
-   
-    r.startPacket();
-    r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_PIDLIMITS);
-    r.writePacket();
-
-    // ThreadTable2 *t=threadPool->getThreadTable(id);
-    t->setPending(r._writeMessages);
-    _mutex.unlock();
-    t->synch();
-
-    if (!r.getErrorStatus() || (t->timedOut()))
-    {
-        yError("getTorquePidLimits: message timed out\n");
-        //@@@ TODO: check here
-        // value=0;
-        return false;
-    }
-
-    m=t->get(0);
-    if (m==0)
-    {
-        //@@@ TODO: check here
-        // value=0;
-        return false;
-    }
-
-    data=m->getData()+1;
-    out->offset= *((short *)(data));
-    data+=2;
-    out->max_output= *((short *)(data));
-    data+=2;
-    out->max_int= *((short *)(data));
-
-    t->clear();
-
-    _mutex.lock();
-    
-    DEBUG_FUNC("Calling CAN_GET_MODEL_PARAMS\n");
-   
-    r.startPacket();
-    r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_MODEL_PARAMS);
-    r.writePacket();
-
-    // ThreadTable2 *t=threadPool->getThreadTable(id);
-    t->setPending(r._writeMessages);
-    _mutex.unlock();
-    t->synch();
-
-    if (!r.getErrorStatus() || (t->timedOut()))
-    {
-        yError("CAN_GET_MODEL_PARAMS: message timed out\n");
-        //@@@ TODO: check here
-        // value=0;
-        return false;
-    }
-
-    m=t->get(0);
-    if (m==0)
-    {
-        //@@@ TODO: check here
-        // value=0;
-        return false;
-    }
-
-    data=m->getData()+1;
-    out->kff= *((short *)(data));
-
-    t->clear();
-
-    DEBUG_FUNC("Calling CAN_GET_TORQUE_STICTION_PARAMS\n");
-    short s1;
-    short s2;
-    _readWord16Ex (ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_STICTION_PARAMS, axis, s1, s2 );
-    out->stiction_up_val = double(s1); 
-    out->stiction_down_val = double(s2);
+    decodeTrqPid(rq.data(), out);
 
     return true;
 }
@@ -5706,17 +5651,19 @@ bool CanBusMotionControl::getRefAccelerationsRaw (double *accs)
 {
     CanBusResources& r = RES(system_resources);
     int i;
-    short value = 0;
+
+    std::vector<CanReadRequest> rq;
+    for(i = 0; i < r.getJoints(); i++)
+        rq.push_back(CanReadRequest(i, ICUBCANPROTO_POL_MC_CMD__GET_DESIRED_ACCELER));
+
+    if (!_readBatch(rq))
+        return false;
 
     for(i = 0; i < r.getJoints(); i++)
     {
-        if (_readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_DESIRED_ACCELER, i, value) == true) {
-            _ref_accs[i] = accs[i] = double (value);
-            accs[i] *= 1000.0;
-            accs[i] *= 1000.0;
-        }
-        else
-            return false;
+        _ref_accs[i] = accs[i] = double (*((short *)(rq[i].payload)));
+        accs[i] *= 1000.0;
+        accs[i] *= 1000.0;
     }
 
     return true;
@@ -5746,15 +5693,17 @@ bool CanBusMotionControl::getRefTorquesRaw (double *ref_trqs)
 {
     CanBusResources& r = RES(system_resources);
     int i;
-    short value = 0;
+
+    std::vector<CanReadRequest> rq;
+    for(i = 0; i < r.getJoints(); i++)
+        rq.push_back(CanReadRequest(i, ICUBCANPROTO_POL_MC_CMD__GET_DESIRED_TORQUE));
+
+    if (!_readBatch(rq))
+        return false;
 
     for(i = 0; i < r.getJoints(); i++)
     {
-        if (_readWord16 (ICUBCANPROTO_POL_MC_CMD__GET_DESIRED_TORQUE, i, value) == true) {
-            _ref_torques[i] = ref_trqs[i] = double (value);
-        }
-        else
-            return false;
+        _ref_torques[i] = ref_trqs[i] = double (*((short *)(rq[i].payload)));
     }
 
     return true;
@@ -6490,20 +6439,19 @@ bool CanBusMotionControl::getLimitsRaw(int axis, double *min, double *max)
 {
     if (!(axis >= 0 && axis <= (CAN_MAX_CARDS-1)*2))
         return false;
-    int iMin=0;
-    int iMax=0;
-    bool ret=true;
 
-    ret = ret && _readDWord (ICUBCANPROTO_POL_MC_CMD__GET_MIN_POSITION, axis, iMin);
-    ret = ret && _readDWord (ICUBCANPROTO_POL_MC_CMD__GET_MAX_POSITION, axis, iMax);
+    std::vector<CanReadRequest> rq;
+    rq.push_back(CanReadRequest(axis, ICUBCANPROTO_POL_MC_CMD__GET_MIN_POSITION));
+    rq.push_back(CanReadRequest(axis, ICUBCANPROTO_POL_MC_CMD__GET_MAX_POSITION));
+
+    bool ret = _readBatch(rq);
 
-    *min=iMin;
-    *max=iMax;
+    *min=*((int *)(rq[0].payload));
+    *max=*((int *)(rq[1].payload));
 
     return ret;
 }
 
-
 ////////////////////////////////////////
 //     Position control2 interface    //
 ////////////////////////////////////////
@@ -7279,6 +7227,99 @@ bool CanBusMotionControl::_readWord16Array (int msg, double *out)
     return true;
 }
 
+/// reads a batch of messages, possibly of different types and for different axes, with a
+/// single write of the packet and a single wait for all the replies. the replies are matched
+/// to the requests by axis and message type, thus the same pair cannot be requested twice
+/// in a batch. disabled axes are not requested and read as zero.
+bool CanBusMotionControl::_readBatch (std::vector<CanReadRequest> &requests)
+{
+    CanBusResources& r = RES(system_resources);
+    bool ret = true;
+    size_t first = 0;
+
+    while (first < requests.size())
+    {
+        _mutex.lock();
+        int id;
+        if (!threadPool->getId(id))
+        {
+            yError("More than %d threads, cannot allow more\n", CANCONTROL_MAX_THREADS);
+            _mutex.unlock();
+            return false;
+        }
+
+        // we fill the packet up to the capacity of the buffers of messages and replies
+        r.startPacket();
+        size_t last = first;
+        for (; (last < requests.size()) && (r._writeMessages < BUF_SIZE); last++)
+        {
+            CanReadRequest &rq = requests[last];
+            memset(rq.payload, 0, sizeof(rq.payload));
+            rq.ok = false;
+
+            if (!(rq.axis >= 0 && rq.axis < r.getJoints()))
+            {
+                ret = false;
+                continue;
+            }
+
+            if (!ENABLED(rq.axis))
+            {
+                rq.ok = true;
+                continue;
+            }
+
+            r.addMessage (id, rq.axis, rq.msg);
+        }
+
+        if (r._writeMessages < 1)
+        {
+            _mutex.unlock();
+            first = last;
+            continue;
+        }
+
+        r.writePacket();
+
+        ThreadTable2 *t=threadPool->getThreadTable(id);
+        DEBUG_FUNC("readBatch: going to wait for %d replies %d\n", r._writeMessages, id);
+        t->setPending(r._writeMessages);
+        _mutex.unlock();
+        t->synch();
+
+        bool timedOut = !r.getErrorStatus() || t->timedOut();
+        if (timedOut)
+        {
+            yError("readBatch: at least one message timed out\n");
+            ret = false;
+        }
+
+        for (size_t k = first; k < last; k++)
+        {
+            CanReadRequest &rq = requests[k];
+            if (rq.ok || !(rq.axis >= 0 && rq.axis < r.getJoints()))
+                continue;
+
+            // after a time out the list of replies may hold stale messages, thus it is not used
+            CanMessage *m = timedOut ? 0 : t->getByJointAndType(rq.axis, rq.msg, r._destInv);
+            if ( (m!=0) && (m->getId() != 0xffff) )
+            {
+                memcpy(rq.payload, m->getData()+1, sizeof(rq.payload));
+                rq.ok = true;
+            }
+            else
+            {
+                ret = false;
+            }
+        }
+
+        t->clear();
+        first = last;
+    }
+
+    return ret;
+}
+
 yarp::dev::DeviceDriver *CanBusMotionControl::createDevice(yarp::os::Searchable& config)
 {
     //analogSensor
@@ -22,6 +22,7 @@
 #include <yarp/os/PeriodicThread.h>
 #include <string>
 #include <list>
+#include <vector>
 #include <mutex>
 
 #include <iCub/FactoryInterface.h>
@@ -37,6 +38,24 @@ namespace yarp{
 
 class ThreadPool2;
 class RequestsQueue;
+class CanBroadcastTable;
+
+// one request of a batch read (see CanBusMotionControl::_readBatch): the reply to message msg
+// for the given axis. payload holds the bytes of the reply following the message type.
+struct CanReadRequest
+{
+    int axis;
+    int msg;
+    bool ok;
+    unsigned char payload[7];
+
+    CanReadRequest(int a=0, int m=0) : axis(a), msg(m), ok(false)
+    {
+        for (int i=0; i<7; i++)
+            payload[i]=0;
+    }
+};
+
 struct SpeedEstimationParameters
 {
     double jnt_Vel_estimator_shift;
@@ -1123,6 +1142,7 @@ protected:
     bool _noreply;
     bool _opened;
     ThreadPool2 *threadPool;
+    CanBroadcastTable *broadcastTable;
 
     /**
     * filter for recurrent messages.
@@ -1153,6 +1173,7 @@ protected:
     bool _writeNone  (int msg, int axis);
     bool _writeByte8 (int msg, int axis, int value);
     bool _readByte8(int msg, int axis, int& value);
+    bool _readBatch (std::vector<CanReadRequest> &requests);
     bool _writeByteWords16(int msg, int axis, unsigned char value, short s1, short s2, short s3);
     axisTorqueHelper      *_axisTorqueHelper;
     axisImpedanceHelper   *_axisImpedanceHelper;
@@ -103,6 +103,9 @@ public:
     //get can message from joint number
     inline yarp::dev::CanMessage *getByJoint(int j, const unsigned char *destInv);
 
+    //get can message from joint number and message type, for batches of different requests
+    inline yarp::dev::CanMessage *getByJointAndType(int j, unsigned char type, const unsigned char *destInv);
+
     //get n-nth message in the list of replies
     inline yarp::dev::CanMessage *get(int n);
 };
@@ -123,6 +126,14 @@ yarp::dev::CanMessage *ThreadTable2::getByJoint(int j, const unsigned char *dest
     return 0;
 }
 
+yarp::dev::CanMessage *ThreadTable2::getByJointAndType(int j, unsigned char type, const unsigned char *destInv)
+{
+    for(int k=0;k<_replied;k++)
+        if ((getJoint(_replies[k], destInv)==j) && (getMessageType(_replies[k])==(type&0x7f)))
+            return &_replies[k];
+    return 0;
+}
+
 bool ThreadTable2::push(const yarp::dev::CanMessage &m)
 {
     lock();
@@ -30,6 +30,10 @@
 
 #include <iCub/iKin/iKinVocabs.h>
 
+#ifdef CARTCTRL_LOCAL_SOLVER
+    #include <iCub/iKin/iKinSlv.h>
+#endif
+
 #define CARTCTRL_SERVER_VER                 "2.0"
 #define CARTCTRL_DEFAULT_PER                0.01    // [s]
 #define CARTCTRL_DEFAULT_TASKVEL_PERFACTOR  4
@@ -196,6 +200,9 @@ void ServerCartesianController::init()
     portCmd     =NULL;
     rpcProcessor=NULL;
 
+    localSlv=NULL;
+    localSlvEnabled=false;
+
     attached     =false;
     connected    =false;
     closed       =true;
@@ -219,6 +226,7 @@ void ServerCartesianController::init()
     txTokenLatchedGoToRpc=0.0;
     skipSlvRes=false;
     syncEventEnabled=false;
+    latencyPending=false;
 
     contextIdCnt=0;
 }
@@ -234,16 +242,22 @@ void ServerCartesianController::openPorts()
     string prefixName="/";
     prefixName=prefixName+ctrlName;
 
-    portSlvIn.open(prefixName+"/"+slvName+"/in");
-    portSlvOut.open(prefixName+"/"+slvName+"/out");
-    portSlvRpc.open(prefixName+"/"+slvName+"/rpc");
+    if (!localSlvEnabled)
+    {
+        portSlvIn.open(prefixName+"/"+slvName+"/in");
+        portSlvOut.open(prefixName+"/"+slvName+"/out");
+        portSlvRpc.open(prefixName+"/"+slvName+"/rpc");
+    }
     portCmd->open(prefixName+"/command:i");
     portState.open(prefixName+"/state:o");
     portEvent.open(prefixName+"/events:o");
     portRpc.open(prefixName+"/rpc:i");
 
     if (debugInfoEnabled)
+    {
         portDebugInfo.open(prefixName+"/dbg:o");
+        portDebugLatency.open(prefixName+"/dbg/latency:o");
+    }
 }
 
 
@@ -277,7 +291,9 @@ void ServerCartesianController::closePorts()
     if (debugInfoEnabled)
     {
         portDebugInfo.interrupt();
+        portDebugLatency.interrupt();
         portDebugInfo.close();
+        portDebugLatency.close();
     }
 
     delete rpcProcessor;
@@ -351,7 +367,7 @@ bool ServerCartesianController::respond(const Bottle &command, Bottle &reply)
                 // just behave as a relay
                 Bottle slvCommand=command;
 
-                if (!portSlvRpc.write(slvCommand,reply))
+                if (!askSolver(slvCommand,reply))
                 {
                     yError("%s: unable to get reply from solver!",ctrlName.c_str());
                     reply.addVocab32(IKINCARTCTRL_VOCAB_REP_NACK);
@@ -1191,7 +1207,7 @@ void ServerCartesianController::createController()
 /************************************************************************/
 bool ServerCartesianController::getNewTarget()
 {
-    if (Bottle *b1=portSlvIn.read(false))
+    if (Bottle *b1=readSolverResult())
     {
         bool tokened=getTokenOption(*b1,&rxToken);
 
@@ -1280,6 +1296,103 @@ bool ServerCartesianController::getNewTarget()
 }
 
 
+/************************************************************************/
+bool ServerCartesianController::openLocalSolver()
+{
+#ifdef CARTCTRL_LOCAL_SOLVER
+    if (localSlv==NULL)
+    {
+        yInfo("%s: Instantiating cartesian solver %s in-process...",ctrlName.c_str(),slvName.c_str());
+
+        if (kinPart=="arm")
+            localSlv=new iCubArmCartesianSolver(slvName);
+        else if (kinPart=="leg")
+            localSlv=new iCubLegCartesianSolver(slvName);
+        else
+        {
+            yError("%s: in-process solver not available for the %s kinematic part",
+                   ctrlName.c_str(),kinPart.c_str());
+            return false;
+        }
+
+        if (!localSlv->open(localSlvOptions))
+        {
+            yError("%s: unable to open the in-process solver %s",ctrlName.c_str(),slvName.c_str());
+            closeLocalSolver();
+            return false;
+        }
+    }
+
+    return true;
+#else
+    yError("%s: in-process solver not available since iKin has been built without IPOPT",
+           ctrlName.c_str());
+    return false;
+#endif
+}
+
+
+/************************************************************************/
+void ServerCartesianController::closeLocalSolver()
+{
+#ifdef CARTCTRL_LOCAL_SOLVER
+    if (localSlv!=NULL)
+    {
+        localSlv->close();
+        delete localSlv;
+        localSlv=NULL;
+    }
+#endif
+}
+
+
+/************************************************************************/
+Bottle &ServerCartesianController::prepareSolverRequest()
+{
+    return (localSlvEnabled?localSlvIn:portSlvOut.prepare());
+}
+
+
+/************************************************************************/
+void ServerCartesianController::writeSolverRequest()
+{
+#ifdef CARTCTRL_LOCAL_SOLVER
+    if (localSlvEnabled)
+    {
+        if (localSlv!=NULL)
+            localSlv->postLocal(localSlvIn);
+        return;
+    }
+#endif
+
+    portSlvOut.writeStrict();
+}
+
+
+/************************************************************************/
+Bottle *ServerCartesianController::readSolverResult()
+{
+#ifdef CARTCTRL_LOCAL_SOLVER
+    if (localSlvEnabled)
+        return (((localSlv!=NULL) && localSlv->readLocal(localSlvOut))?&localSlvOut:NULL);
+#endif
+
+    return portSlvIn.read(false);
+}
+
+
+/************************************************************************/
+bool ServerCartesianController::askSolver(const Bottle &command, Bottle &reply)
+{
+#ifdef CARTCTRL_LOCAL_SOLVER
+    if (localSlvEnabled)
+        return ((localSlv!=NULL) && localSlv->rpcLocal(command,reply));
+#endif
+
+    return portSlvRpc.write(command,reply);
+}
+
+
 /************************************************************************/
 bool ServerCartesianController::areJointsHealthyAndSet(vector<int> &jointsToSet)
 {    
@@ -1664,6 +1777,9 @@ void ServerCartesianController::run()
 
                 motionOngoingEventsCurrent=motionOngoingEvents;
                 q0=fb;
+
+                // the token of the reply is the time of the goTo request
+                latencyPending=debugInfoEnabled;
             }
         }
 
@@ -1713,6 +1829,23 @@ void ServerCartesianController::run()
                 }
                 else
                     (this->*sendCtrlCmd)();
+
+                if (latencyPending)
+                {
+                    latencyPending=false;
+                    if (portDebugLatency.getOutputCount()>0)
+                    {
+                        double now=Time::now();
+                        Bottle &latency=portDebugLatency.prepare();
+                        latency.clear();
+                        latency.addFloat64(rxToken);
+                        latency.addFloat64(now);
+                        latency.addFloat64(now-rxToken);
+                        latency.addString(localSlvEnabled?"local":"port");
+                        portDebugLatency.setEnvelope(txInfo);
+                        portDebugLatency.writeStrict();
+                    }
+                }
             }
         }        
 
@@ -1870,7 +2003,30 @@ bool ServerCartesianController::open(Searchable &config)
 
     debugInfoEnabled=optGeneral.check("DebugInfo",Value("off")).asString()=="on";
     if (debugInfoEnabled)
-        yDebug("Commands to robot will be also streamed out on debug port");
+        yDebug("Commands to robot will be also streamed out on debug port, along with the goTo latency");
+
+    // SOLVER group
+    Bottle &optSolver=config.findGroup("SOLVER");
+    localSlvEnabled=!optSolver.isNull();
+#ifndef CARTCTRL_LOCAL_SOLVER
+    if (localSlvEnabled)
+    {
+        yWarning("SOLVER group ignored: in-process solver not available without IPOPT");
+        localSlvEnabled=false;
+    }
+#endif
+    if (localSlvEnabled && (kinPart!="arm") && (kinPart!="leg"))
+    {
+        yWarning("SOLVER group ignored: in-process solver not available for the %s kinematic part",kinPart.c_str());
+        localSlvEnabled=false;
+    }
+    if (localSlvEnabled)
+    {
+        yInfo("SOLVER group detected: the solver will be instantiated in-process");
+        localSlvOptions.fromString(optSolver.tail().toString());
+        if (!localSlvOptions.check("type"))
+            localSlvOptions.put("type",kinType);
+    }
 
     // scan DRIVER groups
     for (int i=0; i<numDrv; i++)
@@ -2013,6 +2169,7 @@ bool ServerCartesianController::close()
         return true;
 
     detachAll();
+    closeLocalSolver();
 
     delete limbState;
     delete limbPlan;
@@ -2247,6 +2404,9 @@ bool ServerCartesianController::detachAll()
 /************************************************************************/
 bool ServerCartesianController::pingSolver()
 {    
+    if (localSlvEnabled)
+        return openLocalSolver();
+
     string portSlvName="/";
     portSlvName=portSlvName+slvName+"/in";    
 
@@ -2263,23 +2423,28 @@ bool ServerCartesianController::connectToSolver()
 {
     if (attached && !connected && pingSolver())
     {        
-        yInfo("%s: Connecting to cartesian solver %s...",ctrlName.c_str(),slvName.c_str());
+        if (localSlvEnabled)
+            yInfo("%s: Linked in-process to cartesian solver %s",ctrlName.c_str(),slvName.c_str());
+        else
+        {
+            yInfo("%s: Connecting to cartesian solver %s...",ctrlName.c_str(),slvName.c_str());
 
-        string portSlvName="/";
-        portSlvName=portSlvName+slvName;
+            string portSlvName="/";
+            portSlvName=portSlvName+slvName;
 
-        bool ok=true;
+            bool ok=true;
 
-        ok&=Network::connect(portSlvName+"/out",portSlvIn.getName(),"udp");
-        ok&=Network::connect(portSlvOut.getName(),portSlvName+"/in","udp");
-        ok&=Network::connect(portSlvRpc.getName(),portSlvName+"/rpc");
+            ok&=Network::connect(portSlvName+"/out",portSlvIn.getName(),"udp");
+            ok&=Network::connect(portSlvOut.getName(),portSlvName+"/in","udp");
+            ok&=Network::connect(portSlvRpc.getName(),portSlvName+"/rpc");
 
-        if (ok)
-            yInfo("%s: Connections established with %s",ctrlName.c_str(),slvName.c_str());
-        else
-        {
-            yError("%s: Problems detected while connecting to %s",ctrlName.c_str(),slvName.c_str());
-            return false;
+            if (ok)
+                yInfo("%s: Connections established with %s",ctrlName.c_str(),slvName.c_str());
+            else
+            {
+                yError("%s: Problems detected while connecting to %s",ctrlName.c_str(),slvName.c_str());
+                return false;
+            }
         }
 
         // this line shall be put before any
@@ -2292,7 +2457,7 @@ bool ServerCartesianController::connectToSolver()
         command.addVocab32(IKINSLV_VOCAB_OPT_DOF);
 
         // send command to solver and wait for reply
-        if (!portSlvRpc.write(command,reply))
+        if (!askSolver(command,reply))
         {
             yError("%s: unable to get reply from solver!",ctrlName.c_str());         
             return false;
@@ -2337,7 +2502,7 @@ bool ServerCartesianController::goTo(unsigned int _ctrlPose, const Vector &xd,
         if (t>0.0)
             setTrajTimeHelper(t);
 
-        Bottle &b=portSlvOut.prepare();
+        Bottle &b=prepareSolverRequest();
         b.clear();
     
         // xd part
@@ -2358,7 +2523,7 @@ bool ServerCartesianController::goTo(unsigned int _ctrlPose, const Vector &xd,
         if (latchToken)
             txTokenLatchedGoToRpc=txToken;
 
-        portSlvOut.writeStrict();
+        writeSolverRequest();
         return true;
     }
     else
@@ -2378,7 +2543,7 @@ bool ServerCartesianController::setTrackingModeHelper(const bool f)
 
         // send command to solver and wait for reply
         bool ret=false;
-        if (!portSlvRpc.write(command,reply))
+        if (!askSolver(command,reply))
             yError("%s: unable to get reply from solver!",ctrlName.c_str());         
         else if (reply.get(0).asVocab32()==IKINSLV_VOCAB_REP_ACK)
         {
@@ -2454,7 +2619,7 @@ bool ServerCartesianController::setPosePriority(const string &p)
         command.addVocab32(p=="position"?IKINSLV_VOCAB_VAL_PRIO_XYZ:IKINSLV_VOCAB_VAL_PRIO_ANG);
 
         // send command to solver and wait for reply
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
             ret=(reply.get(0).asVocab32()==IKINSLV_VOCAB_REP_ACK);
         else
             yError("%s: unable to get reply from solver!",ctrlName.c_str());
@@ -2475,7 +2640,7 @@ bool ServerCartesianController::getPosePriority(string &p)
         command.addVocab32(IKINSLV_VOCAB_OPT_PRIO);
 
         // send command to solver and wait for reply
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
         {
             if (ret=(reply.get(0).asVocab32()==IKINSLV_VOCAB_REP_ACK))
                 p=(reply.get(1).asVocab32()==IKINSLV_VOCAB_VAL_PRIO_XYZ)?
@@ -2661,7 +2826,7 @@ bool ServerCartesianController::askForPose(const Vector &xd, const Vector &od,
 
     // send command and wait for reply
     bool ret=false;
-    if (portSlvRpc.write(command,reply))
+    if (askSolver(command,reply))
         ret=getDesiredOption(reply,xdhat,odhat,qdhat);
     else
         yError("%s: unable to get reply from solver!",ctrlName.c_str());         
@@ -2695,7 +2860,7 @@ bool ServerCartesianController::askForPose(const Vector &q0, const Vector &xd,
 
     // send command and wait for reply
     bool ret=false;
-    if (portSlvRpc.write(command,reply))
+    if (askSolver(command,reply))
         ret=getDesiredOption(reply,xdhat,odhat,qdhat);
     else
         yError("%s: unable to get reply from solver!",ctrlName.c_str());         
@@ -2720,7 +2885,7 @@ bool ServerCartesianController::askForPosition(const Vector &xd, Vector &xdhat,
 
     // send command and wait for reply
     bool ret=false;
-    if (portSlvRpc.write(command,reply))
+    if (askSolver(command,reply))
         ret=getDesiredOption(reply,xdhat,odhat,qdhat);
     else
         yError("%s: unable to get reply from solver!",ctrlName.c_str());         
@@ -2747,7 +2912,7 @@ bool ServerCartesianController::askForPosition(const Vector &q0, const Vector &x
 
     // send command and wait for reply
     bool ret=false;
-    if (portSlvRpc.write(command,reply))
+    if (askSolver(command,reply))
         ret=getDesiredOption(reply,xdhat,odhat,qdhat);
     else
         yError("%s: unable to get reply from solver!",ctrlName.c_str());         
@@ -2790,7 +2955,7 @@ bool ServerCartesianController::setDOF(const Vector &newDof, Vector &curDof)
     
         // send command to solver and wait for reply
         bool ret=false;
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
         {
             // update chain's links
             // skip the first ack/nack vocab
@@ -2838,7 +3003,7 @@ bool ServerCartesianController::getRestPos(Vector &curRestPos)
     
         // send command to solver and wait for reply
         bool ret=false;
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
         {
             Bottle *rxRestPart=reply.get(1).asList();
             curRestPos.resize(rxRestPart->size());
@@ -2872,7 +3037,7 @@ bool ServerCartesianController::setRestPos(const Vector &newRestPos,
     
         // send command to solver and wait for reply
         bool ret=false;
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
         {
             Bottle *rxRestPart=reply.get(1).asList();
             curRestPos.resize(rxRestPart->size());
@@ -2904,7 +3069,7 @@ bool ServerCartesianController::getRestWeights(Vector &curRestWeights)
     
         // send command to solver and wait for reply
         bool ret=false;
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
         {
             Bottle *rxRestPart=reply.get(1).asList();
             curRestWeights.resize(rxRestPart->size());
@@ -2938,7 +3103,7 @@ bool ServerCartesianController::setRestWeights(const Vector &newRestWeights,
     
         // send command to solver and wait for reply
         bool ret=false;
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
         {
             Bottle *rxRestPart=reply.get(1).asList();
             curRestWeights.resize(rxRestPart->size());
@@ -2973,7 +3138,7 @@ bool ServerCartesianController::getLimits(const int axis, double *min,
             command.addInt32(axis);
 
             // send command to solver and wait for reply
-            if (!portSlvRpc.write(command,reply))
+            if (!askSolver(command,reply))
                 yError("%s: unable to get reply from solver!",ctrlName.c_str());         
             else if (reply.get(0).asVocab32()==IKINSLV_VOCAB_REP_ACK)
             {
@@ -3005,7 +3170,7 @@ bool ServerCartesianController::setLimits(const int axis, const double min,
         command.addFloat64(max);
 
         // send command to solver and wait for reply        
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
             ret=(reply.get(0).asVocab32()==IKINSLV_VOCAB_REP_ACK);
         else
             yError("%s: unable to get reply from solver!",ctrlName.c_str());
@@ -3219,7 +3384,7 @@ bool ServerCartesianController::attachTipFrame(const Vector &x, const Vector &o)
 
         // send command to solver and wait for reply
         bool ret=false;
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
         {
             if (ret=(reply.get(0).asVocab32()==IKINSLV_VOCAB_REP_ACK))
             {
@@ -3715,7 +3880,7 @@ bool ServerCartesianController::getTask2ndOptions(Value &v)
         command.addVocab32(IKINSLV_VOCAB_OPT_TASK2);
 
         // send command to solver and wait for reply
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
         {
             if (ret=(reply.get(0).asVocab32()==IKINSLV_VOCAB_REP_ACK))
                 v=reply.get(1);
@@ -3742,7 +3907,7 @@ bool ServerCartesianController::setTask2ndOptions(const Value &v)
         command.add(v);
 
         // send command to solver and wait for reply
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
             ret=(reply.get(0).asVocab32()==IKINSLV_VOCAB_REP_ACK);
         else
             yError("%s: unable to get reply from solver!",ctrlName.c_str());
@@ -3763,7 +3928,7 @@ bool ServerCartesianController::getSolverConvergenceOptions(Bottle &options)
         command.addVocab32(IKINSLV_VOCAB_OPT_CONVERGENCE);
 
         // send command to solver and wait for reply
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
         {
             if (ret=(reply.get(0).asVocab32()==IKINSLV_VOCAB_REP_ACK))
                 options=*reply.get(1).asList();
@@ -3790,7 +3955,7 @@ bool ServerCartesianController::setSolverConvergenceOptions(const Bottle &option
         command.addList()=options;
 
         // send command to solver and wait for reply
-        if (portSlvRpc.write(command,reply))
+        if (askSolver(command,reply))
             ret=(reply.get(0).asVocab32()==IKINSLV_VOCAB_REP_ACK);
         else
             yError("%s: unable to get reply from solver!",ctrlName.c_str());        
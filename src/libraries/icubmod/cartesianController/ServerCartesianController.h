@@ -41,6 +41,8 @@
 
 class ServerCartesianController;
 
+namespace iCub { namespace iKin { class CartesianSolver; } }
+
 
 struct DriverDescriptor
 {
@@ -100,6 +102,23 @@ public:
 * |:-----------------:|
 * | `servercartesiancontroller` |
 *
+* If the configuration contains the group `SOLVER`, the solver is
+* instantiated within the device rather than being connected through
+* the ports of the iKinCartesianSolver module: the group holds the
+* options of the solver (e.g. `robot`, `pose`, `mode`, as in the
+* configuration file of the module; `type` defaults to the
+* `KinematicType`) and the solver is named after
+* `SolverNameToConnect`. Targets, results and commands are then
+* exchanged in-process and each target is processed as soon as it
+* is posted, skipping the serialization, the network stack and the
+* wait for the next period of the solver. This applies to the arm
+* and leg kinematic parts and requires iKin to be built with IPOPT.
+*
+* With `DebugInfo on`, for each new target the port
+* `/<ControllerName>/dbg/latency:o` streams the time of the goTo
+* request, the time of the first command sent to the robot after
+* the reply of the solver and their difference [s], followed by
+* `local` or `port` according to the link with the solver.
 */
 class ServerCartesianController : public    yarp::dev::DeviceDriver,
                                   public    yarp::dev::IMultipleWrapper,
@@ -168,6 +187,7 @@ protected:
     double       txTokenLatchedGoToRpc;    
     bool         skipSlvRes;
     bool         syncEventEnabled;
+    bool         latencyPending;
 
     std::mutex mtx;
     std::mutex mtx_syncEvent;
@@ -188,9 +208,16 @@ protected:
     yarp::os::BufferedPort<yarp::os::Bottle>   portSlvOut;
     yarp::os::RpcClient                        portSlvRpc;
 
+    iCub::iKin::CartesianSolver               *localSlv;
+    yarp::os::Property                         localSlvOptions;
+    bool                                       localSlvEnabled;
+    yarp::os::Bottle                           localSlvIn;
+    yarp::os::Bottle                           localSlvOut;
+
     yarp::os::BufferedPort<yarp::sig::Vector>  portState;
     yarp::os::BufferedPort<yarp::os::Bottle>   portEvent;
     yarp::os::BufferedPort<yarp::os::Bottle>   portDebugInfo;
+    yarp::os::BufferedPort<yarp::os::Bottle>   portDebugLatency;
     yarp::os::RpcServer                        portRpc;
 
     CartesianCtrlCommandPort                  *portCmd;
@@ -235,6 +262,12 @@ protected:
     double getFeedback(yarp::sig::Vector &_fb);
     void   createController();
     bool   getNewTarget();
+    bool   openLocalSolver();
+    void   closeLocalSolver();
+    yarp::os::Bottle &prepareSolverRequest();
+    void   writeSolverRequest();
+    yarp::os::Bottle *readSolverResult();
+    bool   askSolver(const yarp::os::Bottle &command, yarp::os::Bottle &reply);
     bool   areJointsHealthyAndSet(std::vector<int> &jointsToSet);
     void   setJointsCtrlMode(const std::vector<int> &jointsToSet);
     void   stopLimb(const bool execStopPosition=true);
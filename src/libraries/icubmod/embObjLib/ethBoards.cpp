@@ -274,7 +274,9 @@ eth::AbstractEthResource* eth::EthBoards::get_resource(eOipv4addr_t ipv4)
     uint8_t index = 0;
     eo_common_ipv4addr_to_decimal(ipv4, NULL, NULL, NULL, &index);
     index --;
-    if(index<maxEthBoards)
+    // the LUT is indexed by the last byte of the address, thus we also verify that the whole address matches
+    // so that packets coming from a different network are not given to the board
+    if((index<maxEthBoards) && (ipv4 == LUT[index].ipv4))
     {
         ret = LUT[index].resource;
     }
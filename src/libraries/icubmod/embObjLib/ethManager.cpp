@@ -82,7 +82,8 @@ using namespace eth;
 //               that is the same behaviour of the former yarp::os::Semaphore initted w/ value 1
 std::mutex TheEthManager::managerSem {}; 
 std::mutex TheEthManager::txSem {};
-std::mutex TheEthManager::rxSem {};
+std::shared_timed_mutex TheEthManager::rxSem {};
+std::mutex TheEthManager::rxBoardSem[TheEthManager::maxBoards] {};
 
 TheEthManager* TheEthManager::handle {nullptr};
 
@@ -91,6 +92,8 @@ TheEthManager::TheEthManager()
     // it is a singleton. the constructor is private.
     communicationIsInitted = false;
     UDP_socket  = NULL;
+    embBoardsConnected = true;
+    fakeBoardsRX = false;
 
     // the container of ethernet boards: resources and attached interfaces
     ethBoards = new(eth::EthBoards);
@@ -316,9 +319,10 @@ bool TheEthManager::initCommunication(yarp::os::Searchable &cfgtotal)
     int rxrate = pc104data.rxrate;
     eOipv4addressing_t tmpaddress = pc104data.localaddressing;
     embBoardsConnected = pc104data.embBoardsConnected;
+    fakeBoardsRX = (!embBoardsConnected) && pc104data.fakeBoardsRX;
 
     // localaddress
-    if(false == createCommunicationObjects(tmpaddress, txrate, rxrate) )
+    if(false == createCommunicationObjects(tmpaddress, txrate, rxrate, pc104data.rxmode, pc104data.rxcores) )
     {
         yError () << "TheEthManager::initCommunication() cannot create communication objects";
         return false;
@@ -531,7 +535,7 @@ double TheEthManager::getLifeTime(void)
 
 
 
-bool TheEthManager::createCommunicationObjects(const eOipv4addressing_t &localaddress, int txrate, int rxrate)
+bool TheEthManager::createCommunicationObjects(const eOipv4addressing_t &localaddress, int txrate, int rxrate, const std::string &rxmode, const std::vector<int> &rxcores)
 {
     lock(true);
 
@@ -540,7 +544,7 @@ bool TheEthManager::createCommunicationObjects(const eOipv4addressing_t &localad
     if(!communicationIsInitted)
     {
         UDP_socket = new ACE_SOCK_Dgram();
-        if((embBoardsConnected)  && (-1 == UDP_socket->open(inetaddr)))
+        if((embBoardsConnected || fakeBoardsRX)  && (-1 == UDP_socket->open(inetaddr)))
         {
             char tmp[64] = {0};
             inetaddr.addr_to_string(tmp, 64);
@@ -564,8 +568,13 @@ bool TheEthManager::createCommunicationObjects(const eOipv4addressing_t &localad
             {
                 rxrate = EthReceiver::EthReceiverDefaultRate;
             }
+            EthReceiver::Mode mode = EthReceiver::Mode::poll;
+            if(false == EthReceiver::string2mode(rxmode, mode))
+            {
+                yWarning() << "TheEthManager::createCommunicationObjects() does not know PC104RXmode =" << rxmode << ", thus using poll";
+            }
             sender = new eth::EthSender(txrate);
-            receiver = new eth::EthReceiver(rxrate);
+            receiver = new eth::EthReceiver(rxrate, mode, rxcores);
 
             sender->config(UDP_socket, this);
             receiver->config(UDP_socket, this);
@@ -663,18 +672,20 @@ ACE_INET_Addr TheEthManager::toaceinet(const eOipv4addressing_t &ipv4addressing)
 
 bool TheEthManager::Reception(eOipv4addr_t from, uint64_t* data, ssize_t size)
 {
-    lockRX(true);
+    lockRXshared(true);
 
     eth::AbstractEthResource* r = ethBoards->get_resource(from);
 
-    if((size >=0) && (NULL != r) && (!r->isFake()))
+    if((size >=0) && (NULL != r) && (!r->isFake() || fakeBoardsRX))
     {
+        lockRXboard(from, true);
         r->Tick();
 
         if(false == r->processRXpacket(data, size))
         {   // cannot give packet to ethresource
             yError() << "TheEthManager::Reception() cannot give a received packet of size" << size << "to EthResource because EthResource::processRXpacket() returns false.";
         }
+        lockRXboard(from, false);
 
     }
     else
@@ -683,13 +694,82 @@ bool TheEthManager::Reception(eOipv4addr_t from, uint64_t* data, ssize_t size)
     //    yError() << "TheEthManager::Reception cannot get a ethres associated to address" << address;
     }
 
-    lockRX(false);
+    lockRXshared(false);
 
 
     return(true);
 }
 
 
+bool TheEthManager::Reception(const eOipv4addr_t *from, uint64_t * const *data, const ssize_t *size, size_t n)
+{
+    // stable ordering of the packets by board, so that each EthResource is served in a row.
+    // n is small (it is the capacity of the receiver ring), thus an insertion sort is enough.
+    uint16_t order[256];
+    if(n > 256)
+    {
+        n = 256;
+    }
+    for(size_t i=0; i<n; i++)
+    {
+        size_t j = i;
+        while((j > 0) && (from[order[j-1]] > from[i]))
+        {
+            order[j] = order[j-1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    lockRXshared(true);
+
+    eOipv4addr_t prev = 0;
+    eth::AbstractEthResource* r = NULL;
+
+    for(size_t k=0; k<n; k++)
+    {
+        size_t i = order[k];
+
+        if((0 == k) || (from[i] != prev))
+        {
+            if((0 != k) && (NULL != r))
+            {
+                lockRXboard(prev, false);
+            }
+            prev = from[i];
+            r = ethBoards->get_resource(from[i]);
+            if((NULL != r) && (r->isFake()) && (!fakeBoardsRX))
+            {
+                r = NULL;
+            }
+            if(NULL != r)
+            {
+                lockRXboard(prev, true);
+            }
+        }
+
+        if((size[i] >=0) && (NULL != r))
+        {
+            r->Tick();
+
+            if(false == r->processRXpacket(data[i], size[i]))
+            {   // cannot give packet to ethresource
+                yError() << "TheEthManager::Reception() cannot give a received packet of size" << size[i] << "to EthResource because EthResource::processRXpacket() returns false.";
+            }
+        }
+    }
+
+    if((n > 0) && (NULL != r))
+    {
+        lockRXboard(prev, false);
+    }
+
+    lockRXshared(false);
+
+    return(true);
+}
+
+
 
 int TheEthManager::getNumberOfResources(void)
 {
@@ -753,6 +833,44 @@ bool TheEthManager::lockRX(bool on)
     return true;
 }
 
+bool TheEthManager::lockRXshared(bool on)
+{
+    if(on)
+    {
+        rxSem.lock_shared();
+    }
+    else
+    {
+        rxSem.unlock_shared();
+    }
+
+    return true;
+}
+
+
+bool TheEthManager::lockRXboard(eOipv4addr_t ipv4, bool on)
+{
+    uint8_t index = 0;
+    eo_common_ipv4addr_to_decimal(ipv4, NULL, NULL, NULL, &index);
+    index --;
+    if(index >= maxBoards)
+    {
+        return false;
+    }
+
+    if(on)
+    {
+        rxBoardSem[index].lock();
+    }
+    else
+    {
+        rxBoardSem[index].unlock();
+    }
+
+    return true;
+}
+
+
 bool TheEthManager::lockTXRX(bool on)
 {
     if(on)
@@ -30,6 +30,7 @@
 #include <string>
 #include <stdio.h>
 #include <mutex>
+#include <shared_mutex>
 //#include <map>
 
 
@@ -125,6 +126,12 @@ namespace eth {
 
         bool Reception(eOipv4addr_t from, uint64_t* data, ssize_t size);
 
+        // it processes n packets under a single acquisition of the rx lock. the packets of the same board are
+        // given to its EthResource one after the other, in the order of their reception.
+        // it can be called concurrently by several threads: packets of different boards are parsed in parallel
+        // whereas those of the same board are serialised by a lock dedicated to the board.
+        bool Reception(const eOipv4addr_t *from, uint64_t * const *data, const ssize_t *size, size_t n);
+
         eth::AbstractEthResource* getEthResource(eOipv4addr_t ipv4);
 
         IethResource* getInterface(eOipv4addr_t ipv4, eOprotID32_t id32);
@@ -144,7 +151,7 @@ namespace eth {
 
         bool isCommunicationInitted(void);
 
-        bool createCommunicationObjects(const eOipv4addressing_t &localaddress, int txrate, int rxrate);
+        bool createCommunicationObjects(const eOipv4addressing_t &localaddress, int txrate, int rxrate, const std::string &rxmode = "poll", const std::vector<int> &rxcores = {});
 
         bool initCommunication(yarp::os::Searchable &cfgtotal);
 
@@ -155,6 +162,9 @@ namespace eth {
         bool lockTX(bool on);
         bool lockRX(bool on);
         bool lockTXRX(bool on);
+        // it allows concurrent receptions, which are excluded only by lockRX() and lockTXRX()
+        bool lockRXshared(bool on);
+        bool lockRXboard(eOipv4addr_t ipv4, bool on);
 
 
     private:
@@ -165,7 +175,9 @@ namespace eth {
         static std::mutex managerSem;
         // the following two semaphore are used separately or together to stop tx and rx if a change is done on ethboards (in startup and shutdown phases)
         static std::mutex txSem;
-        static std::mutex rxSem;
+        static std::shared_timed_mutex rxSem;
+        // it serialises the parsing of the packets of a given board
+        static std::mutex rxBoardSem[maxBoards];
 
         static eth::TheEthManager* handle;
 
@@ -181,6 +193,7 @@ namespace eth {
         eth::EthReceiver* receiver;
         ACE_SOCK_Dgram* UDP_socket;
         bool embBoardsConnected;
+        bool fakeBoardsRX;      // in debug mode, the fake resources receive the packets sent from the addresses of the boards
 
     };
 
@@ -62,6 +62,8 @@ bool eth::parser::print(const pc104Data &pc104data)
     yDebug() << "PC104/PC104IpAddress:PC104IpPort = " << pc104data.addressingstring;
     yDebug() << "PC104/PC104TXrate = " << pc104data.txrate;
     yDebug() << "PC104/PC104RXrate = " << pc104data.rxrate;
+    yDebug() << "PC104/PC104RXmode = " << pc104data.rxmode;
+    yDebug() << "PC104/PC104RXcores = " << pc104data.rxcores.size() << "rx workers";
 
     return true;
 }
@@ -102,6 +104,13 @@ bool eth::parser::read(yarp::os::Searchable &cfgtotal, pc104Data &pc104data)
     if(!pc104data.embBoardsConnected)
     {
         yError() << "ATTENTION: NO EMBEDDED BOARDS CONNECTED. YOU ARE IN DEBUG MODE";
+
+        // the packets sent from the addresses of the boards (e.g. by benchmarks/ethFakeBoards)
+        // are received and parsed by the fake resources
+        if ((! groupDEBUG.isNull()) && (groupDEBUG.check("fakeBoardsRX")))
+        {
+            pc104data.fakeBoardsRX = groupDEBUG.find("fakeBoardsRX").asBool();
+        }
     }
 
     // localaddress
@@ -173,6 +182,27 @@ bool eth::parser::read(yarp::os::Searchable &cfgtotal, pc104Data &pc104data)
         yWarning () << "eth::parser::read() cannot find ETH/PC104RXrate. thus using default value" << pc104data.rxrate;
     }
 
+    // rxmode: it is optional and can be poll (default), batch or event
+    if(cfgtotal.findGroup("PC104").check("PC104RXmode"))
+    {
+        pc104data.rxmode = cfgtotal.findGroup("PC104").find("PC104RXmode").asString();
+    }
+
+    // rxcores: it is optional and used only in modes batch and event. it is the list of the cores where to
+    // pin the rx workers which parse the packets, one worker per core. if missing, the packets are parsed
+    // by the thread of EthReceiver
+    if(cfgtotal.findGroup("PC104").check("PC104RXcores"))
+    {
+        Bottle *cores = cfgtotal.findGroup("PC104").find("PC104RXcores").asList();
+        if(nullptr != cores)
+        {
+            for(size_t i=0; i<cores->size(); i++)
+            {
+                pc104data.rxcores.push_back(cores->get(i).asInt32());
+            }
+        }
+    }
+
     // now i print all the found values
 
     //print(pc104data);
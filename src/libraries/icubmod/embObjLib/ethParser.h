@@ -24,6 +24,7 @@
 #define _ETHPARSER_H_
 
 #include <string>
+#include <vector>
 
 #include "EoProtocol.h"
 #include <yarp/os/Searchable.h>
@@ -97,20 +98,23 @@ namespace eth { namespace parser {
     struct pc104Data
     {
         bool embBoardsConnected;
+        bool fakeBoardsRX;
         eOipv4addressing_t localaddressing;
         std::uint16_t  txrate;
         std::uint16_t rxrate;
+        std::string rxmode;
+        std::vector<int> rxcores;
         std::string addressingstring;
         void reset() {
-            embBoardsConnected = true;
+            embBoardsConnected = true; fakeBoardsRX = false;
             localaddressing.addr = eo_common_ipv4addr(10, 0, 1, 104); localaddressing.port = 12345;
-            txrate = 1; rxrate = 5;
+            txrate = 1; rxrate = 5; rxmode = "poll"; rxcores.clear();
             addressingstring = "10.0.1.104:12345";
         }
         void setdefault() {
-            embBoardsConnected = true;
+            embBoardsConnected = true; fakeBoardsRX = false;
             localaddressing.addr = eo_common_ipv4addr(10, 0, 1, 104); localaddressing.port = 12345;
-            txrate = 1; rxrate = 5;
+            txrate = 1; rxrate = 5; rxmode = "poll"; rxcores.clear();
             addressingstring = "10.0.1.104:12345";
         }
     };
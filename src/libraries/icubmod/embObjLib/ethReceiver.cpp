@@ -44,11 +44,195 @@ using yarp::os::Log;
 #include "ethManager.h"
 #include "ethResource.h"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <time.h>
+#include <cstring>
+#endif
+
 
 // --------------------------------------------------------------------------------------------------------------------
 // - pimpl: private implementation (see scott meyers: item 22 of effective modern c++, item 31 of effective c++
 // --------------------------------------------------------------------------------------------------------------------
 
+// it holds the preallocated ring of frames used by recvmmsg(), the epoll descriptor and the rx workers.
+// every worker parses the packets of a fixed subset of boards (index of board modulo number of workers), so that
+// the packets of a board are always parsed in order by the same thread. the receiver hands the frames of the ring
+// over to the workers and waits for them to finish before reusing the ring.
+
+struct eth::EthReceiver::BatchRX
+{
+    enum { capacity = 64 };
+
+#if defined(__linux__)
+    struct Worker
+    {
+        std::thread thread;
+        int core;
+        eOipv4addr_t from[capacity];
+        uint64_t * frames[capacity];
+        ssize_t sizes[capacity];
+        size_t n;
+    };
+
+    std::vector<Worker*> workers;
+    std::mutex mtx;
+    std::condition_variable cvstart;
+    std::condition_variable cvdone;
+    uint64_t generation = 0;
+    size_t pending = 0;
+    bool quit = false;
+
+    void startWorkers(const std::vector<int> &cores, TheEthManager *manager)
+    {
+        for(size_t w=0; w<cores.size(); w++)
+        {
+            Worker *wk = new Worker;
+            wk->core = cores[w];
+            wk->n = 0;
+            workers.push_back(wk);
+        }
+
+        for(size_t w=0; w<workers.size(); w++)
+        {
+            workers[w]->thread = std::thread(&BatchRX::work, this, workers[w], manager);
+        }
+    }
+
+    void stopWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            quit = true;
+        }
+        cvstart.notify_all();
+
+        for(size_t w=0; w<workers.size(); w++)
+        {
+            workers[w]->thread.join();
+            delete workers[w];
+        }
+        workers.clear();
+    }
+
+    // it is executed by the receiver thread: it gives the frames to the workers and waits until they have parsed them
+    void dispatch(size_t n)
+    {
+        for(size_t w=0; w<workers.size(); w++)
+        {
+            workers[w]->n = 0;
+        }
+
+        for(size_t i=0; i<n; i++)
+        {
+            uint8_t index = 0;
+            eo_common_ipv4addr_to_decimal(from[i], NULL, NULL, NULL, &index);
+            Worker *wk = workers[index % workers.size()];
+            wk->from[wk->n] = from[i];
+            wk->frames[wk->n] = frames[i];
+            wk->sizes[wk->n] = sizes[i];
+            wk->n++;
+        }
+
+        std::unique_lock<std::mutex> lck(mtx);
+        pending = workers.size();
+        generation++;
+        cvstart.notify_all();
+        cvdone.wait(lck, [this]{ return 0 == pending; });
+    }
+
+    void work(Worker *wk, TheEthManager *manager)
+    {
+        if(wk->core >= 0)
+        {
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(wk->core, &cpuset);
+            if(0 != pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset))
+            {
+                yWarning() << "EthReceiver: cannot pin an rx worker to core" << wk->core;
+            }
+        }
+
+        uint64_t seen = 0;
+        for(;;)
+        {
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                cvstart.wait(lck, [&]{ return quit || (generation != seen); });
+                if(quit)
+                {
+                    return;
+                }
+                seen = generation;
+            }
+
+            if(wk->n > 0)
+            {
+                manager->Reception(wk->from, wk->frames, wk->sizes, wk->n);
+            }
+
+            bool last = false;
+            {
+                std::lock_guard<std::mutex> lck(mtx);
+                last = (0 == --pending);
+            }
+            if(last)
+            {
+                cvdone.notify_one();
+            }
+        }
+    }
+
+    uint64_t data[capacity][TheEthManager::maxRXpacketsize/8];
+    struct mmsghdr msgs[capacity];
+    struct iovec iovecs[capacity];
+    struct sockaddr_in addrs[capacity];
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+    // kernel reception time of each packet (SO_TIMESTAMPNS)
+    char control[capacity][CMSG_SPACE(sizeof(struct timespec))];
+#endif
+    eOipv4addr_t from[capacity];
+    uint64_t * frames[capacity];
+    ssize_t sizes[capacity];
+    int epollfd = -1;
+    std::vector<int> cores;
+
+    void prepare()
+    {
+        for(int i=0; i<capacity; i++)
+        {
+            iovecs[i].iov_base = data[i];
+            iovecs[i].iov_len = TheEthManager::maxRXpacketsize;
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+            msgs[i].msg_hdr.msg_control = control[i];
+            msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+#else
+            msgs[i].msg_hdr.msg_control = NULL;
+            msgs[i].msg_hdr.msg_controllen = 0;
+#endif
+            msgs[i].msg_hdr.msg_flags = 0;
+            msgs[i].msg_len = 0;
+            frames[i] = data[i];
+        }
+    }
+#endif
+};
+
 
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -62,10 +246,55 @@ using namespace eth;
 
 
 
-EthReceiver::EthReceiver(int raterx): PeriodicThread((double)raterx/1000.0)
+bool EthReceiver::string2mode(const std::string &str, Mode &mode)
+{
+    if(str == "poll")
+    {
+        mode = Mode::poll;
+    }
+    else if(str == "batch")
+    {
+        mode = Mode::batch;
+    }
+    else if(str == "event")
+    {
+        mode = Mode::event;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
+EthReceiver::EthReceiver(int raterx, Mode rxmode, const std::vector<int> &rxcores): PeriodicThread((double)raterx/1000.0)
 {
     rateofthread = raterx;
-    yDebug() << "EthReceiver is a PeriodicThread with rxrate =" << rateofthread << "ms";
+    mode = rxmode;
+    batchrx = nullptr;
+
+#if !defined(__linux__)
+    if(Mode::poll != mode)
+    {
+        yWarning() << "EthReceiver: modes batch and event are available only on linux, thus using mode poll";
+        mode = Mode::poll;
+    }
+#else
+    if(Mode::poll != mode)
+    {
+        batchrx = new BatchRX;
+        batchrx->prepare();
+        batchrx->cores = rxcores;
+    }
+    else if(!rxcores.empty())
+    {
+        yWarning() << "EthReceiver: the rx workers are available only in modes batch and event, thus the packets are parsed by the receiver thread";
+    }
+#endif
+
+    yDebug() << "EthReceiver is a PeriodicThread with rxrate =" << rateofthread << "ms and mode =" << static_cast<int>(mode) << "(0 poll, 1 batch, 2 event)";
     // ok, and now i get it from xml file ... if i find it.
 
 //    std::string tmp = yarp::conf::environment::get_string("ETHSTAT_PRINT_INTERVAL");
@@ -83,6 +312,12 @@ EthReceiver::EthReceiver(int raterx): PeriodicThread((double)raterx/1000.0)
      */
     double raterx_sec = (double)raterx/1000;//raterx is in milliseconds
     m_perEvtVerifier.init(raterx_sec, (raterx_sec/100), raterx_sec-0.001, raterx_sec+0.001, 0.0001, 1, "Receiver");
+    /* the age of a packet is the time between its reception by the kernel and its dispatch to the EthResource.
+       it is available only in modes batch and event, which read the kernel timestamp of each packet.
+     */
+    m_packetAgeVerifier.init(raterx_sec/2, raterx_sec/2, 0, 2*raterx_sec, 0.0002, 1, "Receiver packet age");
+    m_stat_cycles = m_stat_syscalls = m_stat_packets = m_stat_maxsyscalls = 0;
+    m_stat_lastreport = 0;
 #endif
 }
 
@@ -95,7 +330,17 @@ void EthReceiver::onStop()
 
 EthReceiver::~EthReceiver()
 {
-
+#if defined(__linux__)
+    if(nullptr != batchrx)
+    {
+        batchrx->stopWorkers();
+        if(batchrx->epollfd >= 0)
+        {
+            ::close(batchrx->epollfd);
+        }
+        delete batchrx;
+    }
+#endif
 }
 
 bool EthReceiver::config(ACE_SOCK_Dgram *pSocket, TheEthManager* _ethManager)
@@ -132,6 +377,38 @@ bool EthReceiver::config(ACE_SOCK_Dgram *pSocket, TheEthManager* _ethManager)
 
     yWarning() << "in EthReceiver::config() the config socket has queue size = "<< sock_input_buf_size<< "; you request ETHRECEIVER_BUFFER_SIZE=" << _dgram_buffer_size;
 
+#if defined(__linux__)
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+    if(Mode::poll != mode)
+    {
+        int on = 1;
+        if(0 != ACE_OS::setsockopt(sockfd, SOL_SOCKET, SO_TIMESTAMPNS, (char *)&on, sizeof(on)))
+        {
+            yWarning() << "in EthReceiver::config() cannot enable SO_TIMESTAMPNS: the packet age will not be measured";
+        }
+    }
+#endif
+
+    if(Mode::event == mode)
+    {
+        batchrx->epollfd = epoll_create1(0);
+        struct epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = sockfd;
+        if((batchrx->epollfd < 0) || (0 != epoll_ctl(batchrx->epollfd, EPOLL_CTL_ADD, sockfd, &ev)))
+        {
+            yError() << "in EthReceiver::config() cannot use epoll on the socket, thus using mode batch";
+            mode = Mode::batch;
+        }
+    }
+
+    if((nullptr != batchrx) && (!batchrx->cores.empty()))
+    {
+        batchrx->startWorkers(batchrx->cores, ethManager);
+        yDebug() << "EthReceiver::config() has started" << batchrx->cores.size() << "rx workers";
+    }
+#endif
+
     return true;
 }
 
@@ -163,6 +440,19 @@ uint64_t getRopFrameAge(char *pck)
 
 
 void EthReceiver::run()
+{
+    if(Mode::poll == mode)
+    {
+        runPoll();
+    }
+    else
+    {
+        runBatch();
+    }
+}
+
+
+void EthReceiver::runPoll()
 {
     ssize_t       incoming_msg_size = 0;
     ACE_INET_Addr sender_addr;
@@ -171,6 +461,8 @@ void EthReceiver::run()
 
 #ifdef NETWORK_PERFORMANCE_BENCHMARK
     m_perEvtVerifier.tick(yarp::os::Time::now());
+    uint64_t syscalls = 0;
+    uint64_t packets = 0;
 #endif
     
     
@@ -198,22 +490,185 @@ void EthReceiver::run()
     for(int i=0; i<maxUDPpackets; i++)
     {
         incoming_msg_size = recv_socket->recv((void *) incoming_msg_data, incoming_msg_capacity, sender_addr, flags);
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+        syscalls++;
+#endif
         if(incoming_msg_size <= 0)
         { // marco.accame: i prefer using <= 0.
             earlyexit_prev = 1; // yes, we have an early exit
             break; // we break and do not return because we want to be sure to execute what is after the for() loop
         }
 
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+        packets++;
+#endif
         // we have a packet ... we give it to the ethmanager for it parsing
         //bool collectStatistics = (statPrintInterval > 0) ? true : false;
         ethManager->Reception(ethManager->toipv4addr(sender_addr), incoming_msg_data, incoming_msg_size);
     }
 
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+    statCycle(syscalls, packets);
+#endif
+
     // execute the check on presence of all eth boards.
     ethManager->CheckPresence();
 }
 
 
+size_t EthReceiver::drainBatch()
+{
+    size_t total = 0;
+
+#if defined(__linux__)
+    const int sockfd = recv_socket->get_handle();
+
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+    uint64_t syscalls = 0;
+#endif
+
+    // we read the socket until it has fewer packets than the capacity of the ring.
+    // every group of packets is dispatched to TheEthManager with a single acquisition of its rx lock
+    for(;;)
+    {
+        for(int i=0; i<BatchRX::capacity; i++)
+        {
+            batchrx->msgs[i].msg_hdr.msg_namelen = sizeof(batchrx->addrs[i]);
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+            batchrx->msgs[i].msg_hdr.msg_controllen = sizeof(batchrx->control[i]);
+#endif
+        }
+
+        int n = recvmmsg(sockfd, batchrx->msgs, BatchRX::capacity, MSG_DONTWAIT, NULL);
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+        syscalls++;
+#endif
+        if(n <= 0)
+        {
+            break;
+        }
+
+        for(int i=0; i<n; i++)
+        {
+            uint32_t a32 = ntohl(batchrx->addrs[i].sin_addr.s_addr);
+            batchrx->from[i] = eo_common_ipv4addr((a32 >> 24) & 0xff, (a32 >> 16) & 0xff, (a32 >> 8) & 0xff, a32 & 0xff);
+            batchrx->sizes[i] = batchrx->msgs[i].msg_len;
+        }
+
+        if(batchrx->workers.empty())
+        {
+            ethManager->Reception(batchrx->from, batchrx->frames, batchrx->sizes, n);
+        }
+        else
+        {
+            batchrx->dispatch(n);
+        }
+        total += n;
+
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        double tnow = now.tv_sec + 1e-9*now.tv_nsec;
+        for(int i=0; i<n; i++)
+        {
+            for(struct cmsghdr *c = CMSG_FIRSTHDR(&batchrx->msgs[i].msg_hdr); c != NULL; c = CMSG_NXTHDR(&batchrx->msgs[i].msg_hdr, c))
+            {
+                if((SOL_SOCKET == c->cmsg_level) && (SCM_TIMESTAMPNS == c->cmsg_type))
+                {
+                    struct timespec ts;
+                    memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+                    double trx = ts.tv_sec + 1e-9*ts.tv_nsec;
+                    m_packetAgeVerifier.tick(tnow - trx, trx);
+                }
+            }
+        }
+#endif
+
+        if(n < BatchRX::capacity)
+        {
+            break;
+        }
+    }
+
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+    statCycle(syscalls, total);
+#endif
+#endif
+
+    return total;
+}
+
+
+void EthReceiver::runBatch()
+{
+#if defined(__linux__)
+    if(Mode::batch == mode)
+    {
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+        m_perEvtVerifier.tick(yarp::os::Time::now());
+#endif
+        drainBatch();
+        ethManager->CheckPresence();
+        return;
+    }
+
+    // mode event: we stay in here and wake up as soon as packets arrive, or at the latest after the period
+    // of the thread, so that the presence of the boards is still checked regularly. when the thread is
+    // stopped, onStop() sends a packet to ourselves which unblocks epoll_wait().
+    double lastcheck = yarp::os::Time::now();
+    while(!isStopping())
+    {
+        struct epoll_event ev;
+        int ready = epoll_wait(batchrx->epollfd, &ev, 1, rateofthread);
+
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+        m_perEvtVerifier.tick(yarp::os::Time::now());
+#endif
+
+        if(ready > 0)
+        {
+            drainBatch();
+        }
+
+        double now = yarp::os::Time::now();
+        if((now - lastcheck) >= 0.001*rateofthread)
+        {
+            ethManager->CheckPresence();
+            lastcheck = now;
+        }
+    }
+#endif
+}
+
+
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+void EthReceiver::statCycle(uint64_t syscalls, uint64_t packets)
+{
+    m_stat_cycles++;
+    m_stat_syscalls += syscalls;
+    m_stat_packets += packets;
+    if(syscalls > m_stat_maxsyscalls)
+    {
+        m_stat_maxsyscalls = syscalls;
+    }
+
+    double now = yarp::os::Time::now();
+    if(0 == m_stat_lastreport)
+    {
+        m_stat_lastreport = now;
+    }
+    else if((now - m_stat_lastreport) >= 1.0)
+    {
+        yDebug() << "EthReceiver: in the last" << now - m_stat_lastreport << "sec there were" << m_stat_cycles << "cycles with"
+                 << (double)m_stat_syscalls/m_stat_cycles << "syscalls per cycle on average (max" << m_stat_maxsyscalls << ") and"
+                 << (double)m_stat_packets/m_stat_cycles << "packets per cycle";
+        m_stat_cycles = m_stat_syscalls = m_stat_packets = m_stat_maxsyscalls = 0;
+        m_stat_lastreport = now;
+    }
+}
+#endif
+
+
 
 // - end-of-file (leave a blank line after)----------------------------------------------------------------------------
 
@@ -26,9 +26,15 @@
 // -- class EthReceiver
 // -- it is a rate thread created by singleton TheEthManager.
 // -- it regularly wakes up to see if a packet is in its listening socket and it parses that with methods made available by TheEthManager.
+// -- on linux it can alternatively drain the socket in batches with recvmmsg() (mode batch) and also wait for packets with epoll()
+// -- rather than polling at fixed rate (mode event). in these two modes the parsing of packets of different boards can
+// -- be spread over a pool of rx workers pinned to given cores.
 
 //#include <ethManager.h>
 
+#include <string>
+#include <vector>
+
 #include <ace/SOCK_Dgram.h>
 
 #include <yarp/os/PeriodicThread.h>
@@ -45,21 +51,45 @@ namespace eth {
 
     class EthReceiver : public yarp::os::PeriodicThread
     {
+    public:
+
+        enum class Mode { poll = 0, batch = 1, event = 2 };
+
+        // it converts the value of PC104/PC104RXmode (poll, batch, event) into a Mode. it returns false if unknown
+        static bool string2mode(const std::string &str, Mode &mode);
+
     private:
         int rateofthread;
+        Mode mode;
+
+        struct BatchRX;
+        BatchRX *batchrx;
 
         ACE_SOCK_Dgram *recv_socket;
         eth::TheEthManager *ethManager;
         double statPrintInterval;
 #ifdef NETWORK_PERFORMANCE_BENCHMARK 
         Tools::Emb_PeriodicEventVerifier m_perEvtVerifier;
+        Tools::Emb_RensponseTimingVerifier m_packetAgeVerifier;
+        // counters of syscalls and packets, reported every second
+        uint64_t m_stat_cycles;
+        uint64_t m_stat_syscalls;
+        uint64_t m_stat_packets;
+        uint64_t m_stat_maxsyscalls;
+        double m_stat_lastreport;
+        void statCycle(uint64_t syscalls, uint64_t packets);
 #endif
 
+        void runPoll();
+        void runBatch();
+        size_t drainBatch();
+
     public:
 
         enum { EthReceiverDefaultRate = 5, EthReceiverMaxRate = 20 };
 
-        EthReceiver(int rxrate);
+        // rxcores are the cores where to pin the rx workers (one each). they are used only in modes batch and event
+        EthReceiver(int rxrate, Mode rxmode = Mode::poll, const std::vector<int> &rxcores = {});
         ~EthReceiver();
         bool config(ACE_SOCK_Dgram *pSocket, eth::TheEthManager* _ethManager);
         bool threadInit();
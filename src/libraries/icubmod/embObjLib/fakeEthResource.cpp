@@ -177,7 +177,8 @@ bool FakeEthResource::Check()
 
 bool FakeEthResource::processRXpacket(const void *data, const size_t size)
 {
-    return true;
+    // packets arrive only with DEBUG/fakeBoardsRX, from a stand-in of the board
+    return transceiver.parseUDP(data, size);
 }
 
 
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2023 iCub Facility - Istituto Italiano di Tecnologia
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+ */
+
+#ifndef __SNAPSHOT_BUFFER_H_
+#define __SNAPSHOT_BUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <type_traits>
+
+namespace eth {
+
+    /**
+     * @brief Fixed-size array of items published by a single writer (the thread receiving the
+     *        ROP frames) and read by many readers without locking, by means of a sequence lock.
+     *        The writer never blocks; readers retry their copy whenever it overlapped a write.
+     * @tparam T the item type, which must be trivially copyable (e.g. eOmc_joint_status_core_t).
+     */
+    template <typename T>
+    class SnapshotBuffer
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SnapshotBuffer requires trivially copyable items");
+
+    public:
+
+        SnapshotBuffer() = default;
+
+        /**
+         * @brief Sizes the buffer and zeroes its content. It is not thread safe: call it before
+         *        the writer and the readers start.
+         * @param n number of items.
+         */
+        void resize(size_t n)
+        {
+            items.assign(n, T{});
+            stamps.assign(n, 0.0);
+            seq.store(0, std::memory_order_relaxed);
+        }
+
+        size_t size() const { return items.size(); }
+
+        /**
+         * @brief Publishes a new value for the i-th item. To be called by the single writer only.
+         * @param i the item index.
+         * @param value the new value.
+         * @param stamp the acquisition time of the value.
+         */
+        void write(size_t i, const T &value, double stamp)
+        {
+            if(i >= items.size())
+            {
+                return;
+            }
+
+            uint32_t s = seq.load(std::memory_order_relaxed);
+            seq.store(s+1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            std::memcpy(&items[i], &value, sizeof(T));
+            stamps[i] = stamp;
+
+            seq.store(s+2, std::memory_order_release);
+        }
+
+        /**
+         * @brief Gives a consistent view of the whole buffer to a functor, which typically extracts
+         *        the fields of interest into the caller's storage. The functor may be invoked more
+         *        than once if a write overlaps the reading, thus it must have no side effects other
+         *        than overwriting its outputs.
+         * @param extract functor with signature void(const T *items, const double *stamps, size_t n).
+         */
+        template <typename F>
+        void read(F &&extract) const
+        {
+            for(;;)
+            {
+                uint32_t s0 = seq.load(std::memory_order_acquire);
+                if(s0 & 1)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                extract(items.data(), stamps.data(), items.size());
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(seq.load(std::memory_order_relaxed) == s0)
+                {
+                    return;
+                }
+            }
+        }
+
+        /**
+         * @brief Copies a consistent value of the i-th item.
+         * @param i the item index.
+         * @param value the output value.
+         * @param stamp if not nullptr, the output acquisition time.
+         * @return false if the index is out of range.
+         */
+        bool get(size_t i, T &value, double *stamp = nullptr) const
+        {
+            if(i >= items.size())
+            {
+                return false;
+            }
+
+            read([&](const T *it, const double *st, size_t)
+            {
+                std::memcpy(&value, &it[i], sizeof(T));
+                if(nullptr != stamp)
+                {
+                    *stamp = st[i];
+                }
+            });
+
+            return true;
+        }
+
+    private:
+
+        std::vector<T> items;
+        std::vector<double> stamps;
+        std::atomic<uint32_t> seq {0};
+    };
+
+} // eth
+
+#endif  // __SNAPSHOT_BUFFER_H_
@@ -135,6 +135,7 @@ bool embObjMotionControl::alloc(int nj)
     _jointEncs.resize(nj);
     _motorEncs.resize(nj);
     _kalman_params.resize(nj);
+    _jointsStatus.resize(nj);
     
     //debug purpose
 
@@ -1530,6 +1531,21 @@ bool embObjMotionControl::update(eOprotID32_t id32, double timestamp, void *rxda
         _encodersStamp[joint] = timestamp;
     }
 
+    // publish the joint status core so that the multi-joint getters can read it without
+    // going through the transceiver. the update of the snapshot is lock-free for the readers.
+    if(eoprot_entity_mc_joint == eoprot_ID2entity(id32))
+    {
+        eOprotTag_t tag = eoprot_ID2tag(id32);
+        if(eoprot_tag_mc_joint_status_core == tag)
+        {
+            _jointsStatus.write(joint, *reinterpret_cast<eOmc_joint_status_core_t*>(rxdata), timestamp);
+        }
+        else if(eoprot_tag_mc_joint_status == tag)
+        {
+            _jointsStatus.write(joint, reinterpret_cast<eOmc_joint_status_t*>(rxdata)->core, timestamp);
+        }
+    }
+
 
     if(eomn_serv_diagn_mode_MC_AMOyarp == mcdiagnostics.config.mode)
     {
@@ -2740,9 +2756,8 @@ bool embObjMotionControl::resetEncodersRaw()
 bool embObjMotionControl::getEncoderRaw(int j, double *value)
 {
     eOmc_joint_status_core_t core;
-    eOprotID32_t protid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, j, eoprot_tag_mc_joint_status_core);
 
-    bool ret = res->getLocalValue(protid, &core);
+    bool ret = _jointsStatus.get(j, core);
 
     if(ret)
     {
@@ -2759,21 +2774,19 @@ bool embObjMotionControl::getEncoderRaw(int j, double *value)
 
 bool embObjMotionControl::getEncodersRaw(double *encs)
 {
-    bool ret = true;
-    for(int j=0; j< _njoints; j++)
+    _jointsStatus.read([&](const eOmc_joint_status_core_t *core, const double *, size_t n)
     {
-        ret &= getEncoderRaw(j, &encs[j]);
-
-    }
-    return ret;
+        for(size_t j=0; j<n; j++)
+            encs[j] = (double) core[j].measures.meas_position;
+    });
+    return true;
 }
 
 bool embObjMotionControl::getEncoderSpeedRaw(int j, double *sp)
 {
-    eOprotID32_t protid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, j, eoprot_tag_mc_joint_status_core);
     eOmc_joint_status_core_t core;
     *sp = 0;
-    if(!res->getLocalValue(protid, &core))
+    if(!_jointsStatus.get(j, core))
     {
         return false;
     }
@@ -2784,20 +2797,19 @@ bool embObjMotionControl::getEncoderSpeedRaw(int j, double *sp)
 
 bool embObjMotionControl::getEncoderSpeedsRaw(double *spds)
 {
-    bool ret = true;
-    for(int j=0; j< _njoints; j++)
+    _jointsStatus.read([&](const eOmc_joint_status_core_t *core, const double *, size_t n)
     {
-        ret &= getEncoderSpeedRaw(j, &spds[j]);
-    }
-    return ret;
+        for(size_t j=0; j<n; j++)
+            spds[j] = (double) core[j].measures.meas_velocity;
+    });
+    return true;
 }
 
 bool embObjMotionControl::getEncoderAccelerationRaw(int j, double *acc)
 {
-    eOprotID32_t protid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, j, eoprot_tag_mc_joint_status_core);
     eOmc_joint_status_core_t core;
     *acc = 0;
-    if(! res->getLocalValue(protid, &core))
+    if(!_jointsStatus.get(j, core))
     {
         return false;
     }
@@ -2807,30 +2819,35 @@ bool embObjMotionControl::getEncoderAccelerationRaw(int j, double *acc)
 
 bool embObjMotionControl::getEncoderAccelerationsRaw(double *accs)
 {
-    bool ret = true;
-    for(int j=0; j< _njoints; j++)
+    _jointsStatus.read([&](const eOmc_joint_status_core_t *core, const double *, size_t n)
     {
-        ret &= getEncoderAccelerationRaw(j, &accs[j]);
-    }
-    return ret;
+        for(size_t j=0; j<n; j++)
+            accs[j] = (double) core[j].measures.meas_acceleration;
+    });
+    return true;
 }
 
 ///////////////////////// END Encoder Interface
 
 bool embObjMotionControl::getEncodersTimedRaw(double *encs, double *stamps)
 {
-    bool ret = getEncodersRaw(encs);
-    std::lock_guard<std::mutex> lck(_mutex);
-    for(int i=0; i<_njoints; i++)
-        stamps[i] = _encodersStamp[i];
-    return ret;
+    // positions and stamps come from the same snapshot, thus they are always coherent
+    _jointsStatus.read([&](const eOmc_joint_status_core_t *core, const double *st, size_t n)
+    {
+        for(size_t j=0; j<n; j++)
+        {
+            encs[j] = (double) core[j].measures.meas_position;
+            stamps[j] = st[j];
+        }
+    });
+    return true;
 }
 
 bool embObjMotionControl::getEncoderTimedRaw(int j, double *encs, double *stamp)
 {
-    bool ret = getEncoderRaw(j, encs);
-    std::lock_guard<std::mutex> lck(_mutex);
-    *stamp = _encodersStamp[j];
+    eOmc_joint_status_core_t core;
+    bool ret = _jointsStatus.get(j, core, stamp);
+    *encs = ret ? (double) core.measures.meas_position : 0.0;
     return ret;
 }
 
@@ -3801,17 +3818,23 @@ bool embObjMotionControl::updateVirtualAnalogSensorMeasure(int userLevel_jointNu
 bool embObjMotionControl::getTorqueRaw(int j, double *t)
 {
     eOmc_joint_status_core_t jstatus;
-    eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, j, eoprot_tag_mc_joint_status_core);
-    bool ret = res->getLocalValue(protoid, &jstatus);
-    *t = (double) _measureConverter->trqS2N(jstatus.measures.meas_torque, j);
+    bool ret = _jointsStatus.get(j, jstatus);
+    *t = ret ? (double) _measureConverter->trqS2N(jstatus.measures.meas_torque, j) : 0.0;
     return ret;
 }
 
 bool embObjMotionControl::getTorquesRaw(double *t)
 {
-    bool ret = true;
+    // copy the raw values first, so that the conversion is not repeated in case of retries
+    _jointsStatus.read([&](const eOmc_joint_status_core_t *core, const double *, size_t n)
+    {
+        for(size_t j=0; j<n; j++)
+            t[j] = (double) core[j].measures.meas_torque;
+    });
+
     for(int j=0; j<_njoints; j++)
-        ret = ret && getTorqueRaw(j, &t[j]);
+        t[j] = _measureConverter->trqS2N(t[j], j);
+
     return true;
 }
 
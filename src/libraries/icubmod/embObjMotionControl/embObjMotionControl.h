@@ -55,6 +55,7 @@ using namespace std;
 #include "measuresConverter.h"
 
 #include "mcEventDownsampler.h"
+#include "snapshotBuffer.h"
 
 
 #ifdef NETWORK_PERFORMANCE_BENCHMARK 
@@ -261,6 +262,7 @@ private:
     double  *_ref_positions;    // used for direct position control.
     double  *_ref_accs;         // for velocity control, in position min jerk eq is used.
     double  *_encodersStamp;                    /** keep information about acquisition time for encoders read */
+    eth::SnapshotBuffer<eOmc_joint_status_core_t> _jointsStatus; /** lock-free copy of the joints status published by the rx thread */
     bool  *checking_motiondone;                 /* flag telling if I'm already waiting for motion done */
     #define MAX_POSITION_MOVE_INTERVAL 0.080
     double *_last_position_move_time;           /** time stamp for last received position move command*/    
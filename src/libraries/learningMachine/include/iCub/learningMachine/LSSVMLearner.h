@@ -112,6 +112,12 @@ public:
  * efficiency the hyperparameters are shared among all outputs. Only the RBF
  * kernel function is supported.
  *
+ * In incremental mode each sample is learned as soon as it is fed: the inverse
+ * of the regularized kernel matrix is bordered with the new sample and, when a
+ * window of samples is given, the oldest sample is removed from it, so that
+ * both the update and the exact Leave-One-Out error cost O(n^2) rather than
+ * the O(n^3) of train().
+ *
  * \see iCub::contrib::IMachineLearner
  * \see iCub::contrib::IFixedSizeLearner
  *
@@ -155,6 +161,65 @@ private:
      */
     RBFKernel* kernel;
 
+    /**
+     * Whether the samples are learned as they are fed.
+     */
+    bool incremental;
+
+    /**
+     * Maximum number of samples retained in incremental mode (0 for no limit).
+     */
+    unsigned int window;
+
+    /**
+     * Cache of the kernel evaluations; row i holds the kernel between sample i
+     * and the samples 0..i.
+     */
+    std::vector<yarp::sig::Vector> kernelRows;
+
+    /**
+     * The kernel parameter the cached rows have been evaluated with.
+     */
+    double kernelGamma;
+
+    /**
+     * The inverse of the regularized kernel matrix K + I/C.
+     */
+    yarp::sig::Matrix Hinv;
+
+    /**
+     * The regularization parameter the inverse has been computed with.
+     */
+    double HinvC;
+
+    /**
+     * Evaluates the kernel rows of the samples that are not in the cache yet.
+     */
+    void updateKernelRows();
+
+    /**
+     * Computes the inverse of the regularized kernel matrix from scratch.
+     */
+    void invert();
+
+    /**
+     * Borders the inverse of the regularized kernel matrix with the last
+     * sample.
+     */
+    void append();
+
+    /**
+     * Removes the oldest sample, along with its kernel row and its row and
+     * column of the inverse of the regularized kernel matrix.
+     */
+    void removeOldest();
+
+    /**
+     * Computes the coefficients, the biases and the Leave-One-Out error from
+     * the inverse of the regularized kernel matrix.
+     */
+    void solve();
+
 
 public:
     /**
@@ -259,6 +324,42 @@ public:
         return this->C;
     }
 
+    /**
+     * Mutator for the incremental mode.
+     *
+     * @param incremental whether the samples are learned as they are fed
+     */
+    virtual void setIncremental(bool incremental) {
+        this->incremental = incremental;
+    }
+
+    /**
+     * Accessor for the incremental mode.
+     *
+     * @returns whether the samples are learned as they are fed
+     */
+    virtual bool getIncremental() {
+        return this->incremental;
+    }
+
+    /**
+     * Mutator for the number of samples retained in incremental mode.
+     *
+     * @param window the number of samples, 0 for no limit
+     */
+    virtual void setWindow(unsigned int window) {
+        this->window = window;
+    }
+
+    /**
+     * Accessor for the number of samples retained in incremental mode.
+     *
+     * @returns the number of samples, 0 for no limit
+     */
+    virtual unsigned int getWindow() {
+        return this->window;
+    }
+
     /**
      * Accessor for the kernel.
      *
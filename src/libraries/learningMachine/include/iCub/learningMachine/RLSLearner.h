@@ -33,7 +33,10 @@ namespace learningmachine {
  *
  * Recursive Regularized Least Squares (a.k.a. ridge regression) learner. It
  * uses a rank 1 update rule to update the Cholesky factor of the covariance
- * matrix.
+ * matrix. The weights are updated in place along the gain vector of each
+ * sample, so that a sample costs O(d^2 + d*m) operations without allocations.
+ * A forgetting factor smaller than 1 exponentially discounts the former
+ * samples (and the regularization), for tracking time-varying targets.
  *
  * \see iCub::learningmachine::IMachineLearner
  * \see iCub::learningmachine::IFixedSizeLearner
@@ -70,6 +73,34 @@ private:
      */
     double lambda;
 
+    /**
+     * Forgetting factor of the former samples.
+     */
+    double forgetting;
+
+    /**
+     * Workspace for the rank 1 update and the gain vector.
+     */
+    yarp::sig::Vector work;
+
+    /**
+     * Workspace for the gain vector.
+     */
+    yarp::sig::Vector gain;
+
+    /**
+     * Workspace for the prediction error.
+     */
+    yarp::sig::Vector error;
+
+    /**
+     * Updates the Cholesky factor, B and the weights with a sample.
+     *
+     * @param input pointer to the domain size elements of the input
+     * @param output pointer to the codomain size elements of the output
+     */
+    void update(const double* input, const double* output);
+
 public:
     /**
      * Constructor.
@@ -100,6 +131,15 @@ public:
      */
     virtual void feedSample(const yarp::sig::Vector& input, const yarp::sig::Vector& output);
 
+    /**
+     * Feeds a batch of samples to the learner, in the order of the rows.
+     *
+     * @param inputs matrix with an input sample on each row
+     * @param outputs matrix with the corresponding output samples on its rows
+     * @throw a runtime error if the sizes of the matrices do not match
+     */
+    virtual void feedSamples(const yarp::sig::Matrix& inputs, const yarp::sig::Matrix& outputs);
+
     /*
      * Inherited from IMachineLearner.
      */
@@ -167,6 +207,21 @@ public:
      */
     double getLambda();
 
+    /**
+     * Sets the forgetting factor of the former samples, where 1 weights all
+     * samples equally.
+     *
+     * @param f the desired value, in (0, 1]
+     */
+    void setForgetting(double f);
+
+    /**
+     * Accessor for the forgetting factor.
+     *
+     * @returns the value of the parameter
+     */
+    double getForgetting();
+
     /*
      * Inherited from IConfig.
      */
@@ -49,6 +49,10 @@ double RBFKernel::evaluate(const yarp::sig::Vector& v1, const yarp::sig::Vector&
 LSSVMLearner::LSSVMLearner(unsigned int dom, unsigned int cod, double c) {
     this->setName("LSSVM");
     this->kernel = new RBFKernel();
+    this->incremental = false;
+    this->window = 0;
+    this->kernelGamma = this->kernel->getGamma();
+    this->HinvC = 0.;
     // make sure to not use initialization list to constructor of base for
     // domain and codomain size, as it will not use overloaded mutators
     this->setDomainSize(dom);
@@ -59,7 +63,9 @@ LSSVMLearner::LSSVMLearner(unsigned int dom, unsigned int cod, double c) {
 LSSVMLearner::LSSVMLearner(const LSSVMLearner& other)
   : IFixedSizeLearner(other), inputs(other.inputs), outputs(other.outputs),
     alphas(other.alphas), bias(other.bias), LOO(other.LOO), C(other.C),
-    kernel(new RBFKernel(*other.kernel)) {
+    kernel(new RBFKernel(*other.kernel)), incremental(other.incremental),
+    window(other.window), kernelRows(other.kernelRows),
+    kernelGamma(other.kernelGamma), Hinv(other.Hinv), HinvC(other.HinvC) {
 
 }
 
@@ -79,6 +85,12 @@ LSSVMLearner& LSSVMLearner::operator=(const LSSVMLearner& other) {
     this->C = other.C;
     delete this->kernel;
     this->kernel = new RBFKernel(*other.kernel);
+    this->incremental = other.incremental;
+    this->window = other.window;
+    this->kernelRows = other.kernelRows;
+    this->kernelGamma = other.kernelGamma;
+    this->Hinv = other.Hinv;
+    this->HinvC = other.HinvC;
 
     return *this;
 }
@@ -87,8 +99,19 @@ void LSSVMLearner::feedSample(const yarp::sig::Vector& input, const yarp::sig::V
     // call parent method to let it do some validation for us
     this->IFixedSizeLearner::feedSample(input, output);
 
+    if(this->incremental && this->window > 0) {
+        while(this->inputs.size() >= this->window) {
+            this->removeOldest();
+        }
+    }
+
     this->inputs.push_back(input);
     this->outputs.push_back(output);
+
+    if(this->incremental) {
+        this->append();
+        this->solve();
+    }
 }
 
 void LSSVMLearner::train() {
@@ -99,47 +122,177 @@ void LSSVMLearner::train() {
         return;
     }
 
-    // create kernel matrix
-    yarp::sig::Matrix K(inputs.size() + 1, inputs.size() + 1);
-    for(int r = 0; r < K.rows() - 1; r++) {
+    this->invert();
+    this->solve();
+}
+
+void LSSVMLearner::updateKernelRows() {
+    // the cached evaluations are only valid for the current kernel parameter
+    if(this->kernelGamma != this->kernel->getGamma()) {
+        this->kernelRows.clear();
+        this->kernelGamma = this->kernel->getGamma();
+    }
+
+    for(size_t r = this->kernelRows.size(); r < this->inputs.size(); r++) {
+        yarp::sig::Vector row(r + 1);
+        for(size_t c = 0; c <= r; c++) {
+            row(c) = this->kernel->evaluate(this->inputs[r], this->inputs[c]);
+        }
+        this->kernelRows.push_back(row);
+    }
+}
+
+void LSSVMLearner::invert() {
+    this->updateKernelRows();
+
+    // create regularized kernel matrix
+    size_t n = this->inputs.size();
+    yarp::sig::Matrix H(n, n);
+    for(size_t r = 0; r < n; r++) {
         // symmetric matrix
-        for(int c = 0; c <= r; c++) {
-            K(r, c) = K(c, r) = this->kernel->evaluate(this->inputs[r], this->inputs[c]);
-            if(r == c) K(r, c) += (1.0 / this->C);
+        for(size_t c = 0; c <= r; c++) {
+            H(r, c) = H(c, r) = this->kernelRows[r](c);
+        }
+        H(r, r) += (1.0 / this->C);
+    }
+
+    // the bias is accounted for by solve(), as the bordered kernel
+    // matrix is not positive definite
+    this->Hinv = luinv(H);
+    this->HinvC = this->C;
+}
+
+void LSSVMLearner::append() {
+    size_t m = this->inputs.size() - 1;
+
+    // start over whenever the inverse does not match the former samples
+    if(this->Hinv.rows() != (int)m || this->HinvC != this->C ||
+       this->kernelGamma != this->kernel->getGamma() || this->kernelRows.size() != m) {
+        this->invert();
+        return;
+    }
+
+    this->updateKernelRows();
+    const yarp::sig::Vector& k = this->kernelRows[m];
+
+    // Schur complement of the former regularized kernel matrix
+    yarp::sig::Vector u(m);
+    double gamma = k(m) + (1.0 / this->C);
+    for(size_t r = 0; r < m; r++) {
+        const double* Hr = this->Hinv[r];
+        double ur = 0.;
+        for(size_t c = 0; c < m; c++) {
+            ur += Hr[c] * k(c);
+        }
+        u(r) = ur;
+        gamma -= k(r) * ur;
+    }
+
+    if(gamma <= 0.) {
+        // numerical loss of positive definiteness
+        this->invert();
+        return;
+    }
+
+    // inverse of the bordered matrix [H k; k' k(x,x) + 1/C]
+    yarp::sig::Matrix P(m + 1, m + 1);
+    for(size_t r = 0; r < m; r++) {
+        const double* Hr = this->Hinv[r];
+        double* Pr = P[r];
+        double ur = u(r) / gamma;
+        for(size_t c = 0; c < m; c++) {
+            Pr[c] = Hr[c] + ur * u(c);
         }
+        Pr[m] = P(m, r) = -ur;
     }
-    for(int i = 0; i < K.rows() - 1; i++) {
-        K(i, K.cols() - 1) = K(K.rows() - 1, i) = 1.;
+    P(m, m) = 1.0 / gamma;
+    this->Hinv = P;
+}
+
+void LSSVMLearner::removeOldest() {
+    size_t n = this->inputs.size();
+    if(n == 0) {
+        return;
     }
-    K(K.rows() - 1, K.cols() - 1) = 0.;
 
-    // invert kernel matrix
-    yarp::sig::Matrix Kinv = luinv(K);
+    // the inverse is downdated only if it matches the samples
+    if(this->Hinv.rows() == (int)n && n > 1) {
+        yarp::sig::Matrix P(n - 1, n - 1);
+        const double* H0 = this->Hinv[0];
+        for(size_t r = 1; r < n; r++) {
+            const double* Hr = this->Hinv[r];
+            double* Pr = P[r - 1];
+            double f = Hr[0] / H0[0];
+            for(size_t c = 1; c < n; c++) {
+                Pr[c - 1] = Hr[c] - f * H0[c];
+            }
+        }
+        this->Hinv = P;
+    } else {
+        this->Hinv = yarp::sig::Matrix();
+    }
 
-    // compute solution
-    yarp::sig::Matrix Y = zeros(this->outputs.size() + 1, this->getCoDomainSize());
-    for(int r = 0; r < Y.rows() - 1; r++) {
-        for(int c = 0; c < Y.cols(); c++) {
-            Y(r, c) = this->outputs[r](c);
+    if(this->kernelRows.size() > 0) {
+        this->kernelRows.erase(this->kernelRows.begin());
+        for(size_t r = 0; r < this->kernelRows.size(); r++) {
+            this->kernelRows[r] = this->kernelRows[r].subVector(1, this->kernelRows[r].size() - 1);
         }
     }
 
-    yarp::sig::Matrix result = Kinv * Y;
-    this->alphas = result.submatrix(0, result.rows() - 2, 0, result.cols() - 1);
-    this->bias = result.getRow(result.rows() - 1);
+    this->inputs.erase(this->inputs.begin());
+    this->outputs.erase(this->outputs.begin());
+}
 
-    // compute LOO
-    this->LOO = zeros(this->getCoDomainSize());
+void LSSVMLearner::solve() {
+    // with eta = Hinv * 1 and s = sum(eta), the inverse of the bordered
+    // kernel matrix [H 1; 1' 0] has Hinv - eta * eta' / s on its top left,
+    // hence b = sum(Hinv * y) / s and alpha = Hinv * y - eta * b
+    size_t n = this->inputs.size();
+    size_t d = this->getCoDomainSize();
+
+    yarp::sig::Vector eta(n);
+    yarp::sig::Matrix nu = zeros(n, d);
+    double s = 0.;
+    for(size_t r = 0; r < n; r++) {
+        const double* Hr = this->Hinv[r];
+        double* nur = nu[r];
+        double etar = 0.;
+        for(size_t c = 0; c < n; c++) {
+            etar += Hr[c];
+            const yarp::sig::Vector& y = this->outputs[c];
+            for(size_t i = 0; i < d; i++) {
+                nur[i] += Hr[c] * y(i);
+            }
+        }
+        eta(r) = etar;
+        s += etar;
+    }
 
-    for(unsigned int i = 0; i < this->getCoDomainSize(); i++) {
-        yarp::sig::Vector alphas_i = this->alphas.getCol(i);
-        for(size_t j = 0; j < alphas_i.size(); j++) {
-            double err = alphas_i(j) / Kinv(j, j);
-            this->LOO(i) += err * err;
+    this->bias = zeros(d);
+    for(size_t r = 0; r < n; r++) {
+        for(size_t i = 0; i < d; i++) {
+            this->bias(i) += nu(r, i);
         }
-        this->LOO(i) /= alphas_i.size();
     }
+    this->bias = this->bias / s;
 
+    this->alphas.resize(n, d);
+    for(size_t r = 0; r < n; r++) {
+        for(size_t i = 0; i < d; i++) {
+            this->alphas(r, i) = nu(r, i) - eta(r) * this->bias(i);
+        }
+    }
+
+    // compute LOO
+    this->LOO = zeros(d);
+    for(size_t r = 0; r < n; r++) {
+        double diag = this->Hinv(r, r) - eta(r) * eta(r) / s;
+        for(size_t i = 0; i < d; i++) {
+            double err = this->alphas(r, i) / diag;
+            this->LOO(i) += err * err;
+        }
+    }
+    this->LOO = this->LOO / (double)n;
 }
 
 Prediction LSSVMLearner::predict(const yarp::sig::Vector& input) {
@@ -164,6 +317,8 @@ void LSSVMLearner::reset() {
     this->alphas = yarp::sig::Matrix();
     this->LOO.clear();
     this->bias.clear();
+    this->kernelRows.clear();
+    this->Hinv = yarp::sig::Matrix();
 }
 
 LSSVMLearner* LSSVMLearner::clone() {
@@ -176,6 +331,11 @@ std::string LSSVMLearner::getInfo() {
     buffer << "C: " << this->getC() << " | ";
     buffer << "Collected Samples: " << this->inputs.size() << " | ";
     buffer << "Training Samples: " << this->alphas.rows() << " | ";
+    buffer << "Incremental: " << this->incremental;
+    if(this->incremental && this->window > 0) {
+        buffer << " (window: " << this->window << ")";
+    }
+    buffer << " | ";
     buffer << "Kernel: " << this->kernel->getInfo() << std::endl;
     buffer << "LOO: " << this->LOO.toString() << std::endl;
     return buffer.str();
@@ -186,6 +346,8 @@ std::string LSSVMLearner::getConfigHelp() {
     buffer << this->IFixedSizeLearner::getConfigHelp();
     //buffer << "  kernel idx|all cfg    Kernel configuration" << std::endl;
     buffer << "  c val                 Tradeoff parameter C" << std::endl;
+    buffer << "  incremental 0|1       Learn each sample as it is fed" << std::endl;
+    buffer << "  window n              Retain the last n samples in incremental mode" << std::endl;
     buffer << this->kernel->getConfigHelp() << std::endl;
     return buffer.str();
 }
@@ -242,6 +404,10 @@ void LSSVMLearner::readBottle(yarp::os::Bottle& bot) {
     bot >> this->alphas >> this->bias >> c >> gamma;
     this->setC(c);
     this->kernel->setGamma(gamma);
+
+    // the caches refer to the former samples
+    this->kernelRows.clear();
+    this->Hinv = yarp::sig::Matrix();
 }
 
 void LSSVMLearner::setDomainSize(unsigned int size) {
@@ -265,6 +431,18 @@ bool LSSVMLearner::configure(yarp::os::Searchable& config) {
         }
     }
 
+    // format: set incremental 0|1
+    if(config.find("incremental").isInt32() || config.find("incremental").isBool()) {
+        this->setIncremental(config.find("incremental").asBool());
+        success = true;
+    }
+
+    // format: set window int
+    if(config.find("window").isInt32() && config.find("window").asInt32() >= 0) {
+        this->setWindow(config.find("window").asInt32());
+        success = true;
+    }
+
     success |= this->kernel->configure(config);
 
     return success;
@@ -37,6 +37,7 @@ namespace learningmachine {
 RLSLearner::RLSLearner(unsigned int dom, unsigned int cod, double lambda) {
     this->setName("RLS");
     this->sampleCount = 0;
+    this->forgetting = 1.0;
     // make sure to not use initialization list to constructor of base for
     // domain and codomain size, as it will not use overloaded mutators
     this->setDomainSize(dom);
@@ -47,7 +48,8 @@ RLSLearner::RLSLearner(unsigned int dom, unsigned int cod, double lambda) {
 
 RLSLearner::RLSLearner(const RLSLearner& other)
   : IFixedSizeLearner(other), sampleCount(other.sampleCount), R(other.R),
-    B(other.B), W(other.W), lambda(other.lambda) {
+    B(other.B), W(other.W), lambda(other.lambda), forgetting(other.forgetting),
+    work(other.work), gain(other.gain), error(other.error) {
 }
 
 RLSLearner::~RLSLearner() {
@@ -63,6 +65,10 @@ RLSLearner& RLSLearner::operator=(const RLSLearner& other) {
     this->B = other.B;
     this->W = other.W;
     this->lambda = other.lambda;
+    this->forgetting = other.forgetting;
+    this->work = other.work;
+    this->gain = other.gain;
+    this->error = other.error;
 
     return *this;
 }
@@ -70,14 +76,106 @@ RLSLearner& RLSLearner::operator=(const RLSLearner& other) {
 void RLSLearner::feedSample(const yarp::sig::Vector& input, const yarp::sig::Vector& output) {
     this->IFixedSizeLearner::feedSample(input, output);
 
-    // update R
-    cholupdate(this->R, input);
+    this->update(input.data(), output.data());
+}
+
+void RLSLearner::feedSamples(const yarp::sig::Matrix& inputs, const yarp::sig::Matrix& outputs) {
+    if(inputs.cols() != (int)this->getDomainSize()) {
+        throw std::runtime_error("Input samples have invalid dimensionality");
+    }
+    if(outputs.cols() != (int)this->getCoDomainSize()) {
+        throw std::runtime_error("Output samples have invalid dimensionality");
+    }
+    if(inputs.rows() != outputs.rows()) {
+        throw std::runtime_error("Number of input and output samples differs");
+    }
+
+    for(int i = 0; i < inputs.rows(); i++) {
+        this->update(inputs[i], outputs[i]);
+    }
+}
+
+void RLSLearner::update(const double* input, const double* output) {
+    int d = this->R.rows();
+    int m = this->W.rows();
+    double* w = this->work.data();
+    double* k = this->gain.data();
+    double* e = this->error.data();
+
+    // discount the former samples, i.e. R'R and B
+    if(this->forgetting < 1.0) {
+        double f = sqrt(this->forgetting);
+        for(int r = 0; r < d; r++) {
+            double* Rr = this->R[r];
+            for(int c = 0; c < d; c++) {
+                Rr[c] *= f;
+            }
+        }
+        for(int r = 0; r < m; r++) {
+            double* Br = this->B[r];
+            for(int c = 0; c < d; c++) {
+                Br[c] *= this->forgetting;
+            }
+        }
+    }
+
+    // update R with Givens rotations, keeping R' in the lower triangle as
+    // expected by cholsolve
+    for(int c = 0; c < d; c++) {
+        w[c] = input[c];
+    }
+    for(int i = 0; i < d; i++) {
+        double* Ri = this->R[i];
+        double rho = hypot(Ri[i], w[i]);
+        if(rho == 0.0) {
+            continue;
+        }
+        double cs = Ri[i] / rho;
+        double sn = w[i] / rho;
+        Ri[i] = rho;
+        for(int j = i + 1; j < d; j++) {
+            double t = Ri[j];
+            Ri[j] = cs * t + sn * w[j];
+            w[j] = cs * w[j] - sn * t;
+            this->R(j, i) = Ri[j];
+        }
+    }
 
-    // update B
-    this->B = this->B + outerprod(output, input);
+    // gain vector k = (R'R)^-1 x, forward substitution on R' and backward on R
+    for(int i = 0; i < d; i++) {
+        const double* Ri = this->R[i];
+        double v = input[i];
+        for(int j = 0; j < i; j++) {
+            v -= Ri[j] * w[j];
+        }
+        w[i] = v / Ri[i];
+    }
+    for(int i = d - 1; i >= 0; i--) {
+        const double* Ri = this->R[i];
+        double v = w[i];
+        for(int j = i + 1; j < d; j++) {
+            v -= Ri[j] * k[j];
+        }
+        k[i] = v / Ri[i];
+    }
 
-    // update W
-    cholsolve(this->R, this->B, this->W);
+    // update W along the gain with the prediction error, and B
+    for(int r = 0; r < m; r++) {
+        double* Wr = this->W[r];
+        double v = output[r];
+        for(int c = 0; c < d; c++) {
+            v -= Wr[c] * input[c];
+        }
+        e[r] = v;
+    }
+    for(int r = 0; r < m; r++) {
+        double* Wr = this->W[r];
+        double* Br = this->B[r];
+        for(int c = 0; c < d; c++) {
+            Wr[c] += e[r] * k[c];
+            Br[c] += output[r] * input[c];
+        }
+    }
 
     this->sampleCount++;
 }
@@ -99,12 +197,16 @@ void RLSLearner::reset() {
     this->R = eye(this->getDomainSize(), this->getDomainSize()) * sqrt(this->lambda);
     this->B = zeros(this->getCoDomainSize(), this->getDomainSize());
     this->W = zeros(this->getCoDomainSize(), this->getDomainSize());
+    this->work.resize(this->getDomainSize());
+    this->gain.resize(this->getDomainSize());
+    this->error.resize(this->getCoDomainSize());
 }
 
 std::string RLSLearner::getInfo() {
     std::ostringstream buffer;
     buffer << this->IFixedSizeLearner::getInfo();
     buffer << "Lambda: " << this->getLambda() << " | ";
+    buffer << "Forgetting: " << this->getForgetting() << " | ";
     buffer << "Sample Count: " << this->sampleCount << std::endl;
     //for(unsigned int i = 0; i < this->machines.size(); i++) {
     //    buffer << "  [" << (i + 1) << "] ";
@@ -118,6 +220,7 @@ std::string RLSLearner::getConfigHelp() {
     std::ostringstream buffer;
     buffer << this->IFixedSizeLearner::getConfigHelp();
     buffer << "  lambda val            Regularization parameter lambda" << std::endl;
+    buffer << "  forgetting val        Forgetting factor of former samples" << std::endl;
     return buffer.str();
 }
 
@@ -156,6 +259,18 @@ double RLSLearner::getLambda() {
     return this->lambda;
 }
 
+void RLSLearner::setForgetting(double f) {
+    if(f > 0.0 && f <= 1.0) {
+        this->forgetting = f;
+    } else{
+        throw std::runtime_error("Forgetting factor has to be in (0, 1]");
+    }
+}
+
+double RLSLearner::getForgetting() {
+    return this->forgetting;
+}
+
 
 bool RLSLearner::configure(yarp::os::Searchable& config) {
     bool success = this->IFixedSizeLearner::configure(config);
@@ -166,6 +281,12 @@ bool RLSLearner::configure(yarp::os::Searchable& config) {
         success = true;
     }
 
+    // format: set forgetting val
+    if(config.find("forgetting").isFloat64() || config.find("forgetting").isInt32()) {
+        this->setForgetting(config.find("forgetting").asFloat64());
+        success = true;
+    }
+
     return success;
 }
 
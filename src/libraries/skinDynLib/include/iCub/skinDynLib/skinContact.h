@@ -32,6 +32,7 @@
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <cstdint>
 #include <yarp/sig/Vector.h>
 #include "iCub/skinDynLib/dynContact.h"
 
@@ -41,6 +42,29 @@ namespace iCub
 namespace skinDynLib
 {
 
+/**
+* @ingroup skinDynLib
+*
+* Fixed-size record of a skinContact in the packed encoding of a skinContactList
+* (see skinContactList::setPackedEncoding). The active taxel ids are not part of
+* the record: they are stored in a single array for all the contacts of the list.
+*/
+struct packedSkinContact
+{
+    double CoP[3];
+    double F[3];
+    double Mu[3];
+    double geoCenter[3];
+    double normalDir[3];
+    double pressure;
+    std::int32_t contactId;
+    std::int32_t bodyPart;
+    std::int32_t linkNumber;
+    std::int32_t skinPart;
+    std::int32_t firstTaxel;        // position of the first active taxel id in the array of the list
+    std::int32_t activeTaxels;
+};
+
 /** 
 * @ingroup skinDynLib 
 *  
@@ -255,6 +279,21 @@ public:
     */
     virtual bool write(yarp::os::ConnectionWriter& connection) const override;
 
+    /**
+    * Fill the packed record of this skinContact.
+    * @param p the record to fill
+    * @param firstTaxel position of the active taxel ids of this contact in the array of the list
+    * @param taxels where to store the ids of the active taxels, i.e. the array of the list plus firstTaxel
+    */
+    void toPacked(packedSkinContact &p, std::int32_t firstTaxel, std::int32_t *taxels) const;
+
+    /**
+    * Set this skinContact from its packed record.
+    * @param p the record
+    * @param taxels the ids of the p.activeTaxels active taxels
+    */
+    void fromPacked(const packedSkinContact &p, const std::int32_t *taxels);
+
     /**
     * Convert this skinContact to a vector. The size of the vector is 21 plus
     * the number of active taxels. The vector contains this data, in this order:
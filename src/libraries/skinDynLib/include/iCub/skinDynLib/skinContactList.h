@@ -27,6 +27,7 @@
 
 #include <vector>
 #include <map>
+#include <cstdint>
 #include <yarp/os/Portable.h>
 #include "iCub/skinDynLib/skinContact.h"
 #include "iCub/skinDynLib/dynContactList.h"
@@ -36,6 +37,25 @@ namespace iCub
 namespace skinDynLib
 {
 
+/**
+* @ingroup skinDynLib
+*
+* Header of a skinContactList in the packed encoding, which is followed by the
+* records of the contacts (packedSkinContact) and by the array of the ids of
+* their active taxels (int32).
+*/
+struct packedSkinContactListHeader
+{
+    std::int32_t tag;               // SKIN_CONTACT_LIST_PACKED_TAG
+    std::int32_t contacts;          // number of contacts
+    std::int32_t taxels;            // size of the array of the taxel ids
+    std::int32_t reserved;
+};
+
+// first int of a skinContactList in the packed encoding, which cannot be mistaken
+// for the BOTTLE_TAG_LIST that starts the default encoding
+const std::int32_t SKIN_CONTACT_LIST_PACKED_TAG = 0x4C434B53;
+
 /** 
 * @ingroup skinDynLib 
 *  
@@ -44,7 +64,9 @@ namespace skinDynLib
 class skinContactList  : public std::vector<skinContact>, public yarp::os::Portable
 {
 protected:
-    
+    bool packed;
+    std::vector<char> packedBuffer;     // used by read()
+
 public:
     //~~~~~~~~~~~~~~~~~~~~~~
     //   CONSTRUCTORS
@@ -85,6 +107,53 @@ public:
     */
     virtual bool write(yarp::os::ConnectionWriter& connection) const;
 
+    /**
+    * Select the encoding used by write(). The default one represents each contact
+    * as a list of 8 tagged lists (see skinContact::write), so that it can be read
+    * as a Bottle. The packed one is a fixed-size record for each contact followed
+    * by the ids of the active taxels (see packedSkinContactListHeader), which is
+    * much faster to write and read. read() accepts both encodings, and the
+    * connections in text mode always get the default one.
+    * @param packed true to use the packed encoding
+    */
+    void setPackedEncoding(bool packed);
+
+    /**
+    * @return true if write() uses the packed encoding
+    */
+    bool isPackedEncoding() const { return packed; }
+
+    /**
+    * Encode this skinContactList in the packed encoding.
+    * @param buffer the buffer to fill
+    */
+    void pack(std::vector<char> &buffer) const;
+
+    /**
+    * Set this skinContactList from its packed encoding.
+    * @param buffer the encoded list
+    * @param size size of the buffer
+    * @return true iff the buffer contains a valid skinContactList
+    */
+    bool unpack(const char *buffer, size_t size);
+
+    /**
+    * Read the rest of a skinContactList in the packed encoding, once its
+    * tag has been read from the connection.
+    * @param connection the connection to read from
+    * @param buffer filled with the whole encoded list, tag included
+    * @return true iff a skinContactList was read correctly
+    */
+    static bool readPacked(yarp::os::ConnectionReader& connection, std::vector<char> &buffer);
+
+    /**
+    * Check the packed encoding of a skinContactList.
+    * @param buffer the encoded list
+    * @param size size of the buffer
+    * @return true iff the buffer contains a valid skinContactList
+    */
+    static bool checkPacked(const char *buffer, size_t size);
+
     /**
      * Convert this skinContactList to a dynContactList casting all its elements
      * to dynContact.
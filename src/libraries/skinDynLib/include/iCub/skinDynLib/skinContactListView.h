@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#ifndef __SKINCONTLISTVIEW_H__
+#define __SKINCONTLISTVIEW_H__
+
+#include <vector>
+#include <cstdint>
+#include <yarp/os/Portable.h>
+#include "iCub/skinDynLib/skinContactList.h"
+
+namespace iCub
+{
+namespace skinDynLib
+{
+
+/**
+* @ingroup skinDynLib
+*
+* Read-only view of a skinContactList in the packed encoding (see
+* skinContactList::setPackedEncoding). Reading a list only copies it into a
+* buffer that is reused from one read to the next, and the contacts are
+* accessed through their packed records, thus no memory is allocated for
+* each contact. A list in the default encoding is accepted as well, but it
+* is converted to the packed one.
+*/
+class skinContactListView : public yarp::os::Portable
+{
+protected:
+    // the list in the packed encoding
+    std::vector<char> buffer;
+    // used to convert the lists received in the default encoding
+    skinContactList list;
+
+    const packedSkinContactListHeader& header() const;
+    const packedSkinContact* records() const;
+    const std::int32_t* taxels() const;
+
+public:
+    /**
+    * Create an empty view.
+    */
+    skinContactListView();
+
+    /**
+    * @return the number of contacts
+    */
+    size_t size() const;
+
+    /**
+    * @return true if there are no contacts
+    */
+    bool empty() const;
+
+    /**
+    * @param i the index of a contact, which is not checked
+    * @return the packed record of the contact
+    */
+    const packedSkinContact& operator[](size_t i) const;
+
+    /**
+    * @param i the index of a contact, which is not checked
+    * @return the ids of the active taxels of the contact, i.e.
+    *         (*this)[i].activeTaxels values
+    */
+    const std::int32_t* getTaxels(size_t i) const;
+
+    /**
+    * @return the contacts as a skinContactList
+    */
+    skinContactList toSkinContactList() const;
+
+    /**
+    * Read a skinContactList, in either encoding, from a connection.
+    * @return true iff a skinContactList was read correctly
+    */
+    virtual bool read(yarp::os::ConnectionReader& connection) override;
+
+    /**
+    * Write the skinContactList in the packed encoding to a connection,
+    * or in the default one if the connection is in text mode.
+    * @return true iff the skinContactList was written correctly
+    */
+    virtual bool write(yarp::os::ConnectionWriter& connection) const override;
+};
+
+}
+
+}
+#endif
+
@@ -217,6 +217,43 @@ bool skinContact::read(ConnectionReader& connection){
     return !connection.isError();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void skinContact::toPacked(packedSkinContact &p, int32_t firstTaxel, int32_t *taxels) const{
+    for(int i=0;i<3;i++){
+        p.CoP[i]        = CoP[i];
+        p.F[i]          = F[i];
+        p.Mu[i]         = Mu[i];
+        p.geoCenter[i]  = geoCenter[i];
+        p.normalDir[i]  = normalDir[i];
+    }
+    p.pressure      = pressure;
+    p.contactId     = (int32_t)contactId;
+    p.bodyPart      = bodyPart;
+    p.linkNumber    = linkNumber;
+    p.skinPart      = skinPart;
+    p.firstTaxel    = firstTaxel;
+    p.activeTaxels  = activeTaxels;
+    for(unsigned int i=0;i<activeTaxels;i++)
+        taxels[i] = taxelList[i];
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void skinContact::fromPacked(const packedSkinContact &p, const int32_t *taxels){
+    contactId   = p.contactId;
+    bodyPart    = (BodyPart)p.bodyPart;
+    linkNumber  = p.linkNumber;
+    skinPart    = (SkinPart)p.skinPart;
+    for(int i=0;i<3;i++){
+        CoP[i]          = p.CoP[i];
+        F[i]            = p.F[i];
+        Mu[i]           = p.Mu[i];
+        geoCenter[i]    = p.geoCenter[i];
+        normalDir[i]    = p.normalDir[i];
+    }
+    setForce(F);
+    activeTaxels = p.activeTaxels;
+    taxelList.assign(taxels, taxels+activeTaxels);
+    pressure    = p.pressure;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 Vector skinContact::toVector() const{
     Vector v(activeTaxels+21);
     unsigned int index = 0;
@@ -9,6 +9,7 @@
 #include <sstream>
 #include <iomanip>
 #include <string>
+#include <cstring>
 
 #include <yarp/os/ConnectionReader.h>
 #include <yarp/os/ConnectionWriter.h>
@@ -25,10 +26,10 @@ using namespace iCub::skinDynLib;
 //   CONSTRUCTORS
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 skinContactList::skinContactList()
-:vector<skinContact>(){}
+:vector<skinContact>(), packed(false){}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 skinContactList::skinContactList(const size_type &n, const skinContact& value)
-:vector<skinContact>(n, value){}
+:vector<skinContact>(n, value), packed(false){}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 skinContactList skinContactList::filterBodyPart(const BodyPart &bp)
 {
@@ -59,9 +60,16 @@ map<SkinPart, skinContactList> skinContactList::splitPerSkinPart()
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool skinContactList::read(ConnectionReader& connection)
 {
+    // auto-convert text mode interaction
+    connection.convertTextMode();
+
+    std::int32_t tag = connection.expectInt32();
+    if(tag==SKIN_CONTACT_LIST_PACKED_TAG)
+        return readPacked(connection, packedBuffer) && unpack(packedBuffer.data(), packedBuffer.size());
+
     // A skinContactList is represented as a list of list
     // where each list is a skinContact
-    if(connection.expectInt32()!=BOTTLE_TAG_LIST)
+    if(tag!=BOTTLE_TAG_LIST)
         return false;
 
     int listLength = connection.expectInt32();
@@ -79,6 +87,16 @@ bool skinContactList::read(ConnectionReader& connection)
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool skinContactList::write(ConnectionWriter& connection) const
 {
+    if(packed && !connection.isTextMode())
+    {
+        // the connection keeps its own copy of the block, since the list may be
+        // written to several connections, and written again, before it is sent
+        vector<char> buffer;
+        pack(buffer);
+        connection.appendBlock(buffer.data(), buffer.size());
+        return !connection.isError();
+    }
+
     // A skinContactList is represented as a list of list
     // where each list is a skinContact
     connection.appendInt32(BOTTLE_TAG_LIST);
@@ -91,6 +109,89 @@ bool skinContactList::write(ConnectionWriter& connection) const
     return !connection.isError();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void skinContactList::setPackedEncoding(bool _packed)
+{
+    packed = _packed;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void skinContactList::pack(std::vector<char> &buffer) const
+{
+    std::int32_t taxels = 0;
+    for(const_iterator it=begin(); it!=end(); it++)
+        taxels += it->getActiveTaxels();
+
+    buffer.resize(sizeof(packedSkinContactListHeader)+size()*sizeof(packedSkinContact)+taxels*sizeof(std::int32_t));
+    packedSkinContactListHeader *h = (packedSkinContactListHeader*)buffer.data();
+    h->tag      = SKIN_CONTACT_LIST_PACKED_TAG;
+    h->contacts = (std::int32_t)size();
+    h->taxels   = taxels;
+    h->reserved = 0;
+
+    packedSkinContact *c = (packedSkinContact*)(h+1);
+    std::int32_t *ids = (std::int32_t*)(c+size());
+    std::int32_t first = 0;
+    for(const_iterator it=begin(); it!=end(); it++, c++)
+    {
+        it->toPacked(*c, first, ids+first);
+        first += it->getActiveTaxels();
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContactList::checkPacked(const char *buffer, size_t size)
+{
+    if(size<sizeof(packedSkinContactListHeader))
+        return false;
+    const packedSkinContactListHeader *h = (const packedSkinContactListHeader*)buffer;
+    if(h->tag!=SKIN_CONTACT_LIST_PACKED_TAG || h->contacts<0 || h->taxels<0)
+        return false;
+    if(size!=sizeof(packedSkinContactListHeader)+(size_t)h->contacts*sizeof(packedSkinContact)
+             +(size_t)h->taxels*sizeof(std::int32_t))
+        return false;
+
+    const packedSkinContact *c = (const packedSkinContact*)(h+1);
+    for(std::int32_t i=0; i<h->contacts; i++, c++)
+        if(c->firstTaxel<0 || c->activeTaxels<0 || c->activeTaxels>h->taxels-c->firstTaxel)
+            return false;
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContactList::unpack(const char *buffer, size_t size)
+{
+    if(!checkPacked(buffer, size))
+        return false;
+    const packedSkinContactListHeader *h = (const packedSkinContactListHeader*)buffer;
+    const packedSkinContact *c = (const packedSkinContact*)(h+1);
+    const std::int32_t *ids = (const std::int32_t*)(c+h->contacts);
+
+    if(h->contacts!=(std::int32_t)this->size())
+        resize(h->contacts);
+    for(iterator it=begin(); it!=end(); it++, c++)
+        it->fromPacked(*c, ids+c->firstTaxel);
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContactList::readPacked(ConnectionReader& connection, std::vector<char> &buffer)
+{
+    packedSkinContactListHeader h;
+    h.tag = SKIN_CONTACT_LIST_PACKED_TAG;
+    if(!connection.expectBlock((char*)&h+sizeof(h.tag), sizeof(h)-sizeof(h.tag)))
+        return false;
+    if(h.contacts<0 || h.taxels<0)
+        return false;
+
+    // check the size (when known) before allocating the buffer
+    size_t payload = (size_t)h.contacts*sizeof(packedSkinContact)+(size_t)h.taxels*sizeof(std::int32_t);
+    size_t available = connection.getSize();
+    if(available>0 && payload>available)
+        return false;
+
+    buffer.resize(sizeof(h)+payload);
+    memcpy(buffer.data(), &h, sizeof(h));
+    if(payload>0 && !connection.expectBlock(buffer.data()+sizeof(h), payload))
+        return false;
+    return !connection.isError();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 dynContactList skinContactList::toDynContactList() const
 {
     dynContactList res(this->size());
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
+
+#include "iCub/skinDynLib/skinContactListView.h"
+
+using namespace std;
+using namespace yarp::os;
+using namespace iCub::skinDynLib;
+
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//   CONSTRUCTORS
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+skinContactListView::skinContactListView()
+{
+    list.pack(buffer);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+const packedSkinContactListHeader& skinContactListView::header() const
+{
+    return *(const packedSkinContactListHeader*)buffer.data();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+const packedSkinContact* skinContactListView::records() const
+{
+    return (const packedSkinContact*)(&header()+1);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+const int32_t* skinContactListView::taxels() const
+{
+    return (const int32_t*)(records()+header().contacts);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+size_t skinContactListView::size() const
+{
+    return header().contacts;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContactListView::empty() const
+{
+    return header().contacts==0;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+const packedSkinContact& skinContactListView::operator[](size_t i) const
+{
+    return records()[i];
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+const int32_t* skinContactListView::getTaxels(size_t i) const
+{
+    return taxels()+records()[i].firstTaxel;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+skinContactList skinContactListView::toSkinContactList() const
+{
+    skinContactList res;
+    res.unpack(buffer.data(), buffer.size());
+    return res;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//   SERIALIZATION methods
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContactListView::read(ConnectionReader& connection)
+{
+    connection.convertTextMode();
+
+    bool ok = false;
+    int32_t tag = connection.expectInt32();
+    if(tag==SKIN_CONTACT_LIST_PACKED_TAG)
+        ok = skinContactList::readPacked(connection, buffer) &&
+             skinContactList::checkPacked(buffer.data(), buffer.size());
+    else if(tag==BOTTLE_TAG_LIST)
+    {
+        // the tag has been read already, thus read the contacts one by one
+        int listLength = connection.expectInt32();
+        ok = (listLength>=0);
+        if(ok)
+        {
+            list.resize(listLength);
+            for(skinContactList::iterator it=list.begin(); ok && it!=list.end(); it++)
+                ok = it->read(connection);
+            ok = ok && !connection.isError();
+        }
+        if(ok)
+            list.pack(buffer);
+    }
+
+    // never leave the buffer in an invalid state
+    if(!ok)
+    {
+        list.clear();
+        list.pack(buffer);
+    }
+    return ok;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContactListView::write(ConnectionWriter& connection) const
+{
+    if(connection.isTextMode())
+        return toSkinContactList().write(connection);
+
+    // copied, since the view may read the next list before this one is sent
+    connection.appendBlock(buffer.data(), buffer.size());
+    return !connection.isError();
+}
@@ -49,11 +49,10 @@ public:
                  const int max_iter=IKINCTRL_DISABLED,
                  const unsigned int verbose=0) :
                  iKinIpOptMin(_chain,IKINCTRL_POSE_XYZ,tol,constr_tol,
-                              max_iter,verbose,false) { }
+                              max_iter,verbose,true) { }
 
     void   set_ctrlPose(const unsigned int _ctrlPose) { }
     bool   set_posePriority(const string &priority)   { return false; }
-    void   setHessianOpt(const bool useHessian)       { }   // Hessian not implemented
     Vector solve(const Vector &q0, Vector &xd, const Vector &gDir);
 };
 
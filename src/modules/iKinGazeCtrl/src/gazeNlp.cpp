@@ -46,14 +46,20 @@ protected:
     Vector  q0;
     Vector  q;
     Vector  qRest;
-    Matrix  Hxd;
+    iKinSE3 H;
     Matrix  GeoJacobP;
-    Matrix  AnaJacobZ;    
+    Matrix  dZ;
+    Vector  dMod;
+    Vector  dCosAng;
+    Vector  hess;
 
+    double z[3];
+    double d[3];
     double mod;
     double cosAng;
     double fPitch;
     double dfPitch;
+    double d2fPitch;
 
     double __obj_scaling;
     double __x_scaling;
@@ -65,23 +71,27 @@ protected:
     /************************************************************************/
     void computeQuantities(const Ipopt::Number *x)
     {
-        Vector new_q(dim);
-        for (Ipopt::Index i=0; i<(int)dim; i++)
-            new_q[i]=x[i];
+        bool new_q=firstGo;
+        for (Ipopt::Index i=0; (i<(int)dim) && !new_q; i++)
+            new_q=(q[i]!=x[i]);
 
-        if (!(q==new_q) || firstGo)
+        if (new_q)
         {
             firstGo=false;
-            q=new_q;
 
-            q=chain.setAng(q);
-            Hxd=chain.getH();
-            Hxd(0,3)-=xd[0];
-            Hxd(1,3)-=xd[1];
-            Hxd(2,3)-=xd[2];
-            Hxd(3,3)=0.0;
-            mod=norm(Hxd,3);
-            cosAng=dot(Hxd,2,Hxd,3)/mod;
+            for (unsigned int i=0; i<dim; i++)
+                q[i]=chain(i).setAng(x[i]);
+
+            // z-axis of the head and its position wrt the target
+            chain.getH(H);
+            for (int k=0; k<3; k++)
+            {
+                z[k]=H.R[k][2];
+                d[k]=H.p[k]-xd[k];
+            }
+
+            mod=sqrt(d[0]*d[0]+d[1]*d[1]+d[2]*d[2]);
+            cosAng=(z[0]*d[0]+z[1]*d[1]+z[2]*d[2])/mod;
 
             double offset=5.0*CTRL_DEG2RAD;
             double delta=1.0*CTRL_DEG2RAD;
@@ -94,9 +104,24 @@ protected:
             // approaches its minimum
             fPitch=0.5*(1.0+_tanh);
             dfPitch=0.5*c*(1.0-_tanh*_tanh);
-            
-            GeoJacobP=chain.GeoJacobian();
-            AnaJacobZ=chain.AnaJacobian(2);
+            d2fPitch=-2.0*c*_tanh*dfPitch;
+
+            // the derivatives of the z-axis are given by the
+            // joints axes w_i as dz/dq_i=w_i x z
+            chain.GeoJacobian(GeoJacobP);
+            for (unsigned int i=0; i<dim; i++)
+            {
+                dZ(0,i)=GeoJacobP(4,i)*z[2]-GeoJacobP(5,i)*z[1];
+                dZ(1,i)=GeoJacobP(5,i)*z[0]-GeoJacobP(3,i)*z[2];
+                dZ(2,i)=GeoJacobP(3,i)*z[1]-GeoJacobP(4,i)*z[0];
+
+                double dz_d=dZ(0,i)*d[0]+dZ(1,i)*d[1]+dZ(2,i)*d[2];
+                double z_dd=z[0]*GeoJacobP(0,i)+z[1]*GeoJacobP(1,i)+z[2]*GeoJacobP(2,i);
+                double d_dd=d[0]*GeoJacobP(0,i)+d[1]*GeoJacobP(1,i)+d[2]*GeoJacobP(2,i);
+
+                dMod[i]=d_dd/mod;
+                dCosAng[i]=(dz_d+z_dd-cosAng*dMod[i])/mod;
+            }
         }
     }
 
@@ -124,6 +149,13 @@ public:
         upperBoundInf=std::numeric_limits<double>::max();
 
         qRest.resize(dim,0.0);
+
+        H.eye();
+        GeoJacobP.resize(6,dim);
+        dZ.resize(3,dim);
+        dMod.resize(dim,0.0);
+        dCosAng.resize(dim,0.0);
+        hess.resize(6,0.0);
     }
 
     /************************************************************************/
@@ -151,7 +183,7 @@ public:
         n=dim;
         m=3;
         nnz_jac_g=n+2*(n-1);
-        nnz_h_lag=0;
+        nnz_h_lag=(n*(n+1))>>1;
         index_style=TNLP::C_STYLE;
         
         return true;
@@ -249,8 +281,7 @@ public:
 
             // dg[0]/dxi
             for (Ipopt::Index i=0; i<n; i++)
-                values[i]=(dot(AnaJacobZ,i,Hxd,3)+dot(Hxd,2,GeoJacobP,i))/mod
-                          -(cosAng*dot(Hxd,3,GeoJacobP,i))/(mod*mod);
+                values[i]=dCosAng[i];
 
             // dg[1]/dPitch
             values[3]=(chain(1).getMin()-qRest[1])*dfPitch;
@@ -274,6 +305,67 @@ public:
                 bool new_lambda, Ipopt::Index nele_hess, Ipopt::Index *iRow,
                 Ipopt::Index *jCol, Ipopt::Number *values) override
     {
+        if (!values)
+        {
+            Ipopt::Index idx=0;
+            for (Ipopt::Index row=0; row<n; row++)
+            {
+                for (Ipopt::Index col=0; col<=row; col++)
+                {
+                    iRow[idx]=row;
+                    jCol[idx]=col;
+                    idx++;
+                }
+            }
+        }
+        else
+        {
+            // Given g[0]=<z,d>/|d|, with z the head z-axis and
+            // d the head position wrt the target, the second
+            // derivatives of d come from iKinChain::fastHessian_ij,
+            // whereas d2z/dqidqj=w_i x (w_j x z) for i<=j
+            computeQuantities(x);
+            chain.prepareForHessian(GeoJacobP);
+
+            Ipopt::Index idx=0;
+            for (Ipopt::Index row=0; row<n; row++)
+            {
+                for (Ipopt::Index col=0; col<=row; col++)
+                {
+                    chain.fastHessian_ij(col,row,hess);
+
+                    double d2z[3];
+                    d2z[0]=GeoJacobP(4,col)*dZ(2,row)-GeoJacobP(5,col)*dZ(1,row);
+                    d2z[1]=GeoJacobP(5,col)*dZ(0,row)-GeoJacobP(3,col)*dZ(2,row);
+                    d2z[2]=GeoJacobP(3,col)*dZ(1,row)-GeoJacobP(4,col)*dZ(0,row);
+
+                    double d2N=0.0, d2Mod=0.0;
+                    for (int k=0; k<3; k++)
+                    {
+                        d2N+=d2z[k]*d[k]+dZ(k,col)*GeoJacobP(k,row)+
+                             dZ(k,row)*GeoJacobP(k,col)+z[k]*hess[k];
+                        d2Mod+=GeoJacobP(k,col)*GeoJacobP(k,row)+d[k]*hess[k];
+                    }
+                    d2Mod=(d2Mod-dMod[col]*dMod[row])/mod;
+
+                    double d2CosAng=(d2N-dCosAng[row]*dMod[col]-dCosAng[col]*dMod[row]-
+                                     cosAng*d2Mod)/mod;
+
+                    values[idx]=lambda[0]*d2CosAng;
+
+                    if (row==col)
+                        values[idx]+=obj_factor;
+
+                    // g[1] and g[2] depend nonlinearly only on the pitch
+                    if (row==0)
+                        values[idx]+=(lambda[1]*(chain(1).getMin()-qRest[1])-
+                                      lambda[2]*(chain(1).getMax()-qRest[1]))*d2fPitch;
+
+                    idx++;
+                }
+            }
+        }
+
         return true;
     }
 
@@ -181,6 +181,12 @@ to (cond1)&&(cond2) || (cond1)&&(cond3).
 --db \e dbFileName 
 - The parameter \e dbFileName specifies the name of the database 
   to load at startup (if already existing) and save at shutdown.
+  The database is saved as a binary snapshot, whereas at startup
+  both the snapshot and the text format are recognized.
+ 
+--text-db 
+- If this option is given then the database is saved in the text
+  format instead of the binary snapshot.
  
 --context \e contextName 
 - To specify the context where to search for the database file; 
@@ -257,10 +263,19 @@ reply: [ack] (id (1))
 
 #include <cstdio>
 #include <cstdarg>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <limits>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <algorithm>
+#include <vector>
 #include <map>
+#include <set>
+#include <unordered_map>
 #include <deque>
 
 #include <yarp/os/all.h>
@@ -297,6 +312,11 @@ using namespace yarp::os;
 #define BCTAG_EMPTY                     ("empty")
 #define BCTAG_SYNC                      ("sync")
 #define BCTAG_ASYNC                     ("async")
+                                        
+#define DB_SNAPSHOT_MAGIC               ("OPCDB\x01")
+#define DB_SNAPSHOT_MAGIC_LEN           (6)
+#define DB_TIMERWHEEL_SLOTS             (512)
+#define DB_TIMERWHEEL_MAXTICKS          (1000000000L)
 
 
 namespace relationalOperators
@@ -405,10 +425,14 @@ protected:
         Property *prop;
         double    lastUpdate;
         string    owner;
+        double    lifeStart;    // wheel time at which the lifeTimer was stored
+        long      lifeTick;     // wheel tick at which the item expires (-1 if none)
 
         Item() : prop(NULL),
                  lastUpdate(OPT_DISABLED),
-                 owner(OPT_OWNERSHIP_ALL) { }
+                 owner(OPT_OWNERSHIP_ALL),
+                 lifeStart(0.0),
+                 lifeTick(-1) { }
     };
 
     /************************************************************************/
@@ -419,17 +443,250 @@ protected:
         Value val;
     };
 
+    /************************************************************************/
+    struct Number   // ordered by type first, since numbers compare within the same type only
+    {
+        bool   isInt;
+        double val;
+        int    id;
+
+        Number(const bool isInt, const double val, const int id) :
+               isInt(isInt), val(val), id(id) { }
+
+        bool operator<(const Number &n) const
+        {
+            if (isInt!=n.isInt)
+                return (isInt<n.isInt);
+            else if (val!=n.val)
+                return (val<n.val);
+            else
+                return (id<n.id);
+        }
+    };
+
+    /************************************************************************/
+    struct Index    // the items holding a given property
+    {
+        std::set<int> ids;
+        unordered_map<string,std::set<int>> strings;    // for equality tests
+        std::set<Number> numbers;                       // for range tests
+    };
+
+    /************************************************************************/
+    struct Range    // the numbers of a property satisfying some conditions
+    {
+        string prop;
+        bool   isInt;
+        std::set<Number>::const_iterator first,last;
+    };
+
     ResourceFinder *rf;
     map<int,Item> itemsMap;
+    unordered_map<string,Index> indexes;
     mutex mtx;
     int  idCnt;
     bool initialized;
     bool nosavedb;
+    bool textdb;
     bool quitting;
 
+    vector<vector<pair<long,int>>> timerWheel;  // (tick,id) of the life-timers
+    long   wheelTick;
+    double wheelTime;
+    double wheelPeriod;
+
     BufferedPort<Bottle> *pBroadcastPort;
     bool asyncBroadcast;
 
+    /************************************************************************/
+    static Property *toProperty(const Bottle &content)
+    {
+        // fill the property straight with the ("prop" <val>) pairs
+        // and resort to the parser only for any other content
+        Property *prop=new Property;
+        for (int i=0; i<content.size(); i++)
+        {
+            Bottle *option=content.get(i).asList();
+            if ((option==NULL) || (option->size()!=2) || !option->get(0).isString())
+            {
+                delete prop;
+                return new Property(content.toString().c_str());
+            }
+
+            prop->put(option->get(0).asString(),option->get(1));
+        }
+
+        return prop;
+    }
+
+    /************************************************************************/
+    void indexProperty(const int id, const string &prop, Value &val,
+                       const bool insert)
+    {
+        Index &index=indexes[prop];
+        if (insert)
+            index.ids.insert(id);
+        else
+            index.ids.erase(id);
+
+        // the lifeTimer changes over time, hence its value is not indexed;
+        // NaN does not compare and would break the ordering, hence neither
+        if (prop!=PROP_LIFETIMER)
+        {
+            if (val.isFloat64())
+            {
+                double d=val.asFloat64();
+                if (d==d)
+                {
+                    if (insert)
+                        index.numbers.insert(Number(false,d,id));
+                    else
+                        index.numbers.erase(Number(false,d,id));
+                }
+            }
+            else if (val.isInt32())
+            {
+                if (insert)
+                    index.numbers.insert(Number(true,val.asInt32(),id));
+                else
+                    index.numbers.erase(Number(true,val.asInt32(),id));
+            }
+            else if (val.isString())
+            {
+                if (insert)
+                    index.strings[val.asString()].insert(id);
+                else
+                {
+                    unordered_map<string,std::set<int>>::iterator it=index.strings.find(val.asString());
+                    if (it!=index.strings.end())
+                    {
+                        it->second.erase(id);
+                        if (it->second.empty())
+                            index.strings.erase(it);
+                    }
+                }
+            }
+        }
+
+        if (index.ids.empty())
+            indexes.erase(prop);
+    }
+
+    /************************************************************************/
+    void indexItem(const int id, Property *pProp, const bool insert)
+    {
+        Bottle content;
+        content.read(*pProp);
+        for (int i=0; i<content.size(); i++)
+        {
+            if (Bottle *option=content.get(i).asList())
+            {
+                if (option->size()<2)
+                    continue;
+
+                string prop=option->get(0).asString();
+                indexProperty(id,prop,pProp->find(prop),insert);
+            }
+        }
+    }
+
+    /************************************************************************/
+    long lifeTicks(const double lifeTimer) const
+    {
+        // the item expires at the first tick its lifeTimer runs out
+        if (lifeTimer!=lifeTimer)
+            return DB_TIMERWHEEL_MAXTICKS;
+
+        double ticks=ceil(lifeTimer/wheelPeriod);
+        if (ticks<1.0)
+            return 1;
+        else if (ticks>(double)DB_TIMERWHEEL_MAXTICKS)
+            return DB_TIMERWHEEL_MAXTICKS;
+        else
+            return (long)ticks;
+    }
+
+    /************************************************************************/
+    void schedule(const int id, Item &item, const double lifeTimer)
+    {
+        // entries left behind by former schedules are dropped as stale
+        // when met, since they do not match the item's lifeTick anymore
+        item.lifeTick=wheelTick+lifeTicks(lifeTimer);
+        timerWheel[item.lifeTick%DB_TIMERWHEEL_SLOTS].push_back(make_pair(item.lifeTick,id));
+    }
+
+    /************************************************************************/
+    void scheduleItem(const int id, Item &item)
+    {
+        // to be called whenever the lifeTimer has been stored anew
+        item.lifeStart=wheelTime;
+        if (item.prop->check(PROP_LIFETIMER))
+            schedule(id,item,item.prop->find(PROP_LIFETIMER).asFloat64());
+        else
+            item.lifeTick=-1;
+    }
+
+    /************************************************************************/
+    double remainingLife(const Item &item) const
+    {
+        return item.prop->find(PROP_LIFETIMER).asFloat64()-(wheelTime-item.lifeStart);
+    }
+
+    /************************************************************************/
+    void refreshLifeTimer(Item &item)
+    {
+        // bring the stored lifeTimer up to date before it is read
+        if ((item.lifeTick>=0) && (item.lifeStart!=wheelTime))
+        {
+            double lifeTimer=remainingLife(item);
+            item.prop->unput(PROP_LIFETIMER);
+            item.prop->put(PROP_LIFETIMER,lifeTimer);
+            item.lifeStart=wheelTime;
+        }
+    }
+
+    /************************************************************************/
+    Item &insertItem(const int id, Property *pProp)
+    {
+        map<int,Item>::iterator it=itemsMap.find(id);
+        if (it!=itemsMap.end())
+            eraseItem(it);
+
+        Item &item=itemsMap[id];
+        item.prop=pProp;
+        indexItem(id,pProp,true);
+        scheduleItem(id,item);
+
+        return item;
+    }
+
+    /************************************************************************/
+    void putProperty(const int id, Item &item, const string &prop, const Value &val)
+    {
+        if (item.prop->check(prop))
+            indexProperty(id,prop,item.prop->find(prop),false);
+
+        item.prop->unput(prop);
+        item.prop->put(prop,val);
+        indexProperty(id,prop,item.prop->find(prop),true);
+
+        if (prop==PROP_LIFETIMER)
+            scheduleItem(id,item);
+    }
+
+    /************************************************************************/
+    void unputProperty(const int id, Item &item, const string &prop)
+    {
+        if (item.prop->check(prop))
+        {
+            indexProperty(id,prop,item.prop->find(prop),false);
+            item.prop->unput(prop);
+
+            if (prop==PROP_LIFETIMER)
+                scheduleItem(id,item);
+        }
+    }
+
     /************************************************************************/
     void clear()
     {
@@ -437,11 +694,15 @@ protected:
             delete it->second.prop;
 
         itemsMap.clear();
+        indexes.clear();
+        for (size_t i=0; i<timerWheel.size(); i++)
+            timerWheel[i].clear();
     }
 
     /************************************************************************/
     void eraseItem(map<int,Item>::iterator &it)
     {
+        indexItem(it->first,it->second.prop,false);
         delete it->second.prop;
         itemsMap.erase(it);
     }
@@ -451,56 +712,278 @@ protected:
     {
         int i=0;
         for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+        {
+            refreshLifeTimer(it->second);
             fprintf(stream,"item_%d (%s %d) (%s)\n",
                     i++,PROP_ID,it->first,it->second.prop->toString().c_str());
+        }
+    }
+
+    /************************************************************************/
+    void writeSnapshot(FILE *stream)
+    {
+        // the snapshot is the binary form of the bottle
+        // ((<id0> (("prop0" <val0>) ...)) (<id1> (...)) ...)
+        Bottle content;
+        for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+        {
+            refreshLifeTimer(it->second);
+            Bottle &item=content.addList();
+            item.addInt32(it->first);
+            item.addList().read(*it->second.prop);
+        }
+
+        size_t size=0;
+        const char *buf=content.toBinary(&size);
+        uint64_t len=size;
+
+        fwrite(DB_SNAPSHOT_MAGIC,1,DB_SNAPSHOT_MAGIC_LEN,stream);
+        fwrite(&len,sizeof(len),1,stream);
+        fwrite(buf,1,size,stream);
     }
 
     /************************************************************************/
-    bool recursiveCheck(Property *item, deque<Condition> &condList,
-                        deque<string> &opList, const unsigned int i=0)
+    bool loadSnapshot(const string &dbFileName)
     {
-        bool result;
-        if (item->check(condList[i].prop))
+        FILE *fin=fopen(dbFileName.c_str(),"rb");
+        if (fin==NULL)
+            return false;
+
+        char magic[DB_SNAPSHOT_MAGIC_LEN];
+        if ((fread(magic,1,DB_SNAPSHOT_MAGIC_LEN,fin)!=DB_SNAPSHOT_MAGIC_LEN) ||
+            (memcmp(magic,DB_SNAPSHOT_MAGIC,DB_SNAPSHOT_MAGIC_LEN)!=0))
         {
-            // take the current value of the item's property under test
-            Value &val=item->find(condList[i].prop);
+            fclose(fin);
+            return false;
+        }
 
-            // compute the condition over the current value
-            result=(*condList[i].compare)(val,condList[i].val);
+        uint64_t len=0;
+        bool ok=(fread(&len,sizeof(len),1,fin)==1);
+        if (ok)
+        {
+            long pos=ftell(fin);
+            fseek(fin,0,SEEK_END);
+            ok=(len==(uint64_t)(ftell(fin)-pos));
+            fseek(fin,pos,SEEK_SET);
+        }
+
+        vector<char> buf;
+        if (ok)
+        {
+            buf.resize((size_t)len);
+            ok=(fread(buf.data(),1,buf.size(),fin)==buf.size());
+        }
+        fclose(fin);
+
+        if (!ok)
+        {
+            yWarning("corrupted database snapshot!");
+            return true;
+        }
+
+        Bottle content;
+        content.fromBinary(buf.data(),buf.size());
+        for (int i=0; i<content.size(); i++)
+        {
+            Bottle *item=content.get(i).asList();
+            if ((item==NULL) || (item->size()<2) || (item->get(1).asList()==NULL))
+            {
+                yWarning("error while loading item_%d!",i);
+                continue;
+            }
+
+            int id=item->get(0).asInt32();
+            insertItem(id,toProperty(*item->get(1).asList()));
+
+            if (idCnt<=id)
+                idCnt=id+1;
+        }
+
+        return true;
+    }
+
+    /************************************************************************/
+    void loadText(const string &dbFileName)
+    {
+        Property finProperty;
+        finProperty.fromConfigFile(dbFileName);
+
+        Bottle finBottle; finBottle.read(finProperty);
+        for (int i=0; i<finBottle.size(); i++)
+        {
+            ostringstream tag;
+            tag<<"item_"<<i;
+            Bottle &b1=finBottle.findGroup(tag.str());
+
+            if (b1.isNull())
+                continue;
+
+            if (b1.size()<3)
+            {
+                yWarning("error while loading %s!",tag.str().c_str());
+                continue;
+            }
+
+            Bottle *b2=b1.get(1).asList();
+            Bottle *b3=b1.get(2).asList();
+            if ((b2==NULL) || (b3==NULL))
+            {
+                yWarning("error while loading %s!",tag.str().c_str());
+                continue;
+            }
+
+            if (b2->size()<2)
+            {
+                yWarning("error while loading %s!",tag.str().c_str());
+                continue;
+            }
+
+            int id=b2->get(1).asInt32();
+            insertItem(id,toProperty(*b3));
+
+            if (idCnt<=id)
+                idCnt=id+1;
+        }
+    }
+
+    /************************************************************************/
+    bool evaluate(Item &item, Condition &condition)
+    {
+        if (!item.prop->check(condition.prop))
+            return false;
+
+        if (condition.prop==PROP_LIFETIMER)
+            refreshLifeTimer(item);
+
+        // take the current value of the item's property under test
+        // and compute the condition over it
+        Value &val=item.prop->find(condition.prop);
+        return (*condition.compare)(val,condition.val);
+    }
+
+    /************************************************************************/
+    void narrow(deque<Range> &ranges, const Index &index, const Condition &condition)
+    {
+        bool isInt=condition.val.isInt32();
+        double val=isInt?(double)condition.val.asInt32():condition.val.asFloat64();
+        Number lo(isInt,val,numeric_limits<int>::min());
+        Number hi(isInt,val,numeric_limits<int>::max());
+        std::set<Number>::const_iterator end=index.numbers.end();
+
+        // the range of a property starts off from all its numbers of the given type
+        size_t i=0;
+        while ((i<ranges.size()) && ((ranges[i].prop!=condition.prop) || (ranges[i].isInt!=isInt)))
+            i++;
+
+        if (i>=ranges.size())
+        {
+            double inf=numeric_limits<double>::infinity();
+            Range range;
+            range.prop=condition.prop;
+            range.isInt=isInt;
+            range.first=index.numbers.lower_bound(Number(isInt,-inf,numeric_limits<int>::min()));
+            range.last=index.numbers.upper_bound(Number(isInt,inf,numeric_limits<int>::max()));
+            ranges.push_back(range);
         }
-        else
-            result=false;
 
-        if ((i+1)>=condList.size())
-            return result;
-        else if (opList[i]=="||")
-            return (result||recursiveCheck(item,condList,opList,i+1));
-        else    // at this point we know we deal with "&&" operations
+        Range &range=ranges[i];
+        std::set<Number>::const_iterator first=range.first;
+        std::set<Number>::const_iterator last=range.last;
+        if (condition.compare==&relationalOperators::equal)
         {
-            unsigned int j;
-            for (j=i+1; j<condList.size(); j++)
+            first=index.numbers.lower_bound(lo);
+            last=index.numbers.upper_bound(hi);
+        }
+        else if (condition.compare==&relationalOperators::greater)
+            first=index.numbers.upper_bound(hi);
+        else if (condition.compare==&relationalOperators::greaterEqual)
+            first=index.numbers.lower_bound(lo);
+        else if (condition.compare==&relationalOperators::lower)
+            last=index.numbers.lower_bound(lo);
+        else if (condition.compare==&relationalOperators::lowerEqual)
+            last=index.numbers.upper_bound(hi);
+
+        // keep the tighter bounds, where the end stands for +infinity
+        if ((first==end) || ((range.first!=end) && (*range.first<*first)))
+            range.first=first;
+        if ((last!=end) && ((range.last==end) || (*last<*range.last)))
+            range.last=last;
+
+        if (range.first==end)
+            range.last=end;
+        else if ((range.last!=end) && (*range.last<*range.first))
+            range.last=range.first;
+    }
+
+    /************************************************************************/
+    bool candidates(deque<Condition> &condList, const size_t first,
+                    const size_t last, vector<int> &ids)
+    {
+        // look for the smallest set of candidates among the items
+        // holding a given string, the items whose numbers fall within
+        // the bounds set by the conditions on a property and, at worst,
+        // the items holding a property; conditions that cannot be
+        // satisfied by any item make the whole group empty
+        const std::set<int> *pIds=NULL;
+        deque<Range> ranges;
+        for (size_t i=first; i<=last; i++)
+        {
+            Condition &condition=condList[i];
+            unordered_map<string,Index>::iterator idx=indexes.find(condition.prop);
+            if (idx==indexes.end())
+                return false;
+
+            Index &index=idx->second;
+            const std::set<int> *ids=&index.ids;
+            if ((condition.prop!=PROP_LIFETIMER) &&
+                (condition.compare!=&relationalOperators::alwaysTrue) &&
+                (condition.compare!=&relationalOperators::notEqual))
             {
-                if (result)
+                if (condition.val.isString() && (condition.compare==&relationalOperators::equal))
                 {
-                    if (item->check(condList[j].prop))
-                    {
-                        Value &val=item->find(condList[j].prop);
-                        result=result&&(*condList[j].compare)(val,condList[j].val);
-                    }
-                    else
-                        result=false;
+                    unordered_map<string,std::set<int>>::iterator it=index.strings.find(condition.val.asString());
+                    if (it==index.strings.end())
+                        return false;
+
+                    ids=&it->second;
                 }
+                else if (condition.val.isInt32() ||
+                         (condition.val.isFloat64() && (condition.val.asFloat64()==condition.val.asFloat64())))
+                    narrow(ranges,index,condition);
+                else    // the relational operators do not hold for these values
+                    return false;
+            }
+
+            if ((pIds==NULL) || (ids->size()<pIds->size()))
+                pIds=ids;
+        }
+
+        // count the items of the ranges, yet not beyond the best figure
+        size_t size=pIds->size();
+        size_t best=ranges.size();
+        for (size_t i=0; i<ranges.size(); i++)
+        {
+            size_t n=0;
+            for (std::set<Number>::const_iterator it=ranges[i].first; (it!=ranges[i].last) && (n<size); it++)
+                n++;
 
-                if (j<opList.size())
-                    if (opList[j]=="||")
-                        break;
+            if (n<size)
+            {
+                size=n;
+                best=i;
             }
+        }
 
-            if (j>=condList.size())
-                return result;
-            else
-                return (result||recursiveCheck(item,condList,opList,j+1));
+        ids.clear();
+        if (best<ranges.size())
+        {
+            for (std::set<Number>::const_iterator it=ranges[best].first; it!=ranges[best].last; it++)
+                ids.push_back(it->id);
         }
+        else
+            ids.assign(pIds->begin(),pIds->end());
+
+        return true;
     }
 
     /************************************************************************/
@@ -517,8 +1000,14 @@ public:
         asyncBroadcast=false;
         initialized=false;
         nosavedb=false;
+        textdb=false;
         quitting=false;
         idCnt=0;
+
+        timerWheel.resize(DB_TIMERWHEEL_SLOTS);
+        wheelTick=0;
+        wheelTime=0.0;
+        wheelPeriod=1.0;
     }
 
     /************************************************************************/
@@ -542,6 +1031,7 @@ public:
         }
 
         nosavedb=rf.check("no-save-db");
+        textdb=rf.check("text-db");
         if (!rf.check("no-load-db"))
             load();
 
@@ -580,45 +1070,10 @@ public:
         clear();
         idCnt=0;
 
-        Property finProperty;
-        finProperty.fromConfigFile(dbFileName);
-
-        Bottle finBottle; finBottle.read(finProperty);
-        for (int i=0; i<finBottle.size(); i++)
-        {
-            ostringstream tag;
-            tag<<"item_"<<i;
-            Bottle &b1=finBottle.findGroup(tag.str());
-
-            if (b1.isNull())
-                continue;
-
-            if (b1.size()<3)
-            {
-                yWarning("error while loading %s!",tag.str().c_str());
-                continue;
-            }
-
-            Bottle *b2=b1.get(1).asList();
-            Bottle *b3=b1.get(2).asList();
-            if ((b2==NULL) || (b3==NULL))
-            {
-                yWarning("error while loading %s!",tag.str().c_str());
-                continue;
-            }
-
-            if (b2->size()<2)
-            {
-                yWarning("error while loading %s!",tag.str().c_str());
-                continue;
-            }
-
-            int id=b2->get(1).asInt32();
-            itemsMap[id].prop=new Property(b3->toString().c_str());
-
-            if (idCnt<=id)
-                idCnt=id+1;
-        }
+        // the content is either a binary snapshot or,
+        // as saved by former versions, in text format
+        if (!loadSnapshot(dbFileName))
+            loadText(dbFileName);
 
         yInfo("database loaded");
     }
@@ -635,8 +1090,17 @@ public:
         dbFileName+=rf->find("db").asString();
         yInfo("saving database in %s ...",dbFileName.c_str());
 
-        FILE *fout=fopen(dbFileName.c_str(),"w");
-        write(fout);
+        FILE *fout=fopen(dbFileName.c_str(),textdb?"w":"wb");
+        if (fout==NULL)
+        {
+            yWarning("unable to open %s!",dbFileName.c_str());
+            return;
+        }
+
+        if (textdb)
+            write(fout);
+        else
+            writeSnapshot(fout);
         fclose(fout);
 
         yInfo("database stored");
@@ -670,6 +1134,7 @@ public:
                     bottle.addString(BCTAG_EMPTY);
                 else for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
                 {
+                    refreshLifeTimer(it->second);
                     Bottle &item=bottle.addList();
                     item.read(*it->second.prop);
 
@@ -696,8 +1161,8 @@ public:
         }
 
         lock_guard<mutex> lck(mtx);
-        itemsMap[idCnt].prop=new Property(content->toString().c_str());
-        itemsMap[idCnt].lastUpdate=Time::now();
+        Item &item=insertItem(idCnt,toProperty(*content));
+        item.lastUpdate=Time::now();
 
         return true;
     }
@@ -738,7 +1203,7 @@ public:
             if (propSet!=NULL)
             {
                 for (int i=0; i<propSet->size(); i++)
-                    it->second.prop->unput(propSet->get(i).asString());
+                    unputProperty(it->first,it->second,propSet->get(i).asString());
 
                 it->second.lastUpdate=Time::now();
             }
@@ -769,6 +1234,7 @@ public:
         map<int,Item>::iterator it=itemsMap.find(id);
         if (it!=itemsMap.end())
         {
+            refreshLifeTimer(it->second);
             Property *pProp=it->second.prop;
             response.clear();
 
@@ -815,7 +1281,6 @@ public:
             string owner=it->second.owner;
             if ((owner==OPT_OWNERSHIP_ALL) || (owner==agent))
             {
-                Property *pProp=it->second.prop;
                 for (int i=0; i<content->size(); i++)
                 {
                     if (Bottle *option=content->get(i).asList())
@@ -829,8 +1294,7 @@ public:
                         if (prop==PROP_ID)
                             continue;
 
-                        pProp->unput(prop);
-                        pProp->put(prop,val);
+                        putProperty(it->first,it->second,prop,val);
                     }
                     else
                         continue;
@@ -1061,15 +1525,42 @@ public:
 
         response.clear();
 
-        // apply the conditions to each item
-        for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+        // the conditions are resolved as "||" of groups of "&&": the
+        // items of each group are sought among the candidates picked
+        // up from the indexes rather than throughout the database
+        vector<int> ids,items;
+        size_t first=0;
+        while (first<condList.size())
         {
-            // do recursion and keep only the item that
-            // satisfies the whole list of conditions
-            if (recursiveCheck(it->second.prop,condList,opList))
-                response.addInt32(it->first);
+            size_t last=first;
+            while ((last<opList.size()) && (opList[last]=="&&"))
+                last++;
+
+            if (candidates(condList,first,last,items))
+            {
+                for (size_t k=0; k<items.size(); k++)
+                {
+                    map<int,Item>::iterator it=itemsMap.find(items[k]);
+                    if (it==itemsMap.end())
+                        continue;
+
+                    bool result=true;
+                    for (size_t i=first; (i<=last) && result; i++)
+                        result=evaluate(it->second,condList[i]);
+
+                    if (result)
+                        ids.push_back(items[k]);
+                }
+            }
+
+            first=last+1;
         }
 
+        sort(ids.begin(),ids.end());
+        ids.erase(unique(ids.begin(),ids.end()),ids.end());
+        for (size_t i=0; i<ids.size(); i++)
+            response.addInt32(ids[i]);
+
         return true;
     }
 
@@ -1077,24 +1568,54 @@ public:
     void periodicHandler(const double dt)   // manage the items life-timers
     {
         mtx.lock();
+
+        // the ticks to expiry depend on the period, hence
+        // a new period requires the wheel to be set up anew
+        if (dt!=wheelPeriod)
+        {
+            wheelPeriod=dt;
+            for (size_t i=0; i<timerWheel.size(); i++)
+                timerWheel[i].clear();
+
+            for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+                if (it->second.lifeTick>=0)
+                    schedule(it->first,it->second,remainingLife(it->second));
+        }
+
+        // advance the timer wheel by one tick and go only
+        // through the items that are due to expire at this tick
+        wheelTime+=dt;
+        wheelTick++;
+
+        vector<pair<long,int>> &slot=timerWheel[wheelTick%DB_TIMERWHEEL_SLOTS];
+        vector<int> expiring;
+        size_t n=0;
+        for (size_t i=0; i<slot.size(); i++)
+        {
+            if (slot[i].first>wheelTick)
+                slot[n++]=slot[i];
+            else
+                expiring.push_back(slot[i].second);
+        }
+        slot.resize(n);
+
         bool erased=false;
-        for (map<int,Item>::iterator it=itemsMap.begin(); it!=itemsMap.end(); it++)
+        for (size_t i=0; i<expiring.size(); i++)
         {
-            Property *pProp=it->second.prop;
-            if (pProp->check(PROP_LIFETIMER))
+            map<int,Item>::iterator it=itemsMap.find(expiring[i]);
+            if ((it==itemsMap.end()) || (it->second.lifeTick!=wheelTick))
+                continue;
+
+            double lifeTimer=remainingLife(it->second);
+            if (lifeTimer<=0.0)
             {
-                double lifeTimer=pProp->find(PROP_LIFETIMER).asFloat64()-dt;
-                if (lifeTimer<=0.0)
-                {
-                    eraseItem(it);
-                    erased=true;
-                    break;
-                }
-                else
-                {
-                    pProp->unput(PROP_LIFETIMER);
-                    pProp->put(PROP_LIFETIMER,lifeTimer);
-                }
+                eraseItem(it);
+                erased=true;
+            }
+            else    // rounding has anticipated the expiry
+            {
+                refreshLifeTimer(it->second);
+                schedule(it->first,it->second,lifeTimer);
             }
         }
         mtx.unlock();
@@ -1434,7 +1955,7 @@ public:
                             if (idList->get(0).asString()==PROP_ID)
                             {
                                 int id=idList->get(1).asInt32();
-                                itemsMap[id].prop=new Property(item->tail().toString().c_str());
+                                insertItem(id,toProperty(item->tail()));
 
                                 if (idCnt<=id)
                                     idCnt=id+1;
@@ -1642,6 +2163,7 @@ int main(int argc, char *argv[])
         printf("\t--context  <context>: context to search for database file (default: objectsPropertiesCollector)\n");
         printf("\t--no-load-db        : start an empty database\n");
         printf("\t--no-save-db        : prevent from saving the content of database at shutdown\n");
+        printf("\t--text-db           : save the database in text format rather than as binary snapshot\n");
         printf("\t--sync-bc        <T>: broadcast the database content each T seconds\n");
         printf("\t--async-bc          : broadcast the database content whenever a change occurs\n");
         printf("\t--stats             : enable statistics printouts\n");
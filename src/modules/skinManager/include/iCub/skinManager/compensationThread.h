@@ -139,6 +139,7 @@ private:
 
     // SKIN EVENTS
     bool skinEventsOn;
+    bool skinEventsPacked;              // true if the skin events are written in the packed encoding
 
     /* ports */
     BufferedPort<skinContactList> skinEventsPort;   // skin events output port
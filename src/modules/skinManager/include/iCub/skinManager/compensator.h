@@ -71,7 +71,15 @@ private:
     unsigned int linkNum;                       // number of the link
 
     // SKIN CONTACTS
-    vector< list<int> >     neighborsXtaxel;    // list of neighbors for each taxel    
+    // the neighbors of the taxel i are neighbors[neighborsOffset[i]] ... neighbors[neighborsOffset[i+1]-1];
+    // the taxels without position (i.e. in the origin) are neighbors of one another and are not listed
+    vector<int>             neighborsOffset;
+    vector<int>             neighbors;
+    vector<unsigned char>   taxelNoPos;         // 1 if the taxel has no position
+    vector<unsigned char>   taxelNearOrigin;    // 1 if the taxel has a position and is neighbor of the taxels without position
+    unsigned int            taxelsNoPos;        // number of taxels without position
+    vector<int>             contactRoot;        // union-find forest of the active taxels, used to cluster them into contacts
+    vector<int>             contactXtaxel;      // contact of each active taxel
     vector<Vector>          taxelPos;           // taxel positions {xPos, yPos, zPos}
     vector<Vector>          taxelOri;           // taxel normals {xOri, yOri, zOri}
     Vector                  taxelPoseConfidence;// taxels pose estimation confidence
@@ -79,9 +87,10 @@ private:
     mutex                   poseSem;            // mutex to access taxel poses
 
     // COMPENSATION
-    vector<bool> touchDetected;                 // true if touch has been detected in the last read of the taxel
-    vector<bool> touchDetectedFilt;             // true if touch has been detected after applying the filtering
-    vector<bool> subTouchDetected;              // true if the taxel value has gone under the baseline (because of touch in neighbouring taxels)
+    // the per-taxel flags are stored as bytes (not as vector<bool>) so that the compensation kernel can write them in blocks
+    vector<unsigned char> touchDetected;        // 1 if touch has been detected in the last read of the taxel
+    vector<unsigned char> touchDetectedFilt;    // 1 if touch has been detected after applying the filtering
+    vector<unsigned char> subTouchDetected;     // 1 if the taxel value has gone under the baseline (because of touch in neighbouring taxels)
     Vector rawData;                             // data read from the skin
     Vector touchThresholds;                     // thresholds for discriminating between "touch" and "no touch"
     mutex touchThresholdSem;                    // semaphore for controlling the access to the touchThreshold
@@ -90,6 +99,7 @@ private:
     Vector compensatedData;                     // compensated tactile data (that is rawData-touchThreshold)
     Vector compensatedDataOld;                  // compensated tactile data of the previous step (used for smoothing filter)
     Vector compensatedDataFilt;                 // compensated tactile data after smooth filter
+    unsigned int negativeBaselines;             // number of taxels whose baseline became negative in the last compensation
     
     // CALIBRATION
     int calibrationRead;                        // count the calibration reads
@@ -127,8 +137,11 @@ private:
     bool init(string name, string robotName, string outputPortName, string inputPortName);
     bool readInputData(Vector& skin_values);
     void sendInfoMsg(string msg);
+    void buildNeighbors();
     void computeNeighbors();
     void updateNeighbors(unsigned int taxelId);
+    int findContactRoot(int i);
+    void joinContacts(int i, int j);
 
     /* class methods */
 public:
@@ -140,7 +153,9 @@ public:
     void calibrationInit();
     void calibrationDataCollection();
     void calibrationFinish();
+    // it reads the raw data, compensates them and updates the baselines in a single pass over the taxels
     bool readRawAndWriteCompensatedData();
+    // it signals the taxels whose baseline became negative during the last compensation
     void updateBaseline();
     bool doesBaselineExceed(unsigned int &taxelIndex, double &baseline, double &initialBaseline);
     skinContactList getContacts();
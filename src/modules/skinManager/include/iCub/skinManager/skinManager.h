@@ -125,6 +125,9 @@ These are the parameters of this section:
     missing calibration procedure for that skin part).
  - \c maxNeighborDist \c 0.015 \n
     maximum distance between two neighbor tactile sensors (in meters).
+ - \c packedEncoding \c [not active] \n
+    if specified the skin events are written in the packed encoding of iCub::skinDynLib::skinContactList,
+    which is faster to write and read but cannot be read as a Bottle (connections in text mode are not affected).
  
 
 \section portsa_sec Ports Accessed
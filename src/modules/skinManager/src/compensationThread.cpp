@@ -135,9 +135,11 @@ bool CompensationThread::threadInit()
 
     // configure the SKIN_EVENT if the corresponding section exists
     skinEventsOn = false;
+    skinEventsPacked = false;
     Bottle &skinEventsConf = rf->findGroup("SKIN_EVENTS");
     if(!skinEventsConf.isNull()){
         yDebug("SKIN_EVENTS section found");
+        skinEventsPacked = skinEventsConf.check("packedEncoding");
         string eventPortName = "/" + moduleName + "/skin_events:o";  // output skin events
         if(!skinEventsPort.open(eventPortName.c_str()))
             sendErrorMsg("Unable to open port "+eventPortName);
@@ -251,6 +253,7 @@ void CompensationThread::run(){
 void CompensationThread::sendSkinEvents(){
     skinContactList &skinEvents = skinEventsPort.prepare();
     skinEvents.clear();
+    skinEvents.setPackedEncoding(skinEventsPacked);
 
     skinContactList temp;
     Stamp timestamp;
@@ -19,9 +19,27 @@
 #include <yarp/math/Math.h>
 #include <yarp/math/Rand.h> // TEMP
 #include "math.h"
+#include <cmath>
+#include <cstdio>
 #include <algorithm>
 #include "iCub/skinManager/compensator.h"
 
+// the AVX2 kernel is built in any case on x86 with GCC and clang, and it is
+// selected at run time if the CPU supports it; a build with -mavx2 calls it
+// directly
+#if defined(__AVX2__)
+    #define COMPENSATOR_AVX2
+    #define COMPENSATOR_AVX2_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define COMPENSATOR_AVX2
+    #define COMPENSATOR_AVX2_DISPATCH
+    #define COMPENSATOR_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#if defined(COMPENSATOR_AVX2)
+    #include <immintrin.h>
+#endif
+
 
 using namespace std;
 using namespace yarp::os;
@@ -33,6 +51,190 @@ using namespace iCub::skinDynLib;
 const double Compensator::BIN_TOUCH     = 100.0;
 const double Compensator::BIN_NO_TOUCH  = 0.0;
 
+namespace
+{
+    // the per-taxel arrays processed by the compensation kernel
+    struct TaxelArrays
+    {
+        const double  *raw;             // raw data
+        const double  *thr;             // touch thresholds
+        double        *baselines;
+        double        *comp;            // compensated data, before filtering
+        double        *filt;            // compensated data, after the smooth filter
+        double        *old;             // last output of the smooth filter
+        double        *out;             // data to send
+        unsigned char *touch;
+        unsigned char *subTouch;
+        unsigned char *touchFilt;
+    };
+
+    // the parameters of the compensation, constant over the taxels
+    struct CompensationParams
+    {
+        double sign, offset;            // the raw value is sign*raw+offset (zero up or 255 down)
+        double maxSkin;
+        double addThr;
+        bool   smooth;
+        double smoothNew, smoothOld;    // weights of the new and old value in the smooth filter
+        bool   binarization;
+        double binTouch, binNoTouch;
+        double gain, contactGain;       // baseline update gains without and with touch
+    };
+
+
+    /********************************************************************/
+    // baseline subtraction, touch detection, smoothing, binarization and
+    // baseline update of the taxels [i,n) in one pass; it returns the
+    // number of taxels whose baseline became negative
+    unsigned int compensateScalar(const TaxelArrays &x, const CompensationParams &p,
+                                  unsigned int i, const unsigned int n)
+    {
+        unsigned int negative=0;
+        for (; i<n; i++)
+        {
+            double d=std::min(p.maxSkin,(p.sign*x.raw[i]+p.offset)-x.baselines[i]);
+            x.comp[i]=d;
+
+            double t=x.thr[i]+p.addThr;
+            bool touch=(d>t);
+            x.touch[i]=touch;
+            x.subTouch[i]=(d<-t);
+
+            double f=d;
+            if (p.smooth)
+            {
+                f=p.smoothNew*d+p.smoothOld*x.old[i];
+                x.old[i]=f;
+            }
+            x.filt[i]=f;
+
+            bool touchFilt=(f>t);
+            x.touchFilt[i]=touchFilt;
+            if (p.binarization)
+                f=(touchFilt?p.binTouch:p.binNoTouch);
+            x.out[i]=std::max(0.0,f);
+
+            x.baselines[i]+=(touch?p.contactGain:p.gain)*d/x.thr[i];
+            if (x.baselines[i]<0.0)
+                negative++;
+        }
+
+        return negative;
+    }
+
+#if defined(COMPENSATOR_AVX2)
+    /********************************************************************/
+    // the same as compensateScalar() on the taxels [0,n), four at a time
+    COMPENSATOR_AVX2_TARGET
+    unsigned int compensateAVX2(const TaxelArrays &x, const CompensationParams &p,
+                                const unsigned int n)
+    {
+        unsigned int negative=0;
+        unsigned int i=0;
+
+        const __m256d sign=_mm256_set1_pd(p.sign);
+        const __m256d offset=_mm256_set1_pd(p.offset);
+        const __m256d maxSkin=_mm256_set1_pd(p.maxSkin);
+        const __m256d addThr=_mm256_set1_pd(p.addThr);
+        const __m256d smoothNew=_mm256_set1_pd(p.smoothNew);
+        const __m256d smoothOld=_mm256_set1_pd(p.smoothOld);
+        const __m256d binTouch=_mm256_set1_pd(p.binTouch);
+        const __m256d binNoTouch=_mm256_set1_pd(p.binNoTouch);
+        const __m256d gain=_mm256_set1_pd(p.gain);
+        const __m256d contactGain=_mm256_set1_pd(p.contactGain);
+        const __m256d zero=_mm256_setzero_pd();
+        const __m256d signBit=_mm256_set1_pd(-0.0);
+
+        for (; i+4<=n; i+=4)
+        {
+            __m256d b=_mm256_loadu_pd(x.baselines+i);
+            __m256d thr=_mm256_loadu_pd(x.thr+i);
+
+            // baseline compensation
+            __m256d d=_mm256_add_pd(_mm256_mul_pd(sign,_mm256_loadu_pd(x.raw+i)),offset);
+            d=_mm256_min_pd(_mm256_sub_pd(d,b),maxSkin);
+            _mm256_storeu_pd(x.comp+i,d);
+
+            // touch and subtouch detection on the unfiltered data
+            __m256d t=_mm256_add_pd(thr,addThr);
+            __m256d touch=_mm256_cmp_pd(d,t,_CMP_GT_OQ);
+            __m256d subTouch=_mm256_cmp_pd(d,_mm256_xor_pd(t,signBit),_CMP_LT_OQ);
+
+            // smooth filter
+            __m256d f=d;
+            if (p.smooth)
+            {
+                f=_mm256_add_pd(_mm256_mul_pd(smoothNew,d),_mm256_mul_pd(smoothOld,_mm256_loadu_pd(x.old+i)));
+                _mm256_storeu_pd(x.old+i,f);
+            }
+            _mm256_storeu_pd(x.filt+i,f);
+
+            // binarization filter
+            __m256d touchFilt=_mm256_cmp_pd(f,t,_CMP_GT_OQ);
+            if (p.binarization)
+                f=_mm256_blendv_pd(binNoTouch,binTouch,touchFilt);
+            _mm256_storeu_pd(x.out+i,_mm256_max_pd(f,zero));
+
+            // baseline update
+            __m256d g=_mm256_blendv_pd(gain,contactGain,touch);
+            b=_mm256_add_pd(b,_mm256_div_pd(_mm256_mul_pd(g,d),thr));
+            _mm256_storeu_pd(x.baselines+i,b);
+
+            int m=_mm256_movemask_pd(touch);
+            int ms=_mm256_movemask_pd(subTouch);
+            int mf=_mm256_movemask_pd(touchFilt);
+            int mn=_mm256_movemask_pd(_mm256_cmp_pd(b,zero,_CMP_LT_OQ));
+            for (int k=0; k<4; k++)
+            {
+                x.touch[i+k]=(unsigned char)((m>>k)&1);
+                x.subTouch[i+k]=(unsigned char)((ms>>k)&1);
+                x.touchFilt[i+k]=(unsigned char)((mf>>k)&1);
+                negative+=(mn>>k)&1;
+            }
+        }
+
+        return negative+compensateScalar(x,p,i,n);
+    }
+#endif
+
+    /********************************************************************/
+    // the compensation of the taxels [0,n) with the fastest kernel available
+    unsigned int compensate(const TaxelArrays &x, const CompensationParams &p,
+                            const unsigned int n)
+    {
+    #if defined(COMPENSATOR_AVX2_DISPATCH)
+        static const bool avx2=(__builtin_cpu_supports("avx2")!=0);
+        if (avx2)
+            return compensateAVX2(x,p,n);
+    #elif defined(COMPENSATOR_AVX2)
+        return compensateAVX2(x,p,n);
+    #endif
+        return compensateScalar(x,p,0,n);
+    }
+
+    // a taxel in the uniform grid used to find the neighbors
+    struct GridEntry
+    {
+        long long x, y, z;      // cell
+        int id;                 // taxel
+
+        bool operator<(const GridEntry &e) const
+        {
+            if (x!=e.x) return x<e.x;
+            if (y!=e.y) return y<e.y;
+            if (z!=e.z) return z<e.z;
+            return id<e.id;
+        }
+    };
+
+    inline long long gridCell(double c, double cellSize)
+    {
+        // far away taxels are clamped into the border cells, which is harmless
+        // since the distance is checked anyway
+        return (long long)std::max(-1e15, std::min(1e15, std::floor(c/cellSize)));
+    }
+}
+
 Compensator::Compensator(string _name, string _robotName, string outputPortName, string inputPortName, BufferedPort<Bottle>* _infoPort, 
                          double _compensationGain, double _contactCompensationGain, int addThreshold, float _minBaseline, bool _zeroUpRawData, 
                          bool _binarization, bool _smoothFilter, float _smoothFactor, unsigned int _linkNum)
@@ -129,16 +331,13 @@ bool Compensator::init(string name, string robotName, string outputPortName, str
     compensatedData.resize(skinDim);
     compensatedDataOld.resize(skinDim);
     compensatedDataFilt.resize(skinDim);
+    negativeBaselines = 0;
     taxelPos.resize(skinDim, zeros(3));
     taxelOri.resize(skinDim, zeros(3));
     taxelPoseConfidence.resize(skinDim,0.0);
     maxNeighDist = MAX_NEIGHBOR_DISTANCE;
-    // by default every taxel is neighbor with all the other taxels
-    list<int> defaultNeighbors(skinDim);
-    int i=0;
-    for(list<int>::iterator it=defaultNeighbors.begin();it!=defaultNeighbors.end();it++, i++) 
-        *it = i;
-    neighborsXtaxel.resize(skinDim, defaultNeighbors);
+    // by default no taxel has a position, so every taxel is neighbor with all the other taxels
+    buildNeighbors();
 
     // test read to check if the skin is broken (all taxel output is 0)
     if(robotName!="icubSim" && readInputData(compensatedData)){
@@ -341,106 +540,64 @@ bool Compensator::readRawAndWriteCompensatedData(){
     Vector& compensatedData2Send = compensatedTactileDataPort.prepare();
     compensatedData2Send.resize(skinDim);   // local variable with data to send
     compensatedData.resize(skinDim);        // global variable with data to store
-    
-    double d;
-    for(unsigned int i=0; i<skinDim; i++){
-        // baseline compensation
-        d =  (double)( zeroUpRawData ? rawData(i)-baselines[i] : MAX_SKIN-rawData(i)-baselines[i] );
-        d =   min<double>( MAX_SKIN, d);
-        compensatedData[i] = d;     // save the data before applying filtering
 
-        // detect touch (before applying filtering, so the compensation algorithm is not affected by the filters)
-        touchDetected[i] = (d > touchThresholds[i] + addThreshold);
-        
-        // detect subtouch
-        subTouchDetected[i] = (d < -touchThresholds[i] - addThreshold);
-        
-        // smooth filter
-        if(smoothFilter){
-            lock_guard<mutex> lck(smoothFactorSem);
-            d = (1-smoothFactor)*d + smoothFactor*compensatedDataOld(i);
-            compensatedDataOld(i) = d;    // update old value
-        }
-        compensatedDataFilt[i] = d;
-
-        // binarization filter
-        // here we don't use the touchDetected array because, if the smooth filter is on,
-        // we want to use the filtered values
-        touchDetectedFilt[i] = (d > touchThresholds[i] + addThreshold);
-        if(binarization)
-            d = ( touchDetectedFilt[i] ? BIN_TOUCH : BIN_NO_TOUCH );
-        
-        compensatedData2Send[i] = max<double>(0.0, d); // trim only data to send because you need negative values for update baseline
+    CompensationParams p;
+    p.sign          = zeroUpRawData ? 1.0 : -1.0;
+    p.offset        = zeroUpRawData ? 0.0 : MAX_SKIN;
+    p.maxSkin       = MAX_SKIN;
+    p.addThr        = addThreshold;
+    p.smooth        = smoothFilter;
+    {
+        // the smooth factor is read once for all the taxels
+        lock_guard<mutex> lck(smoothFactorSem);
+        p.smoothNew = 1-smoothFactor;
+        p.smoothOld = smoothFactor;
     }
+    p.binarization  = binarization;
+    p.binTouch      = BIN_TOUCH;
+    p.binNoTouch    = BIN_NO_TOUCH;
+    p.gain          = compensationGain*0.02;
+    p.contactGain   = contactCompensationGain*0.02;
+
+    TaxelArrays x;
+    x.raw           = rawData.data();
+    x.thr           = touchThresholds.data();
+    x.baselines     = baselines.data();
+    x.comp          = compensatedData.data();
+    x.filt          = compensatedDataFilt.data();
+    x.old           = compensatedDataOld.data();
+    x.out           = compensatedData2Send.data();
+    x.touch         = touchDetected.data();
+    x.subTouch      = subTouchDetected.data();
+    x.touchFilt     = touchDetectedFilt.data();
+
+    // the baselines are updated in the same pass, as the compensated data of a taxel
+    // (before filtering) are all that is needed to update its baseline;
+    // negative values are trimmed only in the data to send because they are needed
+    // to update the baselines
+    negativeBaselines = compensate(x,p,skinDim);
 
     compensatedTactileDataPort.write();
     return true;
 }
 
 void Compensator::updateBaseline(){
-    double mean_change = 0, change, gain;
-    unsigned int non_touching_taxels = 0;
-    double d; 
+    // the baselines have already been updated by readRawAndWriteCompensatedData()
+    if(negativeBaselines==0)
+        return;
 
+    char temp[300];
     for(unsigned int j=0; j<skinDim; j++) {
-        // *** Algorithm 1
-        /*if(!touchDetected[j]){
-            if(d > 0.5) {
-                baselines[j]        += compensationGain;
-                mean_change            += compensationGain;                //for changing the taxels where we detected touch
-            }else if(d < -0.5) {
-                baselines[j]        -= compensationGain;
-                mean_change            -= compensationGain;                //for changing the taxels where we detected touch
-            }
-        }*/
-
-        // *** Algorithm 2
-        /*if(!(touchDetected[j] || subTouchDetected[j])){
-            non_touching_taxels++;                                        //for changing the taxels where we detected touch
-            d = compensatedData(j);
-            if(fabs(d)>0.5){
-                change          = (compensationGain/50)*d/touchThresholds[j];
-                baselines[j]    += change;
-                mean_change     += change;
-            }
-        }*/
-    
-        d = compensatedData(j);
-        if(touchDetected[j]){
-            gain            = contactCompensationGain*0.02;                
-        }else{
-            gain            = compensationGain*0.02;
-            non_touching_taxels++;
-        }
-        change          = gain*d/touchThresholds[j];
-        baselines[j]    += change;
-        mean_change     += change;
-
-    //        if(j<5)
-    //        printf("%d touch detected %s, change %.6f, gain: %.3f\n", j, touchDetected[j]?"yes":"no", change, touchDetected[j]?contactCompensationGain:compensationGain);
-
         if(baselines[j]<0){
-            char* temp = new char[300];
-            sprintf(temp, "ERROR-Negative baseline. Port %s; tax %d; baseline %.2f; gain: %.4f; d: %.2f; raw: %.2f; change: %f; touchThr: %.2f", 
+            double d        = compensatedData(j);
+            double gain     = (touchDetected[j] ? contactCompensationGain : compensationGain)*0.02;
+            double change   = gain*d/touchThresholds[j];
+            snprintf(temp, sizeof(temp), "ERROR-Negative baseline. Port %s; tax %d; baseline %.2f; gain: %.4f; d: %.2f; raw: %.2f; change: %f; touchThr: %.2f", 
                 SkinPart_s[skinPart].c_str(), j, baselines[j], gain, d, rawData[j], change, touchThresholds[j]);
             sendInfoMsg(temp);
-        }      
-    }
-    
-    //for compensating the taxels where we detected touch
-    /*if (non_touching_taxels>0 && non_touching_taxels<skinDim && mean_change!=0){
-        mean_change /= non_touching_taxels;
-        for(unsigned int j=0; j<skinDim; j++) {
-            if (touchDetected[j]) {
-                baselines[j]        += mean_change;
-                if(baselines[j]<0){
-                    char* temp = new char[300];
-                    sprintf(temp, "ERROR-Negative baseline. Taxel %d; baseline %.2f; meanchange: %f", j, baselines[j], mean_change);
-                    sendInfoMsg(temp);
-                }
-            }
         }
-    }*/
+    }
+    negativeBaselines = 0;
 }
 
 bool Compensator::doesBaselineExceed(unsigned int &taxelIndex, double &baseline, double &initialBaseline){
@@ -461,82 +618,94 @@ bool Compensator::doesBaselineExceed(unsigned int &taxelIndex, double &baseline,
     return false;
 }
 
-skinContactList Compensator::getContacts(){    
-    vector<int>         contactXtaxel(skinDim, -1);     // contact for each taxel (-1 means no contact)
-    deque<deque<int> >  taxelsXcontact;                 // taxels for each contact
-    int                 contactId = 0;                  // id of the next contact to create
-    int                 neighCont;                      // id of the contact of the current neighbor
+int Compensator::findContactRoot(int i){
+    while(contactRoot[i]!=i){
+        contactRoot[i] = contactRoot[contactRoot[i]];   // path halving
+        i = contactRoot[i];
+    }
+    return i;
+}
 
-    poseSem.lock();
-    {
-        for(unsigned int i=0; i<skinDim; i++){
-            if(touchDetectedFilt[i] ){ // && contactXtaxel[i]<0 (second condition should always be true)
-                list<int> *neighbors = &(neighborsXtaxel[i]);
-                //printf("Taxel %d active. Going to check its %d neighbors\n", i, neighbors->size());
-                for(list<int>::iterator it=neighbors->begin(); it!=neighbors->end(); it++){
-                    neighCont = contactXtaxel[(*it)];
-                    if(neighCont >= 0){                                     // ** if neighbor belongs to a contact
-                        if(contactXtaxel[i]<0){                             // ** add taxel to pre-existing contact
-                            contactXtaxel[i] = neighCont;
-                            taxelsXcontact[neighCont].push_back(i);
-                            //printf("Add taxel to pre existing contact %d (neighbor %d)\n", neighCont, (*neighbors)[n]);
-                        }else if(contactXtaxel[i]!=neighCont){              // ** merge 2 contacts
-                            //mergeContacts(contactXtaxel[i], neighCont);
-                            int newId = min(contactXtaxel[i], neighCont);
-                            int oldId = max(contactXtaxel[i], neighCont);
-                            deque<int> tax2move = taxelsXcontact[oldId];
-                            for(deque<int>::iterator it=tax2move.begin(); it!=tax2move.end(); it++){
-                                contactXtaxel[(*it)] = newId;               // assign new contact id
-                                taxelsXcontact[newId].push_back((*it));     // add taxel ids to contact
-                            }
-                            taxelsXcontact[oldId].clear();      // clear the list of taxels belonging to the merged contact
-                            //printf("Merge two contacts: %d and %d\n", oldId, newId);
-                        }
-                    }
+void Compensator::joinContacts(int i, int j){
+    i = findContactRoot(i);
+    j = findContactRoot(j);
+    // the root of a contact is always its taxel with the smallest id
+    if(i<j)         contactRoot[j] = i;
+    else if(j<i)    contactRoot[i] = j;
+}
 
-                }
-                if(contactXtaxel[i]<0){            // ** if no neighbor belongs to a contact -> create new contact
-                    contactXtaxel[i] = contactId;
-                    taxelsXcontact.resize(contactId+1);
-                    taxelsXcontact[contactId].push_back(i);
-                    contactId++;
-                    //printf("New contact created: %d\n", contactId-1);
-                }
-            }
+skinContactList Compensator::getContacts(){
+    skinContactList contactList;
+    lock_guard<mutex> lck(poseSem);
+
+    // cluster the active taxels: two active taxels belong to the same contact if they are neighbors
+    const int n = (int)skinDim;
+    int firstNoPos = -1;
+    for(int i=0; i<n; i++){
+        if(!touchDetectedFilt[i])
+            continue;
+        contactRoot[i] = i;
+        for(int k=neighborsOffset[i]; k<neighborsOffset[i+1]; k++){
+            int j = neighbors[k];
+            if(j<i && touchDetectedFilt[j])
+                joinContacts(i, j);
         }
+        if(taxelNoPos[i] && firstNoPos<0)
+            firstNoPos = i;
+    }
+    if(firstNoPos>=0){
+        // the taxels without position are neighbors of one another and of those near the origin
+        for(int i=firstNoPos+1; i<n; i++)
+            if(touchDetectedFilt[i] && (taxelNoPos[i] || taxelNearOrigin[i]))
+                joinContacts(firstNoPos, i);
+        for(int i=0; i<firstNoPos; i++)
+            if(touchDetectedFilt[i] && taxelNearOrigin[i])
+                joinContacts(firstNoPos, i);
+    }
+
+    // the contacts are ordered by their first taxel, and so are the taxels of each contact
+    vector<vector<unsigned int> > taxelsXcontact;
+    for(int i=0; i<n; i++){
+        if(!touchDetectedFilt[i])
+            continue;
+        int r = findContactRoot(i);
+        if(r==i){
+            contactXtaxel[i] = (int)taxelsXcontact.size();
+            taxelsXcontact.resize(taxelsXcontact.size()+1);
+        }
+        else
+            contactXtaxel[i] = contactXtaxel[r];
+        taxelsXcontact[contactXtaxel[i]].push_back(i);
     }
-    poseSem.unlock();
 
-    skinContactList contactList;
     Vector CoP(3), geoCenter(3), normal(3);
     double pressure, pressureCoP, pressureNormal, out;
     int activeTaxels, activeTaxelsGeo;
-    vector<unsigned int> taxelList;
-    for( deque<deque<int> >::iterator it=taxelsXcontact.begin(); it!=taxelsXcontact.end(); it++){
+    for(vector<vector<unsigned int> >::const_iterator it=taxelsXcontact.begin(); it!=taxelsXcontact.end(); it++){
         activeTaxels = it->size();
-        if(activeTaxels==0) continue;
-        
-        taxelList.resize(activeTaxels);
         CoP.zero();
         geoCenter.zero();
         normal.zero();
         pressure = pressureCoP = pressureNormal = 0.0;
         activeTaxelsGeo = 0;
-        int i=0;
-        for( deque<int>::iterator tax=it->begin(); tax!=it->end(); tax++, i++){
+        for(vector<unsigned int>::const_iterator tax=it->begin(); tax!=it->end(); tax++){
             out         = max(compensatedDataFilt[(*tax)], 0.0);
-            if(norm(taxelPos[(*tax)])!=0.0){  // if the taxel position estimate exists
-                CoP         += taxelPos[(*tax)] * out;
+            if(!taxelNoPos[(*tax)]){  // if the taxel position estimate exists
+                const double *p = taxelPos[(*tax)].data();
+                for(int k=0; k<3; k++){
+                    CoP[k]          += p[k] * out;
+                    geoCenter[k]    += p[k];
+                }
                 pressureCoP += out;
                 activeTaxelsGeo++;
-                geoCenter   += taxelPos[(*tax)];
             }
-            if(norm(taxelOri[(*tax)])!=0.0){  // if the taxel orientation estimate exists
-                normal          += taxelOri[(*tax)] * out;
+            const double *o = taxelOri[(*tax)].data();
+            if(o[0]*o[0]+o[1]*o[1]+o[2]*o[2]!=0.0){  // if the taxel orientation estimate exists
+                for(int k=0; k<3; k++)
+                    normal[k]   += o[k] * out;
                 pressureNormal  += out;
             }
             pressure    += out;
-            taxelList[i] = *tax;
         }
         // if this is not the only contact and no taxel in this contact has a position => discard it
         if(taxelsXcontact.size()>1 && activeTaxelsGeo==0)
@@ -545,7 +714,7 @@ skinContactList Compensator::getContacts(){
         if(pressureNormal!=0.0)     normal      /= pressureNormal;
         if(activeTaxelsGeo!=0)      geoCenter   /= activeTaxelsGeo;
         pressure    /= activeTaxels;
-        skinContact c(bodyPart, skinPart, linkNum, CoP, geoCenter, taxelList, pressure, normal);
+        skinContact c(bodyPart, skinPart, linkNum, CoP, geoCenter, *it, pressure, normal);
         // set an estimate of the force that is with normal direction and intensity equal to the pressure
         c.setForce(-0.05*activeTaxels*pressure*normal);
         contactList.push_back(c);
@@ -778,8 +947,8 @@ bool Compensator::setTaxelPoses(const vector<Vector> &poses){
             if(poses[i].size() == 7)
                 taxelPoseConfidence[i] = poses[i][6];
         }
+        computeNeighbors();
     }
-    computeNeighbors();
     return true;
 }
 bool Compensator::setTaxelPose(unsigned int taxelId, const Vector &pose){
@@ -791,8 +960,8 @@ bool Compensator::setTaxelPose(unsigned int taxelId, const Vector &pose){
         taxelOri[taxelId] = pose.subVector(3,5);
         if(pose.size() == 7)
                 taxelPoseConfidence[taxelId] = pose[6];
+        updateNeighbors(taxelId);
     }
-    updateNeighbors(taxelId);
     return true;
 }
 bool Compensator::setTaxelPositions(const Vector &positions){
@@ -841,28 +1010,107 @@ bool Compensator::setTaxelOrientation(unsigned int taxelId, const Vector &orient
         taxelPoseConfidence[taxelId] = orientation[3];
     return true;
 }
-void Compensator::computeNeighbors(){
-    neighborsXtaxel.clear();
-    neighborsXtaxel.resize(skinDim, list<int>(0));
-    Vector v;
-    double d2 = maxNeighDist*maxNeighDist;
-    for(unsigned int i=0; i<skinDim; i++){
-        for(unsigned int j=i+1; j<skinDim; j++){
-            //if(taxelPos[i][0]!=0.0 || taxelPos[i][1]!=0.0 || taxelPos[i][2]!=0.0){  // if the taxel exists
-            v = taxelPos[i]-taxelPos[j];
-            if( dot(v,v) <= d2){
-                neighborsXtaxel[i].push_back(j);
-                neighborsXtaxel[j].push_back(i);
-                //printf("Taxels %d (%s) and %d (%s) are neighbors\n", i, taxelPos[i].toString().c_str(), j, taxelPos[j].toString().c_str());
+void Compensator::buildNeighbors(){
+    const int n = (int)skinDim;
+    const double d2 = maxNeighDist*maxNeighDist;
+
+    taxelNoPos.assign(n, 0);
+    taxelNearOrigin.assign(n, 0);
+    taxelsNoPos = 0;
+    vector<int> located;
+    located.reserve(n);
+    double extent = 0.0;
+    for(int i=0; i<n; i++){
+        const double *p = taxelPos[i].data();
+        double s = p[0]*p[0]+p[1]*p[1]+p[2]*p[2];
+        if(s==0.0){
+            taxelNoPos[i] = 1;
+            taxelsNoPos++;
+            continue;
+        }
+        if(!std::isfinite(p[0]) || !std::isfinite(p[1]) || !std::isfinite(p[2]))
+            continue;
+        if(s<=d2)
+            taxelNearOrigin[i] = 1;
+        extent = max(extent, max(fabs(p[0]), max(fabs(p[1]), fabs(p[2]))));
+        located.push_back(i);
+    }
+
+    // the cells are slightly larger than the max distance, so that two neighbors are at most one cell apart;
+    // only the cells with some taxel are stored, but the cells must not be so small that their index overflows
+    double cellSize = max(maxNeighDist, 1e-9*extent)*(1.0+1e-6);
+    if(cellSize==0.0)
+        cellSize = 1.0;
+
+    vector<GridEntry> grid(located.size());
+    for(size_t k=0; k<located.size(); k++){
+        const int i = located[k];
+        const double *p = taxelPos[i].data();
+        GridEntry &e = grid[k];
+        e.x = gridCell(p[0], cellSize);
+        e.y = gridCell(p[1], cellSize);
+        e.z = gridCell(p[2], cellSize);
+        e.id = i;
+    }
+    sort(grid.begin(), grid.end());
+
+    // look for the neighbors of each taxel in its cell and in the 26 adjacent ones:
+    // the cells with the same x and y are contiguous in the grid, so they are scanned by z,
+    // and the first cell of each of the 9 columns only moves forward as the grid is visited
+    vector<pair<int,int> > edges;
+    neighborsOffset.assign(n+1, 0);
+    vector<GridEntry>::const_iterator column[9];
+    for(int c=0; c<9; c++)
+        column[c] = grid.begin();
+    for(vector<GridEntry>::const_iterator e=grid.begin(); e!=grid.end(); e++){
+        const double *pi = taxelPos[e->id].data();
+        for(int c=0; c<9; c++){
+            GridEntry cell;
+            cell.x = e->x+c/3-1;
+            cell.y = e->y+c%3-1;
+            cell.z = e->z-1;
+            cell.id = -1;
+            while(column[c]!=grid.end() && *column[c]<cell)
+                column[c]++;
+            for(vector<GridEntry>::const_iterator it=column[c];
+                it!=grid.end() && it->x==cell.x && it->y==cell.y && it->z<=e->z+1; it++){
+                if(it->id<=e->id)
+                    continue;
+                const double *pj = taxelPos[it->id].data();
+                double v0 = pi[0]-pj[0], v1 = pi[1]-pj[1], v2 = pi[2]-pj[2];
+                if(v0*v0+v1*v1+v2*v2 <= d2){
+                    edges.push_back(make_pair(e->id, it->id));
+                    neighborsOffset[e->id+1]++;
+                    neighborsOffset[it->id+1]++;
+                }
             }
-            //}
         }
     }
 
+    for(int i=0; i<n; i++)
+        neighborsOffset[i+1] += neighborsOffset[i];
+    neighbors.resize(neighborsOffset[n]);
+    vector<int> next(neighborsOffset.begin(), neighborsOffset.end()-1);
+    for(vector<pair<int,int> >::const_iterator it=edges.begin(); it!=edges.end(); it++){
+        neighbors[next[it->first]++] = it->second;
+        neighbors[next[it->second]++] = it->first;
+    }
+
+    contactRoot.resize(n);
+    contactXtaxel.resize(n);
+}
+void Compensator::computeNeighbors(){
+    buildNeighbors();
+
     int minNeighbors=skinDim, maxNeighbors=0, ns;
+    int taxelsNearOrigin = (int)count(taxelNearOrigin.begin(), taxelNearOrigin.end(), 1);
     for(unsigned int i=0; i<skinDim; i++){
-        //if(taxelPos[i][0]!=0.0 || taxelPos[i][1]!=0.0 || taxelPos[i][2]!=0.0){  // if the taxel exists
-        ns = neighborsXtaxel[i].size();
+        // the taxels without position are neighbors of all the others without position and of those near the origin
+        ns = neighborsOffset[i+1]-neighborsOffset[i];
+        if(taxelNoPos[i])
+            ns += taxelsNoPos-1+taxelsNearOrigin;
+        else if(taxelNearOrigin[i])
+            ns += taxelsNoPos;
         if(ns>maxNeighbors) maxNeighbors = ns;
         if(ns<minNeighbors) minNeighbors = ns;
     }
@@ -871,22 +1119,8 @@ void Compensator::computeNeighbors(){
     sendInfoMsg(ss.str());
 }
 void Compensator::updateNeighbors(unsigned int taxelId){
-    Vector v;
-    double d2 = maxNeighDist*maxNeighDist;
-    // remove all the neighbors of the taxel with id=taxelId
-    neighborsXtaxel[taxelId].clear();
-
-    for(unsigned int i=0; i<skinDim; i++){
-        //if(taxelPos[i][0]!=0.0 || taxelPos[i][1]!=0.0 || taxelPos[i][2]!=0.0){  // if the taxel exists
-        // remove taxelId from the neighbor list (if there is)
-        neighborsXtaxel[i].remove(taxelId);
-        // check whether they are neighbors
-        v = taxelPos[i]-taxelPos[taxelId];
-        if( dot(v,v) <= d2){
-            neighborsXtaxel[i].push_back(taxelId);
-            neighborsXtaxel[taxelId].push_back(i);
-        }
-    }
+    // rebuilding the whole graph costs O(n log(n)), which is fine also for a single taxel
+    buildNeighbors();
 }
 
 void Compensator::sendInfoMsg(string msg){
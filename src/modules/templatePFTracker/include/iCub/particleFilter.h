@@ -40,6 +40,7 @@
 #include <iostream>
 #include <iomanip>
 #include <deque>
+#include <vector>
 #include <opencv2/core/core_c.h>
 #include <opencv2/imgproc/imgproc_c.h>
 
@@ -84,6 +85,37 @@ typedef struct TemplateStruct
 int particle_cmp( const void* p1, const void* p2 );
 
 
+/**
+ * Integral histogram of an HSV image: for each bin of interest, the table of
+ * the number of pixels of the bin above and to the left of each pixel, so
+ * that the histogram of any rectangle is found with four lookups per bin.
+ * The tables are kept from one image to the next, thus they are allocated
+ * only when the size of the image or the bins change.
+ */
+class IntegralHistogram
+{
+    std::vector<int> planes;        /* table of each bin, -1 for the bins not counted */
+    std::vector<unsigned char> bins;/* bin of each pixel */
+    std::vector<int> table;         /* (height+1) x (width+1) x number of bins counted */
+    std::vector<int> rowSum;
+    int width, height, numPlanes;
+
+public:
+    IntegralHistogram();
+
+    /* count only the given bins, since the others are never looked up */
+    void setBins( const std::vector<int> &bins );
+    int getNumBins() const { return numPlanes; }
+
+    /* build the tables of an HSV image of 32-bit floats */
+    void build( IplImage* hsv );
+
+    /* fill counts (getNumBins() values) with the histogram of the rectangle
+       clipped to the image, and return the number of pixels inside it */
+    int count( int x, int y, int w, int h, int* counts ) const;
+};
+
+
 class PARTICLEThread : public yarp::os::Thread 
 {
 public:
@@ -134,7 +166,7 @@ private:
     IplImage* frame, *frame_blob;
     int width, height, tpl_width, tpl_height, res_width, res_height;
     double scale;
-    IplImage* img_hsv;
+    IplImage* img_hsv, * img_bgr32f;
     gsl_rng* rng;
     bool firstFrame;
     CvScalar color;
@@ -168,7 +200,14 @@ private:
     int total;
 
     histogram** ref_histos;
-    particle* particles, * new_particles;    
+    /* particles of the current and of the next frame, and scratch space of the resampling,
+       allocated once for all frames */
+    std::vector<particle> particles, new_particles;
+    std::vector<int> resample_order;
+    /* integral histogram of the current frame and square roots of the reference histograms,
+       by object, for the bins counted by it */
+    IntegralHistogram integral;
+    std::vector<float> ref_sqrt;
 
     void free_histos( histogram** histo, int n );
     void free_regions( CvRect** regions, int n);
@@ -176,17 +215,16 @@ private:
     histogram** compute_ref_histos( IplImage* img, CvRect* rect, int n );
     histogram* calc_histogram( IplImage** imgs, int n );
     particle transition( const particle &p, int w, int h, gsl_rng* rng );
-    particle* init_distribution( CvRect* regions, histogram** histos, int n, int p);
+    void init_distribution( CvRect* regions, histogram** histos, int n, particle* particles, int p);
     IplImage* bgr2hsv( IplImage* bgr );
-    float likelihood( IplImage* img, int r, int c, int w, int h, histogram* ref_histo );
+    void set_reference( histogram** histos, int n );
+    float likelihood( int r, int c, int w, int h, const float* ref_sqrt ) const;
     void normalize_weights( particle* particles, int n );
-    float histo_dist_sq( histogram* h1, histogram* h2 );
-    int histo_bin( float h, float s, float v );
     float pixval32f(IplImage* img, int r, int c);
     void setpix32f(IplImage* img, int r, int c, float val);
     int get_regions( IplImage* frame, CvRect** regions );
     int get_regionsImage( IplImage* frame, CvRect** regions );
-    particle* resample( particle* particles, int n );
+    void resample( const particle* particles, particle* new_particles, int n );
     void display_particle( IplImage* img, const particle &p, CvScalar color, yarp::sig::Vector& target );
     void display_particleBlob( IplImage* img, const particle &p, yarp::sig::Vector& target );
     void trace_template( IplImage* img, const particle &p );
@@ -205,6 +243,8 @@ public:
     void run(); 
     void setName(std::string module);
     void setTemplate(yarp::sig::ImageOf<yarp::sig::PixelRgb> *tpl);
+    void setNumParticles(int n);
+    static int histo_bin( float h, float s, float v );
     void pushTarget(yarp::sig::Vector &target, yarp::os::Stamp &stamp);
     float getAverage();
     TemplateStruct getBestTemplate();
@@ -228,6 +268,7 @@ private:
 
     yarp::sig::ImageOf<yarp::sig::PixelRgb> *tpl;
     std::string moduleName;
+    int numParticles;
     
 
 public:
@@ -236,6 +277,7 @@ public:
     bool            shouldSend;
 
     void setName(std::string module);
+    void setNumParticles(int n);
     bool threadInit();     
     void threadRelease();
     void run(); 
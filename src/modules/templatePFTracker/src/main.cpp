@@ -62,6 +62,11 @@ configuration file (they can also be specified as command-line parameters if you
 so wish). The value part can be changed to suit your needs; the default values
 are shown below.
 
+- \c particles \c 1000 \n
+  specifies the number of particles of each camera; their likelihoods are
+computed in parallel from an integral histogram of the frame, thus thousands
+of particles can be tracked at the frame rate of the cameras
+
 - \c inputPortNameTemp \c /templatePFTracker/template/image:i \n
   specifies the input port name (this string will be prefixed by \c
 /templatePFTracker or whatever else is specifed by the name parameter
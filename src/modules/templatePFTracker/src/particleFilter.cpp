@@ -20,6 +20,9 @@
  */
 
 #include <utility>
+#include <algorithm>
+#include <cmath>
+#include <opencv2/core/utility.hpp>
 #include <yarp/cv/Cv.h>
 #include <iCub/particleFilter.h>
 
@@ -41,6 +44,83 @@ int particle_cmp( const void* p1, const void* p2 )
     return 0;
 }
 /**********************************************************/
+IntegralHistogram::IntegralHistogram() : planes(NH*NS + NV, -1)
+{
+    width = height = numPlanes = 0;
+}
+/**********************************************************/
+void IntegralHistogram::setBins( const vector<int> &bins )
+{
+    std::fill( planes.begin(), planes.end(), -1 );
+    numPlanes = 0;
+    for( size_t i = 0; i < bins.size(); i++ )
+        planes[bins[i]] = numPlanes++;
+}
+/**********************************************************/
+void IntegralHistogram::build( IplImage* hsv )
+{
+    width = hsv->width;
+    height = hsv->height;
+    bins.resize( (size_t)width * height );
+    table.resize( (size_t)(width + 1) * (height + 1) * numPlanes );
+    rowSum.resize( numPlanes );
+
+    // bin of each pixel, the rows are independent
+    cv::parallel_for_( cv::Range( 0, height ), [&]( const cv::Range &rows )
+    {
+        for( int r = rows.start; r < rows.end; r++ )
+        {
+            const float* px = (const float*)( hsv->imageData + hsv->widthStep * r );
+            unsigned char* b = &bins[(size_t)r * width];
+            for( int c = 0; c < width; c++, px += 3 )
+                b[c] = (unsigned char)PARTICLEThread::histo_bin( px[0], px[1], px[2] );
+        }
+    });
+
+    // the first row and column of the tables are zero, any other entry is the one above
+    // plus the counts of the row up to its pixel
+    int stride = ( width + 1 ) * numPlanes;
+    std::fill( table.begin(), table.begin() + stride, 0 );
+    for( int r = 0; r < height; r++ )
+    {
+        const unsigned char* b = &bins[(size_t)r * width];
+        const int* above = &table[(size_t)r * stride];
+        int* cur = &table[(size_t)( r + 1 ) * stride];
+        std::fill( rowSum.begin(), rowSum.end(), 0 );
+        std::fill( cur, cur + numPlanes, 0 );
+        for( int c = 0; c < width; c++ )
+        {
+            int plane = planes[b[c]];
+            if( plane >= 0 )
+                rowSum[plane]++;
+            above += numPlanes;
+            cur += numPlanes;
+            for( int k = 0; k < numPlanes; k++ )
+                cur[k] = above[k] + rowSum[k];
+        }
+    }
+}
+/**********************************************************/
+int IntegralHistogram::count( int x, int y, int w, int h, int* counts ) const
+{
+    int x0 = MAX( x, 0 ), y0 = MAX( y, 0 );
+    int x1 = MIN( x + w, width ), y1 = MIN( y + h, height );
+    if( x1 <= x0 || y1 <= y0 )
+    {
+        std::fill( counts, counts + numPlanes, 0 );
+        return 0;
+    }
+
+    int stride = ( width + 1 ) * numPlanes;
+    const int* t00 = &table[(size_t)y0 * stride + (size_t)x0 * numPlanes];
+    const int* t01 = &table[(size_t)y0 * stride + (size_t)x1 * numPlanes];
+    const int* t10 = &table[(size_t)y1 * stride + (size_t)x0 * numPlanes];
+    const int* t11 = &table[(size_t)y1 * stride + (size_t)x1 * numPlanes];
+    for( int k = 0; k < numPlanes; k++ )
+        counts[k] = t11[k] - t01[k] - t10[k] + t00[k];
+    return ( x1 - x0 ) * ( y1 - y0 );
+}
+/**********************************************************/
 
 PARTICLEThread::~PARTICLEThread() 
 {
@@ -50,8 +130,11 @@ PARTICLEThread::~PARTICLEThread()
 
     gsl_rng_free ( rng );
     free_histos ( ref_histos, num_objects);  
-    if(particles != NULL)
-        free ( particles);
+
+    if (img_hsv)
+        cvReleaseImage(&img_hsv);
+    if (img_bgr32f)
+        cvReleaseImage(&img_bgr32f);
 
     if (temp)
     {
@@ -74,8 +157,8 @@ PARTICLEThread::PARTICLEThread()
     gotTemplate = false;
     sendTarget = false;
     getImage = false;
-    particles = NULL;
-    new_particles = NULL;
+    img_hsv = NULL;
+    img_bgr32f = NULL;
     temp = NULL;
     ref_histos = NULL;
     tpl = NULL;
@@ -243,31 +326,43 @@ void PARTICLEThread::runAll(IplImage *img)
             free_histos ( ref_histos, num_objects);        
 
         ref_histos = compute_ref_histos( img_hsv, *regions, num_objects );
-        if (particles != NULL)
-            free (particles);
+        set_reference( ref_histos, num_objects );
 
-        particles= init_distribution( *regions, ref_histos, num_objects, num_particles );
+        particles.resize( num_particles );
+        new_particles.resize( num_particles );
+        resample_order.reserve( num_particles );
+        init_distribution( *regions, ref_histos, num_objects, particles.data(), num_particles );
     }
     else
     {
-        // perform prediction and measurement for each particle
+        // perform prediction for each particle, drawing from the generator in turn
         for( j = 0; j < num_particles; j++ ) 
-        {
             particles[j] = transition( particles[j], w, h, rng );
-            s = particles[j].s;
-            particles[j].w = likelihood( img_hsv, cvRound(particles[j].y),
-            cvRound( particles[j].x ),
-            cvRound( particles[j].width * s ),
-            cvRound( particles[j].height * s ),
-            particles[j].histo );
-        }
+
+        // measure the particles in parallel against the integral histogram of the frame
+        integral.build( img_hsv );
+        cv::parallel_for_( cv::Range( 0, num_particles ), [&]( const cv::Range &range )
+        {
+            for( int n = range.start; n < range.end; n++ )
+            {
+                particle &p = particles[n];
+                int o = 0;
+                while( ( o < num_objects - 1 ) && ( ref_histos[o] != p.histo ) )
+                    o++;
+                p.w = likelihood( cvRound( p.y ), cvRound( p.x ),
+                                  cvRound( p.width * p.s ), cvRound( p.height * p.s ),
+                                  &ref_sqrt[(size_t)o * integral.getNumBins()] );
+            }
+        });
+
         // normalize weights and resample a set of unweighted particles
-        normalize_weights( particles, num_particles );
-        new_particles = resample( particles, num_particles );
-        free( particles );
-        particles = new_particles;
+        normalize_weights( particles.data(), num_particles );
+        resample( particles.data(), new_particles.data(), num_particles );
+        particles.swap( new_particles );
     }
-    qsort( particles, num_particles, sizeof( PARTICLEThread::particle ), &particle_cmp );
+    // only the most likely particle is needed in front
+    std::iter_swap( particles.begin(), std::max_element( particles.begin(), particles.end(),
+                    []( const particle &a, const particle &b ) { return a.w < b.w; } ) );
 
     averageMutex.lock();
     for( j = 0; j < num_particles; j++ ) 
@@ -287,8 +382,6 @@ void PARTICLEThread::runAll(IplImage *img)
         display_particleBlob( frame_blob, particles[0], targetTemp );
     targetMutex.unlock();
     trace_template( frame, particles[0] );
-
-    cvReleaseImage(&img_hsv);
 }
 /**********************************************************/
 void PARTICLEThread::setTemplate(ImageOf<PixelRgb> *_tpl)
@@ -296,6 +389,11 @@ void PARTICLEThread::setTemplate(ImageOf<PixelRgb> *_tpl)
     tpl = new ImageOf<PixelRgb> (*_tpl);
 }
 /**********************************************************/
+void PARTICLEThread::setNumParticles(int n)
+{
+    num_particles = MAX( n, 1 );
+}
+/**********************************************************/
 void PARTICLEThread::pushTarget(Vector &target, Stamp &stamp)
 {
     lock_guard<mutex> lck(targetMutex);
@@ -366,6 +464,25 @@ PARTICLEThread::histogram** PARTICLEThread::compute_ref_histos( IplImage* frame,
     return histos;
 }
 /**********************************************************/
+void PARTICLEThread::set_reference( histogram** histos, int n )
+{
+    // the bins empty in all the references do not contribute to the similarity
+    vector<int> bins;
+    for( int b = 0; b < NH*NS + NV; b++ )
+        for( int i = 0; i < n; i++ )
+            if( histos[i]->histo[b] > 0.0f )
+            {
+                bins.push_back( b );
+                break;
+            }
+    integral.setBins( bins );
+
+    ref_sqrt.resize( (size_t)n * bins.size() );
+    for( int i = 0; i < n; i++ )
+        for( size_t k = 0; k < bins.size(); k++ )
+            ref_sqrt[i * bins.size() + k] = sqrt( histos[i]->histo[bins[k]] );
+}
+/**********************************************************/
 PARTICLEThread::histogram* PARTICLEThread::calc_histogram( IplImage** imgs, int n ) 
 {
     IplImage* img;
@@ -450,14 +567,12 @@ int PARTICLEThread::histo_bin( float h, float s, float v )
     return sd * NH + hd;
 }
 /**********************************************************/
-PARTICLEThread::particle* PARTICLEThread::init_distribution( CvRect* regions, histogram** histos, int n, int p) 
+void PARTICLEThread::init_distribution( CvRect* regions, histogram** histos, int n, particle* particles, int p) 
 {
-    particle* particles;
     int np;
     float x, y;
     int i, j, width, height, k = 0;
 
-    particles = (particle* )malloc( p * sizeof( particle ) );
     np = p / n;
 
     // create particles at the centers of each of n regions 
@@ -494,7 +609,6 @@ PARTICLEThread::particle* PARTICLEThread::init_distribution( CvRect* regions, hi
         particles[k++].w = 0;
         i = ( i + 1 ) % n;
     }
-    return particles;
 }
 /**********************************************************/
 PARTICLEThread::particle PARTICLEThread::transition( const PARTICLEThread::particle &p, int w, int h, gsl_rng* rng ) 
@@ -526,50 +640,26 @@ PARTICLEThread::particle PARTICLEThread::transition( const PARTICLEThread::parti
     return pn;
 }
 /**********************************************************/
-float PARTICLEThread::likelihood( IplImage* img, int r, int c, int w, int h, histogram* ref_histo ) 
-{
-    IplImage* tmp;
-    histogram* histo;
-    float d_sq;
-
-    // extract region around (r,c) and compute and normalize its histogram 
-    cvSetImageROI( img, cvRect( c - w / 2, r - h / 2, w, h ) );
-    tmp = cvCreateImage( cvGetSize(img), IPL_DEPTH_32F, 3 );
-    cvCopy( img, tmp, NULL );
-    cvResetImageROI( img );
-    histo = calc_histogram( &tmp, 1 );
-    cvReleaseImage( &tmp );
-    normalize_histogram( histo );
-
-    // compute likelihood as e^{\lambda D^2(h, h^*)} 
-    d_sq = histo_dist_sq( histo, ref_histo );
-    free( histo );
-    return exp( -LAMBDA * d_sq );
-}
-/**********************************************************/
-float PARTICLEThread::histo_dist_sq( histogram* h1, histogram* h2 ) 
+float PARTICLEThread::likelihood( int r, int c, int w, int h, const float* ref_sqrt ) const
 {
-    float* hist1, * hist2;
+    int counts[NH*NS + NV];
     float sum = 0;
-    int i, n;
 
-    n = h1->n;
-    hist1 = h1->histo;
-    hist2 = h2->histo;
-    //  According the the Battacharyya similarity coefficient,
-    //  D = \sqrt{ 1 - \sum_1^n{ \sqrt{ h_1(i) * h_2(i) } } }
-
-    for( i = 0; i < n; i++ )
-        sum += sqrt( hist1[i]*hist2[i] );
-
-    if(sum<1.0f)
-        return sqrt(1.0f - sum);
-    else
+    // histogram of the region around (r,c), normalized by its area
+    int area = integral.count( c - w / 2, r - h / 2, w, h, counts );
+    if( area > 0 )
     {
-        // should be impossible to get here...
-        fprintf(stdout,"Error in similarity computation!\n");
-        return 1.0f-sum;
+        //  According the the Battacharyya similarity coefficient,
+        //  D = \sqrt{ 1 - \sum_1^n{ \sqrt{ h_1(i) * h_2(i) } } }
+        for( int i = 0; i < integral.getNumBins(); i++ )
+            sum += sqrt( (float)counts[i] ) * ref_sqrt[i];
+        sum /= sqrt( (float)area );
     }
+
+    // compute likelihood as e^{\lambda D^2(h, h^*)}, where rounding may give
+    // a sum slightly above 1 for identical histograms
+    float d = ( sum < 1.0f ) ? sqrt( 1.0f - sum ) : 0.0f;
+    return exp( -LAMBDA * d );
 }
 /**********************************************************/
 void PARTICLEThread::normalize_weights( particle* particles, int n ) 
@@ -583,30 +673,37 @@ void PARTICLEThread::normalize_weights( particle* particles, int n )
         particles[i].w /= sum;
 }
 /**********************************************************/
-PARTICLEThread::particle* PARTICLEThread::resample( particle* particles, int n ) 
+void PARTICLEThread::resample( const particle* particles, particle* new_particles, int n ) 
 {
-    particle* _new_particles;
-    int i, j, np, k = 0;
+    int i, j, np, best = 0, total = 0, k = 0;
 
-    //new_particles = (particle* )malloc( sizeof( particle ) );
-    qsort( particles, n, sizeof( particle ), &particle_cmp );
-    _new_particles = (particle* ) malloc( n * sizeof( particle ) );
+    for( i = 0; i < n; i++ )
+    {
+        total += cvRound( particles[i].w * n );
+        if( particles[i].w > particles[best].w )
+            best = i;
+    }
 
-    for( i = 0; i < n; i++ ) 
+    // replicate each particle in proportion to its weight; the heaviest go first, but
+    // their order matters only when the copies are too many, and then just the
+    // particles with at least one copy need to be sorted
+    resample_order.clear();
+    for( i = 0; i < n; i++ )
+        if( cvRound( particles[i].w * n ) > 0 )
+            resample_order.push_back( i );
+    if( total > n )
+        std::stable_sort( resample_order.begin(), resample_order.end(),
+                          [particles]( int a, int b ) { return particles[a].w > particles[b].w; } );
+
+    for( size_t o = 0; ( o < resample_order.size() ) && ( k < n ); o++ )
     {
-        np = cvRound( particles[i].w * n );
-        for( j = 0; j < np; j++ ) 
-        {
-            _new_particles[k++] = particles[i];
-        if( k == n )
-            goto exit;
-        }
+        const particle &p = particles[resample_order[o]];
+        np = cvRound( p.w * n );
+        for( j = 0; ( j < np ) && ( k < n ); j++ )
+            new_particles[k++] = p;
     }
     while( k < n )
-        _new_particles[k++] = particles[0];
-
-    exit:
-    return _new_particles;
+        new_particles[k++] = particles[best];
 }
 /**********************************************************/
 void PARTICLEThread::display_particle( IplImage* img, const PARTICLEThread::particle &p, CvScalar color, Vector& target ) 
@@ -716,14 +813,19 @@ float PARTICLEThread::pixval32f(IplImage* img, int r, int c)
 /**********************************************************/
 IplImage* PARTICLEThread::bgr2hsv( IplImage* bgr ) 
 {
-    IplImage* bgr32f, * hsv;
-
-    bgr32f = cvCreateImage( cvGetSize(bgr), IPL_DEPTH_32F, 3 );
-    hsv = cvCreateImage( cvGetSize(bgr), IPL_DEPTH_32F, 3 );
-    cvConvertScale( bgr, bgr32f, 1.0 / 255.0, 0 );
-    cvCvtColor( bgr32f, hsv, CV_BGR2HSV );
-    cvReleaseImage( &bgr32f );
-    return hsv;
+    // the images are reused from one frame to the next
+    if( ( img_hsv == NULL ) || ( img_hsv->width != bgr->width ) || ( img_hsv->height != bgr->height ) )
+    {
+        if( img_hsv )
+            cvReleaseImage( &img_hsv );
+        if( img_bgr32f )
+            cvReleaseImage( &img_bgr32f );
+        img_bgr32f = cvCreateImage( cvGetSize(bgr), IPL_DEPTH_32F, 3 );
+        img_hsv = cvCreateImage( cvGetSize(bgr), IPL_DEPTH_32F, 3 );
+    }
+    cvConvertScale( bgr, img_bgr32f, 1.0 / 255.0, 0 );
+    cvCvtColor( img_bgr32f, img_hsv, CV_BGR2HSV );
+    return img_hsv;
 }
 /**********************************************************/
 TemplateStruct PARTICLEThread::getBestTemplate()
@@ -745,6 +847,7 @@ TemplateStruct PARTICLEThread::getBestTemplate()
 PARTICLEManager::PARTICLEManager() : PeriodicThread(0.02) 
 {
     tpl = NULL;
+    numParticles = PARTICLES;
 }
 /**********************************************************/
 PARTICLEManager::~PARTICLEManager() { }
@@ -754,6 +857,11 @@ void PARTICLEManager::setName(string module)
     this->moduleName = module;
 }
 /**********************************************************/
+void PARTICLEManager::setNumParticles(int n) 
+{
+    numParticles = n;
+}
+/**********************************************************/
 bool PARTICLEManager::threadInit() 
 {
     //create all ports
@@ -772,6 +880,9 @@ bool PARTICLEManager::threadInit()
     particleThreadLeft->setName((moduleName + "/left").c_str());
     particleThreadRight->setName((moduleName + "/right").c_str());
 
+    particleThreadLeft->setNumParticles(numParticles);
+    particleThreadRight->setNumParticles(numParticles);
+
     shouldSend = false;
     particleThreadLeft->start();
     particleThreadRight->start();
@@ -903,6 +1014,9 @@ bool PARTICLEModule::configure(yarp::os::ResourceFinder &rf)
 
     /*pass the name of the module in order to create ports*/
     particleManager->setName(moduleName);    
+    particleManager->setNumParticles(rf.check("particles", 
+                                              Value(PARTICLES), 
+                                              "number of particles (int)").asInt32());
     /* now start the thread to do the work */
     particleManager->start();
     
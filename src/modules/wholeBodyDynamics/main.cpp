@@ -69,6 +69,11 @@ http://wiki.icub.org/wiki/Force_Control
 --no_legs   
 - this option disables the dynamics computation for the legs joints
 
+--parallel \e n 
+- The limbs attached to the upper and lower torso are solved 
+  concurrently by \e n worker threads. The results are identical
+  to those of the serial computation (default, n=0).
+
 \section portsa_sec Ports Accessed
 The port the service is listening to.
 
@@ -122,6 +127,7 @@ This file can be edited at src/wholeBodyDynamics/main.cpp.
 #include <iostream>
 #include <iomanip>
 #include <cstring>
+#include <algorithm>
 
 #include "observerThread.h"
 
@@ -217,6 +223,7 @@ private:
     bool     auto_drift_comp;
     bool     default_ee_cont;       // true: when skin detects no contact, the ext contact is supposed at the end effector
                                     // false: ext contact is supposed at the last location where skin detected a contact
+    int      parallel_workers;      // worker threads solving the limbs concurrently (0: serial)
 
     dataFilter *inertialFilter{};
     BufferedPort<Vector> port_filtered_output;
@@ -256,6 +263,7 @@ public:
         dump_vel_enabled = false;
         auto_drift_comp = false;
         default_ee_cont = false;
+        parallel_workers = 0;
     }
 
     virtual bool createDriver(PolyDriver *&_dd, Property options)
@@ -338,6 +346,24 @@ public:
                 reply.addString("calib arms");
                 reply.addString("calib legs");
                 reply.addString("calib feet");
+                reply.addString("stats");
+                reply.addString("stats reset");
+                return true;
+            }
+            else if (command.get(0).asString()=="stats")
+            {
+                if (inv_dyn)
+                {
+                    if (command.get(1).asString()=="reset")
+                    {
+                        inv_dyn->resetStageStats();
+                        reply.addVocab32("ok");
+                    }
+                    else
+                        inv_dyn->getStageStats(reply);
+                }
+                else
+                    reply.addVocab32("fail");
                 return true;
             }
             else if (command.get(0).asString()=="calib")
@@ -543,6 +569,12 @@ public:
             yInfo("Default contact at the end effector\n");
         }
 
+        if (rf.check("parallel"))
+        {
+            parallel_workers = std::max(0,rf.find("parallel").asInt32());
+            yInfo("Solving the limbs with %d worker threads\n", parallel_workers);
+        }
+
         //---------------------DEVICES--------------------------//
         if(head_enabled)
         {
@@ -671,6 +703,7 @@ public:
         inv_dyn->w0_dw0_enabled=w0_dw0_enabled;
         inv_dyn->dumpvel_enabled=dump_vel_enabled;
         inv_dyn->default_ee_cont=default_ee_cont;
+        inv_dyn->setParallel(parallel_workers);
 
         yInfo("ft thread istantiated...\n");
         Time::delay(5.0);
@@ -834,6 +867,7 @@ int main(int argc, char * argv[])
         cout << "\t--dumpvel         dumps joint velocities and accelerations (debug use only)"                                  << endl;
         cout << "\t--experimental_com_vel  enables com velocity computation (experimental)"                                      << endl;
         cout << "\t--auto_drift_comp  enables automatic drift compensation  (experimental, under debug)"                         << endl;
+        cout << "\t--parallel   n: solves the limbs concurrently with n worker threads. default: 0 (serial)"                    << endl;
         return 0;
     }
 
@@ -43,6 +43,25 @@ using namespace std;
 
 #define TEST_LEG_SENSOR
 #define MEASURE_FROM_FOOT
+
+// F = -(ft-offset), without temporaries
+static void removeOffset(const Vector &ft, const Vector &offset, Vector &F)
+{
+    if (F.length()!=ft.length())
+        F.resize(ft.length());
+    for (size_t i=0; i<ft.length(); i++)
+        F[i] = -(ft[i]-offset[i]);
+}
+
+// ext = measured-model, where model is the i-th column of the estimated sensor wrenches
+static void externalWrench(const Vector &measured, const Matrix &model, int i, Vector &ext)
+{
+    if (ext.length()!=measured.length())
+        ext.resize(measured.length());
+    for (size_t k=0; k<measured.length(); k++)
+        ext[k] = measured[k]-model(k,i);
+}
+
 double lpf_ord1_3hz(double input, int j)
 { 
     if (j<0 || j>= MAX_JN)
@@ -347,6 +366,7 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
     port_all_positions = new BufferedPort<Vector>;
     port_root_position_mat = new BufferedPort<Matrix>;
     port_root_position_vec = new BufferedPort<Vector>;
+    port_stats = new BufferedPort<Vector>;
 
     port_inertial_thread->open(string("/"+local_name+"/inertial:i").c_str());
     port_ft_arm_left->open(string("/"+local_name+"/left_arm/FT:i").c_str());
@@ -406,6 +426,7 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
     port_all_positions->open(string("/"+local_name+"/all_positions:o").c_str());
     port_root_position_mat->open(string("/"+local_name+"/root_position_mat:o").c_str());
     port_root_position_vec->open(string("/"+local_name+"/root_position_vec:o").c_str());
+    port_stats->open(string("/"+local_name+"/stats:o").c_str());
 
     yInfo ("Waiting for port connections");
     if (autoconnect)
@@ -472,6 +493,48 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
     F_ext_cartesian_right_foot.resize(6,0.0);
     com_jac.resize(6,32);
 
+    //-----------PREALLOCATED OUTPUTS----------------//
+    limb_left_arm  = icub->upperTorso->getLimbHandle("left_arm");
+    limb_right_arm = icub->upperTorso->getLimbHandle("right_arm");
+    limb_head      = icub->upperTorso->getLimbHandle("head");
+    limb_left_leg  = icub->lowerTorso->getLimbHandle("left_leg");
+    limb_right_leg = icub->lowerTorso->getLimbHandle("right_leg");
+    limb_torso     = icub->lowerTorso->getLimbHandle("torso");
+
+    F_up.resize(6,0.0);
+    HDTorques.resize(3,0.0);
+    TOTorques.resize(3,0.0);
+    com_all.resize(7,0.0); com_ll.resize(7,0.0); com_rl.resize(7,0.0);
+    com_la.resize(7,0.0);  com_ra.resize(7,0.0); com_hd.resize(7,0.0);
+    com_to.resize(7,0.0);  com_lb.resize(7,0.0); com_ub.resize(7,0.0);
+    com_v.resize(3,0.0);
+    all_dq.resize(32,0.0);
+    all_q.resize(32,0.0);
+    com_all_foot.resize(3,0.0);
+    zeros_up.resize(6,3); zeros_up.zero();
+    foot_root_mat.resize(4,4); foot_root_mat.zero();
+    foot_root_vec.resize(6,0.0);
+    F_mdl_left_leg.resize(6,0.0);
+    F_mdl_right_leg.resize(6,0.0);
+    F_ext_cartesian_left_arm.resize(8,0.0);
+    F_ext_cartesian_right_arm.resize(8,0.0);
+
+    //the rotation from the root to the floor
+    Vector angles(3,0.0);
+    angles[1] = -90/180.0*M_PI;
+    root_r1.fromMatrix(yarp::math::euler2dcm(angles));
+
+    //the frame of the F/T sensors of the feet
+    Matrix hn(4,4); hn.zero();
+    hn(0,2)=1;hn(0,3)=-7.75;
+    hn(1,1)=-1;
+    hn(2,0)=-1;
+    hn(3,3)=1;
+    foot_hn.fromMatrix(hn);
+
+    stage_out.resize(STAGE_NUM,0.0);
+    for (int i=0; i<STAGE_NUM; i++)
+        stage_dt[i]=0.0;
 }
 
 bool inverseDynamics::threadInit()
@@ -541,6 +604,8 @@ void iCubStatus::dump (FILE* f)
 void inverseDynamics::run()
 {
     timestamp.update();
+    double start = Time::now();
+    double tick = start;
 
     thread_status = STATUS_OK;
     static int delay_check=0;
@@ -560,12 +625,12 @@ void inverseDynamics::run()
     }
 
     //remove the offset from the FT sensors measurements
-    F_LArm  = -1.0 * (current_status.ft_arm_left-Offset_LArm);
-    F_RArm  = -1.0 * (current_status.ft_arm_right-Offset_RArm);
-    F_LLeg  = -1.0 * (current_status.ft_leg_left-Offset_LLeg);
-    F_RLeg  = -1.0 * (current_status.ft_leg_right-Offset_RLeg);
-    F_LFoot = -1.0 * (current_status.ft_foot_left-Offset_LFoot);
-    F_RFoot = -1.0 * (current_status.ft_foot_right-Offset_RFoot);
+    removeOffset(current_status.ft_arm_left,  Offset_LArm,  F_LArm);
+    removeOffset(current_status.ft_arm_right, Offset_RArm,  F_RArm);
+    removeOffset(current_status.ft_leg_left,  Offset_LLeg,  F_LLeg);
+    removeOffset(current_status.ft_leg_right, Offset_RLeg,  F_RLeg);
+    removeOffset(current_status.ft_foot_left, Offset_LFoot, F_LFoot);
+    removeOffset(current_status.ft_foot_right,Offset_RFoot, F_RFoot);
    //F_LFoot = 1.0 * (current_status.ft_foot_left);
    //F_RFoot = 1.0 * (current_status.ft_foot_right);
 
@@ -595,23 +660,14 @@ void inverseDynamics::run()
         current_status.inertial_dw0.zero();
     }
 
-    Vector F_up(6, 0.0);
+    stageDone(STAGE_READ,tick);
+
     icub->upperTorso->setInertialMeasure(current_status.inertial_w0,current_status.inertial_dw0,current_status.inertial_d2p0);
     icub->upperTorso->setSensorMeasurement(F_RArm,F_LArm,F_up);
-
-//#define DEBUG_PERFORMANCE
-#ifdef DEBUG_PERFORMANCE
-    static double meanTime = 0.0;
-    static double startTime = 0;
-    startTime = Time::now();
-#endif
     icub->upperTorso->solveKinematics();
     addSkinContacts();
     icub->upperTorso->solveWrench();
-#ifdef DEBUG_PERFORMANCE
-    meanTime += Time::now()-startTime;
-    yDebug("Mean uppertorso NE time: %.4f\n", meanTime/getIterations());
-#endif
+    stageDone(STAGE_UPPER_NE,tick);
 
 //#define DEBUG_KINEMATICS
 #ifdef DEBUG_KINEMATICS
@@ -624,6 +680,7 @@ void inverseDynamics::run()
     icub->attachLowerTorso(F_RLeg,F_LLeg);
     icub->lowerTorso->solveKinematics();
     icub->lowerTorso->solveWrench();
+    stageDone(STAGE_LOWER_NE,tick);
 
 //#define DEBUG_KINEMATICS
 #ifdef DEBUG_KINEMATICS
@@ -660,15 +717,13 @@ void inverseDynamics::run()
             icub->lowerTorso->up->getMoment(2).toString().c_str());
 #endif
 
-    Vector LATorques = icub->upperTorso->getTorques("left_arm");
-    Vector RATorques = icub->upperTorso->getTorques("right_arm");
-    Vector HDtmp     = icub->upperTorso->getTorques("head");
+    icub->upperTorso->getTorques(limb_left_arm,  LATorques);
+    icub->upperTorso->getTorques(limb_right_arm, RATorques);
+    icub->upperTorso->getTorques(limb_head,      HDtmp);
 
-    Vector LLTorques = icub->lowerTorso->getTorques("left_leg");
-    Vector RLTorques = icub->lowerTorso->getTorques("right_leg");
-    Vector TOtmp     = icub->lowerTorso->getTorques("torso");
-    Vector TOTorques(3);
-    Vector HDTorques(3);
+    icub->lowerTorso->getTorques(limb_left_leg,  LLTorques);
+    icub->lowerTorso->getTorques(limb_right_leg, RLTorques);
+    icub->lowerTorso->getTorques(limb_torso,     TOtmp);
 
     //head torques
     HDTorques[0] = HDtmp [0];
@@ -693,31 +748,26 @@ void inverseDynamics::run()
     if (ddLL) writeTorque(LLTorques, 2, port_LLTorques); //leg
     writeTorque(RATorques, 3, port_RWTorques); //wrist
     writeTorque(LATorques, 3, port_LWTorques); //wrist
+    stageDone(STAGE_TORQUES,tick);
 
-    Vector com_all(7), com_ll(7), com_rl(7), com_la(7),com_ra(7), com_hd(7), com_to(7), com_lb(7), com_ub(7);
     double mass_all  , mass_ll  , mass_rl  , mass_la  ,mass_ra  , mass_hd,   mass_to, mass_lb, mass_ub;
-    Vector com_v; com_v.resize(3); com_v.zero();
-    Vector all_dq; all_dq.resize(32,1); all_dq.zero();
-    Vector all_q;  all_q.resize(32,1);  all_q.zero();
+    com_v.zero();
+    all_dq.zero();
+    all_q.zero();
 
     // For balancing purposes
-    yarp::sig::Vector com_all_foot; com_all_foot.resize(3); com_all_foot.zero();
-    yarp::sig::Matrix rTf; rTf.resize(4,4); rTf.zero();
-    yarp::sig::Matrix fTr; fTr.resize(4,4); fTr.zero();
-    yarp::sig::Matrix lastRotTrans; lastRotTrans.resize(4,4); lastRotTrans.zero();
-    lastRotTrans(2,0)=lastRotTrans(3,3)=lastRotTrans(0,2)=1;
-    lastRotTrans(1,1)=-1;
+    com_all_foot.resize(3); com_all_foot.zero();
+    iKinSE3 lastRotTrans;
+    lastRotTrans.eye();
+    lastRotTrans.R[0][0]=lastRotTrans.R[2][2]=0;
+    lastRotTrans.R[2][0]=lastRotTrans.R[0][2]=1;
+    lastRotTrans.R[1][1]=-1;
 
-    rTf = icub->lowerTorso->right->getH();
-
-    rTf = (icub->lowerTorso->getHRight()) * rTf*lastRotTrans;           //Until the world reference frame
-    fTr.setSubmatrix(rTf.submatrix(0,2,0,2).transposed(), 0, 0);         //CHECKED
-    fTr.setSubcol(-1*fTr.submatrix(0,2,0,2)*rTf.subcol(0,3,3), 0, 3);    //CHECKED    
-    fTr(3,3) = 1;
-
-    //filling distance from root projection onto the floor to the right foot. 
-    lastRotTrans(1,3)=-rTf(1,3);
-    lastRotTrans(2,3)= -rTf(0,3); 
+    iKinSE3 rTf,Hi;
+    Hi.fromMatrix(icub->lowerTorso->HRight);
+    icub->lowerTorso->right->getH(rTf);
+    iKinSE3::compose(Hi,rTf,rTf);
+    iKinSE3::compose(rTf,lastRotTrans,rTf);                             //Until the world reference frame
 
 
     if (com_enabled)
@@ -765,17 +815,23 @@ void inverseDynamics::run()
         }
 
         #ifdef MEASURE_FROM_FOOT
-        com_all_foot.setSubvector(0,com_all.subVector(0,2));
+        // com_all_foot = fTr*[com_all;1], where fTr is the inverse of rTf
+        double d[3];
+        for (int i=0; i<3; i++)
+            d[i]=com_all[i]-rTf.p[i];
         com_all_foot.push_back(1);
-        com_all_foot = fTr*com_all_foot;
+        for (int i=0; i<3; i++)
+            com_all_foot[i]=rTf.R[0][i]*d[0]+rTf.R[1][i]*d[1]+rTf.R[2][i]*d[2];
         #endif
 
     }
     else
     {
         mass_all=mass_ll=mass_rl=mass_la=mass_ra=mass_hd=mass_to=0.0;
+        com_all.resize(7); com_ll.resize(7); com_rl.resize(7); com_la.resize(7); com_ra.resize(7); com_hd.resize(7); com_to.resize(7);
         com_all.zero(); com_ll.zero(); com_rl.zero(); com_la.zero(); com_ra.zero(); com_hd.zero(); com_to.zero();
     }
+    stageDone(STAGE_COM,tick);
 
     // DYN/SKIN CONTACTS
     dynContacts = icub->upperTorso->leftSensor->getContactList();
@@ -839,117 +895,104 @@ void inverseDynamics::run()
     
 	//*********************************************** add the legs contacts JUST TEMP FIX!! *******************
 
-    F_ext_cartesian_left_arm = F_ext_cartesian_right_arm = zeros(6);
-    F_ext_cartesian_left_leg = F_ext_cartesian_right_leg = zeros(6);
+    stageDone(STAGE_CONTACTS,tick);
+
     F_ext_left_arm  = icub->upperTorso->leftSensor->getForceMomentEndEff();
     F_ext_right_arm = icub->upperTorso->rightSensor->getForceMomentEndEff();
     F_ext_left_leg  = icub->lowerTorso->leftSensor->getForceMomentEndEff();
     F_ext_right_leg = icub->lowerTorso->rightSensor->getForceMomentEndEff();
 
     // EXTERNAL DYNAMICS AT THE F/T SENSORS
-    Matrix F_sensor_up = icub_sens->upperTorso->estimateSensorsWrench(zeros(6,3));
-    F_ext_sens_right_arm = F_RArm - F_sensor_up.getCol(0);  // measured wrench - internal wrench = external wrench
-    F_ext_sens_left_arm = F_LArm - F_sensor_up.getCol(1);   // measured wrench - internal wrench = external wrench
+    F_sensor_up = icub_sens->upperTorso->estimateSensorsWrench(zeros_up);
+    externalWrench(F_RArm,F_sensor_up,0,F_ext_sens_right_arm);  // measured wrench - internal wrench = external wrench
+    externalWrench(F_LArm,F_sensor_up,1,F_ext_sens_left_arm);   // measured wrench - internal wrench = external wrench
 
 #ifdef TEST_LEG_SENSOR
     setUpperMeasure(true);
     setLowerMeasure(true);
 #endif
 
-    Matrix F_sensor_low = icub_sens->lowerTorso->estimateSensorsWrench(F_ext_low,false);
-    F_ext_sens_right_leg = F_RLeg - F_sensor_low.getCol(0); // measured wrench - internal wrench = external wrench
-    F_ext_sens_left_leg = F_LLeg - F_sensor_low.getCol(1);  // measured wrench - internal wrench = external wrench
+    F_sensor_low = icub_sens->lowerTorso->estimateSensorsWrench(F_ext_low,false);
+    externalWrench(F_RLeg,F_sensor_low,0,F_ext_sens_right_leg); // measured wrench - internal wrench = external wrench
+    externalWrench(F_LLeg,F_sensor_low,1,F_ext_sens_left_leg);  // measured wrench - internal wrench = external wrench
 
 #ifdef TEST_LEG_SENSOR
-    F_mdl_right_leg = F_sensor_low.getCol(0);
-    F_mdl_left_leg  = F_sensor_low.getCol(1);
+    for (int i=0; i<6; i++)
+    {
+        F_mdl_right_leg[i] = F_sensor_low(i,0);
+        F_mdl_left_leg[i]  = F_sensor_low(i,1);
+    }
     F_sns_right_leg = F_RLeg;
     F_sns_left_leg  = F_LLeg;
 #endif
+    stageDone(STAGE_SENSORS,tick);
+
+    iKinSE3 ht,ahl,ahr,lhl,lhr;
+    Hi.fromMatrix(icub->upperTorso->HUp);
+    icub->upperTorso->up->getH(ht);
+    iKinSE3::compose(Hi,ht,ht);
+
+    Hi.fromMatrix(icub->upperTorso->HLeft);
+    icub->upperTorso->left->getH(ahl);
+    iKinSE3::compose(Hi,ahl,ahl);
+    iKinSE3::compose(ht,ahl,ahl);
+
+    Hi.fromMatrix(icub->upperTorso->HRight);
+    icub->upperTorso->right->getH(ahr);
+    iKinSE3::compose(Hi,ahr,ahr);
+    iKinSE3::compose(ht,ahr,ahr);
+
+    Hi.fromMatrix(icub->lowerTorso->HLeft);
+    icub->lowerTorso->left->getH(lhl);
+    iKinSE3::compose(Hi,lhl,lhl);
+
+    Hi.fromMatrix(icub->lowerTorso->HRight);
+    icub->lowerTorso->right->getH(lhr);
+    iKinSE3::compose(Hi,lhr,lhr);
+
+    rotateWrench(ahl,F_ext_left_arm,F_ext_cartesian_left_arm);
+    F_ext_cartesian_left_arm[6]=sqrt(F_ext_cartesian_left_arm[0]*F_ext_cartesian_left_arm[0]+
+                                     F_ext_cartesian_left_arm[1]*F_ext_cartesian_left_arm[1]+
+                                     F_ext_cartesian_left_arm[2]*F_ext_cartesian_left_arm[2]);
+    F_ext_cartesian_left_arm[7]=sqrt(F_ext_cartesian_left_arm[3]*F_ext_cartesian_left_arm[3]+
+                                     F_ext_cartesian_left_arm[4]*F_ext_cartesian_left_arm[4]+
+                                     F_ext_cartesian_left_arm[5]*F_ext_cartesian_left_arm[5]);
+
+    rotateWrench(ahr,F_ext_right_arm,F_ext_cartesian_right_arm);
+    F_ext_cartesian_right_arm[6]=sqrt(F_ext_cartesian_right_arm[0]*F_ext_cartesian_right_arm[0]+
+                                      F_ext_cartesian_right_arm[1]*F_ext_cartesian_right_arm[1]+
+                                      F_ext_cartesian_right_arm[2]*F_ext_cartesian_right_arm[2]);
+    F_ext_cartesian_right_arm[7]=sqrt(F_ext_cartesian_right_arm[3]*F_ext_cartesian_right_arm[3]+
+                                      F_ext_cartesian_right_arm[4]*F_ext_cartesian_right_arm[4]+
+                                      F_ext_cartesian_right_arm[5]*F_ext_cartesian_right_arm[5]);
+
+    rotateWrench(lhl,F_ext_left_leg,F_ext_cartesian_left_leg);
+    rotateWrench(lhr,F_ext_right_leg,F_ext_cartesian_right_leg);
+
+    //computation of the root: foot_root = r1*SE3inv(lhl)
+    iKinSE3 foot_root;
+    for (int i=0; i<3; i++)
+        for (int j=0; j<3; j++)
+            Hi.R[i][j]=lhl.R[j][i];
+    for (int i=0; i<3; i++)
+        Hi.p[i]=-(Hi.R[i][0]*lhl.p[0]+Hi.R[i][1]*lhl.p[1]+Hi.R[i][2]*lhl.p[2]);
+    iKinSE3::compose(root_r1,Hi,foot_root);
+    foot_root.toMatrix(foot_root_mat);
 
-    yarp::sig::Matrix ht   = icub->upperTorso->getHUp()    * icub->upperTorso->up->getH();
-    yarp::sig::Matrix ahl  = ht * icub->upperTorso->getHLeft()  * icub->upperTorso->left->getH();
-    yarp::sig::Matrix ahr  = ht * icub->upperTorso->getHRight() * icub->upperTorso->right->getH();
-    yarp::sig::Matrix lhl  = icub->lowerTorso->getHLeft()  * icub->lowerTorso->left->getH();
-    yarp::sig::Matrix lhr  = icub->lowerTorso->getHRight() * icub->lowerTorso->right->getH();
-
-    yarp::sig::Vector tmp1,tmp2;
-    tmp1 = F_ext_left_arm.subVector(0,2); tmp1.push_back(0.0); tmp1 = ahl * tmp1;
-    tmp2 = F_ext_left_arm.subVector(3,5); tmp2.push_back(0.0); tmp2 = ahl * tmp2;
-    for (int i=0; i<3; i++) F_ext_cartesian_left_arm[i] = tmp1[i];
-    for (int i=3; i<6; i++) F_ext_cartesian_left_arm[i] = tmp2[i-3];
-    double n1=norm(F_ext_cartesian_left_arm.subVector(0,2));
-    double n2=norm(F_ext_cartesian_left_arm.subVector(3,5));
-    F_ext_cartesian_left_arm.push_back(n1);
-    F_ext_cartesian_left_arm.push_back(n2);
-
-    tmp1 = F_ext_right_arm.subVector(0,2); tmp1.push_back(0.0); tmp1 = ahr * tmp1;
-    tmp2 = F_ext_right_arm.subVector(3,5); tmp2.push_back(0.0); tmp2 = ahr * tmp2;
-    for (int i=0; i<3; i++) F_ext_cartesian_right_arm[i] = tmp1[i];
-    for (int i=3; i<6; i++) F_ext_cartesian_right_arm[i] = tmp2[i-3];
-    n1=norm(F_ext_cartesian_right_arm.subVector(0,2));
-    n2=norm(F_ext_cartesian_right_arm.subVector(3,5));
-    F_ext_cartesian_right_arm.push_back(n1);
-    F_ext_cartesian_right_arm.push_back(n2);
-
-    tmp1 = F_ext_left_leg.subVector(0,2); tmp1.push_back(0.0); tmp1 = lhl * tmp1;
-    tmp2 = F_ext_left_leg.subVector(3,5); tmp2.push_back(0.0); tmp2 = lhl * tmp2;
-    for (int i=0; i<3; i++) F_ext_cartesian_left_leg[i] = tmp1[i];
-    for (int i=3; i<6; i++) F_ext_cartesian_left_leg[i] = tmp2[i-3];
-
-    tmp1 = F_ext_right_leg.subVector(0,2); tmp1.push_back(0.0); tmp1 = lhr * tmp1;
-    tmp2 = F_ext_right_leg.subVector(3,5); tmp2.push_back(0.0); tmp2 = lhr * tmp2;
-    for (int i=0; i<3; i++) F_ext_cartesian_right_leg[i] = tmp1[i];
-    for (int i=3; i<6; i++) F_ext_cartesian_right_leg[i] = tmp2[i-3];
-
-    //computation of the root
-    yarp::sig::Vector angles (3);
-    angles[0] = 0;
-    angles[1] = -90/180.0*M_PI;
-    angles[2] = 0;
-    yarp::sig::Matrix r1 = yarp::math::euler2dcm(angles);
-    yarp::sig::Matrix ilhl = yarp::math::SE3inv(lhl);
-    yarp::sig::Matrix foot_root_mat = r1*ilhl;
-    
     yarp::sig::Vector foot_tmp = yarp::math::dcm2rpy(foot_root_mat);
-    //yDebug ("before\n %s\n", foot_root_mat.toString().c_str());
-    yarp::sig::Vector foot_root_vec (6,0.0); 
-    foot_root_vec[3] = foot_root_mat[0][3]*1000;
-    foot_root_vec[4] = foot_root_mat[1][3]*1000;
-    foot_root_vec[5] = foot_root_mat[2][3]*1000;
+    foot_root_vec[3] = foot_root.p[0]*1000;
+    foot_root_vec[4] = foot_root.p[1]*1000;
+    foot_root_vec[5] = foot_root.p[2]*1000;
     foot_root_vec[0] = foot_tmp[0]*180.0/M_PI;
     foot_root_vec[1] = foot_tmp[1]*180.0/M_PI;
     foot_root_vec[2] = foot_tmp[2]*180.0/M_PI;
-    //yarp::sig::Matrix test = iCub::ctrl::rpy2dcm(foot_tmp);
-    //yDebug ("afer\n %s\n", test.toString().c_str());
-    //yDebug ("angles %+.2f %+.2f %+.2f\n", foot_tmp[0]*180.0/M_PI, foot_tmp[1]*180.0/M_PI, foot_tmp[2]*180.0/M_PI);
 
     //computation for the foot
-    Matrix foot_hn(4,4); foot_hn.zero();
-    foot_hn(0,2)=1;foot_hn(0,3)=-7.75;
-    foot_hn(1,1)=-1;
-    foot_hn(2,0)=-1;
-    foot_hn(3,3)=1;
-
-    tmp1 = F_LFoot.subVector(0,2); tmp1.push_back(0.0); tmp1 = foot_hn * tmp1;
-    tmp2 = F_LFoot.subVector(3,5); tmp2.push_back(0.0); tmp2 = foot_hn * tmp2;
-    for (int i=0; i<3; i++) F_ext_left_foot[i] = tmp1[i];
-    for (int i=3; i<6; i++) F_ext_left_foot[i] = tmp2[i-3];
-
-    tmp1 = F_RFoot.subVector(0,2); tmp1.push_back(0.0); tmp1 = foot_hn * tmp1;
-    tmp2 = F_RFoot.subVector(3,5); tmp2.push_back(0.0); tmp2 = foot_hn * tmp2;
-    for (int i=0; i<3; i++) F_ext_right_foot[i] = tmp1[i];
-    for (int i=3; i<6; i++) F_ext_right_foot[i] = tmp2[i-3];
-
-    tmp1 = F_ext_left_foot.subVector(0,2); tmp1.push_back(0.0); tmp1 = lhl * tmp1;
-    tmp2 = F_ext_left_foot.subVector(3,5); tmp2.push_back(0.0); tmp2 = lhl * tmp2;
-    for (int i=0; i<3; i++) F_ext_cartesian_left_foot[i] = tmp1[i];
-    for (int i=3; i<6; i++) F_ext_cartesian_left_foot[i] = tmp2[i-3];
-
-    tmp1 = F_ext_right_foot.subVector(0,2); tmp1.push_back(0.0); tmp1 = lhr * tmp1;
-    tmp2 = F_ext_right_foot.subVector(3,5); tmp2.push_back(0.0); tmp2 = lhr * tmp2;
-    for (int i=0; i<3; i++) F_ext_cartesian_right_foot[i] = tmp1[i];
-    for (int i=3; i<6; i++) F_ext_cartesian_right_foot[i] = tmp2[i-3];
+    rotateWrench(foot_hn,F_LFoot,F_ext_left_foot);
+    rotateWrench(foot_hn,F_RFoot,F_ext_right_foot);
+    rotateWrench(lhl,F_ext_left_foot,F_ext_cartesian_left_foot);
+    rotateWrench(lhr,F_ext_right_foot,F_ext_cartesian_right_foot);
+    stageDone(STAGE_CARTESIAN,tick);
 
     // *** MONITOR DATA ***
     //sendMonitorData();
@@ -1005,6 +1048,18 @@ void inverseDynamics::run()
 
     broadcastData<Matrix> (foot_root_mat,                           port_root_position_mat);
     broadcastData<Vector> (foot_root_vec,                           port_root_position_vec);
+    stageDone(STAGE_BROADCAST,tick);
+
+    stage_dt[STAGE_TOTAL]=Time::now()-start;
+    {
+        lock_guard<mutex> lck(stats_mutex);
+        for (int i=0; i<STAGE_NUM; i++)
+        {
+            stage_stats[i].update(stage_dt[i]);
+            stage_out[i]=1e3*stage_dt[i];
+        }
+    }
+    broadcastData<Vector> (stage_out, port_stats);
 }
 
 void inverseDynamics::threadRelease()
@@ -1139,6 +1194,8 @@ void inverseDynamics::threadRelease()
     yInfo("Closing Foot/Root port\n");
     closePort(port_root_position_mat);
     closePort(port_root_position_vec);
+    yInfo("Closing stats port\n");
+    closePort(port_stats);
 
     if (icub)      {delete icub; icub=0;}
     if (icub_sens) {delete icub_sens; icub=0;}
@@ -1166,16 +1223,67 @@ template <class T> void inverseDynamics::broadcastData(T& _values, BufferedPort<
     }
 }
 
-void inverseDynamics::writeTorque(Vector _values, int _address, BufferedPort<Bottle> *_port)
+void inverseDynamics::writeTorque(const Vector &_values, int _address, BufferedPort<Bottle> *_port)
 {
-    Bottle a;
+    Bottle &a = _port->prepare();
+    a.clear();
     a.addInt32(_address);
     for(size_t i=0;i<_values.length();i++)
         a.addFloat64(_values(i));
-    _port->prepare() = a;
     _port->write();
 }
 
+void inverseDynamics::stageDone(stage_enum stage, double &tick)
+{
+    double now = Time::now();
+    stage_dt[stage] = now-tick;
+    tick = now;
+}
+
+void inverseDynamics::rotateWrench(const iKinSE3 &H, const Vector &wrench, Vector &out)
+{
+    // out = [R*f; R*m], which is the rotation of both the force and the moment
+    // by the homogeneous transformation H applied to [f;0] and [m;0]
+    for (int i=0; i<3; i++)
+    {
+        out[i]   = H.R[i][0]*wrench[0]+H.R[i][1]*wrench[1]+H.R[i][2]*wrench[2];
+        out[i+3] = H.R[i][0]*wrench[3]+H.R[i][1]*wrench[4]+H.R[i][2]*wrench[5];
+    }
+}
+
+void inverseDynamics::getStageStats(Bottle &reply)
+{
+    const char *names[STAGE_NUM]={"read","upper_ne","lower_ne","torques","com",
+                                  "contacts","sensors","cartesian","broadcast","total"};
+
+    lock_guard<mutex> lck(stats_mutex);
+    for (int i=0; i<STAGE_NUM; i++)
+    {
+        // name count last mean min max, times in ms
+        Bottle &b = reply.addList();
+        b.addString(names[i]);
+        b.addInt64((int64_t)stage_stats[i].count);
+        b.addFloat64(1000.0*stage_stats[i].last);
+        b.addFloat64(1000.0*stage_stats[i].mean);
+        b.addFloat64(1000.0*stage_stats[i].min);
+        b.addFloat64(1000.0*stage_stats[i].max);
+    }
+}
+
+void inverseDynamics::resetStageStats()
+{
+    lock_guard<mutex> lck(stats_mutex);
+    for (int i=0; i<STAGE_NUM; i++)
+        stage_stats[i].reset();
+}
+
+void inverseDynamics::setParallel(int nWorkers)
+{
+    // both models are driven by this thread, thus they can share the workers
+    icub->setParallel(nWorkers>0?(unsigned int)nWorkers:0);
+    icub_sens->setTaskPool(icub->getTaskPool());
+}
+
 void inverseDynamics::calibrateOffset(calib_enum calib_code)
 {
     yInfo("calibrateOffset: starting calibration... \n");
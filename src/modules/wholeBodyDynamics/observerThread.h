@@ -32,12 +32,14 @@
 #include <iomanip>
 #include <cstring>
 #include <list>
+#include <mutex>
 
 using namespace yarp::os;
 using namespace yarp::sig;
 using namespace yarp::math;
 using namespace yarp::dev;
 using namespace iCub::ctrl;
+using namespace iCub::iKin;
 using namespace iCub::iDyn;
 using namespace std;
 
@@ -48,6 +50,10 @@ constexpr float_t SKIN_EVENTS_TIMEOUT = 0.2;     // max time (in sec) a contact
 enum thread_status_enum {STATUS_OK=0, STATUS_DISCONNECTED}; 
 enum calib_enum {CALIB_ALL=0, CALIB_ARMS, CALIB_LEGS, CALIB_FEET};
 
+// the stages of the observer loop whose latency is measured
+enum stage_enum {STAGE_READ=0, STAGE_UPPER_NE, STAGE_LOWER_NE, STAGE_TORQUES, STAGE_COM,
+                 STAGE_CONTACTS, STAGE_SENSORS, STAGE_CARTESIAN, STAGE_BROADCAST, STAGE_TOTAL, STAGE_NUM};
+
 // struct version
 // {
 //     int head_version;
@@ -125,6 +131,34 @@ class iCubStatus
 
 };
 
+// latency statistics of a stage of the observer loop, in seconds
+class stageStats
+{
+    public:
+    double last;
+    double mean;
+    double min;
+    double max;
+    unsigned long count;
+
+    stageStats() { reset(); }
+
+    void reset()
+    {
+        last=mean=min=max=0.0;
+        count=0;
+    }
+
+    void update(double dt)
+    {
+        last=dt;
+        count++;
+        mean+=(dt-mean)/count;
+        if ((count==1) || (dt<min)) min=dt;
+        if ((count==1) || (dt>max)) max=dt;
+    }
+};
+
 // class inverseDynamics: class for reading from Vrow and providing FT on an output port
 class inverseDynamics: public PeriodicThread
 {
@@ -230,6 +264,7 @@ private:
     BufferedPort<Vector> *port_all_positions;
     BufferedPort<Matrix> *port_root_position_mat;
     BufferedPort<Vector> *port_root_position_vec;
+    BufferedPort<Vector> *port_stats;
 
     // ports outputing the external dynamics seen at the F/T sensor
     BufferedPort<Vector> *port_external_ft_arm_left;
@@ -287,6 +322,30 @@ private:
     iCub::skinDynLib::skinContactList skinContacts;
     iCub::skinDynLib::dynContactList dynContacts;
 
+    // handles of the limbs of the whole body model, resolved once at startup
+    int limb_left_arm, limb_right_arm, limb_head;
+    int limb_left_leg, limb_right_leg, limb_torso;
+
+    // outputs of run(), preallocated so that the loop does not allocate them at every cycle
+    Vector F_up;
+    Vector LATorques, RATorques, HDtmp, HDTorques;
+    Vector LLTorques, RLTorques, TOtmp, TOTorques;
+    Vector com_all, com_ll, com_rl, com_la, com_ra, com_hd, com_to, com_lb, com_ub;
+    Vector com_v, all_dq, all_q, com_all_foot;
+    Matrix F_sensor_up, F_sensor_low, zeros_up;
+    Matrix foot_root_mat;
+    Vector foot_root_vec;
+    iKinSE3 foot_hn, root_r1;
+
+    // latency of the stages of run(), available through getStageStats()
+    stageStats stage_stats[STAGE_NUM];
+    double stage_dt[STAGE_NUM];
+    Vector stage_out;
+    std::mutex stats_mutex;
+
+    void stageDone(stage_enum stage, double &tick);
+    void rotateWrench(const iKinSE3 &H, const Vector &wrench, Vector &out);
+
 
     // icub model
     int comp;
@@ -320,7 +379,7 @@ public:
     void run() override;
     void threadRelease() override;
     void closePort(Contactable *_port);
-    void writeTorque(Vector _values, int _address, BufferedPort<Bottle> *_port);
+    void writeTorque(const Vector &_values, int _address, BufferedPort<Bottle> *_port);
     template <class T> void broadcastData(T& _values, BufferedPort<T> *_port);
     void calibrateOffset(calib_enum calib_code=CALIB_ALL);
     bool readAndUpdate(bool waitMeasure=false, bool _init=false);
@@ -329,6 +388,9 @@ public:
     void setZeroJntAngVelAcc();
     void sendMonitorData();
     void sendVelAccData();
+    void getStageStats(Bottle &reply);
+    void resetStageStats();
+    void setParallel(int nWorkers);
 
 };
 
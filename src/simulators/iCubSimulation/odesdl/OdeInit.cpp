@@ -51,6 +51,39 @@ OdeInit::OdeInit(RobotConfig *config) : robot_config(config)
     contactFrictionCoefficient = config->getContactFrictionCoefficient(); //unlike the other ODE params fron .ini file that are used to intiialize the properties of the simulation (dWorldSet...),
     //This parameter is employed on the run as contact joints are created (in OdeSdlSimulation::nearCallback() )
 
+    // The "quick" stepper solves the constraints iteratively, in linear time, instead of exactly
+    OdeParams odeParameters = config->getOdeParameters();
+    quickStep = (odeParameters.stepper == "quick");
+    if (quickStep)
+    {
+        dWorldSetQuickStepNumIterations(world, odeParameters.quickStepIterations);
+    }
+    else if (odeParameters.stepper != "step")
+    {
+        yWarning("Unknown stepper %s, using step\n", odeParameters.stepper.c_str());
+    }
+
+    // The islands of the world (groups of bodies connected by joints or contacts) are independent,
+    // thus they can be stepped by a pool of threads
+#ifdef ICUB_SIM_ODE_THREADING
+    threading = NULL;
+    pool = NULL;
+    if (odeParameters.stepThreads > 0)
+    {
+        threading = dThreadingAllocateMultiThreadedImplementation();
+        pool = dThreadingAllocateThreadPool(odeParameters.stepThreads, 0, dAllocateFlagBasicData, NULL);
+        dThreadingThreadPoolServeMultiThreadedImplementation(pool, threading);
+        dWorldSetStepThreadingImplementation(world, dThreadingImplementationGetFunctions(threading), threading);
+        dWorldSetStepIslandsProcessingMaxThreadCount(world, odeParameters.stepThreads);
+        yInfo("Stepping the islands of the world with %d threads\n", odeParameters.stepThreads);
+    }
+#else
+    if (odeParameters.stepThreads > 0)
+    {
+        yWarning("ODE has been built without threading support, stepThreads is ignored\n");
+    }
+#endif
+
     ground = dCreatePlane (space,0, 1, 0, 0);
     //feedback = new dJointFeedback;
     //feedback1 = new dJointFeedback;
@@ -111,9 +144,31 @@ OdeInit::~OdeInit()
     dGeomDestroy(ground);
     dJointGroupDestroy(contactgroup);
     dSpaceDestroy(space);
+#ifdef ICUB_SIM_ODE_THREADING
+    if (threading != NULL)
+    {
+        dThreadingImplementationShutdownProcessing(threading);
+        dThreadingThreadPoolWaitIdleState(pool);
+        dThreadingFreeThreadPool(pool);
+        dWorldSetStepThreadingImplementation(world, NULL, NULL);
+        dThreadingFreeImplementation(threading);
+    }
+#endif
     dWorldDestroy(world);
 }
 
+void OdeInit::step(dReal dstep)
+{
+    if (quickStep)
+    {
+        dWorldQuickStep(world, dstep);
+    }
+    else
+    {
+        dWorldStep(world, dstep);
+    }
+}
+
 OdeInit& OdeInit::init(RobotConfig *config)
 {
     if (_odeinit==NULL)
@@ -38,6 +38,7 @@
 //#include <vector>
 
 #include "RobotConfig.h"
+#include "OdeStateBuffer.h"
 
 #include <mutex>
 #include <list>
@@ -84,6 +85,8 @@ public:
         dJointID contact_joint;
     };
     list<contactOnSkin_t> listOfSkinContactInfos;
+    // poses of the world after the last step, used by the rendering
+    OdeStateBuffer stateBuffer;
   
 
     void setName( string module ){
@@ -101,6 +104,8 @@ public:
     void removeSimulationIMU();
     static OdeInit& init(RobotConfig *config);
     void sendHomePos();
+    // advance the world by a time step, with the stepper set in the configuration
+    void step(dReal dstep);
 
     static OdeInit& get();
 
@@ -115,6 +120,11 @@ private:
     static OdeInit *_odeinit;
 
     RobotConfig *robot_config;
+    bool quickStep;
+#ifdef ICUB_SIM_ODE_THREADING
+    dThreadingImplementationID threading;
+    dThreadingThreadPoolID pool;
+#endif
 };
 
 #endif
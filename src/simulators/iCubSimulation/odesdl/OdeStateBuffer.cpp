@@ -0,0 +1,105 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+ * Copyright (C) 2023 iCub Facility - Istituto Italiano di Tecnologia
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#include "OdeStateBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+OdeStateBuffer::OdeStateBuffer() : writing(0), published(1), reading(2), fresh(false) {
+    for (int i=0; i<3; i++) {
+        buffers[i].time = 0.0;
+    }
+}
+
+void OdeStateBuffer::add(Snapshot &s, const void *id, const dReal *pos, const dReal *R) {
+    Pose p;
+    p.id = id;
+    memcpy(p.pos, pos, sizeof(dVector3));
+    memcpy(p.R, R, sizeof(dMatrix3));
+    s.poses.push_back(p);
+}
+
+void OdeStateBuffer::addSpace(Snapshot &s, dSpaceID space) {
+    int n = dSpaceGetNumGeoms(space);
+    for (int i=0; i<n; i++) {
+        dGeomID g = dSpaceGetGeom(space, i);
+        if (dGeomIsSpace(g)) {
+            addSpace(s, (dSpaceID)g);
+            continue;
+        }
+        // planes are not placeable
+        if (dGeomGetClass(g) == dPlaneClass) {
+            continue;
+        }
+        add(s, g, dGeomGetPosition(g), dGeomGetRotation(g));
+        dBodyID b = dGeomGetBody(g);
+        if (b) {
+            add(s, b, dBodyGetPosition(b), dBodyGetRotation(b));
+        }
+    }
+}
+
+void OdeStateBuffer::capture(dSpaceID space, double simTime) {
+    // the buffers keep their capacity, thus the steady state does not allocate
+    Snapshot &s = buffers[writing];
+    s.poses.clear();
+    s.time = simTime;
+    addSpace(s, space);
+    // the bodies with several geoms are added more than once, which is harmless
+    std::sort(s.poses.begin(), s.poses.end());
+
+    std::lock_guard<std::mutex> lck(mtx);
+    std::swap(writing, published);
+    fresh = true;
+}
+
+void OdeStateBuffer::acquire() {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (fresh) {
+        std::swap(reading, published);
+        fresh = false;
+    }
+}
+
+const OdeStateBuffer::Pose *OdeStateBuffer::find(const void *id) const {
+    const std::vector<Pose> &poses = buffers[reading].poses;
+    Pose key;
+    key.id = id;
+    std::vector<Pose>::const_iterator it = std::lower_bound(poses.begin(), poses.end(), key);
+    return ((it != poses.end()) && (it->id == id)) ? &(*it) : NULL;
+}
+
+const dReal *OdeStateBuffer::geomPosition(dGeomID g) const {
+    const Pose *p = find(g);
+    return p ? p->pos : dGeomGetPosition(g);
+}
+
+const dReal *OdeStateBuffer::geomRotation(dGeomID g) const {
+    const Pose *p = find(g);
+    return p ? p->R : dGeomGetRotation(g);
+}
+
+const dReal *OdeStateBuffer::bodyPosition(dBodyID b) const {
+    const Pose *p = find(b);
+    return p ? p->pos : dBodyGetPosition(b);
+}
+
+const dReal *OdeStateBuffer::bodyRotation(dBodyID b) const {
+    const Pose *p = find(b);
+    return p ? p->R : dBodyGetRotation(b);
+}
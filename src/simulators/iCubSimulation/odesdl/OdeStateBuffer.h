@@ -0,0 +1,87 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+ * Copyright (C) 2023 iCub Facility - Istituto Italiano di Tecnologia
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+/**
+ * \file OdeStateBuffer.h
+ * \brief Snapshots of the poses of the geoms and bodies of the world, taken by the
+ * physics thread after each step and read by the rendering, so that drawing the
+ * scene and the camera images never reads the world while it is being stepped.
+ **/
+
+#ifndef ICUBSIMULATION_ODESTATEBUFFER_INC
+#define ICUBSIMULATION_ODESTATEBUFFER_INC
+
+#include <ode/ode.h>
+#include <vector>
+#include <mutex>
+
+class OdeStateBuffer {
+public:
+    OdeStateBuffer();
+
+    /**
+     * Take a snapshot of all the placeable geoms of the space (and of its
+     * subspaces) and of their bodies, and publish it. It is called by the
+     * physics thread, with the world locked.
+     */
+    void capture(dSpaceID space, double simTime);
+
+    /**
+     * Switch the rendering to the last published snapshot, if any. The
+     * snapshot in use is kept until the next call.
+     */
+    void acquire();
+
+    /**
+     * @return the simulation time of the snapshot in use
+     */
+    double getTime() const { return buffers[reading].time; }
+
+    // the pose in the snapshot in use; objects missing from it (e.g. created
+    // after the last step) are read from the world
+    const dReal *geomPosition(dGeomID g) const;
+    const dReal *geomRotation(dGeomID g) const;
+    const dReal *bodyPosition(dBodyID b) const;
+    const dReal *bodyRotation(dBodyID b) const;
+
+private:
+    struct Pose {
+        const void *id;
+        dVector3 pos;
+        dMatrix3 R;
+        bool operator<(const Pose &p) const { return id<p.id; }
+    };
+
+    struct Snapshot {
+        std::vector<Pose> poses;    // sorted by id
+        double time;
+    };
+
+    const Pose *find(const void *id) const;
+    void add(Snapshot &s, const void *id, const dReal *pos, const dReal *R);
+    void addSpace(Snapshot &s, dSpaceID space);
+
+    // triple buffering: the physics thread fills buffers[writing] and then swaps
+    // it with buffers[published], the rendering swaps buffers[reading] with the
+    // published one when it is newer
+    Snapshot buffers[3];
+    int writing, published, reading;
+    bool fresh;
+    std::mutex mtx;
+};
+
+#endif
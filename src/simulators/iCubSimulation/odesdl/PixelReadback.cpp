@@ -0,0 +1,169 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+ * Copyright (C) 2023 iCub Facility - Istituto Italiano di Tecnologia
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#include "PixelReadback.h"
+
+#include <yarp/os/LogStream.h>
+#include <cstdio>
+#include <cstring>
+
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_READ_ONLY
+#define GL_READ_ONLY 0x88B8
+#endif
+
+using namespace yarp::os;
+using namespace yarp::sig;
+
+PixelReadback::PixelReadback() : buffers(2), loaded(false), supported(false),
+    genBuffers(NULL), deleteBuffers(NULL), bindBuffer(NULL), bufferData(NULL),
+    mapBuffer(NULL), unmapBuffer(NULL) {
+}
+
+void PixelReadback::setBuffers(int n) {
+    buffers = (n > 0) ? n : 0;
+}
+
+bool PixelReadback::load() {
+    loaded = true;
+
+    // pixel buffer objects are core since OpenGL 2.1, before it they may be there as an extension
+    int major = 0, minor = 0;
+    const char *version = (const char *)glGetString(GL_VERSION);
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    if (version) {
+        sscanf(version, "%d.%d", &major, &minor);
+    }
+    bool core = (major > 2) || ((major == 2) && (minor >= 1));
+    bool arb = (extensions != NULL) && (strstr(extensions, "GL_ARB_pixel_buffer_object") != NULL);
+    if (!core && !arb) {
+        yWarning("pixel buffer objects are not supported (OpenGL %s), the camera images are read synchronously\n",
+                 version ? version : "unknown");
+        return false;
+    }
+
+    const char *suffix = core ? "" : "ARB";
+    char name[64];
+#define PIXELREADBACK_LOAD(fn, type, gl) \
+    snprintf(name, sizeof(name), "%s%s", gl, suffix); \
+    fn = (type)SDL_GL_GetProcAddress(name);
+    PIXELREADBACK_LOAD(genBuffers, GenBuffersFn, "glGenBuffers")
+    PIXELREADBACK_LOAD(deleteBuffers, DeleteBuffersFn, "glDeleteBuffers")
+    PIXELREADBACK_LOAD(bindBuffer, BindBufferFn, "glBindBuffer")
+    PIXELREADBACK_LOAD(bufferData, BufferDataFn, "glBufferData")
+    PIXELREADBACK_LOAD(mapBuffer, MapBufferFn, "glMapBuffer")
+    PIXELREADBACK_LOAD(unmapBuffer, UnmapBufferFn, "glUnmapBuffer")
+#undef PIXELREADBACK_LOAD
+
+    if (!genBuffers || !deleteBuffers || !bindBuffer || !bufferData || !mapBuffer || !unmapBuffer) {
+        yWarning("cannot load the pixel buffer object functions, the camera images are read synchronously\n");
+        return false;
+    }
+    return true;
+}
+
+void PixelReadback::reset(View &v, int w, int h) {
+    if (!v.pbo.empty()) {
+        deleteBuffers((GLsizei)v.pbo.size(), v.pbo.data());
+    }
+    v.pbo.assign(buffers, 0);
+    v.stamps.assign(buffers, Stamp());
+    v.w = w;
+    v.h = h;
+    v.next = 0;
+    v.pending = 0;
+
+    genBuffers((GLsizei)buffers, v.pbo.data());
+    for (int i=0; i<buffers; i++) {
+        bindBuffer(GL_PIXEL_PACK_BUFFER, v.pbo[i]);
+        bufferData(GL_PIXEL_PACK_BUFFER, (std::ptrdiff_t)w*h*3, NULL, GL_STREAM_READ);
+    }
+    bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void PixelReadback::flip(const unsigned char *pixels, int w, int h, ImageOf<PixelRgb>& target) {
+    // OpenGL has the origin in the bottom left corner, thus the rows are read bottom up
+    target.resize(w, h);
+    size_t row = (size_t)w*3;
+    for (int y=0; y<h; y++) {
+        memcpy(target.getRow(y), pixels + (size_t)(h-1-y)*row, row);
+    }
+}
+
+void PixelReadback::readNow(int w, int h, ImageOf<PixelRgb>& target) {
+    pixels.resize((size_t)w*h*3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+    flip(pixels.data(), w, h, target);
+}
+
+bool PixelReadback::read(int view, int w, int h, Stamp& stamp, ImageOf<PixelRgb>& target) {
+    if (!loaded && (buffers > 0)) {
+        supported = load();
+    }
+    if ((buffers == 0) || !supported) {
+        readNow(w, h, target);
+        return true;
+    }
+
+    if (view >= (int)views.size()) {
+        views.resize(view+1);
+    }
+    View &v = views[view];
+    if (((int)v.pbo.size() != buffers) || (v.w != w) || (v.h != h)) {
+        reset(v, w, h);
+    }
+
+    // start reading the view into the next buffer, the call returns as soon as the read is queued
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    bindBuffer(GL_PIXEL_PACK_BUFFER, v.pbo[v.next]);
+    glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+    v.stamps[v.next] = stamp;
+    v.next = (v.next+1) % buffers;
+    if (v.pending < buffers) {
+        v.pending++;
+    }
+
+    // the oldest read, i.e. the buffer of the next one, has most likely been completed meanwhile
+    bool ok = false;
+    if (v.pending == buffers) {
+        bindBuffer(GL_PIXEL_PACK_BUFFER, v.pbo[v.next]);
+        const unsigned char *data = (const unsigned char *)mapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (data) {
+            flip(data, w, h, target);
+            unmapBuffer(GL_PIXEL_PACK_BUFFER);
+            stamp = v.stamps[v.next];
+            ok = true;
+        }
+    }
+    bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return ok;
+}
+
+void PixelReadback::release() {
+    for (size_t i=0; i<views.size(); i++) {
+        if (!views[i].pbo.empty()) {
+            deleteBuffers((GLsizei)views[i].pbo.size(), views[i].pbo.data());
+        }
+    }
+    views.clear();
+}
@@ -0,0 +1,110 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+ * Copyright (C) 2023 iCub Facility - Istituto Italiano di Tecnologia
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+/**
+ * \file PixelReadback.h
+ * \brief Reading of the rendered camera views back into images. Each camera
+ * view is read into a ring of pixel buffer objects, so that the rendering goes
+ * on while the GPU transfers the pixels, and the image is taken from the
+ * oldest buffer of the ring, i.e. with a latency of (buffers-1) views.
+ **/
+
+#ifndef ICUBSIMULATION_PIXELREADBACK_INC
+#define ICUBSIMULATION_PIXELREADBACK_INC
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+#include <yarp/os/Stamp.h>
+#include <yarp/sig/Image.h>
+#include <cstddef>
+#include <vector>
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+class PixelReadback {
+public:
+    PixelReadback();
+
+    /**
+     * Set the number of pixel buffer objects of each view: 0 reads the pixels
+     * synchronously with glReadPixels (as does also the lack of support for
+     * pixel buffer objects), 1 reads them through a buffer object without
+     * latency, n>1 with a latency of n-1 views.
+     */
+    void setBuffers(int n);
+    int getBuffers() const { return buffers; }
+
+    /**
+     * Start reading the w x h pixels rendered for a view, and store in target
+     * the oldest image of the view whose reading is complete.
+     * @param view index of the view (e.g. the camera)
+     * @param stamp the stamp of the pixels just rendered, replaced by the one
+     *        of target
+     * @return false if no image of the view is available yet
+     */
+    bool read(int view, int w, int h, yarp::os::Stamp& stamp,
+              yarp::sig::ImageOf<yarp::sig::PixelRgb>& target);
+
+    /**
+     * Read the w x h pixels just rendered into target, waiting for the
+     * rendering to complete.
+     */
+    void readNow(int w, int h, yarp::sig::ImageOf<yarp::sig::PixelRgb>& target);
+
+    /**
+     * Delete the buffer objects; it has to be called with the OpenGL context
+     * of the reads still current.
+     */
+    void release();
+
+private:
+    typedef void (APIENTRY *GenBuffersFn)(GLsizei, GLuint *);
+    typedef void (APIENTRY *DeleteBuffersFn)(GLsizei, const GLuint *);
+    typedef void (APIENTRY *BindBufferFn)(GLenum, GLuint);
+    typedef void (APIENTRY *BufferDataFn)(GLenum, std::ptrdiff_t, const void *, GLenum);
+    typedef void *(APIENTRY *MapBufferFn)(GLenum, GLenum);
+    typedef GLboolean (APIENTRY *UnmapBufferFn)(GLenum);
+
+    struct View {
+        std::vector<GLuint> pbo;
+        std::vector<yarp::os::Stamp> stamps;
+        int w, h;
+        int next;       // buffer of the next read
+        int pending;    // buffers holding a read
+    };
+
+    bool load();
+    void reset(View &v, int w, int h);
+    static void flip(const unsigned char *pixels, int w, int h,
+                     yarp::sig::ImageOf<yarp::sig::PixelRgb>& target);
+
+    int buffers;
+    bool loaded, supported;
+    std::vector<View> views;
+    std::vector<unsigned char> pixels;
+
+    GenBuffersFn genBuffers;
+    DeleteBuffersFn deleteBuffers;
+    BindBufferFn bindBuffer;
+    BufferDataFn bufferData;
+    MapBufferFn mapBuffer;
+    UnmapBufferFn unmapBuffer;
+};
+
+#endif
@@ -38,6 +38,7 @@
 #include <sstream>
 
 #include "iCub.h"
+#include "OdeInit.h"
 #include "EyeLidsController.h"
 
 #include "MS3D.h"
@@ -314,6 +315,7 @@ void ICubSim::setJointControlAction() {
 }
 
 void ICubSim::draw(){
+    const OdeStateBuffer &state = OdeInit::get().stateBuffer;
     if (reinitialized)
     {
         glFinish();
@@ -335,12 +337,12 @@ void ICubSim::draw(){
     {
         glColor3d(1.0,1.0,1.0);
         glPushMatrix(); //opengl: glPushMatrix pushes the current matrix stack down by one, duplicating the current matrix. That is, after a glPushMatrix call, the matrix on top of the stack is identical to the one below it.
-        LDEsetM(dGeomGetPosition(screenGeom),dGeomGetRotation(screenGeom)); //this makes a homo transformation matrix out of the pos and ori and multiplies the opengl "current" matrix with it and sets the current matrix to the new one
+        LDEsetM(state.geomPosition(screenGeom),state.geomRotation(screenGeom)); //this makes a homo transformation matrix out of the pos and ori and multiplies the opengl "current" matrix with it and sets the current matrix to the new one
         DrawBox(1.0,1.0,0.001,false,textured,15);glPopMatrix();
     }
 
     //glColor3d(1.0,0.0,1.0);
-    //glPushMatrix();LDEsetM(dGeomGetPosition(geom_cube[0]),dGeomGetRotation(geom_cube[0]));DrawBox(0.1,2.005,0.1,false,false,0);glPopMatrix();
+    //glPushMatrix();LDEsetM(state.geomPosition(geom_cube[0]),state.geomRotation(geom_cube[0]));DrawBox(0.1,2.005,0.1,false,false,0);glPopMatrix();
 
     if (actLegs == "off"){
         glColor3d(1.0,1.0,1.0);
@@ -349,64 +351,64 @@ void ICubSim::draw(){
             glPushMatrix();
             if (actCoversCol == "on"){ //in this case, the covers are placeable geoms initialized in initCovers() - we can retrieve their coordinates
                 //left leg
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["leftFoot"].geom),dGeomGetRotation(model_ThreeD_obj["leftFoot"].geom));    
+                LDEsetM(state.geomPosition(model_ThreeD_obj["leftFoot"].geom),state.geomRotation(model_ThreeD_obj["leftFoot"].geom));    
                 DrawX( model_trimesh["leftFoot"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["lowerLeftLeg"].geom),dGeomGetRotation(model_ThreeD_obj["lowerLeftLeg"].geom));    
+                LDEsetM(state.geomPosition(model_ThreeD_obj["lowerLeftLeg"].geom),state.geomRotation(model_ThreeD_obj["lowerLeftLeg"].geom));    
                 DrawX( model_trimesh["lowerLeftLeg"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["upperLeftLeg"].geom),dGeomGetRotation(model_ThreeD_obj["upperLeftLeg"].geom));    
+                LDEsetM(state.geomPosition(model_ThreeD_obj["upperLeftLeg"].geom),state.geomRotation(model_ThreeD_obj["upperLeftLeg"].geom));    
                 DrawX( model_trimesh["upperLeftLeg"], modelTexture[0]);
                 glPopMatrix();
 
                 //right leg
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["rightFoot"].geom),dGeomGetRotation(model_ThreeD_obj["rightFoot"].geom));   
+                LDEsetM(state.geomPosition(model_ThreeD_obj["rightFoot"].geom),state.geomRotation(model_ThreeD_obj["rightFoot"].geom));   
                 DrawX( model_trimesh["rightFoot"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["lowerRightLeg"].geom),dGeomGetRotation(model_ThreeD_obj["lowerRightLeg"].geom));   
+                LDEsetM(state.geomPosition(model_ThreeD_obj["lowerRightLeg"].geom),state.geomRotation(model_ThreeD_obj["lowerRightLeg"].geom));   
                 DrawX( model_trimesh["lowerRightLeg"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["upperRightLeg"].geom),dGeomGetRotation(model_ThreeD_obj["upperRightLeg"].geom));     
+                LDEsetM(state.geomPosition(model_ThreeD_obj["upperRightLeg"].geom),state.geomRotation(model_ThreeD_obj["upperRightLeg"].geom));     
                 DrawX( model_trimesh["upperRightLeg"], modelTexture[0]);
                 glPopMatrix();
             } else { // covers are not placeable geoms but only "eye-candy" - coordinates need to be retrieved from other geoms
                 //left leg
-                LDEsetM(dGeomGetPosition(l_leg1_geom),dGeomGetRotation(l_leg1_geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(l_leg1_geom),state.geomRotation(l_leg1_geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["leftFoot"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(l_leg3_geom),dGeomGetRotation(l_leg3_geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(l_leg3_geom),state.geomRotation(l_leg3_geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["lowerLeftLeg"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(l_leg6_geom),dGeomGetRotation(l_leg5_geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(l_leg6_geom),state.geomRotation(l_leg5_geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["upperLeftLeg"], modelTexture[0]);
                 glPopMatrix();
 
                 //right leg
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(r_leg1_geom),dGeomGetRotation(r_leg1_geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(r_leg1_geom),state.geomRotation(r_leg1_geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["rightFoot"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(r_leg3_geom),dGeomGetRotation(r_leg3_geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(r_leg3_geom),state.geomRotation(r_leg3_geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["lowerRightLeg"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(r_leg6_geom),dGeomGetRotation(r_leg5_geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(r_leg6_geom),state.geomRotation(r_leg5_geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["upperRightLeg"], modelTexture[0]);
                 glPopMatrix();
            }
@@ -415,85 +417,85 @@ void ICubSim::draw(){
         // left leg
         if ((actSelfCol == "on") || (actCoversCol == "on")){ //the foot "box" is drawn - in this regime, we want to draw all objects that are relevant for the simulation
              glColor3d(0.9,0.9,0.9);
-             glPushMatrix();LDEsetM(dGeomGetPosition(l_leg0_geom),dGeomGetRotation(l_leg0_geom));
+             glPushMatrix();LDEsetM(state.geomPosition(l_leg0_geom),state.geomRotation(l_leg0_geom));
              DrawBox(0.054,0.004,0.13,false,textured,2);glPopMatrix();//Taken from ODE use Y, Z, X
         }
         else {
             if (actLegsCovers == "off") //if covers are off, the foot "box" is drawn; if they are on, it is not drawn as it is slightly longer and is visually not ideal
             {
                 glColor3d(0.9,0.9,0.9);
-                glPushMatrix();LDEsetM(dGeomGetPosition(l_leg0_geom),dGeomGetRotation(l_leg0_geom));
+                glPushMatrix();LDEsetM(state.geomPosition(l_leg0_geom),state.geomRotation(l_leg0_geom));
                 DrawBox(0.054,0.004,0.13,false,textured,2);glPopMatrix();//Taken from ODE use Y, Z, X
             }
         }
       
         //the rest is drawn irrespective whether covers are on
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(l_leg1_geom),dGeomGetRotation(l_leg1_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(l_leg1_geom),state.geomRotation(l_leg1_geom));
         DrawCylinder(0.027,0.095,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(l_leg2_geom),dGeomGetRotation(l_leg2_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(l_leg2_geom),state.geomRotation(l_leg2_geom));
         DrawCylinder(0.0245,0.063,false,textured,2);glPopMatrix();
 
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(l_leg3_geom),dGeomGetRotation(l_leg3_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(l_leg3_geom),state.geomRotation(l_leg3_geom));
         DrawCylinder(0.0315,fabs(jP_leftLeg[2][2]-jP_leftLeg[1][2]),false,textured,2);glPopMatrix();	
 
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(l_leg4_geom),dGeomGetRotation(l_leg4_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(l_leg4_geom),state.geomRotation(l_leg4_geom));
         DrawCylinder(0.0315,0.077,false,textured,2);glPopMatrix();
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(l_leg5_geom),dGeomGetRotation(l_leg5_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(l_leg5_geom),state.geomRotation(l_leg5_geom));
         DrawCylinder(0.034,0.224,false,textured,2);glPopMatrix();
 
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(l_leg6_geom),dGeomGetRotation(l_leg6_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(l_leg6_geom),state.geomRotation(l_leg6_geom));
         DrawCylinder(0.031,0.075,false,textured,2);glPopMatrix();
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(l_leg7_geom),dGeomGetRotation(l_leg7_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(l_leg7_geom),state.geomRotation(l_leg7_geom));
         DrawCylinder(0.038,0.013,false,textured,2);glPopMatrix();
 
        
         // right leg
         if ((actSelfCol == "on") || (actCoversCol == "on")){ //the foot "box" is drawn - in this regime, we want to draw all objects that are relevant for the simulation
              glColor3d(0.9,0.9,0.9);
-             glPushMatrix();LDEsetM(dGeomGetPosition(r_leg0_geom),dGeomGetRotation(r_leg0_geom));
+             glPushMatrix();LDEsetM(state.geomPosition(r_leg0_geom),state.geomRotation(r_leg0_geom));
              DrawBox(0.054,0.004,0.13,false,textured,2);glPopMatrix();//Taken from ODE use Y, Z, X
         }
         else {
             if (actLegsCovers == "off") //if covers are off, the foot "box" is drawn; if they are on, it is not drawn as it is slightly longer and is visually not ideal
             {
                 glColor3d(0.9,0.9,0.9);
-                glPushMatrix();LDEsetM(dGeomGetPosition(r_leg0_geom),dGeomGetRotation(r_leg0_geom));
+                glPushMatrix();LDEsetM(state.geomPosition(r_leg0_geom),state.geomRotation(r_leg0_geom));
                 DrawBox(0.054,0.004,0.13,false,textured,2);glPopMatrix();//Taken from ODE use Y, Z, X
             }
         }
         //the rest is drawn irrespective whether covers are on              
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(r_leg1_geom),dGeomGetRotation(r_leg1_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(r_leg1_geom),state.geomRotation(r_leg1_geom));
         DrawCylinder(0.027,0.095,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(r_leg2_geom),dGeomGetRotation(r_leg2_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(r_leg2_geom),state.geomRotation(r_leg2_geom));
         DrawCylinder(0.0245,0.063,false,textured,2);glPopMatrix();	
 
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(r_leg3_geom),dGeomGetRotation(r_leg3_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(r_leg3_geom),state.geomRotation(r_leg3_geom));
         DrawCylinder(0.0315,fabs(jP_rightLeg[2][2]-jP_rightLeg[1][2]),false,textured,2);glPopMatrix();
 
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(r_leg4_geom),dGeomGetRotation(r_leg4_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(r_leg4_geom),state.geomRotation(r_leg4_geom));
         DrawCylinder(0.0315,0.077,false,textured,2);glPopMatrix();	
 
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(r_leg5_geom),dGeomGetRotation(r_leg5_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(r_leg5_geom),state.geomRotation(r_leg5_geom));
         DrawCylinder(0.034,0.224,false,textured,2);glPopMatrix();
 
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(r_leg6_geom),dGeomGetRotation(r_leg6_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(r_leg6_geom),state.geomRotation(r_leg6_geom));
         DrawCylinder(0.031,0.075,false,textured,2);glPopMatrix();
 
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(r_leg7_geom),dGeomGetRotation(r_leg7_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(r_leg7_geom),state.geomRotation(r_leg7_geom));
         DrawCylinder(0.038,0.013,false,textured,2);glPopMatrix();
 
     }else{ //(actLegs == "on")
@@ -501,14 +503,14 @@ void ICubSim::draw(){
         // left leg
         if ((actSelfCol == "on") || (actCoversCol == "on")){ //the foot "box" is drawn - in this regime, we want to draw all objects that are relevant for the simulation
              glColor3d(1.0,1.0,1.0);
-             glPushMatrix();LDEsetM(dBodyGetPosition(leftLeg[0]),dBodyGetRotation(leftLeg[0]));
+             glPushMatrix();LDEsetM(state.bodyPosition(leftLeg[0]),state.bodyRotation(leftLeg[0]));
              DrawBox(0.054,0.004,0.13,false,textured,2);glPopMatrix();//Taken from ODE use Y, Z, X
         }
         else {
             if (actLegsCovers == "off") //if covers are off, the foot "box" is drawn; if they are on, it is not drawn as it is slightly longer and is visually not ideal
             {
                 glColor3d(1.0,1.0,1.0);
-                glPushMatrix();LDEsetM(dBodyGetPosition(leftLeg[0]),dBodyGetRotation(leftLeg[0]));
+                glPushMatrix();LDEsetM(state.bodyPosition(leftLeg[0]),state.bodyRotation(leftLeg[0]));
                 DrawBox(0.054,0.004,0.13,false,textured,2);glPopMatrix();//Taken from ODE use Y, Z, X
             }
         }      
@@ -519,66 +521,66 @@ void ICubSim::draw(){
             if (actCoversCol == "on"){ //in this case, the covers are placeable geoms initialized in initCovers() - we can retrieve their coordinates
                
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["leftFoot"].geom),dGeomGetRotation(model_ThreeD_obj["leftFoot"].geom));    
+                LDEsetM(state.geomPosition(model_ThreeD_obj["leftFoot"].geom),state.geomRotation(model_ThreeD_obj["leftFoot"].geom));    
                 DrawX( model_trimesh["leftFoot"], modelTexture[0]);
                 glPopMatrix();
                            
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["lowerLeftLeg"].geom),dGeomGetRotation(model_ThreeD_obj["lowerLeftLeg"].geom));    
+                LDEsetM(state.geomPosition(model_ThreeD_obj["lowerLeftLeg"].geom),state.geomRotation(model_ThreeD_obj["lowerLeftLeg"].geom));    
                 DrawX( model_trimesh["lowerLeftLeg"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["upperLeftLeg"].geom),dGeomGetRotation(model_ThreeD_obj["upperLeftLeg"].geom));    
+                LDEsetM(state.geomPosition(model_ThreeD_obj["upperLeftLeg"].geom),state.geomRotation(model_ThreeD_obj["upperLeftLeg"].geom));    
                 DrawX( model_trimesh["upperLeftLeg"], modelTexture[0]);
                 glPopMatrix();
 
                 //right leg
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["rightFoot"].geom),dGeomGetRotation(model_ThreeD_obj["rightFoot"].geom));  
+                LDEsetM(state.geomPosition(model_ThreeD_obj["rightFoot"].geom),state.geomRotation(model_ThreeD_obj["rightFoot"].geom));  
                 DrawX( model_trimesh["rightFoot"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["lowerRightLeg"].geom),dGeomGetRotation(model_ThreeD_obj["lowerRightLeg"].geom));   
+                LDEsetM(state.geomPosition(model_ThreeD_obj["lowerRightLeg"].geom),state.geomRotation(model_ThreeD_obj["lowerRightLeg"].geom));   
                 DrawX( model_trimesh["lowerRightLeg"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["upperRightLeg"].geom),dGeomGetRotation(model_ThreeD_obj["upperRightLeg"].geom));     
+                LDEsetM(state.geomPosition(model_ThreeD_obj["upperRightLeg"].geom),state.geomRotation(model_ThreeD_obj["upperRightLeg"].geom));     
                 DrawX( model_trimesh["upperRightLeg"], modelTexture[0]);
                 glPopMatrix();
             } else { // covers are not placeable geoms but only "eye-candy" - coordinates need to be retrieved from other geoms
               
                 glPushMatrix();
-                LDEsetM(dBodyGetPosition(leftLeg[1]),dBodyGetRotation(leftLeg[0]));     //DRAW THE MODEL
+                LDEsetM(state.bodyPosition(leftLeg[1]),state.bodyRotation(leftLeg[0]));     //DRAW THE MODEL
                 DrawX( model_trimesh["leftFoot"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(leftLeg_2_2),dGeomGetRotation(leftLeg_2_2));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(leftLeg_2_2),state.geomRotation(leftLeg_2_2));     //DRAW THE MODEL
                 DrawX( model_trimesh["lowerLeftLeg"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(leftLeg_4_2),dGeomGetRotation(leftLeg_3_2));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(leftLeg_4_2),state.geomRotation(leftLeg_3_2));     //DRAW THE MODEL
                 DrawX( model_trimesh["upperLeftLeg"], modelTexture[0]);
                 glPopMatrix();
                   
                 //right leg
                 glPushMatrix();
-                LDEsetM(dBodyGetPosition(rightLeg[1]),dBodyGetRotation(rightLeg[0]));     //DRAW THE MODEL
+                LDEsetM(state.bodyPosition(rightLeg[1]),state.bodyRotation(rightLeg[0]));     //DRAW THE MODEL
                 DrawX( model_trimesh["rightFoot"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(rightLeg_2_2),dGeomGetRotation(rightLeg_2_2));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(rightLeg_2_2),state.geomRotation(rightLeg_2_2));     //DRAW THE MODEL
                 //glTranslatef(0.0, 0.0,0.5*fabs(jP_leftArm[5][2] - jP_leftArm[4][2]));
                 DrawX( model_trimesh["lowerRightLeg"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(rightLeg_4_2),dGeomGetRotation(rightLeg_3_2));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(rightLeg_4_2),state.geomRotation(rightLeg_3_2));     //DRAW THE MODEL
                 //glTranslatef(0.0, 0.0,0.5*fabs(jP_leftArm[5][2] - jP_leftArm[4][2]));
                 DrawX( model_trimesh["upperRightLeg"], modelTexture[0]);
                 glPopMatrix();
@@ -586,71 +588,71 @@ void ICubSim::draw(){
         }
 
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dBodyGetPosition(leftLeg[1]),dBodyGetRotation(leftLeg[1]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(leftLeg[1]),state.bodyRotation(leftLeg[1]));
         DrawCylinder(0.027,0.095,false,textured,2);glPopMatrix();                                               //foot joint
         
-        glPushMatrix(); LDEsetM(dGeomGetPosition(leftLeg_2_1),dGeomGetRotation(leftLeg_2_1));
+        glPushMatrix(); LDEsetM(state.geomPosition(leftLeg_2_1),state.geomRotation(leftLeg_2_1));
         DrawCylinder(0.0245,0.063,false,textured,2);glPopMatrix();                                              //foot joint
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(leftLeg_2_2),dGeomGetRotation(leftLeg_2_2));
+        glPushMatrix(); LDEsetM(state.geomPosition(leftLeg_2_2),state.geomRotation(leftLeg_2_2));
         DrawCylinder(0.0315,fabs(jP_leftLeg[2][2]-jP_leftLeg[1][2]),false,textured,2);glPopMatrix();            //tibia
 
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(leftLeg_3_1),dGeomGetRotation(leftLeg_3_1));
+        glPushMatrix(); LDEsetM(state.geomPosition(leftLeg_3_1),state.geomRotation(leftLeg_3_1));
         DrawCylinder(0.0315,0.077,false,textured,2);glPopMatrix();	                                            //knee
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(leftLeg_3_2),dGeomGetRotation(leftLeg_3_2));
+        glPushMatrix(); LDEsetM(state.geomPosition(leftLeg_3_2),state.geomRotation(leftLeg_3_2));
         DrawCylinder(0.034,fabs(jP_leftLeg[3][2]-jP_leftLeg[2][2]),false,textured,2);glPopMatrix();             //thigh
 
-        //glPushMatrix(); LDEsetM(dGeomGetPosition(leftLeg_4_1),dGeomGetRotation(leftLeg_4_1));
+        //glPushMatrix(); LDEsetM(state.geomPosition(leftLeg_4_1),state.geomRotation(leftLeg_4_1));
         //DrawSphere(0.017,false,false);glPopMatrix();
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(leftLeg_4_2),dGeomGetRotation(leftLeg_4_2));
+        glPushMatrix(); LDEsetM(state.geomPosition(leftLeg_4_2),state.geomRotation(leftLeg_4_2));
         DrawCylinder(0.031,0.075,false,textured,2);glPopMatrix();
 
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dBodyGetPosition(leftLeg[5]),dBodyGetRotation(leftLeg[5]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(leftLeg[5]),state.bodyRotation(leftLeg[5]));
         DrawCylinder(0.038,0.013,false,textured,2);glPopMatrix();
        
         
         //right leg
         if ((actSelfCol == "on") || (actCoversCol == "on")){ //the foot "box" is drawn - in this regime, we want to draw all objects that are relevant for the simulation
              glColor3d(0.9,0.9,0.9);
-             glPushMatrix();LDEsetM(dBodyGetPosition(rightLeg[0]),dBodyGetRotation(rightLeg[0]));
+             glPushMatrix();LDEsetM(state.bodyPosition(rightLeg[0]),state.bodyRotation(rightLeg[0]));
              DrawBox(0.054,0.004,0.13,false,textured,2);glPopMatrix();//Taken from ODE use Y, Z, X
         }
         else {
             if (actLegsCovers == "off") //if covers are off, the foot "box" is drawn; if they are on, it is not drawn as it is slightly longer and is visually not ideal
             {
                 glColor3d(0.9,0.9,0.9);
-                glPushMatrix();LDEsetM(dBodyGetPosition(rightLeg[0]),dBodyGetRotation(rightLeg[0]));
+                glPushMatrix();LDEsetM(state.bodyPosition(rightLeg[0]),state.bodyRotation(rightLeg[0]));
                 DrawBox(0.054,0.004,0.13,false,textured,2);glPopMatrix();//Taken from ODE use Y, Z, X
             }
         }      
                   
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dBodyGetPosition(rightLeg[1]),dBodyGetRotation(rightLeg[1]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(rightLeg[1]),state.bodyRotation(rightLeg[1]));
         DrawCylinder(0.027,0.095,false,textured,2);glPopMatrix();
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rightLeg_2_1),dGeomGetRotation(rightLeg_2_1));
+        glPushMatrix(); LDEsetM(state.geomPosition(rightLeg_2_1),state.geomRotation(rightLeg_2_1));
         DrawCylinder(0.0245,0.063,false,textured,2);glPopMatrix();
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rightLeg_2_2),dGeomGetRotation(rightLeg_2_2));
+        glPushMatrix(); LDEsetM(state.geomPosition(rightLeg_2_2),state.geomRotation(rightLeg_2_2));
         DrawCylinder(0.0315,fabs(jP_rightLeg[2][2]-jP_rightLeg[1][2]),false,textured,2);glPopMatrix();
 
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rightLeg_3_1),dGeomGetRotation(rightLeg_3_1));
+        glPushMatrix(); LDEsetM(state.geomPosition(rightLeg_3_1),state.geomRotation(rightLeg_3_1));
         DrawCylinder(0.0315,0.077,false,textured,2);glPopMatrix();
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rightLeg_3_2),dGeomGetRotation(rightLeg_3_2));
+        glPushMatrix(); LDEsetM(state.geomPosition(rightLeg_3_2),state.geomRotation(rightLeg_3_2));
         DrawCylinder(0.034,fabs(jP_rightLeg[3][2]-jP_rightLeg[2][2]),false,textured,2);glPopMatrix();
-        //glPushMatrix(); LDEsetM(dGeomGetPosition(rightLeg_4_1),dGeomGetRotation(rightLeg_4_1));
+        //glPushMatrix(); LDEsetM(state.geomPosition(rightLeg_4_1),state.geomRotation(rightLeg_4_1));
         //DrawSphere(0.017,false,false);glPopMatrix();
 
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rightLeg_4_2),dGeomGetRotation(rightLeg_4_2));
+        glPushMatrix(); LDEsetM(state.geomPosition(rightLeg_4_2),state.geomRotation(rightLeg_4_2));
         DrawCylinder(0.031,0.075,false,textured,2);glPopMatrix();
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dBodyGetPosition(rightLeg[5]),dBodyGetRotation(rightLeg[5]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(rightLeg[5]),state.bodyRotation(rightLeg[5]));
         DrawCylinder(0.038,0.013,false,textured,2);glPopMatrix();
     }
     if (actTorso == "off"){
@@ -659,60 +661,60 @@ void ICubSim::draw(){
         {
             if (actCoversCol == "on"){ //in this case, the covers are placeable geoms initialized in initCovers() - we can retrieve their coordinates 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["waist"].geom),dGeomGetRotation(model_ThreeD_obj["waist"].geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(model_ThreeD_obj["waist"].geom),state.geomRotation(model_ThreeD_obj["waist"].geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["waist"], modelTexture[0]);
                 glPopMatrix();
             
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["torso"].geom),dGeomGetRotation(model_ThreeD_obj["torso"].geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(model_ThreeD_obj["torso"].geom),state.geomRotation(model_ThreeD_obj["torso"].geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["torso"], modelTexture[0]);
                 glPopMatrix();
             } else { // covers are not placeable geoms but only "eye-candy" - coordinates need to be retrieved from other geoms
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(torso1_geom),dGeomGetRotation(torso1_geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(torso1_geom),state.geomRotation(torso1_geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["waist"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
                 if (actHead == "on")
-                    LDEsetM(dBodyGetPosition(neck[0]),dGeomGetRotation(torso3_geom));     //DRAW THE MODEL
+                    LDEsetM(state.bodyPosition(neck[0]),state.geomRotation(torso3_geom));     //DRAW THE MODEL
                 else
-                    LDEsetM(dGeomGetPosition(neck0_geom),dGeomGetRotation(torso3_geom));
+                    LDEsetM(state.geomPosition(neck0_geom),state.geomRotation(torso3_geom));
 
                 DrawX( model_trimesh["torso"], modelTexture[0]);
                 glPopMatrix();
             }
         }
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(torso0_geom),dGeomGetRotation(torso0_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(torso0_geom),state.geomRotation(torso0_geom));
         DrawBox(0.0470,fabs((jP_torso[0][2]-0.031/*torso pitch cyl rad*/)-(jP_leftLeg[5][2]-0.031/*leg cyl rad*/)),0.064,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(torso1_geom),dGeomGetRotation(torso1_geom));
+        glPushMatrix();LDEsetM(state.geomPosition(torso1_geom),state.geomRotation(torso1_geom));
         //DrawBox(0.176,0.063,0.127,false,textured,2);glPopMatrix();
         DrawCylinder(0.031,fabs(jP_leftLeg[3][1]-jP_rightLeg[3][1]),false,textured,2);glPopMatrix();
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(torso2_geom),dGeomGetRotation(torso2_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(torso2_geom),state.geomRotation(torso2_geom));
         DrawCylinder(0.031,0.097,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(torso3_geom),dGeomGetRotation(torso3_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(torso3_geom),state.geomRotation(torso3_geom));
         DrawCylinder(0.04,0.0274,false,textured,2);glPopMatrix();
         glColor3d(1.0,1.0,1.0);
         
     
         if ((actSelfCol == "on") || (actCoversCol == "on")){ //the torso "boxes" are drawn - in this regime, we want to draw all objects that are relevant for the simulation
-            glPushMatrix();LDEsetM(dBodyGetPosition(torso[4]),dBodyGetRotation(torso[4]));
+            glPushMatrix();LDEsetM(state.bodyPosition(torso[4]),state.bodyRotation(torso[4]));
             DrawBox(fabs(jP_leftArm[1][1]-jP_torso[2][1])-0.011-0.5*0.059 /*clavicule height + half shoulder height*/,fabs((jP_head[0][2]-0.015/*head pitch cyl rad*/)-(jP_torso[2][2]+0.031+0.0274/*torso roll cyl rad + torso yaw cyl height*/))/*0.118*/,0.109,false,textured,2);glPopMatrix();
 
-            glPushMatrix();LDEsetM(dBodyGetPosition(torso[5]),dBodyGetRotation(torso[5]));
+            glPushMatrix();LDEsetM(state.bodyPosition(torso[5]),state.bodyRotation(torso[5]));
             DrawBox(fabs(jP_rightArm[1][1]-jP_torso[2][1])-0.011-0.5*0.059 /*clavicule height + half shoulder height*/,fabs((jP_head[0][2]-0.015/*head pitch cyl rad*/)-(jP_torso[2][2]+0.031+0.0274/*torso roll cyl rad + torso yaw cyl height*/))/*0.118*/,0.109,false,textured,2);glPopMatrix();
         }
         else {
             if (actTorsoCovers == "off") //if covers are off, the torso "boxes" are drawn; if they are on, they are not drawn as the cover visually fills up the space
             {
-                glPushMatrix();LDEsetM(dBodyGetPosition(torso[4]),dBodyGetRotation(torso[4]));
+                glPushMatrix();LDEsetM(state.bodyPosition(torso[4]),state.bodyRotation(torso[4]));
                 DrawBox(fabs(jP_leftArm[1][1]-jP_torso[2][1])-0.011-0.5*0.059 /*clavicule height + half shoulder height*/,fabs((jP_head[0][2]-0.015/*head pitch cyl rad*/)-(jP_torso[2][2]+0.031+0.0274/*torso roll cyl rad + torso yaw cyl height*/))/*0.118*/,0.109,false,textured,2);glPopMatrix();
 
-                glPushMatrix();LDEsetM(dBodyGetPosition(torso[5]),dBodyGetRotation(torso[5]));
+                glPushMatrix();LDEsetM(state.bodyPosition(torso[5]),state.bodyRotation(torso[5]));
                 DrawBox(fabs(jP_rightArm[1][1]-jP_torso[2][1])-0.011-0.5*0.059 /*clavicule height + half shoulder height*/,fabs((jP_head[0][2]-0.015/*head pitch cyl rad*/)-(jP_torso[2][2]+0.031+0.0274/*torso roll cyl rad + torso yaw cyl height*/))/*0.118*/,0.109,false,textured,2);glPopMatrix();
              }
         } 
@@ -726,25 +728,25 @@ void ICubSim::draw(){
         {
             if (actCoversCol == "on"){ //in this case, the covers are placeable geoms initialized in initCovers() - we can retrieve their coordinates 
                 glPushMatrix(); 
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["waist"].geom),dGeomGetRotation(model_ThreeD_obj["waist"].geom));  
+                LDEsetM(state.geomPosition(model_ThreeD_obj["waist"].geom),state.geomRotation(model_ThreeD_obj["waist"].geom));  
                 DrawX( model_trimesh["waist"], modelTexture[0]);
                 glPopMatrix(); //takes the current matrix back out
             
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["torso"].geom),dGeomGetRotation(model_ThreeD_obj["torso"].geom));    
+                LDEsetM(state.geomPosition(model_ThreeD_obj["torso"].geom),state.geomRotation(model_ThreeD_obj["torso"].geom));    
                 DrawX( model_trimesh["torso"], modelTexture[0]);
                 glPopMatrix();
              } else { // covers are not placeable geoms but only "eye-candy" - coordinates need to be retrieved from other geoms
                 glPushMatrix();
-                LDEsetM(dBodyGetPosition(torso[1]),dBodyGetRotation(torso[0]));     //DRAW THE MODEL
+                LDEsetM(state.bodyPosition(torso[1]),state.bodyRotation(torso[0]));     //DRAW THE MODEL
                 DrawX( model_trimesh["waist"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
                 if (actHead == "on")
-                    LDEsetM(dBodyGetPosition(neck[0]),dBodyGetRotation(torso[3]));     //DRAW THE MODEL
+                    LDEsetM(state.bodyPosition(neck[0]),state.bodyRotation(torso[3]));     //DRAW THE MODEL
                 else
-                    LDEsetM(dGeomGetPosition(neck0_geom),dBodyGetRotation(torso[3]));
+                    LDEsetM(state.geomPosition(neck0_geom),state.bodyRotation(torso[3]));
 
                 DrawX( model_trimesh["torso"], modelTexture[0]);
                 glPopMatrix();
@@ -753,26 +755,26 @@ void ICubSim::draw(){
         }
         //////TORSO
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix();LDEsetM(dBodyGetPosition(torso[0]),dBodyGetRotation(torso[0]));
+        glPushMatrix();LDEsetM(state.bodyPosition(torso[0]),state.bodyRotation(torso[0]));
         DrawBox(0.0470,fabs((jP_torso[0][2]-0.031/*torso pitch cyl rad*/)-(jP_leftLeg[5][2]-0.031/*leg cyl rad*/)),0.064,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dBodyGetPosition(torso[1]),dBodyGetRotation(torso[1]));
+        glPushMatrix();LDEsetM(state.bodyPosition(torso[1]),state.bodyRotation(torso[1]));
         //DrawBox(0.176,0.063,0.127,false,textured,2);glPopMatrix();
         DrawCylinder(0.031,fabs(jP_leftLeg[3][1]-jP_rightLeg[3][1]),false,textured,2);glPopMatrix();
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dBodyGetPosition(torso[2]),dBodyGetRotation(torso[2]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(torso[2]),state.bodyRotation(torso[2]));
         DrawCylinder(0.031,0.097,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(torso[3]),dBodyGetRotation(torso[3]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(torso[3]),state.bodyRotation(torso[3]));
         DrawCylinder(0.04,0.0274,false,textured,2);glPopMatrix();
         glColor3d(1.0,1.0,1.0);
 
         if ((actSelfCol == "on") || (actCoversCol == "on")){ //the torso "boxes" are drawn - in this regime, we want to draw all objects that are relevant for the simulation
-              glPushMatrix();LDEsetM(dBodyGetPosition(torso[4]),dBodyGetRotation(torso[4]));
+              glPushMatrix();LDEsetM(state.bodyPosition(torso[4]),state.bodyRotation(torso[4]));
               DrawBox(fabs(jP_leftArm[1][1]-jP_torso[2][1])-0.011-0.5*0.059 /*clavicule height + half shoulder height*/,fabs((jP_head[0][2]-0.015/*head pitch cyl rad*/)-(jP_torso[2][2]+0.031+0.0274/*torso roll cyl rad + torso yaw cyl height*/))/*0.118*/,0.109,false,textured,2);
               glPopMatrix();
 
-              glPushMatrix();LDEsetM(dBodyGetPosition(torso[5]),dBodyGetRotation(torso[5]));
+              glPushMatrix();LDEsetM(state.bodyPosition(torso[5]),state.bodyRotation(torso[5]));
               DrawBox(fabs(jP_rightArm[1][1]-jP_torso[2][1])-0.011-0.5*0.059/*clavicule height + half shoulder height*/,fabs((jP_head[0][2]-0.015/*head pitch cyl rad*/)-(jP_torso[2][2]+0.031+0.0274/*torso roll cyl rad + torso yaw cyl height*/))/*0.118*/,0.109,false,textured,2);
               glPopMatrix();
              
@@ -780,11 +782,11 @@ void ICubSim::draw(){
         else {
             if (actTorsoCovers == "off") //if covers are off, the torso "boxes" are drawn; if they are on, they are not drawn as the cover visually fills up the space
             {
-                glPushMatrix();LDEsetM(dBodyGetPosition(torso[4]),dBodyGetRotation(torso[4]));
+                glPushMatrix();LDEsetM(state.bodyPosition(torso[4]),state.bodyRotation(torso[4]));
                 DrawBox(fabs(jP_leftArm[1][1]-jP_torso[2][1])-0.011-0.5*0.059 /*clavicule height + half shoulder height*/,fabs((jP_head[0][2]-0.015/*head pitch cyl rad*/)-(jP_torso[2][2]+0.031+0.0274/*torso roll cyl rad + torso yaw cyl height*/))/*0.118*/,0.109,false,textured,2);
                 glPopMatrix();
 
-                glPushMatrix();LDEsetM(dBodyGetPosition(torso[5]),dBodyGetRotation(torso[5]));
+                glPushMatrix();LDEsetM(state.bodyPosition(torso[5]),state.bodyRotation(torso[5]));
                 DrawBox(fabs(jP_rightArm[1][1]-jP_torso[2][1])-0.011-0.5*0.059/*clavicule height + half shoulder height*/,fabs((jP_head[0][2]-0.015/*head pitch cyl rad*/)-(jP_torso[2][2]+0.031+0.0274/*torso roll cyl rad + torso yaw cyl height*/))/*0.118*/,0.109,false,textured,2);
                 glPopMatrix();
                 
@@ -798,40 +800,40 @@ void ICubSim::draw(){
         {
             if (actCoversCol == "on"){ //in this case, the covers are placeable geoms initialized in initCovers() - we can retrieve their coordinates 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["upperLeftArm"].geom),dGeomGetRotation(model_ThreeD_obj["upperLeftArm"].geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(model_ThreeD_obj["upperLeftArm"].geom),state.geomRotation(model_ThreeD_obj["upperLeftArm"].geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["upperLeftArm"], modelTexture[0]);
                 glPopMatrix();
             
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["lowerLeftArm"].geom),dGeomGetRotation(model_ThreeD_obj["lowerLeftArm"].geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(model_ThreeD_obj["lowerLeftArm"].geom),state.geomRotation(model_ThreeD_obj["lowerLeftArm"].geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["lowerLeftArm"], modelTexture[0]);
                 glPopMatrix();
             } else { // covers are not placeable geoms but only "eye-candy" - coordinates need to be retrieved from other geoms
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(larm2_geom),dGeomGetRotation(larm2_geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(larm2_geom),state.geomRotation(larm2_geom));     //DRAW THE MODEL
                 glTranslatef(0.0, 0.0,0.5*fabs(jP_leftArm[4][2] - jP_leftArm[2][2]));
                 DrawX( model_trimesh["upperLeftArm"], modelTexture[0]);
                 glPopMatrix();
 
                 //draw texture
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(larm3_geom),dGeomGetRotation(larm3_geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(larm3_geom),state.geomRotation(larm3_geom));     //DRAW THE MODEL
                 glTranslatef(0.0, 0.0,0.5*fabs(jP_leftArm[5][2] - jP_leftArm[3][2])); 
                 DrawX( model_trimesh["lowerLeftArm"], modelTexture[0]);
                 glPopMatrix();
             }
        }
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(larm0_geom),dGeomGetRotation(larm0_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(larm0_geom),state.geomRotation(larm0_geom));
         DrawCylinder(0.031,0.011,false,textured,2);glPopMatrix();
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(larm1_geom),dGeomGetRotation(larm1_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(larm1_geom),state.geomRotation(larm1_geom));
         DrawCylinder(0.03,0.059,false,textured,2);glPopMatrix();
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(larm2_geom),dGeomGetRotation(larm2_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(larm2_geom),state.geomRotation(larm2_geom));
         DrawCylinder(0.026 ,fabs(jP_leftArm[4][2]-jP_leftArm[2][2]),false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(larm3_geom),dGeomGetRotation(larm3_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(larm3_geom),state.geomRotation(larm3_geom));
         DrawCylinder(0.02 ,fabs(jP_leftArm[5][2]-jP_leftArm[3][2]),false,textured,2);glPopMatrix();
 
     }else{
@@ -841,23 +843,23 @@ void ICubSim::draw(){
         {
             if (actCoversCol == "on"){ //in this case, the covers are placeable geoms initialized in initCovers() - we can retrieve their coordinates 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["upperLeftArm"].geom),dGeomGetRotation(model_ThreeD_obj["upperLeftArm"].geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(model_ThreeD_obj["upperLeftArm"].geom),state.geomRotation(model_ThreeD_obj["upperLeftArm"].geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["upperLeftArm"], modelTexture[0]);
                 glPopMatrix();
             
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["lowerLeftArm"].geom),dGeomGetRotation(model_ThreeD_obj["lowerLeftArm"].geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(model_ThreeD_obj["lowerLeftArm"].geom),state.geomRotation(model_ThreeD_obj["lowerLeftArm"].geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["lowerLeftArm"], modelTexture[0]);
                 glPopMatrix();
              } else { // covers are not placeable geoms but only "eye-candy" - coordinates need to be retrieved from other geoms
                 glPushMatrix();
-                LDEsetM(dBodyGetPosition(body[6]),dBodyGetRotation(body[4]));     //DRAW THE MODEL
+                LDEsetM(state.bodyPosition(body[6]),state.bodyRotation(body[4]));     //DRAW THE MODEL
                 DrawX( model_trimesh["upperLeftArm"], modelTexture[0]);
                 glPopMatrix();
 
                 //draw texture
                 glPushMatrix();
-                LDEsetM(dBodyGetPosition(body[8]),dBodyGetRotation(body[8]));     //DRAW THE MODEL
+                LDEsetM(state.bodyPosition(body[8]),state.bodyRotation(body[8]));     //DRAW THE MODEL
                 glTranslatef(0.0, 0.0,0.5*fabs(jP_leftArm[5][2] - jP_leftArm[3][2])); //for consinstency with initLeftArm
                 //glTranslatef(0.0, 0.0,0.5*fabs(jP_leftArm[5][2] - jP_leftArm[4][2]));
                 DrawX( model_trimesh["lowerLeftArm"], modelTexture[0]);
@@ -866,21 +868,21 @@ void ICubSim::draw(){
         }
 
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[0]),dBodyGetRotation(body[0]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[0]),state.bodyRotation(body[0]));
         DrawCylinder(0.031,0.011,false,textured,2);glPopMatrix();
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[2]),dBodyGetRotation(body[2]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[2]),state.bodyRotation(body[2]));
         DrawCylinder(0.03,0.059,false,textured,2);glPopMatrix();
         glColor3d(1.0,1.0,1.0); 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[4]),dBodyGetRotation(body[4]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[4]),state.bodyRotation(body[4]));
         DrawCylinder(0.026 ,fabs(jP_leftArm[4][2]-jP_leftArm[2][2]),false,textured,2);
         glPopMatrix();
 
         //glColor3d(1.0,1.0,0.0);
-        //glPushMatrix(); LDEsetM(dBodyGetPosition(body[6]),dBodyGetRotation(body[6]));
+        //glPushMatrix(); LDEsetM(state.bodyPosition(body[6]),state.bodyRotation(body[6]));
         //DrawSphere(0.01,false,false,0);glPopMatrix();
         glColor4d(1.0,1.0,1.0,0.5);
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[8]),dBodyGetRotation(body[8]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[8]),state.bodyRotation(body[8]));
         DrawCylinder(0.02 ,fabs(jP_leftArm[5][2]-jP_leftArm[3][2]),false,textured,2);
         glPopMatrix();
 
@@ -891,40 +893,40 @@ void ICubSim::draw(){
         {
              if (actCoversCol == "on"){ //in this case, the covers are placeable geoms initialized in initCovers() - we can retrieve their coordinates 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["upperRightArm"].geom),dGeomGetRotation(model_ThreeD_obj["upperRightArm"].geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(model_ThreeD_obj["upperRightArm"].geom),state.geomRotation(model_ThreeD_obj["upperRightArm"].geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["upperRightArm"], modelTexture[0]);
                 glPopMatrix();
             
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["lowerRightArm"].geom),dGeomGetRotation(model_ThreeD_obj["lowerRightArm"].geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(model_ThreeD_obj["lowerRightArm"].geom),state.geomRotation(model_ThreeD_obj["lowerRightArm"].geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["lowerRightArm"], modelTexture[0]);
                 glPopMatrix();
              } else { // covers are not placeable geoms but only "eye-candy" - coordinates need to be retrieved from other geoms
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(rarm2_geom),dGeomGetRotation(rarm2_geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(rarm2_geom),state.geomRotation(rarm2_geom));     //DRAW THE MODEL
                 glTranslatef(0.0, 0.0,0.5*fabs(jP_rightArm[4][2] - jP_rightArm[2][2]));  //Matej fix
                 DrawX( model_trimesh["upperRightArm"], modelTexture[0]);
                 glPopMatrix();
 
                 //draw texture
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(rarm3_geom),dGeomGetRotation(rarm3_geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(rarm3_geom),state.geomRotation(rarm3_geom));     //DRAW THE MODEL
                 glTranslatef(0.0, 0.0,0.5*fabs(jP_rightArm[5][2] - jP_rightArm[3][2])); //Matej fix
                 DrawX( model_trimesh["lowerRightArm"], modelTexture[0]); //Matej fix
                 glPopMatrix();
              }
         }
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rarm0_geom),dGeomGetRotation(rarm0_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(rarm0_geom),state.geomRotation(rarm0_geom));
         DrawCylinder(0.031,0.011,false,textured,2);glPopMatrix();
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rarm1_geom),dGeomGetRotation(rarm1_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(rarm1_geom),state.geomRotation(rarm1_geom));
         DrawCylinder(0.03,0.059,false,textured,2);glPopMatrix();
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rarm2_geom),dGeomGetRotation(rarm2_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(rarm2_geom),state.geomRotation(rarm2_geom));
         DrawCylinder(0.026 ,fabs(jP_rightArm[4][2]-jP_rightArm[2][2]),false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rarm3_geom),dGeomGetRotation(rarm3_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(rarm3_geom),state.geomRotation(rarm3_geom));
         DrawCylinder(0.02 ,fabs(jP_rightArm[5][2]-jP_rightArm[3][2]),false,textured,2);glPopMatrix();
 
     }else{
@@ -933,43 +935,43 @@ void ICubSim::draw(){
         {
              if (actCoversCol == "on"){ //in this case, the covers are placeable geoms initialized in initCovers() - we can retrieve their coordinates 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["upperRightArm"].geom),dGeomGetRotation(model_ThreeD_obj["upperRightArm"].geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(model_ThreeD_obj["upperRightArm"].geom),state.geomRotation(model_ThreeD_obj["upperRightArm"].geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["upperRightArm"], modelTexture[0]);
                 glPopMatrix();
             
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["lowerRightArm"].geom),dGeomGetRotation(model_ThreeD_obj["lowerRightArm"].geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(model_ThreeD_obj["lowerRightArm"].geom),state.geomRotation(model_ThreeD_obj["lowerRightArm"].geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["lowerRightArm"], modelTexture[0]);
                 glPopMatrix();
              } else { // covers are not placeable geoms but only "eye-candy" - coordinates need to be retrieved from other geoms
                 glPushMatrix();
-                LDEsetM(dBodyGetPosition(body[7]),dBodyGetRotation(body[5]));     //DRAW THE MODEL
+                LDEsetM(state.bodyPosition(body[7]),state.bodyRotation(body[5]));     //DRAW THE MODEL
                 //glTranslatef(0.0, 0.0,0.5*fabs(jP_rightArm[4][2] - jP_rightArm[2][2]));
                 DrawX( model_trimesh["upperRightArm"], modelTexture[0]);
                 glPopMatrix();
 
                 glPushMatrix();
-                LDEsetM(dBodyGetPosition(body[9]),dBodyGetRotation(body[9]));     //DRAW THE MODEL
+                LDEsetM(state.bodyPosition(body[9]),state.bodyRotation(body[9]));     //DRAW THE MODEL
                 glTranslatef(0.0, 0.0,0.5*fabs(jP_rightArm[5][2] - jP_rightArm[3][2])); //Matej fix
                 DrawX( model_trimesh["lowerRightArm"], modelTexture[0]);
                 glPopMatrix();
              }    
         }
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[1]),dBodyGetRotation(body[1]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[1]),state.bodyRotation(body[1]));
         DrawCylinder(0.031,0.011,false,textured,2);glPopMatrix();
         glColor3d(0.5,0.5,0.5);
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[3]),dBodyGetRotation(body[3]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[3]),state.bodyRotation(body[3]));
         DrawCylinder(0.03,0.059,false,textured,2);glPopMatrix();
 
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[5]),dBodyGetRotation(body[5]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[5]),state.bodyRotation(body[5]));
         DrawCylinder(0.026 ,fabs(jP_rightArm[4][2]-jP_rightArm[2][2]),false,textured,2);glPopMatrix();
 
-        //glPushMatrix(); LDEsetM(dBodyGetPosition(body[7]),dBodyGetRotation(body[7]));
+        //glPushMatrix(); LDEsetM(state.bodyPosition(body[7]),state.bodyRotation(body[7]));
         //DrawSphere(0.01,false,false);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[9]),dBodyGetRotation(body[9]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[9]),state.bodyRotation(body[9]));
         DrawCylinder(0.02 ,fabs(jP_rightArm[5][2]-jP_rightArm[3][2]),false,textured,2);glPopMatrix();
         
     }
@@ -979,12 +981,12 @@ void ICubSim::draw(){
         if (actLeftArmCovers == "on"){
             if (actCoversCol == "on"){ //in this case, the covers are placeable geoms initialized in initCovers() - we can retrieve their coordinates 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["leftPalm"].geom),dGeomGetRotation(model_ThreeD_obj["leftPalm"].geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(model_ThreeD_obj["leftPalm"].geom),state.geomRotation(model_ThreeD_obj["leftPalm"].geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["leftPalm"], modelTexture[0]);
                 glPopMatrix();
             }  else  { // covers are not placeable geoms but only "eye-candy" - coordinates need to be retrieved from other geoms
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(l_hand0_geom),dGeomGetRotation(l_hand0_geom));  
+                LDEsetM(state.geomPosition(l_hand0_geom),state.geomRotation(l_hand0_geom));  
                 glTranslatef(0.0, 0.5*fabs(jP_leftArm[7][2] - jP_leftArm[6][2]), 0.0); 
                 DrawX( model_trimesh["leftPalm"], modelTexture[0]);
                 glPopMatrix();
@@ -992,40 +994,40 @@ void ICubSim::draw(){
         }
        
         if ((actSelfCol == "on") || (actCoversCol == "on")){ //the palm "box" is drawn - in this regime, we want to draw all objects that are relevant for the simulation
-              glPushMatrix();LDEsetM(dGeomGetPosition(l_hand0_geom),dGeomGetRotation(l_hand0_geom));
+              glPushMatrix();LDEsetM(state.geomPosition(l_hand0_geom),state.geomRotation(l_hand0_geom));
               DrawBox(0.022,0.069,0.065,false,textured,2);glPopMatrix();
         } else {
             if (actLeftArmCovers == "off") //if covers are off, the palm "box" is drawn; if they are on, it is not drawn as the cover visually fills up the space
             {
-              glPushMatrix();LDEsetM(dGeomGetPosition(l_hand0_geom),dGeomGetRotation(l_hand0_geom));
+              glPushMatrix();LDEsetM(state.geomPosition(l_hand0_geom),state.geomRotation(l_hand0_geom));
               DrawBox(0.022,0.069,0.065,false,textured,2);glPopMatrix();
             }
         } 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(l_hand1_geom),dGeomGetRotation(l_hand1_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(l_hand1_geom),state.geomRotation(l_hand1_geom));
         DrawCylinder(0.0065,0.08,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(l_hand2_geom),dGeomGetRotation(l_hand2_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(l_hand2_geom),state.geomRotation(l_hand2_geom));
         DrawCylinder(0.0065,0.084,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(l_hand3_geom),dGeomGetRotation(l_hand3_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(l_hand3_geom),state.geomRotation(l_hand3_geom));
         DrawCylinder(0.0065,0.08,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(l_hand4_geom),dGeomGetRotation(l_hand4_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(l_hand4_geom),state.geomRotation(l_hand4_geom));
         DrawCylinder(0.0065,0.073,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(l_hand5_geom),dGeomGetRotation(l_hand5_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(l_hand5_geom),state.geomRotation(l_hand5_geom));
         DrawCylinder(0.0065,0.064,false,textured,2);glPopMatrix();
 
     }else{ //(actLHand == "on")
         if (actLeftArmCovers == "on"){
             if (actCoversCol == "on"){ //in this case, the covers are placeable geoms initialized in initCovers() - we can retrieve their coordinates 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["leftPalm"].geom),dGeomGetRotation(model_ThreeD_obj["leftPalm"].geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(model_ThreeD_obj["leftPalm"].geom),state.geomRotation(model_ThreeD_obj["leftPalm"].geom));     //DRAW THE MODEL
                 DrawX( model_trimesh["leftPalm"], modelTexture[0]);
                 glPopMatrix();
             }  else  { // covers are not placeable geoms but only "eye-candy" - coordinates need to be retrieved from other geoms
                 glPushMatrix();
-                LDEsetM(dBodyGetPosition(body[10]),dBodyGetRotation(body[10]));    
+                LDEsetM(state.bodyPosition(body[10]),state.bodyRotation(body[10]));    
                 glTranslatef(0.0, 0.5*fabs(jP_leftArm[7][2] - jP_leftArm[6][2]), 0.0); 
                 DrawX( model_trimesh["leftPalm"], modelTexture[0]);
                 glPopMatrix();
@@ -1033,72 +1035,72 @@ void ICubSim::draw(){
         }
        
         if ((actSelfCol == "on") || (actCoversCol == "on")){ //the palm "box" is drawn - in this regime, we want to draw all objects that are relevant for the simulation
-            glPushMatrix();LDEsetM(dBodyGetPosition(body[10]),dBodyGetRotation(body[10]));
+            glPushMatrix();LDEsetM(state.bodyPosition(body[10]),state.bodyRotation(body[10]));
             DrawBox(0.022,0.069,0.065,false,textured,2);glPopMatrix();//Taken from ODE use Y, Z, Xs
         } else {
             if (actLeftArmCovers == "off") //if covers are off, the palm "box" is drawn; if they are on, it is not drawn as the cover visually fills up the space
             {
-                glPushMatrix();LDEsetM(dBodyGetPosition(body[10]),dBodyGetRotation(body[10]));
+                glPushMatrix();LDEsetM(state.bodyPosition(body[10]),state.bodyRotation(body[10]));
                 DrawBox(0.022,0.069,0.065,false,textured,2);glPopMatrix();//Taken from ODE use Y, Z, Xs
             }
         } 
         
         //LEFT HAND + FINGERS
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[12]),dBodyGetRotation(body[12]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[12]),state.bodyRotation(body[12]));
         DrawCylinder(0.0065,0.012,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[13]),dBodyGetRotation(body[13]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[13]),state.bodyRotation(body[13]));
         DrawCylinder(0.0065,0.012,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(lhandfings0_geom),dGeomGetRotation(lhandfings0_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(lhandfings0_geom),state.geomRotation(lhandfings0_geom));
         DrawCylinder(0.0065,0.012,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(lhandfings1_geom),dGeomGetRotation(lhandfings1_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(lhandfings1_geom),state.geomRotation(lhandfings1_geom));
         DrawCylinder(0.0065,0.012,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[16]),dBodyGetRotation(body[16]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[16]),state.bodyRotation(body[16]));
         DrawCylinder(0.0065,0.026,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[17]),dBodyGetRotation(body[17]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[17]),state.bodyRotation(body[17]));
         DrawCylinder(0.0065,0.028,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(lhandfings2_geom),dGeomGetRotation(lhandfings2_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(lhandfings2_geom),state.geomRotation(lhandfings2_geom));
         DrawCylinder(0.0065,0.026,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(lhandfings3_geom),dGeomGetRotation(lhandfings3_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(lhandfings3_geom),state.geomRotation(lhandfings3_geom));
         DrawCylinder(0.0065,0.022,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[20]),dBodyGetRotation(body[20]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[20]),state.bodyRotation(body[20]));
         DrawCylinder(0.0065,0.022,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[21]),dBodyGetRotation(body[21]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[21]),state.bodyRotation(body[21]));
         DrawCylinder(0.0065,0.024,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(lhandfings4_geom),dGeomGetRotation(lhandfings4_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(lhandfings4_geom),state.geomRotation(lhandfings4_geom));
         DrawCylinder(0.0065,0.022,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(lhandfings5_geom),dGeomGetRotation(lhandfings5_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(lhandfings5_geom),state.geomRotation(lhandfings5_geom));
         DrawCylinder(0.0065,0.019,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[24]),dBodyGetRotation(body[24]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[24]),state.bodyRotation(body[24]));
         DrawCylinder(0.0065,0.02,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[25]),dBodyGetRotation(body[25]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[25]),state.bodyRotation(body[25]));
         DrawCylinder(0.0065,0.02,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(lhandfings6_geom),dGeomGetRotation(lhandfings6_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(lhandfings6_geom),state.geomRotation(lhandfings6_geom));
         DrawCylinder(0.0065,0.02,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(lhandfings7_geom),dGeomGetRotation(lhandfings7_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(lhandfings7_geom),state.geomRotation(lhandfings7_geom));
         DrawCylinder(0.0065,0.02,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[28]),dBodyGetRotation(body[28]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[28]),state.bodyRotation(body[28]));
         DrawCylinder(0.0065,0.026,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[29]),dBodyGetRotation(body[29]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[29]),state.bodyRotation(body[29]));
         DrawCylinder(0.0065,0.022,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[30]),dBodyGetRotation(body[30]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[30]),state.bodyRotation(body[30]));
         DrawCylinder(0.0065,0.016,false,textured,2);glPopMatrix();
     }
     if (actRHand == "off"){
@@ -1107,12 +1109,12 @@ void ICubSim::draw(){
         if (actRightArmCovers == "on"){
             if (actCoversCol == "on"){ //in this case, the covers are placeable geoms initialized in initCovers() - we can retrieve their coordinates 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["rightPalm"].geom),dGeomGetRotation(model_ThreeD_obj["rightPalm"].geom));     
+                LDEsetM(state.geomPosition(model_ThreeD_obj["rightPalm"].geom),state.geomRotation(model_ThreeD_obj["rightPalm"].geom));     
                 DrawX( model_trimesh["rightPalm"], modelTexture[0]);
                 glPopMatrix();
             }  else  { // covers are not placeable geoms but only "eye-candy" - coordinates need to be retrieved from other geoms
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(r_hand0_geom),dGeomGetRotation(r_hand0_geom));     //DRAW THE MODEL
+                LDEsetM(state.geomPosition(r_hand0_geom),state.geomRotation(r_hand0_geom));     //DRAW THE MODEL
                 glTranslatef(0.0, 0.5*fabs(jP_rightArm[7][2] - jP_rightArm[6][2]), 0.0);
                 DrawX( model_trimesh["rightPalm"], modelTexture[0]);
                 glPopMatrix();
@@ -1120,41 +1122,41 @@ void ICubSim::draw(){
         }
        
         if ((actSelfCol == "on") || (actCoversCol == "on")){ //the palm "box" is drawn - in this regime, we want to draw all objects that are relevant for the simulation
-            glPushMatrix();LDEsetM(dGeomGetPosition(r_hand0_geom),dGeomGetRotation(r_hand0_geom));
+            glPushMatrix();LDEsetM(state.geomPosition(r_hand0_geom),state.geomRotation(r_hand0_geom));
             DrawBox(0.022,0.069,0.065,false,textured,2);glPopMatrix();
         } else {
             if (actRightArmCovers == "off") //if covers are off, the palm "box" is drawn; if they are on, it is not drawn as the cover visually fills up the space
             {
-               glPushMatrix();LDEsetM(dGeomGetPosition(r_hand0_geom),dGeomGetRotation(r_hand0_geom));
+               glPushMatrix();LDEsetM(state.geomPosition(r_hand0_geom),state.geomRotation(r_hand0_geom));
                DrawBox(0.022,0.069,0.065,false,textured,2);glPopMatrix();
             }
         }
          
-        glPushMatrix(); LDEsetM(dGeomGetPosition(r_hand1_geom),dGeomGetRotation(r_hand1_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(r_hand1_geom),state.geomRotation(r_hand1_geom));
         DrawCylinder(0.0065,0.08,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(r_hand2_geom),dGeomGetRotation(r_hand2_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(r_hand2_geom),state.geomRotation(r_hand2_geom));
         DrawCylinder(0.0065,0.084,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(r_hand3_geom),dGeomGetRotation(r_hand3_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(r_hand3_geom),state.geomRotation(r_hand3_geom));
         DrawCylinder(0.0065,0.08,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(r_hand4_geom),dGeomGetRotation(r_hand4_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(r_hand4_geom),state.geomRotation(r_hand4_geom));
         DrawCylinder(0.0065,0.073,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(r_hand5_geom),dGeomGetRotation(r_hand5_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(r_hand5_geom),state.geomRotation(r_hand5_geom));
         DrawCylinder(0.0065,0.064,false,textured,2);glPopMatrix();
 
     }else{ //(actRHand == "on")
          if (actRightArmCovers == "on"){
             if (actCoversCol == "on"){ //in this case, the covers are placeable geoms initialized in initCovers() - we can retrieve their coordinates 
                 glPushMatrix();
-                LDEsetM(dGeomGetPosition(model_ThreeD_obj["rightPalm"].geom),dGeomGetRotation(model_ThreeD_obj["rightPalm"].geom));     
+                LDEsetM(state.geomPosition(model_ThreeD_obj["rightPalm"].geom),state.geomRotation(model_ThreeD_obj["rightPalm"].geom));     
                 DrawX( model_trimesh["rightPalm"], modelTexture[0]);
                 glPopMatrix();
             }  else  { // covers are not placeable geoms but only "eye-candy" - coordinates need to be retrieved from other geoms
                 glPushMatrix();
-                LDEsetM(dBodyGetPosition(body[11]),dBodyGetRotation(body[11]));     //DRAW THE MODEL
+                LDEsetM(state.bodyPosition(body[11]),state.bodyRotation(body[11]));     //DRAW THE MODEL
                 glTranslatef(0.0, 0.5*fabs(jP_rightArm[7][2] - jP_rightArm[6][2]), 0.0);
                 DrawX( model_trimesh["rightPalm"], modelTexture[0]);
                 glPopMatrix();
@@ -1162,93 +1164,93 @@ void ICubSim::draw(){
         }
        
         if ((actSelfCol == "on") || (actCoversCol == "on")){ //the palm "box" is drawn - in this regime, we want to draw all objects that are relevant for the simulation
-            glPushMatrix();LDEsetM(dBodyGetPosition(body[11]),dBodyGetRotation(body[11]));
+            glPushMatrix();LDEsetM(state.bodyPosition(body[11]),state.bodyRotation(body[11]));
             DrawBox(0.022,0.069,0.065,false,textured,2);glPopMatrix();//Taken from ODE use Y, Z, Xs
         } else {
             if (actRightArmCovers == "off") //if covers are off, the palm "box" is drawn; if they are on, it is not drawn as the cover visually fills up the space
             {
-                glPushMatrix();LDEsetM(dBodyGetPosition(body[11]),dBodyGetRotation(body[11]));
+                glPushMatrix();LDEsetM(state.bodyPosition(body[11]),state.bodyRotation(body[11]));
                 DrawBox(0.022,0.069,0.065,false,textured,2);glPopMatrix();//Taken from ODE use Y, Z, Xs
             }
         }    
          
         //RIGHT HAND FINGERS
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[31]),dBodyGetRotation(body[31]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[31]),state.bodyRotation(body[31]));
         DrawCylinder(0.0065,0.012,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[32]),dBodyGetRotation(body[32]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[32]),state.bodyRotation(body[32]));
         DrawCylinder(0.0065,0.012,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rhandfings0_geom),dGeomGetRotation(rhandfings0_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(rhandfings0_geom),state.geomRotation(rhandfings0_geom));
         DrawCylinder(0.0065,0.012,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rhandfings1_geom),dGeomGetRotation(rhandfings1_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(rhandfings1_geom),state.geomRotation(rhandfings1_geom));
         DrawCylinder(0.0065,0.012,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[35]),dBodyGetRotation(body[35]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[35]),state.bodyRotation(body[35]));
         DrawCylinder(0.0065,0.026,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[36]),dBodyGetRotation(body[36]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[36]),state.bodyRotation(body[36]));
         DrawCylinder(0.0065,0.028,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rhandfings2_geom),dGeomGetRotation(rhandfings2_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(rhandfings2_geom),state.geomRotation(rhandfings2_geom));
         DrawCylinder(0.0065,0.026,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rhandfings3_geom),dGeomGetRotation(rhandfings3_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(rhandfings3_geom),state.geomRotation(rhandfings3_geom));
         DrawCylinder(0.0065,0.022,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[39]),dBodyGetRotation(body[39]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[39]),state.bodyRotation(body[39]));
         DrawCylinder(0.0065,0.022,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[40]),dBodyGetRotation(body[40]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[40]),state.bodyRotation(body[40]));
         DrawCylinder(0.0065,0.024,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rhandfings4_geom),dGeomGetRotation(rhandfings4_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(rhandfings4_geom),state.geomRotation(rhandfings4_geom));
         DrawCylinder(0.0065,0.022,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rhandfings5_geom),dGeomGetRotation(rhandfings5_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(rhandfings5_geom),state.geomRotation(rhandfings5_geom));
         DrawCylinder(0.0065,0.019,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[43]),dBodyGetRotation(body[43]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[43]),state.bodyRotation(body[43]));
         DrawCylinder(0.0065,0.02,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[44]),dBodyGetRotation(body[44]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[44]),state.bodyRotation(body[44]));
         DrawCylinder(0.0065,0.02,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rhandfings6_geom),dGeomGetRotation(rhandfings6_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(rhandfings6_geom),state.geomRotation(rhandfings6_geom));
         DrawCylinder(0.0065,0.02,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(rhandfings7_geom),dGeomGetRotation(rhandfings7_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(rhandfings7_geom),state.geomRotation(rhandfings7_geom));
         DrawCylinder(0.0065,0.02,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[47]),dBodyGetRotation(body[47]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[47]),state.bodyRotation(body[47]));
         DrawCylinder(0.0065,0.026,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[48]),dBodyGetRotation(body[48]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[48]),state.bodyRotation(body[48]));
         DrawCylinder(0.0065,0.022,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(body[49]),dBodyGetRotation(body[49]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(body[49]),state.bodyRotation(body[49]));
         DrawCylinder(0.0065,0.016,false,textured,2);glPopMatrix();
     }
     if (actHead == "off"){
-        glPushMatrix(); LDEsetM(dGeomGetPosition(neck0_geom),dGeomGetRotation(neck0_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(neck0_geom),state.geomRotation(neck0_geom));
         DrawCylinder(0.015,0.077,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(neck1_geom),dGeomGetRotation(neck1_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(neck1_geom),state.geomRotation(neck1_geom));
         DrawCylinder(0.015,0.077,false,textured,2);glPopMatrix();
     }else{
-        glPushMatrix(); LDEsetM(dBodyGetPosition(neck[0]),dBodyGetRotation(neck[0]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(neck[0]),state.bodyRotation(neck[0]));
         DrawCylinder(0.015,0.077,false,textured,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dBodyGetPosition(neck[1]),dBodyGetRotation(neck[1]));
+        glPushMatrix(); LDEsetM(state.bodyPosition(neck[1]),state.bodyRotation(neck[1]));
         DrawCylinder(0.015,0.077,false,textured,2);glPopMatrix();
     }
 
-    glPushMatrix(); LDEsetM(dGeomGetPosition(head0_geom),dGeomGetRotation(head0_geom));
+    glPushMatrix(); LDEsetM(state.geomPosition(head0_geom),state.geomRotation(head0_geom));
     DrawCylinder(0.015,0.06,false,textured,2);glPopMatrix();
 
     if (actHeadCover == "on"){
-        glPushMatrix(); LDEsetM(dGeomGetPosition(eye1_geom),dGeomGetRotation(head1_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(eye1_geom),state.geomRotation(head1_geom));
         glTranslatef(0.0,0.0,-fabs(jP_head[3][0]-jP_head[2][0])*1.20);
         glScalef(0.95,0.95,1);
         iCubHeadModel->draw(false,8);
@@ -1258,7 +1260,7 @@ void ICubSim::draw(){
             eyeLids = new EyeLids;
             eyeLids->setName( eyeLidsPortName );
         } 
-        glPushMatrix();LDEsetM(dGeomGetPosition(eye1_geom),dGeomGetRotation(head1_geom));
+        glPushMatrix();LDEsetM(state.geomPosition(eye1_geom),state.geomRotation(head1_geom));
         eyeLids->checkPort();
         glRotatef(eyeLids->eyeLidsRotation,1,0,0);
         topEyeLidModel->draw(false,8); 
@@ -1267,54 +1269,54 @@ void ICubSim::draw(){
         glPopMatrix();
 
     }else{
-        glPushMatrix(); LDEsetM(dGeomGetPosition(head1_geom),dGeomGetRotation(head1_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(head1_geom),state.geomRotation(head1_geom));
         DrawBox(0.104, 0.002,0.052,false,textured,2);
         glPopMatrix();
 
         glColor3d(0.3,0.3,0.3);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(head2_geom),dGeomGetRotation(head2_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(head2_geom),state.geomRotation(head2_geom));
         DrawBox(0.002, 0.093,0.052,false,false,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(head3_geom),dGeomGetRotation(head3_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(head3_geom),state.geomRotation(head3_geom));
         DrawBox(0.002, 0.093,0.052,false,false,2);glPopMatrix();
-        //glPushMatrix(); LDEsetM(dGeomGetPosition(head4_geom),dGeomGetRotation(head4_geom));
+        //glPushMatrix(); LDEsetM(state.geomPosition(head4_geom),state.geomRotation(head4_geom));
         //DrawBox( 0.104, 0.002 ,0.032,false,false,2);glPopMatrix();
 
-        //glPushMatrix(); LDEsetM(dGeomGetPosition(head5_geom),dGeomGetRotation(head5_geom));
+        //glPushMatrix(); LDEsetM(state.geomPosition(head5_geom),state.geomRotation(head5_geom));
         //DrawBox( 0.011, 0.026,0.025,false,false,2);glPopMatrix();
         glColor3d(0.3,0.3,0.3);
-        glPushMatrix(); LDEsetM(dGeomGetPosition(head6_geom),dGeomGetRotation(head6_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(head6_geom),state.geomRotation(head6_geom));
         DrawBox(  0.011, 0.051,0.012,false,false,2);glPopMatrix();
 
-        glPushMatrix(); LDEsetM(dGeomGetPosition(head7_geom),dGeomGetRotation(head7_geom));
+        glPushMatrix(); LDEsetM(state.geomPosition(head7_geom),state.geomRotation(head7_geom));
         DrawBox( 0.02, 0.022, 0.012,false,false,2);glPopMatrix();
     }
-    glPushMatrix(); LDEsetM(dGeomGetPosition(eye1_geom),dGeomGetRotation(eye1_geom));
+    glPushMatrix(); LDEsetM(state.geomPosition(eye1_geom),state.geomRotation(eye1_geom));
     DrawCylinder(0.002,0.068,false,true,1);glPopMatrix();
 
-    glPushMatrix(); LDEsetM(dGeomGetPosition(eye2_geom),dGeomGetRotation(eye2_geom));
+    glPushMatrix(); LDEsetM(state.geomPosition(eye2_geom),state.geomRotation(eye2_geom));
     DrawCylinder(0.006,0.030,false,true,1);glPopMatrix();
 
-    glPushMatrix(); LDEsetM(dGeomGetPosition(eye3_geom),dGeomGetRotation(eye3_geom));
+    glPushMatrix(); LDEsetM(state.geomPosition(eye3_geom),state.geomRotation(eye3_geom));
     DrawCylinder(0.006,0.05,false,true,1);glPopMatrix();
 
-    glPushMatrix(); LDEsetM(dGeomGetPosition(eye3_geom),dGeomGetRotation(eye3_geom));
+    glPushMatrix(); LDEsetM(state.geomPosition(eye3_geom),state.geomRotation(eye3_geom));
     DrawCylinder(0.006,0.05,false,true,1);glPopMatrix();
 
-    glPushMatrix(); LDEsetM(dGeomGetPosition(eye4_geom),dGeomGetRotation(eye4_geom));
+    glPushMatrix(); LDEsetM(state.geomPosition(eye4_geom),state.geomRotation(eye4_geom));
     DrawCylinder(0.006,0.030,false,true,1);glPopMatrix();
 
-    glPushMatrix(); LDEsetM(dGeomGetPosition(eye5_geom),dGeomGetRotation(eye5_geom));
+    glPushMatrix(); LDEsetM(state.geomPosition(eye5_geom),state.geomRotation(eye5_geom));
     DrawCylinder(0.006,0.05,false,true,1);glPopMatrix();
 
-    glPushMatrix(); LDEsetM(dGeomGetPosition(Leye1_geom),dGeomGetRotation(Leye1_geom));
+    glPushMatrix(); LDEsetM(state.geomPosition(Leye1_geom),state.geomRotation(Leye1_geom));
     glColor3d(0,0,0);
     DrawCylinder(0.006,0.04,false,false,1);
     glColor3d(1,1,1);
     DrawSphere(0.0185,false,false,0);
     glPopMatrix();
 
-    glPushMatrix(); LDEsetM(dGeomGetPosition(Reye1_geom),dGeomGetRotation(Reye1_geom));
+    glPushMatrix(); LDEsetM(state.geomPosition(Reye1_geom),state.geomRotation(Reye1_geom));
     glColor3d(0,0,0);
     DrawCylinder(0.006,0.04,false,false,1);
     glColor3d(1,1,1);
@@ -1322,7 +1324,7 @@ void ICubSim::draw(){
     glPopMatrix();
 
     glColor3d(1,0.49,0.14);
-    glPushMatrix();LDEsetM(dBodyGetPosition(inertialBody),dBodyGetRotation(inertialBody));
+    glPushMatrix();LDEsetM(state.bodyPosition(inertialBody),state.bodyRotation(inertialBody));
     DrawBox( 0.03, 0.02, 0.05,false,false,2);
     glPopMatrix();
 
@@ -21,18 +21,20 @@
 #include "iCub_Sim.h"
 
 #include "OdeInit.h"
+#include "PixelReadback.h"
 #include <yarp/os/LogStream.h>
 #include <mutex>
 #include <cstdlib>
 #include <csignal>
 #include <set>
+#include <chrono>
 
 using namespace yarp::sig;
 
 // locals
 // NOTE that we use (long) instead of (clock_t), because on MacOS, (clock_t) is unsigned, while we need negative numbers
 static long gl_frame_length = 1000/30; // update opengl and vision stream at 30 Hz
-static long ode_step_length = 10;      // target duration of the ODE step in CPU time (set to 0 to go as fast as possible, set to dstep*1000 to go realtime)
+static long ode_step_length = 10;      // target duration of the ODE step in wall time (set to 0 to go as fast as possible, set to dstep*1000 to go realtime)
 static double dstep = 10.0/1000.0;     // step size in ODE's dWorldStep in seconds
 
 static bool glrun;  // draw gl
@@ -95,6 +97,7 @@ static double fov_right;
 
 static int cameraSizeWidth;
 static int cameraSizeHeight;
+static PixelReadback readback;  // reads the camera views back from the GPU
 
 struct contactICubSkinEmul_t{
     bool coverTouched;
@@ -255,6 +258,9 @@ void OdeSdlSimulation::process_events(void) {
             case SDL_VIDEORESIZE:
                 width = event.resize.w;
                 height = event.resize.h;
+                // the context may be recreated along with the window,
+                // the buffers of the camera views are created anew
+                readback.release();
                 SDL_SetVideoMode(width,height,16,SDL_OPENGL | SDL_RESIZABLE);
                 {
                     bool ok = setup_opengl(robot_config->getFinder());
@@ -859,6 +865,8 @@ void OdeSdlSimulation::mouseMovement(float x, float y) {
 
 void OdeSdlSimulation::draw_screen() {
     OdeInit& odeinit = OdeInit::get();
+    // draw the scene and the camera images from the poses of the last step
+    odeinit.stateBuffer.acquire();
         
     glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT); // refresh opengl
 
@@ -1002,55 +1010,64 @@ void OdeSdlSimulation::retreiveInertialData(Bottle& inertialReport) {
 
 int OdeSdlSimulation::thread_ode(void *unused) {
     //SLD_AddTimer freezes the system if delay is too short. Instead use a while loop that waits if there was time left after the computation of ODE_process
-    double cpms = 1e3 / CLOCKS_PER_SEC;
-    long lastOdeProcess = (long) (clock()*cpms);
-    double avg_ode_step_length = 0.0;
+    // The loop is paced by the wall clock: clock() measures the CPU time of the whole process, which runs
+    // faster than real time as soon as the rendering or the islands of the world are processed by other threads
+    typedef std::chrono::steady_clock steady;
+    dAllocateODEDataForThread(dAllocateMaskAll);
+    steady::time_point lastTimeCacheUpdate = steady::now();
+    steady::time_point lastReport = lastTimeCacheUpdate;
+    double odeTimeSinceReport = 0.0;     // [ms] of simulation and of computation since the last report
+    long stepsSinceReport = 0;
     long count = 0;
     simrun = true;
-    double timeCache = ode_step_length;
-    long lastTimeCacheUpdate = (long) (clock()*cpms);
-    double alpha = 0.99;
+    double timeCache = (double)ode_step_length;
     // if realTime=true when delays occur the simulation tries to recover by running more steps in a row
     // if realTime=false the simulation executes the simulation steps with a fixed rate irregardless of delays
     bool realTime = true;
-    long temp;
+    steady::time_point temp;
 
     while (simrun) {
-        temp = (long) (clock()*cpms);
-        timeCache += temp - lastTimeCacheUpdate;
+        temp = steady::now();
+        timeCache += std::chrono::duration<double,std::milli>(temp - lastTimeCacheUpdate).count();
         lastTimeCacheUpdate = temp;
         while(timeCache < ode_step_length){
             SDL_Delay((unsigned int)(ode_step_length-timeCache));
-            temp = (long) (clock()*cpms);
-            timeCache += temp - lastTimeCacheUpdate;
+            temp = steady::now();
+            timeCache += std::chrono::duration<double,std::milli>(temp - lastTimeCacheUpdate).count();
             lastTimeCacheUpdate = temp;
         }
 
-        /*if(timeCache >= 2.0*ode_step_length) 
-            yWarning("Simulation delay: running %d steps in a row to recover.\n", (int)(timeCache/ode_step_length));*/
-
         while(timeCache >= ode_step_length){
             count++;
-            lastOdeProcess = (long) (clock()*cpms);
+            steady::time_point lastOdeProcess = steady::now();
             ODE_process(1, (void*)1);
-            avg_ode_step_length = alpha*avg_ode_step_length + (1.0-alpha)*((long) (clock()*cpms) -lastOdeProcess);
-            
+            odeTimeSinceReport += std::chrono::duration<double,std::milli>(steady::now() - lastOdeProcess).count();
+            stepsSinceReport++;
+
             if(realTime)
                 timeCache -= ode_step_length;
             else
                 timeCache = 0.0;
 
-            // check if the desired timestep is achieved, if not, print a warning msg
+            // every 10 s of simulation, check if the simulation keeps up with real time, if not, print a warning msg
             if(count % (10000/ode_step_length)==0){
-                if(avg_ode_step_length >= ode_step_length+1)
-                    yWarning("the simulation is too slow to run in real-time, you should increase the timestep in ode_params.ini (current value: %ld, suggested value: %.0f)\n", 
-                        ode_step_length, avg_ode_step_length);
-                else if(avg_ode_step_length <= ode_step_length-1)
-                    yWarning("you could get a more accurate dynamics simulation by decreasing the timestep in ode_params.ini (current value: %ld, suggested value: %.0f)\n", 
-                        ode_step_length, avg_ode_step_length);
+                double wall = std::chrono::duration<double,std::milli>(steady::now() - lastReport).count();
+                double rtf = (stepsSinceReport*ode_step_length)/wall;
+                double avg_ode_step_length = odeTimeSinceReport/stepsSinceReport;
+                OdeInit& odeinit = OdeInit::get();
+                if(rtf < 0.95)
+                    yWarning("the simulation is too slow to run in real-time (real-time factor %.2f, step computed in %.1f ms): you should increase the timestep in ode_params.ini (current value: %ld) or use the quick stepper\n",
+                        rtf, avg_ode_step_length, ode_step_length);
+                else if (odeinit.verbosity > 0)
+                    yInfo("real-time factor %.2f, step computed in %.1f ms (timestep %ld ms)\n",
+                        rtf, avg_ode_step_length, ode_step_length);
+                lastReport = steady::now();
+                odeTimeSinceReport = 0.0;
+                stepsSinceReport = 0;
             }
         }
     }
+    dCleanupODEAllDataForThread();
     return(0);
 }
 
@@ -1075,7 +1092,7 @@ Uint32 OdeSdlSimulation::ODE_process(Uint32 interval, void *param) {
     }
     if (odeinit.verbosity > 3) yDebug("***END OF info code collision detection\n ***"); 
     
-    dWorldStep(odeinit.world, dstep);
+    odeinit.step(dstep);
     // do 1 TIMESTEP in controllers (ok to run at same rate as ODE: 1 iteration takes about 300 times less computation time than dWorldStep)
     for (int ipart = 0; ipart<MAX_PART; ipart++) {
         if (odeinit._controls[ipart] != NULL) {
@@ -1091,6 +1108,10 @@ Uint32 OdeSdlSimulation::ODE_process(Uint32 interval, void *param) {
         odeinit._imu->updateIMUData(inertialBot);
     }
 
+    // publish the new poses for the rendering, which does not lock the world
+    static double odeTime = 0.0;
+    odeTime += dstep;
+    odeinit.stateBuffer.capture(odeinit.space, odeTime);
 
     odeinit.sync = true;
     odeinit.mtx.unlock();
@@ -1322,11 +1343,14 @@ void OdeSdlSimulation::simLoop(int h,int w) {
     simrun = false;
     //SDL_WaitThread( thread, NULL );
     SDL_WaitThread( ode_thread, NULL );
+    // the context of the reads is still current
+    readback.release();
     //SDL_Quit();
 }
 
 void OdeSdlSimulation::drawView(bool left, bool right, bool wide) {
     OdeInit& odeinit = OdeInit::get();
+    const OdeStateBuffer &state = odeinit.stateBuffer;
     const dReal *pos;
     const dReal *rot;
     glViewport(0,0,cameraSizeWidth,cameraSizeHeight);
@@ -1335,8 +1359,8 @@ void OdeSdlSimulation::drawView(bool left, bool right, bool wide) {
     if (left){
         glLoadIdentity();
         gluPerspective( fov_left, (float) width_left/height_left, 0.04, 100.0 );
-        pos = dGeomGetPosition(odeinit._iCub->Leye1_geom);
-        rot = dGeomGetRotation(odeinit._iCub->Leye1_geom);
+        pos = state.geomPosition(odeinit._iCub->Leye1_geom);
+        rot = state.geomRotation(odeinit._iCub->Leye1_geom);
         glMatrixMode (GL_MODELVIEW);
         glLoadIdentity();
         glLightfv(GL_LIGHT0, GL_POSITION, light_position);
@@ -1353,8 +1377,8 @@ void OdeSdlSimulation::drawView(bool left, bool right, bool wide) {
     if (right){
         glLoadIdentity();
         gluPerspective( fov_right, (float) width_right/height_right, 0.04, 100.0 );//55.8
-        pos = dGeomGetPosition(odeinit._iCub->Reye1_geom);
-        rot = dGeomGetRotation(odeinit._iCub->Reye1_geom);
+        pos = state.geomPosition(odeinit._iCub->Reye1_geom);
+        rot = state.geomRotation(odeinit._iCub->Reye1_geom);
         glMatrixMode (GL_MODELVIEW);
         glLoadIdentity();
         glLightfv(GL_LIGHT0, GL_POSITION, light_position);
@@ -1438,6 +1462,9 @@ void OdeSdlSimulation::init(RobotStreamer *streamer,
     cameraSizeWidth=width_left;
     cameraSizeHeight=height_left;
 
+    // number of views each camera image lags behind, to let the GPU transfer it while rendering the next ones
+    readback.setBuffers(robot_config->getFinder().check("camera_readback_buffers",Value(2)).asInt32());
+
     double focal_length_left=bCalibLeft.check("fy",Value(257.34)).asFloat64();
     fov_left=2*atan2((double)height_left,2*focal_length_left)*180.0/M_PI;
 
@@ -1634,30 +1661,17 @@ bool OdeSdlSimulation::getTrqData(Bottle data) {
 
 
 bool OdeSdlSimulation::getImage(ImageOf<PixelRgb>& target) {
-    int w = cameraSizeWidth;
-    int h = cameraSizeHeight;
-    int p = 3;
-
-    char *buf=new char[w * h * p];
-    glReadPixels( 0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, buf);
-    ImageOf<PixelRgb> img;
-    img.setQuantum(1);
-    img.setExternal(buf,w,h);
-
-    // inefficient flip!
-    target.resize(img);
-    int ww = img.width();
-    int hh = img.height();
-    for (int x=0; x<ww; x++) {
-        for (int y=0; y<hh; y++) {
-            target(x,y) = img(x,hh-1-y);
-        }
-    }
+    readback.readNow(cameraSizeWidth, cameraSizeHeight, target);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    delete[] buf;
     return true;
 }
 
+bool OdeSdlSimulation::readImage(int camera, Stamp& stamp, ImageOf<PixelRgb>& target) {
+    bool ok = readback.read(camera, cameraSizeWidth, cameraSizeHeight, stamp, target);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    return ok;
+}
+
 void OdeSdlSimulation::inspectWholeBodyContactsAndSendTouch()
 {
       //SkinDynLib enums
@@ -110,6 +110,9 @@ public:
 
     virtual bool getImage(yarp::sig::ImageOf<yarp::sig::PixelRgb>& target);
 
+    virtual bool readImage(int camera, yarp::os::Stamp& stamp,
+                           yarp::sig::ImageOf<yarp::sig::PixelRgb>& target);
+
     virtual bool getTrqData(Bottle data);
 
 private:
@@ -60,111 +60,112 @@ void worldSim::ballDamping()
     }
 }
 void worldSim::draw(){
+    const OdeStateBuffer &state = OdeInit::get().stateBuffer;
 
     if (actWorld == "on"){
         ////table geom
         glColor3d(0.6,0.6,0.0);
-        glPushMatrix();LDEsetM(dGeomGetPosition(tableGeom[0]),dGeomGetRotation(tableGeom[0]));
+        glPushMatrix();LDEsetM(state.geomPosition(tableGeom[0]),state.geomRotation(tableGeom[0]));
         DrawBox(0.03,0.5,0.03,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(tableGeom[1]),dGeomGetRotation(tableGeom[1]));
+        glPushMatrix();LDEsetM(state.geomPosition(tableGeom[1]),state.geomRotation(tableGeom[1]));
         DrawBox(0.03,0.5,0.03,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(tableGeom[2]),dGeomGetRotation(tableGeom[2]));
+        glPushMatrix();LDEsetM(state.geomPosition(tableGeom[2]),state.geomRotation(tableGeom[2]));
         DrawBox(0.03,0.5,0.03,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(tableGeom[3]),dGeomGetRotation(tableGeom[3]));
+        glPushMatrix();LDEsetM(state.geomPosition(tableGeom[3]),state.geomRotation(tableGeom[3]));
         DrawBox(0.03,0.5,0.03,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(tableGeom[4]),dGeomGetRotation(tableGeom[4]));
+        glPushMatrix();LDEsetM(state.geomPosition(tableGeom[4]),state.geomRotation(tableGeom[4]));
         DrawBox(0.7,0.03,0.4,false,textured,2);glPopMatrix();
 
         /*glColor3d(0.8,0.0,0.0);
-        glPushMatrix();LDEsetM(dGeomGetPosition(box_part[0]),dGeomGetRotation(box_part[0]));
+        glPushMatrix();LDEsetM(state.geomPosition(box_part[0]),state.geomRotation(box_part[0]));
         DrawBox(0.01,0.01,0.1,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(box_part[1]),dGeomGetRotation(box_part[1]));
+        glPushMatrix();LDEsetM(state.geomPosition(box_part[1]),state.geomRotation(box_part[1]));
         DrawBox(0.01,0.01,0.1,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(box_part[2]),dGeomGetRotation(box_part[2]));
+        glPushMatrix();LDEsetM(state.geomPosition(box_part[2]),state.geomRotation(box_part[2]));
         DrawBox(0.1,0.01,0.01,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(box_part[3]),dGeomGetRotation(box_part[3]));
+        glPushMatrix();LDEsetM(state.geomPosition(box_part[3]),state.geomRotation(box_part[3]));
         DrawBox(0.1,0.01,0.01,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(box_part[4]),dGeomGetRotation(box_part[4]));
+        glPushMatrix();LDEsetM(state.geomPosition(box_part[4]),state.geomRotation(box_part[4]));
         DrawBox(0.01,0.1,0.01,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(box_part[5]),dGeomGetRotation(box_part[5]));
+        glPushMatrix();LDEsetM(state.geomPosition(box_part[5]),state.geomRotation(box_part[5]));
         DrawBox(0.01,0.1,0.01,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(box_part[6]),dGeomGetRotation(box_part[6]));
+        glPushMatrix();LDEsetM(state.geomPosition(box_part[6]),state.geomRotation(box_part[6]));
         DrawBox(0.01,0.1,0.01,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(box_part[7]),dGeomGetRotation(box_part[7]));
+        glPushMatrix();LDEsetM(state.geomPosition(box_part[7]),state.geomRotation(box_part[7]));
         DrawBox(0.01,0.1,0.01,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(box_part[8]),dGeomGetRotation(box_part[8]));
+        glPushMatrix();LDEsetM(state.geomPosition(box_part[8]),state.geomRotation(box_part[8]));
         DrawBox(0.01,0.01,0.1,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(box_part[9]),dGeomGetRotation(box_part[9]));
+        glPushMatrix();LDEsetM(state.geomPosition(box_part[9]),state.geomRotation(box_part[9]));
         DrawBox(0.01,0.01,0.1,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(box_part[10]),dGeomGetRotation(box_part[10]));
+        glPushMatrix();LDEsetM(state.geomPosition(box_part[10]),state.geomRotation(box_part[10]));
         DrawBox(0.1,0.01,0.01,false,textured,2);glPopMatrix();
 
-        glPushMatrix();LDEsetM(dGeomGetPosition(box_part[11]),dGeomGetRotation(box_part[11]));
+        glPushMatrix();LDEsetM(state.geomPosition(box_part[11]),state.geomRotation(box_part[11]));
         DrawBox(0.1,0.01,0.01,false,textured,2);glPopMatrix();
         */
         glColor3d(0.0,0.0,0.8);
-        glPushMatrix(); LDEsetM(dBodyGetPosition(ballBody),dBodyGetRotation(ballBody));
+        glPushMatrix(); LDEsetM(state.bodyPosition(ballBody),state.bodyRotation(ballBody));
         DrawSphere(0.04,false,textured,2);glPopMatrix();	
         
     }
 
     for (int i=0; i<OBJNUM; i++) {
         glColor3d(color[i][0],color[i][1],color[i][2]);
-        glPushMatrix();LDEsetM(dBodyGetPosition(obj[i].boxbody),dBodyGetRotation(obj[i].boxbody));
+        glPushMatrix();LDEsetM(state.bodyPosition(obj[i].boxbody),state.bodyRotation(obj[i].boxbody));
         DrawBox(obj[i].size[0],obj[i].size[1],obj[i].size[2],false,textured,2);glPopMatrix();
     }
     for (int i=0; i<S_OBJNUM; i++) {
         glColor3d(s_color[i][0],s_color[i][1],s_color[i][2]);
-        glPushMatrix();LDEsetM(dGeomGetPosition(s_obj[i].geom[0]),dGeomGetRotation(s_obj[i].geom[0]));
+        glPushMatrix();LDEsetM(state.geomPosition(s_obj[i].geom[0]),state.geomRotation(s_obj[i].geom[0]));
         DrawBox(s_obj[i].size[0],s_obj[i].size[1],s_obj[i].size[2],false,textured,2);glPopMatrix();
     }
 
     for (int i=0; i<cylOBJNUM; i++) {
         glColor3d(color1[i][0],color1[i][1],color1[i][2]);
-        glPushMatrix();LDEsetM(dBodyGetPosition(cyl_obj[i].cylbody),dBodyGetRotation(cyl_obj[i].cylbody));
+        glPushMatrix();LDEsetM(state.bodyPosition(cyl_obj[i].cylbody),state.bodyRotation(cyl_obj[i].cylbody));
         DrawCylinder(cyl_obj[i].radius,cyl_obj[i].length,false,textured,2);glPopMatrix();
     }
 
     for (int i=0; i<S_cylOBJNUM; i++) {
         glColor3d(s_color1[i][0],s_color1[i][1],s_color1[i][2]);
-        glPushMatrix();LDEsetM(dGeomGetPosition(s_cyl_obj[i].cylgeom[0]),dGeomGetRotation(s_cyl_obj[i].cylgeom[0]));
+        glPushMatrix();LDEsetM(state.geomPosition(s_cyl_obj[i].cylgeom[0]),state.geomRotation(s_cyl_obj[i].cylgeom[0]));
         DrawCylinder(s_cyl_obj[i].radius,s_cyl_obj[i].length,false,textured,2);glPopMatrix();
     }
 
     for (int i=0; i<MODEL_NUM; i++){
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix();LDEsetM(dGeomGetPosition(ThreeD_obj[i].geom),dGeomGetRotation(ThreeD_obj[i].geom));     //DRAW THE MODEL
+        glPushMatrix();LDEsetM(state.geomPosition(ThreeD_obj[i].geom),state.geomRotation(ThreeD_obj[i].geom));     //DRAW THE MODEL
         DrawX( trimesh[i], modelTexture[i]);
         glPopMatrix();
     }
     for (int i=0; i<s_MODEL_NUM; i++){
         glColor3d(1.0,1.0,1.0);
-        glPushMatrix();LDEsetM(dGeomGetPosition(s_ThreeD_obj[i].geom),dGeomGetRotation(s_ThreeD_obj[i].geom));     //DRAW THE MODEL
+        glPushMatrix();LDEsetM(state.geomPosition(s_ThreeD_obj[i].geom),state.geomRotation(s_ThreeD_obj[i].geom));     //DRAW THE MODEL
         DrawX( s_trimesh[i], s_modelTexture[i]);
         glPopMatrix();
     }
     for (int i=0; i<SPHNUM; i++) {
         glColor3d(color2[i][0],color2[i][1],color2[i][2]);
-        glPushMatrix();LDEsetM(dBodyGetPosition(sph[i].sphbody),dBodyGetRotation(sph[i].sphbody));
+        glPushMatrix();LDEsetM(state.bodyPosition(sph[i].sphbody),state.bodyRotation(sph[i].sphbody));
         DrawSphere(sph[i].radius,false,textured,2);glPopMatrix();
     }
     for (int i=0; i<S_SPHNUM; i++) {
         glColor3d(s_color2[i][0],s_color2[i][1],s_color2[i][2]);
-        glPushMatrix();LDEsetM(dGeomGetPosition(s_sph[i].sphgeom[0]),dGeomGetRotation(s_sph[i].sphgeom[0]));
+        glPushMatrix();LDEsetM(state.geomPosition(s_sph[i].sphgeom[0]),state.geomRotation(s_sph[i].sphgeom[0]));
         DrawSphere(s_sph[i].radius,false,textured,2);glPopMatrix();
     }
 }
@@ -42,6 +42,9 @@ public:
     double jointCFM;
     double worldCFM; 
     int    worldTimestep;
+    std::string stepper;        // "step" (exact) or "quick" (iterative)
+    int    quickStepIterations;
+    int    stepThreads;         // threads stepping the islands, 0 for none
     double stopERP;   
     double worldERP;
     double maxContactCorrectingVel;
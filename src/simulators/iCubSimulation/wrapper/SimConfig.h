@@ -158,6 +158,9 @@ private:
         p.worldTimestep   = bParamWorld.check("timestep", Value(10)).asInt32();
         p.worldCFM        = bParamWorld.check("worldCFM", Value(0.00001)).asFloat64();
         p.worldERP        = bParamWorld.check("worldERP", Value(0.2)).asFloat64();
+        p.stepper         = bParamWorld.check("stepper", Value("step")).asString();
+        p.quickStepIterations = bParamWorld.check("quickStepIterations", Value(20)).asInt32();
+        p.stepThreads     = bParamWorld.check("stepThreads", Value(0)).asInt32();
         
         p.maxContactCorrectingVel = bParamContacts.check("maxContactCorrectingVel", Value(1e6)).asFloat64();
         p.contactFrictionCoefficient = bParamContacts.check("contactFrictionCoefficient",Value(1.0)).asFloat64();
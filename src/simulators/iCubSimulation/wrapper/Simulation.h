@@ -23,6 +23,7 @@
 
 #include "RobotStreamer.h"
 #include "RobotConfig.h"
+#include <yarp/os/Stamp.h>
 #include <yarp/sig/Image.h>
 
 class Simulation {
@@ -53,6 +54,20 @@ public:
 
     virtual bool getImage(yarp::sig::ImageOf<yarp::sig::PixelRgb>& img) = 0;
 
+    /**
+     *
+     * Read the view just rendered for a camera (0 left, 1 right, 2 wide)
+     * into img, possibly with the latency of a few views so as not to wait
+     * for the rendering to complete.  The stamp of the view is passed in
+     * stamp, which is replaced by the one of img.  Returns false if no
+     * image is available yet.
+     *
+     */
+    virtual bool readImage(int camera, yarp::os::Stamp& stamp,
+                           yarp::sig::ImageOf<yarp::sig::PixelRgb>& img) {
+        return getImage(img);
+    }
+
     /**
      *
      * Signal that we're done with a view.
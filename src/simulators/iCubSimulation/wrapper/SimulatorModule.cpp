@@ -711,8 +711,7 @@ void SimulatorModule::displayStep(int pause) {
             case 'l':
                 if (needLeft) {
                     sim->drawView(true,false,false);
-                    getImage();
-                    sendImage(portLeft);
+                    sendImage(portLeft, 0);
                     sim->clearBuffer();
                 }
 #ifndef OMIT_LOGPOLAR    
@@ -733,8 +732,7 @@ void SimulatorModule::displayStep(int pause) {
             case 'r':
                 if (needRight) {
                     sim->drawView(false,true,false);
-                    getImage();
-                    sendImage(portRight);
+                    sendImage(portRight, 1);
                     sim->clearBuffer();
                 }
 #ifndef OMIT_LOGPOLAR    
@@ -755,8 +753,7 @@ void SimulatorModule::displayStep(int pause) {
             case 'w':
                 if (needWide) {
                     sim->drawView(false,false,true);
-                    getImage();
-                    sendImage(portWide);
+                    sendImage(portWide, 2);
                     sim->clearBuffer();
                 }
                 break;
@@ -785,10 +782,15 @@ void SimulatorModule::getImage(){
     sim->getImage(buffer);
 }
 
-void SimulatorModule::sendImage(BufferedPort<ImageOf<PixelRgb> >& port) {
+void SimulatorModule::sendImage(BufferedPort<ImageOf<PixelRgb> >& port, int camera) {
+    // the view is read straight into the image of the port, possibly some views late
+    Stamp stamp = camerasStamp;
     ImageOf<PixelRgb>& normal = port.prepare();
-    normal.copy( buffer );
-    port.setEnvelope(camerasStamp);
+    if (!sim->readImage(camera, stamp, normal)) {
+        port.unprepare();
+        return;
+    }
+    port.setEnvelope(stamp);
     port.write();
 }
 
@@ -108,7 +108,7 @@ private:
     void getTorques( yarp::os::BufferedPort<yarp::os::Bottle>& Port );
 
     void getImage();
-    void sendImage(yarp::os::BufferedPort<yarp::sig::ImageOf<yarp::sig::PixelRgb> >& port);
+    void sendImage(yarp::os::BufferedPort<yarp::sig::ImageOf<yarp::sig::PixelRgb> >& port, int camera);
 
     std::string moduleName;
     yarp::dev::IRobotDescription* idesc;
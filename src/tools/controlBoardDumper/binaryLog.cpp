@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#include "binaryLog.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include <yarp/os/Log.h>
+
+SampleQueue::SampleQueue() : capacity(1), width(0), head(0), tail(0)
+{
+}
+
+void SampleQueue::resize(unsigned int c, unsigned int w)
+{
+    // one slot is always left empty to tell a full queue from an empty one
+    capacity = c + 1;
+    width = w;
+    buffer.assign((size_t)capacity*width, 0.0);
+    head = 0;
+    tail = 0;
+}
+
+double *SampleQueue::beginWrite()
+{
+    unsigned int h = head.load(std::memory_order_relaxed);
+    if ((h+1)%capacity == tail.load(std::memory_order_acquire))
+        return 0;
+    return &buffer[(size_t)h*width];
+}
+
+void SampleQueue::endWrite()
+{
+    unsigned int h = head.load(std::memory_order_relaxed);
+    head.store((h+1)%capacity, std::memory_order_release);
+}
+
+const double *SampleQueue::beginRead()
+{
+    unsigned int t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+        return 0;
+    return &buffer[(size_t)t*width];
+}
+
+void SampleQueue::endRead()
+{
+    unsigned int t = tail.load(std::memory_order_relaxed);
+    tail.store((t+1)%capacity, std::memory_order_release);
+}
+
+binaryLogWriter::binaryLogWriter() : logFile(0), dumpers(0), nDumpers(0),
+    period(0.01), drops(0), rows(0)
+{
+}
+
+bool binaryLogWriter::open(const std::string &name, boardDumperThread *d, int n, double p)
+{
+    fileName = name;
+    dumpers = d;
+    nDumpers = n;
+    period = p;
+
+    logFile = fopen(fileName.c_str(), "wb");
+    if (logFile == 0)
+    {
+        yError("error opening binary logfile: %s\n", fileName.c_str());
+        return false;
+    }
+
+    uint32_t nReady = 0;
+    unsigned int nValues = 0;
+    for (int i = 0; i < nDumpers; i++)
+    {
+        if (dumpers[i].isReady())
+        {
+            nReady++;
+            nValues += dumpers[i].getNumberOfJointsRead();
+        }
+    }
+
+    fwrite(BINARYLOG_MAGIC, 1, sizeof(BINARYLOG_MAGIC), logFile);
+    fwrite(&nReady, sizeof(nReady), 1, logFile);
+    for (int i = 0; i < nDumpers; i++)
+    {
+        if (dumpers[i].isReady())
+        {
+            std::string portName = dumpers[i].getPortName();
+            uint32_t len = (uint32_t)portName.length();
+            uint32_t nj = (uint32_t)dumpers[i].getNumberOfJointsRead();
+            fwrite(&len, sizeof(len), 1, logFile);
+            fwrite(portName.c_str(), 1, len, logFile);
+            fwrite(&nj, sizeof(nj), 1, logFile);
+        }
+    }
+
+    // a few seconds of samples can be buffered
+    unsigned int capacity = std::max(1024U, (unsigned int)(4.0/period));
+    queue.resize(capacity, 2*nReady + nValues);
+
+    counts.assign(nReady*BINARYLOG_BLOCK_ROWS, 0);
+    times.assign(nReady*BINARYLOG_BLOCK_ROWS, 0.0);
+    values.assign(nValues*BINARYLOG_BLOCK_ROWS, 0.0);
+    rows = 0;
+
+    yInfo("binary logfile opened: %s\n", fileName.c_str());
+    return true;
+}
+
+bool binaryLogWriter::threadInit()
+{
+    return (logFile != 0);
+}
+
+bool binaryLogWriter::drain()
+{
+    bool any = false;
+    const double *record;
+    while ((record = queue.beginRead()) != 0)
+    {
+        unsigned int q = 0, column = 0;
+        for (int i = 0; i < nDumpers; i++)
+        {
+            if (!dumpers[i].isReady())
+                continue;
+
+            int nj = dumpers[i].getNumberOfJointsRead();
+            Stamp stamp((int)record[0], record[1]);
+            dumpers[i].publish(record+2, stamp);
+
+            counts[q*BINARYLOG_BLOCK_ROWS+rows] = (int32_t)record[0];
+            times[q*BINARYLOG_BLOCK_ROWS+rows] = record[1];
+            for (int j = 0; j < nj; j++)
+                values[(column+j)*BINARYLOG_BLOCK_ROWS+rows] = record[2+j];
+
+            record += 2 + nj;
+            column += nj;
+            q++;
+        }
+        queue.endRead();
+
+        if (++rows == BINARYLOG_BLOCK_ROWS)
+            flush();
+        any = true;
+    }
+    return any;
+}
+
+void binaryLogWriter::flush()
+{
+    if ((logFile == 0) || (rows == 0))
+        return;
+
+    uint32_t nRows = rows;
+    fwrite(&nRows, sizeof(nRows), 1, logFile);
+
+    unsigned int q = 0, column = 0;
+    for (int i = 0; i < nDumpers; i++)
+    {
+        if (!dumpers[i].isReady())
+            continue;
+
+        fwrite(&counts[q*BINARYLOG_BLOCK_ROWS], sizeof(int32_t), rows, logFile);
+        fwrite(&times[q*BINARYLOG_BLOCK_ROWS], sizeof(double), rows, logFile);
+        for (int j = 0; j < dumpers[i].getNumberOfJointsRead(); j++, column++)
+            fwrite(&values[column*BINARYLOG_BLOCK_ROWS], sizeof(double), rows, logFile);
+        q++;
+    }
+    rows = 0;
+}
+
+void binaryLogWriter::run()
+{
+    while (!isStopping())
+    {
+        if (!drain())
+            Time::delay(period);
+    }
+}
+
+void binaryLogWriter::threadRelease()
+{
+    drain();
+    flush();
+
+    if (drops > 0)
+        yWarning("%u samples could not be logged, the writer was lagging behind\n", drops.load());
+
+    if (logFile)
+    {
+        fprintf(stderr, "Closing binary logFile \n");
+        fclose(logFile);
+        logFile = 0;
+    }
+}
+
+bool convertBinaryLog(const std::string &fileName)
+{
+    FILE *in = fopen(fileName.c_str(), "rb");
+    if (in == 0)
+    {
+        yError("cannot open %s\n", fileName.c_str());
+        return false;
+    }
+
+    char magic[sizeof(BINARYLOG_MAGIC)];
+    uint32_t n = 0;
+    if ((fread(magic, 1, sizeof(magic), in) != sizeof(magic)) ||
+        (memcmp(magic, BINARYLOG_MAGIC, sizeof(magic)) != 0) ||
+        (fread(&n, sizeof(n), 1, in) != 1))
+    {
+        yError("%s is not a binary log of controlBoardDumper\n", fileName.c_str());
+        fclose(in);
+        return false;
+    }
+
+    // the text logs are named as those written by --logToFile
+    std::vector<FILE *> out(n, (FILE *)0);
+    std::vector<uint32_t> nj(n, 0);
+    bool ok = true;
+    for (uint32_t q = 0; (q < n) && ok; q++)
+    {
+        uint32_t len = 0;
+        ok = (fread(&len, sizeof(len), 1, in) == 1);
+        std::string name(ok ? len : 0, ' ');
+        ok = ok && (fread(&name[0], 1, len, in) == len);
+        ok = ok && (fread(&nj[q], sizeof(uint32_t), 1, in) == 1);
+        if (ok)
+        {
+            std::replace(name.begin(), name.end(), '/', '_');
+            name += ".log";
+            out[q] = fopen(name.c_str(), "w");
+            ok = (out[q] != 0);
+            if (ok)
+                yInfo("writing %s\n", name.c_str());
+            else
+                yError("error opening logfile: %s\n", name.c_str());
+        }
+    }
+
+    std::vector<int32_t> counts;
+    std::vector<double> times, values;
+    uint32_t rows;
+    unsigned int total = 0;
+    while (ok && (fread(&rows, sizeof(rows), 1, in) == 1))
+    {
+        counts.resize(rows);
+        times.resize(rows);
+        for (uint32_t q = 0; (q < n) && ok; q++)
+        {
+            values.resize((size_t)rows*nj[q]);
+            ok = (fread(counts.data(), sizeof(int32_t), rows, in) == rows) &&
+                 (fread(times.data(), sizeof(double), rows, in) == rows) &&
+                 (fread(values.data(), sizeof(double), values.size(), in) == values.size());
+            if (!ok)
+            {
+                yWarning("%s is truncated\n", fileName.c_str());
+                break;
+            }
+
+            for (uint32_t r = 0; r < rows; r++)
+            {
+                Bottle bData;
+                for (uint32_t j = 0; j < nj[q]; j++)
+                    bData.addFloat64(values[(size_t)j*rows+r]);
+
+                char buff [20];
+                sprintf(buff,"%d ",counts[r]);
+                fputs (buff,out[q]);
+                sprintf(buff,"%f ",times[r]);
+                fputs (buff,out[q]);
+                fputs (bData.toString().c_str(),out[q]);
+                fputs ("\n",out[q]);
+            }
+        }
+        total += rows;
+    }
+
+    for (uint32_t q = 0; q < n; q++)
+        if (out[q])
+            fclose(out[q]);
+    fclose(in);
+
+    yInfo("%u samples converted\n", total);
+    return ok;
+}
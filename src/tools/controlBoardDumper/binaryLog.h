@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/*
+ * Binary log of the data sampled by boardSamplerThread.
+ *
+ * The file starts with the magic "CBDUMP1", followed by the number of
+ * dumped data (uint32) and, for each of them, the length of its port name
+ * (uint32), the port name and the number of joints (uint32). The samples
+ * follow in blocks: the number of rows of the block (uint32) and, for each
+ * data, the columns of the stamp counts (int32), of the stamp times
+ * (double) and of the values of each joint (double). All fields are
+ * stored in the byte order of the machine that wrote the log.
+ */
+
+#ifndef __CONTROLBOARDDUMPER_BINARYLOG__
+#define __CONTROLBOARDDUMPER_BINARYLOG__
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+
+#include <yarp/os/Thread.h>
+
+#include "dumperThread.h"
+
+#define BINARYLOG_MAGIC         "CBDUMP1"
+#define BINARYLOG_BLOCK_ROWS    256
+
+// single producer, single consumer queue of fixed-size records,
+// the sampler writes and the writer reads them without locking
+class SampleQueue
+{
+public:
+  SampleQueue();
+  void resize(unsigned int capacity, unsigned int width);
+  unsigned int getWidth() const { return width; }
+
+  double *beginWrite();
+  void endWrite();
+  const double *beginRead();
+  void endRead();
+
+private:
+  std::vector<double> buffer;
+  unsigned int capacity;
+  unsigned int width;
+  std::atomic<unsigned int> head;
+  std::atomic<unsigned int> tail;
+};
+
+class binaryLogWriter: public Thread
+{
+public:
+  binaryLogWriter();
+  bool open(const std::string &fileName, boardDumperThread *dumpers, int n, double period);
+  SampleQueue &getQueue() { return queue; }
+  void countDrop() { drops++; }
+
+  bool threadInit();
+  void run();
+  void threadRelease();
+
+private:
+  bool drain();
+  void flush();
+
+  std::string fileName;
+  FILE *logFile;
+  boardDumperThread *dumpers;
+  int nDumpers;
+  double period;
+
+  SampleQueue queue;
+  std::atomic<unsigned int> drops;
+
+  std::vector<int32_t> counts;
+  std::vector<double> times;
+  std::vector<double> values;
+  unsigned int rows;
+};
+
+// converts a binary log into the text logs of --logToFile
+bool convertBinaryLog(const std::string &fileName);
+
+#endif
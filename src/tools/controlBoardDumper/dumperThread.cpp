@@ -18,6 +18,7 @@
  * Public License for more details
 */
 #include "dumperThread.h"
+#include "binaryLog.h"
 #include <cstring>
 #include <string>
 
@@ -100,6 +101,9 @@ bool boardDumperThread::threadInit()
         if (buff[i]=='/') buff[i]='_';
     strcat(buff,".log");
 
+    if (getter && !getter->hasStamp())
+        fprintf(stderr, "boardDumperThread::warning. Trying to get a stamp without a proper IPreciselyTimed defined. \n");
+
     if (logToFile)
     {
         logFile = fopen(buff,"w");
@@ -152,6 +156,31 @@ void boardDumperThread::threadRelease()
     }
 }
 
+bool boardDumperThread::sample(double *values, Stamp &stamp)
+{
+    if (!getter)
+        return false;
+
+    getter -> getData(data);
+    for (int i = 0; i < numberOfJointsRead; i++)
+        values[i] = data[dataMap[i]];
+
+    // a missing stamp is reported once, when the sampler is set up
+    if (getter->getStamp(stamp) && !stamp.isValid())
+        stamp=Stamp(-1,0.0);
+    return true;
+}
+
+void boardDumperThread::publish(const double *values, const Stamp &stamp)
+{
+    Bottle bData;
+    for (int i = 0; i < numberOfJointsRead; i++)
+        bData.addFloat64(values[i]);
+
+    port->setEnvelope(stamp);
+    port->write(bData);
+}
+
 void boardDumperThread::run()
 {
     //printf("Entering the main thread\n");
@@ -192,10 +221,6 @@ void boardDumperThread::run()
                 port->setEnvelope(stmp);
             }
         }
-        else
-        {
-            fprintf(stderr, "boardDumperThread::warning. Trying to get a stamp without a proper IPreciselyTimed defined. \n");
-        }
 
         if (logFile)
         {
@@ -210,4 +235,48 @@ void boardDumperThread::run()
         
         port->write(bData);
     }
-}  
+}
+
+boardSamplerThread::boardSamplerThread():PeriodicThread(0.5)
+{
+    dumpers  = 0;
+    nDumpers = 0;
+    writer   = 0;
+}
+
+void boardSamplerThread::setDumpers(boardDumperThread *d, int n, int rate, binaryLogWriter *w)
+{
+    dumpers  = d;
+    nDumpers = n;
+    writer   = w;
+    stamps.assign(n, Stamp());
+    this->setPeriod((double)rate/1000.0);
+
+    for (int i = 0; i < n; i++)
+        if (dumpers[i].isReady() && !dumpers[i].hasStamp())
+            fprintf(stderr, "boardSamplerThread::warning. %s has no IPreciselyTimed defined, its stamps are not logged. \n", dumpers[i].getPortName().c_str());
+}
+
+void boardSamplerThread::run()
+{
+    // the record is written in place and handed over to the writer
+    double *record = writer->getQueue().beginWrite();
+    if (record == 0)
+    {
+        writer->countDrop();
+        return;
+    }
+
+    for (int i = 0; i < nDumpers; i++)
+    {
+        if (!dumpers[i].isReady())
+            continue;
+
+        dumpers[i].sample(record+2, stamps[i]);
+        record[0] = stamps[i].getCount();
+        record[1] = stamps[i].getTime();
+        record += 2 + dumpers[i].getNumberOfJointsRead();
+    }
+
+    writer->getQueue().endWrite();
+}
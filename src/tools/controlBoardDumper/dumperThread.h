@@ -19,6 +19,7 @@
 */
 
 #include <string>
+#include <vector>
 #include <cmath>
 
 #include <yarp/os/Network.h>
@@ -41,6 +42,13 @@ public:
   void threadRelease();
   void run();
   void setGetter(GetData *);
+
+  bool isReady() const { return getter!=0; }
+  int  getNumberOfJointsRead() const { return numberOfJointsRead; }
+  std::string getPortName() const { return portName; }
+  bool hasStamp() const { return (getter!=0) && getter->hasStamp(); }
+  bool sample(double *values, Stamp &stamp);
+  void publish(const double *values, const Stamp &stamp);
     
 private:
   PolyDriver *board_dd;
@@ -74,3 +82,21 @@ private:
 
 };
 
+class binaryLogWriter;
+
+// samples all the data of the dumpers in one thread, leaving the
+// logging and the ports to the writer
+class boardSamplerThread: public PeriodicThread
+{
+public:
+  boardSamplerThread();
+  void setDumpers(boardDumperThread *dumpers, int n, int rate, binaryLogWriter *writer);
+  void run();
+
+private:
+  boardDumperThread *dumpers;
+  int nDumpers;
+  binaryLogWriter *writer;
+  std::vector<Stamp> stamps;
+};
+
@@ -33,6 +33,7 @@ public:
   GetData();
   virtual bool getData(double *) = 0;
   bool getStamp(Stamp &);
+  bool hasStamp() const { return myIstmp!=NULL; }
   void setStamp(IPreciselyTimed*);
   
 };
@@ -82,6 +82,8 @@
  *
  * logToFile                     //if present, this options creates a log file for each data port
  *
+ * binaryLog                     //if present, all data are sampled by a single thread and logged to a binary file
+ *
  * \endcode
  * 
  * If no such file can be found, the application is started
@@ -90,6 +92,15 @@
  * parameter ('part' with default 'head') specifies the used part.
  * The third parameter ('rate' with default '500') specifies the
  * acquisition rate.
+ * With binaryLog, all the data are sampled at once by a single periodic
+ * thread, which hands them over without locking to a writer thread that
+ * publishes them on the ports and stores them in columns into the file
+ * portPrefix.bin (slashes replaced by underscores, e.g.
+ * _controlBoardDumper_head_.bin). The binary log is converted offline
+ * into the text logs of logToFile by:
+ * \code
+ * controlBoardDumper --convertLog _controlBoardDumper_head_.bin
+ * \endcode
  * The parameter dataToDump can assume the following values:
  * <ul>
  * <li> getEncoders             (joint position)
@@ -193,6 +204,7 @@
 #include <yarp/os/LogStream.h>
 
 #include "dumperThread.h"
+#include "binaryLog.h"
 #include <string>
 
 #define NUMBER_OF_AVAILABLE_STANDARD_DATA_TO_DUMP 17
@@ -394,6 +406,9 @@ private:
     int nData;
 
     boardDumperThread *myDumper;
+    boardSamplerThread sampler;
+    binaryLogWriter writer;
+    bool binaryLog;
 
     //time stamp
     IPreciselyTimed *istmp;
@@ -431,7 +446,7 @@ private:
     GetInteractionModes myGetInteractionModes;
 
 public:
-    DumpModule() : useDebugClient(false)
+    DumpModule() : useDebugClient(false), binaryLog(false)
     { 
         istmp=0;
         ienc=0;
@@ -558,6 +573,11 @@ public:
 
         bool logToFile = false;
         if (rf.check("logToFile")) logToFile = true;
+        if (rf.check("binaryLog"))
+        {
+            binaryLog = true;
+            logToFile = false;
+        }
 
         portPrefix= dumpername + part.asString() + "/";
         //boardDumperThread *myDumper = new boardDumperThread(&dd, rate, portPrefix, dataToDump[0]);
@@ -884,8 +904,23 @@ public:
                 }
             }
         Time::delay(1);
-        for (int i = 0; i < nData; i++)
-            myDumper[i].start();
+        if (binaryLog)
+        {
+            std::string fileName = portPrefix + ".bin";
+            for (size_t i = 0; i < fileName.length(); i++)
+                if (fileName[i] == '/') fileName[i] = '_';
+
+            if (!writer.open(fileName, myDumper, nData, (double)rate/1000.0))
+                return false;
+            sampler.setDumpers(myDumper, nData, rate, &writer);
+            writer.start();
+            sampler.start();
+        }
+        else
+        {
+            for (int i = 0; i < nData; i++)
+                myDumper[i].start();
+        }
 
         return true;
     }
@@ -898,8 +933,19 @@ public:
     virtual bool close()
     {
         yInfo("Stopping dumper class\n");
-        for(int i = 0; i < nData; i++)
-            myDumper[i].stop();
+        if (binaryLog)
+        {
+            // the writer drains the samples still queued before stopping
+            sampler.stop();
+            writer.stop();
+            for(int i = 0; i < nData; i++)
+                myDumper[i].threadRelease();
+        }
+        else
+        {
+            for(int i = 0; i < nData; i++)
+                myDumper[i].stop();
+        }
 
         yInfo("Deleting dumper class\n");
         delete[] myDumper;
@@ -962,11 +1008,16 @@ int main(int argc, char *argv[])
         printf (" getTemperatures         (motor temperatures)\n");
         printf ("\n3) controlBoardDumper --robot icub --part left_arm --rate 10  --joints \"(0 1 2)\" --dataToDumpAll\n");
         printf ("   All data from the controlBoarWrapper will be dumped, including data from the debugInterface (getRotorxxx).\n");
-        printf ("\n --logToFile can be used to create log files storing the data\n\n");
+        printf ("\n --logToFile can be used to create log files storing the data\n");
+        printf (" --binaryLog samples all data in a single thread and logs them to a binary file\n");
+        printf (" --convertLog file converts a binary log into the log files of --logToFile\n\n");
 
         return 0;
     }
 
+    if (rf.check("convertLog"))
+        return (convertBinaryLog(rf.find("convertLog").asString()) ? 0 : 1);
+
     if (!yarp.checkNetwork())
     {
         yError()<<"YARP server not available!";
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2022 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <iCub/iDyn/iDyn.h>
+#include <iCub/iDyn/iDynBody.h>
+
+#include "gtest/gtest.h"
+
+using namespace yarp::sig;
+using namespace iCub::iDyn;
+using namespace iCub::skinDynLib;
+
+namespace
+{
+	// indexes of the active links, i.e. the rows of the DOF-dim quantities
+	std::vector<unsigned int> activeLinks(iDynChain &chain)
+	{
+		std::vector<unsigned int> idx;
+		for (unsigned int i = 0; i < chain.getN(); i++)
+			if (!chain[i].isBlocked())
+				idx.push_back(i);
+		return idx;
+	}
+
+	// random state of the chain, the blocked links included
+	void drawState(iDynChain &chain, std::mt19937 &gen, Vector &w0, Vector &dw0, Vector &ddp0, Vector &F, Vector &Mu)
+	{
+		std::uniform_real_distribution<double> d(-1.0, 1.0);
+		for (unsigned int i = 0; i < chain.getN(); i++)
+		{
+			double min = chain[i].getMin();
+			double max = chain[i].getMax();
+			if (!chain[i].isBlocked())
+				chain.setAng(i, min + 0.5 * (d(gen) + 1.0) * (max - min));
+			chain.setDAng(i, d(gen));
+			chain.setD2Ang(i, d(gen));
+		}
+
+		w0.resize(3);
+		dw0.resize(3);
+		ddp0.resize(3);
+		F.resize(3);
+		Mu.resize(3);
+		for (int k = 0; k < 3; k++)
+		{
+			w0[k] = d(gen);
+			dw0[k] = d(gen);
+			ddp0[k] = d(gen);
+			F[k] = 5.0 * d(gen);
+			Mu[k] = 0.5 * d(gen);
+		}
+		ddp0[2] += 9.81;
+	}
+
+	// the mass matrix from the Newton-Euler with unit accelerations
+	Matrix massMatrixNE(iDynChain &chain)
+	{
+		std::vector<unsigned int> idx = activeLinks(chain);
+		unsigned int dof = chain.getDOF();
+		Vector zero3(3, 0.0), tau;
+		Matrix M(dof, dof);
+		for (unsigned int i = 0; i < chain.getN(); i++)
+		{
+			chain.setDAng(i, 0.0);
+			chain.setD2Ang(i, 0.0);
+		}
+		for (unsigned int j = 0; j < dof; j++)
+		{
+			chain.setD2Ang(idx[j], 1.0);
+			chain.computeNewtonEuler(zero3, zero3, zero3, zero3, zero3);
+			chain.getTorques(tau);
+			for (unsigned int i = 0; i < dof; i++)
+				M(i, j) = tau[idx[i]];
+			chain.setD2Ang(idx[j], 0.0);
+		}
+		return M;
+	}
+
+	void checkMassMatrix(iDynChain &chain)
+	{
+		std::mt19937 gen(0);
+		Vector w0, dw0, ddp0, F, Mu;
+		chain.prepareNewtonEuler(DYNAMIC);
+		for (int trial = 0; trial < 20; trial++)
+		{
+			drawState(chain, gen, w0, dw0, ddp0, F, Mu);
+			Matrix M;
+			ASSERT_TRUE(chain.computeMassMatrix(M));
+			Matrix M_NE = massMatrixNE(chain);
+			ASSERT_EQ(M.rows(), M_NE.rows());
+			ASSERT_EQ(M.cols(), M_NE.cols());
+			for (size_t r = 0; r < M.rows(); r++)
+				for (size_t c = 0; c < M.cols(); c++)
+					EXPECT_NEAR(M(r, c), M_NE(r, c), 1e-9);
+		}
+	}
+
+	void checkForwardDynamics(iDynChain &chain)
+	{
+		std::mt19937 gen(1);
+		Vector w0, dw0, ddp0, F, Mu, t, ddq;
+		std::vector<unsigned int> idx = activeLinks(chain);
+		unsigned int dof = chain.getDOF();
+		chain.prepareNewtonEuler(DYNAMIC);
+		for (int trial = 0; trial < 20; trial++)
+		{
+			drawState(chain, gen, w0, dw0, ddp0, F, Mu);
+			Vector ddq_ref = chain.getD2Ang();
+
+			chain.computeNewtonEuler(w0, dw0, ddp0, F, Mu);
+			chain.getTorques(t);
+			Vector tau(dof);
+			for (unsigned int i = 0; i < dof; i++)
+				tau[i] = t[idx[i]];
+
+			ASSERT_TRUE(chain.computeForwardDynamics(w0, dw0, ddp0, F, Mu, tau, ddq));
+			ASSERT_EQ(ddq.length(), dof);
+			for (unsigned int i = 0; i < dof; i++)
+				EXPECT_NEAR(ddq[i], ddq_ref[i], 1e-6);
+
+			// the same through the state left by the Newton-Euler
+			ASSERT_TRUE(chain.computeForwardDynamics(tau, ddq));
+			for (unsigned int i = 0; i < dof; i++)
+				EXPECT_NEAR(ddq[i], ddq_ref[i], 1e-6);
+		}
+	}
+}
+
+TEST(iDynDynamics, mass_matrix_arm_torso_released)
+{
+	iCubArmDyn arm("right");
+	for (unsigned int i = 0; i < 3; i++)
+		arm.releaseLink(i);
+	checkMassMatrix(arm);
+}
+
+TEST(iDynDynamics, mass_matrix_leg)
+{
+	iCubLegDyn leg("left");
+	checkMassMatrix(leg);
+}
+
+TEST(iDynDynamics, mass_matrix_blocked_link)
+{
+	iCubArmDyn arm("left");
+	arm.blockLink(5, 0.3);
+	checkMassMatrix(arm);
+}
+
+TEST(iDynDynamics, forward_dynamics_arm_torso_released)
+{
+	// H0 of the arm is not the identity
+	iCubArmDyn arm("right");
+	for (unsigned int i = 0; i < 3; i++)
+		arm.releaseLink(i);
+	checkForwardDynamics(arm);
+}
+
+TEST(iDynDynamics, forward_dynamics_leg)
+{
+	iCubLegDyn leg("right");
+	checkForwardDynamics(leg);
+}
+
+TEST(iDynDynamics, forward_dynamics_blocked_link)
+{
+	iCubArmDyn arm("left");
+	arm.blockLink(5, 0.3);
+	checkForwardDynamics(arm);
+}
+
+TEST(iDynDynamics, whole_body_limbs_only)
+{
+	version_tag tag;
+	iCubWholeBody body(tag, DYNAMIC, NO_VERBOSE);
+	Matrix M;
+	EXPECT_TRUE(body.computeMassMatrix(LEFT_ARM, M));
+	EXPECT_EQ(M.rows(), body.upperTorso->left->getDOF());
+	EXPECT_FALSE(body.computeMassMatrix(BODY_PART_ALL, M));
+
+	Vector tau(body.upperTorso->left->getDOF(), 0.0), ddq;
+	EXPECT_TRUE(body.computeForwardDynamics(LEFT_ARM, tau, ddq));
+	EXPECT_EQ(ddq.length(), body.upperTorso->left->getDOF());
+	EXPECT_FALSE(body.computeForwardDynamics(BODY_PART_ALL, Vector(32, 0.0), ddq));
+}
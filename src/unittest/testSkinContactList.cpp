@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2022 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/Portable.h>
+#include <yarp/sig/Vector.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <iCub/skinDynLib/skinContactList.h>
+#include <iCub/skinDynLib/skinContactListView.h>
+
+#include "gtest/gtest.h"
+
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::skinDynLib;
+
+namespace
+{
+	// contacts with distinct values in every field, some without active taxels
+	skinContactList synthesize(int contacts)
+	{
+		std::mt19937 gen(0);
+		std::uniform_real_distribution<double> d(-1.0, 1.0);
+		skinContactList list;
+		for (int k = 0; k < contacts; k++)
+		{
+			Vector CoP(3), geo(3), normal(3), F(3), Mu(3);
+			for (int i = 0; i < 3; i++)
+			{
+				CoP[i] = d(gen);
+				geo[i] = d(gen);
+				normal[i] = d(gen);
+				F[i] = 5.0 * d(gen);
+				Mu[i] = 0.5 * d(gen);
+			}
+			std::vector<unsigned int> taxels(k % 7);
+			for (auto &t : taxels)
+				t = gen() % 1000;
+			list.push_back(skinContact((k % 2) ? LEFT_ARM : RIGHT_ARM, (k % 2) ? SKIN_LEFT_FOREARM : SKIN_RIGHT_HAND,
+									   k % 5, CoP, geo, taxels, std::fabs(d(gen)), normal, F, Mu));
+		}
+		return list;
+	}
+
+	void expectEqualVectors(const Vector &a, const Vector &b)
+	{
+		ASSERT_EQ(a.size(), b.size());
+		for (size_t i = 0; i < a.size(); i++)
+			EXPECT_EQ(a[i], b[i]);
+	}
+
+	void expectEqualLists(const skinContactList &a, const skinContactList &b)
+	{
+		ASSERT_EQ(a.size(), b.size());
+		for (size_t k = 0; k < a.size(); k++)
+		{
+			EXPECT_EQ(a[k].getId(), b[k].getId());
+			EXPECT_EQ(a[k].getBodyPart(), b[k].getBodyPart());
+			EXPECT_EQ(a[k].getSkinPart(), b[k].getSkinPart());
+			EXPECT_EQ(a[k].getLinkNumber(), b[k].getLinkNumber());
+			EXPECT_EQ(a[k].getPressure(), b[k].getPressure());
+			EXPECT_EQ(a[k].getActiveTaxels(), b[k].getActiveTaxels());
+			EXPECT_EQ(a[k].getTaxelList(), b[k].getTaxelList());
+			expectEqualVectors(a[k].getCoP(), b[k].getCoP());
+			expectEqualVectors(a[k].getGeoCenter(), b[k].getGeoCenter());
+			expectEqualVectors(a[k].getNormalDir(), b[k].getNormalDir());
+			expectEqualVectors(a[k].getForce(), b[k].getForce());
+			expectEqualVectors(a[k].getMoment(), b[k].getMoment());
+		}
+	}
+}
+
+TEST(skinContactList, pack_unpack_round_trip)
+{
+	skinContactList list = synthesize(20);
+	std::vector<char> buffer;
+	list.pack(buffer);
+	ASSERT_TRUE(skinContactList::checkPacked(buffer.data(), buffer.size()));
+
+	skinContactList copy;
+	ASSERT_TRUE(copy.unpack(buffer.data(), buffer.size()));
+	expectEqualLists(list, copy);
+
+	// unpacking into a longer list shrinks it
+	skinContactList longer = synthesize(30);
+	ASSERT_TRUE(longer.unpack(buffer.data(), buffer.size()));
+	expectEqualLists(list, longer);
+}
+
+TEST(skinContactList, pack_unpack_empty)
+{
+	skinContactList list;
+	std::vector<char> buffer;
+	list.pack(buffer);
+
+	skinContactList copy = synthesize(3);
+	ASSERT_TRUE(copy.unpack(buffer.data(), buffer.size()));
+	EXPECT_TRUE(copy.empty());
+}
+
+TEST(skinContactList, unpack_rejects_invalid_buffers)
+{
+	skinContactList list = synthesize(10);
+	std::vector<char> buffer;
+	list.pack(buffer);
+
+	skinContactList copy;
+	EXPECT_FALSE(copy.unpack(buffer.data(), buffer.size() - 1));
+	EXPECT_FALSE(copy.unpack(buffer.data(), sizeof(packedSkinContactListHeader) - 1));
+
+	std::vector<char> wrongTag = buffer;
+	wrongTag[0] ^= 1;
+	EXPECT_FALSE(copy.unpack(wrongTag.data(), wrongTag.size()));
+}
+
+TEST(skinContactList, write_read_both_encodings)
+{
+	skinContactList list = synthesize(20);
+	for (bool packed : {false, true})
+	{
+		list.setPackedEncoding(packed);
+
+		skinContactList copy;
+		ASSERT_TRUE(Portable::copyPortable(list, copy));
+		expectEqualLists(list, copy);
+
+		skinContactListView view;
+		ASSERT_TRUE(Portable::copyPortable(list, view));
+		ASSERT_EQ(view.size(), list.size());
+		expectEqualLists(list, view.toSkinContactList());
+	}
+}
+
+TEST(skinContactList, write_twice_keeps_content)
+{
+	// each write carries the content of the list at the time of the write
+	skinContactList list = synthesize(5);
+	list.setPackedEncoding(true);
+	skinContactList first, second;
+	ASSERT_TRUE(Portable::copyPortable(list, first));
+	skinContactList expected = list;
+
+	list = synthesize(12);
+	list.setPackedEncoding(true);
+	ASSERT_TRUE(Portable::copyPortable(list, second));
+	expectEqualLists(expected, first);
+	expectEqualLists(list, second);
+}